@@ -1,7 +1,316 @@
 
+// GeneratorPerformanceTest.cpp
+
+// Measures the performance of the generator building blocks on the array shapes the generators use,
+// of the whole generator pipeline (ini-driven and fused), of the cave and ravine carvers and of the piece-based structures
+
 #include "Globals.h"
-#include "ChunkGenerator.h"
+#include "LinearUpscale.h"
+#include "Logger.h"
+#include "LoggerListeners.h"
+#include "IniFile.h"
+#include "Generating/ChunkDesc.h"
+#include "Generating/ChunkGenerator.h"
+#include "Generating/ComposableGenerator.h"
+#include "Generating/FusedComposableGenerator.h"
+#include "Generating/Caves.h"
+#include "Generating/Ravines.h"
+#include "Generating/RoughRavines.h"
+#include "Generating/BioGen.h"
+#include "Generating/HeiGen.h"
+#include "Generating/NetherFortGen.h"
+#include "Generating/VillageGen.h"
+#include <chrono>
+
+
+
+
+
+/** Number of repetitions for each measurement; roughly one per generated chunk */
+static const int NUM_REPETITIONS = 20000;
+
+/** Size of the square area of chunks generated by each generator pipeline */
+static const int NUM_CHUNKS_SIDE = 24;
+
+/** Size of the square area of structure grid cells generated by each piece-based structure generator */
+static const int NUM_STRUCTURES_SIDE = 8;
+
+/** How far ahead (in chunks) the heightmap is queried before generating a chunk, imitating the structure finishers */
+static const int HEIGHTMAP_QUERY_AHEAD = 2;
 
-int main(int argc, char * argv[]) {
-	cChunkGenerator Generator = cChunkGenerator();
+
+
+
+
+/** Upscales the array NUM_REPETITIONS times using the specified upscaler and returns the average time per call, in microseconds. */
+template <typename Func>
+static double MeasureUpscale(Func a_Upscale, std::vector<float> & a_Src, std::vector<float> & a_Dst)
+{
+	auto Start = std::chrono::steady_clock::now();
+	for (int i = 0; i < NUM_REPETITIONS; i++)
+	{
+		a_Src[static_cast<size_t>(i) % a_Src.size()] += 1;  // Don't let the compiler hoist the work out of the loop
+		a_Upscale(a_Src.data(), a_Dst.data());
+	}
+	auto Duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Start);
+	return static_cast<double>(Duration.count()) / NUM_REPETITIONS;
 }
+
+
+
+
+
+/** Measures the 3D upscaler on a single array shape, comparing the runtime-factor code against the instance
+picked for the upscale factor, which is compile-time specialized for the common X factors. */
+static void BenchmarkUpscale3D(const char * a_Name, int a_SizeX, int a_SizeY, int a_SizeZ, int a_UpscaleX, int a_UpscaleY, int a_UpscaleZ)
+{
+	std::vector<float> Src(static_cast<size_t>(a_SizeX * a_SizeY * a_SizeZ));
+	for (size_t i = 0; i < Src.size(); i++)
+	{
+		Src[i] = static_cast<float>((i * 7919) % 1000) / 10;
+	}
+	std::vector<float> Dst(static_cast<size_t>(
+		((a_SizeX - 1) * a_UpscaleX + 1) * ((a_SizeY - 1) * a_UpscaleY + 1) * ((a_SizeZ - 1) * a_UpscaleZ + 1)
+	));
+
+	double Generic = MeasureUpscale([=](float * a_Src, float * a_Dst)
+		{
+			LinearUpscale3DArrayImpl<0>(a_Src, a_SizeX, a_SizeY, a_SizeZ, a_Dst, a_UpscaleX, a_UpscaleY, a_UpscaleZ);
+		},
+		Src, Dst
+	);
+	double Specialized = MeasureUpscale([=](float * a_Src, float * a_Dst)
+		{
+			LinearUpscale3DArray(a_Src, a_SizeX, a_SizeY, a_SizeZ, a_Dst, a_UpscaleX, a_UpscaleY, a_UpscaleZ);
+		},
+		Src, Dst
+	);
+	LOG("  %-28s %8.2f us generic, %8.2f us specialized (%.2fx)", a_Name, Generic, Specialized, Generic / Specialized);
+}
+
+
+
+
+
+/** Generates NUM_CHUNKS_SIDE x NUM_CHUNKS_SIDE chunks using the generator, row by row, and returns the average
+time per chunk, in milliseconds. If a_QueryHeightmaps is true, the heightmap of a chunk HEIGHTMAP_QUERY_AHEAD chunks
+further in the row is queried before each chunk, the way the structure finishers query the neighbors;
+the chunk's composition is then cached and its shape isn't generated again. */
+static double MeasureGenerator(cChunkGenerator::cGenerator & a_Generator, bool a_QueryHeightmaps)
+{
+	std::chrono::steady_clock::duration Total(0);
+	for (int z = 0; z < NUM_CHUNKS_SIDE; z++)
+	{
+		for (int x = 0; x < NUM_CHUNKS_SIDE; x++)
+		{
+			cChunkDesc ChunkDesc(x, z);
+			auto Start = std::chrono::steady_clock::now();
+			if (a_QueryHeightmaps)
+			{
+				cChunkDef::HeightMap HeightMap;
+				a_Generator.GenerateHeightMap(x + HEIGHTMAP_QUERY_AHEAD, z, HeightMap);
+			}
+			a_Generator.DoGenerate(x, z, ChunkDesc);
+			Total += std::chrono::steady_clock::now() - Start;
+		}
+	}
+	auto Duration = std::chrono::duration_cast<std::chrono::microseconds>(Total);
+	return static_cast<double>(Duration.count()) / 1000 / (NUM_CHUNKS_SIDE * NUM_CHUNKS_SIDE);
+}
+
+
+
+
+
+/** Fills the ini file with the default overworld stages and no finishers, so that only the stages themselves are measured. */
+static void SetGeneratorIniValues(cIniFile & a_IniFile)
+{
+	a_IniFile.SetValue("Generator", "BiomeGen", "Grown");
+	a_IniFile.SetValue("Generator", "ShapeGen", "BiomalNoise3D");
+	a_IniFile.SetValue("Generator", "CompositionGen", "Biomal");
+	a_IniFile.SetValue("Generator", "FusedPreset", "Overworld");
+	a_IniFile.SetValue("Generator", "Finishers", "");
+}
+
+
+
+
+
+/** Measures the ini-driven cComposableGenerator and the fused generator with the same (default overworld) stages side by side. */
+static void BenchmarkGenerators(bool a_QueryHeightmaps)
+{
+	// The cChunkGenerator is only used for the seed, which is zero until Start()-ed:
+	cChunkGenerator ChunkGenerator;
+	double Composable, Fused;
+	{
+		cIniFile IniFile;
+		SetGeneratorIniValues(IniFile);
+		cComposableGenerator Generator(ChunkGenerator);
+		Generator.Initialize(IniFile);
+		Composable = MeasureGenerator(Generator, a_QueryHeightmaps);
+	}
+	{
+		cIniFile IniFile;
+		SetGeneratorIniValues(IniFile);
+		cFusedComposableGenerator<cFusedPresetOverworld> Generator(ChunkGenerator);
+		Generator.Initialize(IniFile);
+		Fused = MeasureGenerator(Generator, a_QueryHeightmaps);
+	}
+	LOG("  %-28s %8.3f ms composable, %8.3f ms fused (%.2fx)",
+		a_QueryHeightmaps ? "with heightmap queries" : "stages only", Composable, Fused, Composable / Fused
+	);
+}
+
+
+
+
+
+/** Generates each chunk of the benchmark area using both the ini-driven and the fused generator and checks that
+they produce the same blocks and heightmaps. Returns true if they do. */
+static bool VerifyFusedGenerator(void)
+{
+	cChunkGenerator ChunkGenerator;
+	cIniFile ComposableIni, FusedIni;
+	SetGeneratorIniValues(ComposableIni);
+	SetGeneratorIniValues(FusedIni);
+	cComposableGenerator Composable(ChunkGenerator);
+	Composable.Initialize(ComposableIni);
+	cFusedComposableGenerator<cFusedPresetOverworld> Fused(ChunkGenerator);
+	Fused.Initialize(FusedIni);
+
+	int NumDifferent = 0;
+	for (int z = 0; z < NUM_CHUNKS_SIDE; z++)
+	{
+		for (int x = 0; x < NUM_CHUNKS_SIDE; x++)
+		{
+			cChunkDesc ComposableDesc(x, z);
+			cChunkDesc FusedDesc(x, z);
+			Composable.DoGenerate(x, z, ComposableDesc);
+			Fused.DoGenerate(x, z, FusedDesc);
+			cChunkDef::BlockNibbles ComposableMetas, FusedMetas;
+			ComposableDesc.CompressBlockMetas(ComposableMetas);
+			FusedDesc.CompressBlockMetas(FusedMetas);
+			if (
+				(memcmp(ComposableDesc.GetBlockTypes(), FusedDesc.GetBlockTypes(), sizeof(cChunkDef::BlockTypes)) != 0) ||
+				(memcmp(ComposableMetas, FusedMetas, sizeof(ComposableMetas)) != 0) ||
+				(memcmp(ComposableDesc.GetHeightMap(), FusedDesc.GetHeightMap(), sizeof(cChunkDef::HeightMap)) != 0)
+			)
+			{
+				LOGWARNING("  Chunk [%d, %d] differs between the composable and the fused generator", x, z);
+				NumDifferent += 1;
+			}
+		}
+	}
+	return (NumDifferent == 0);
+}
+
+
+
+
+
+/** Carves NUM_CHUNKS_SIDE x NUM_CHUNKS_SIDE chunks of solid terrain using the finisher and logs the average time per chunk. */
+static void BenchmarkCarver(const char * a_Name, cFinishGen & a_Carver)
+{
+	std::chrono::steady_clock::duration Total(0);
+	for (int z = 0; z < NUM_CHUNKS_SIDE; z++)
+	{
+		for (int x = 0; x < NUM_CHUNKS_SIDE; x++)
+		{
+			// Stone up to height 64, with a layer of sand on top, so that the caves' sandstone handling is exercised, too:
+			cChunkDesc ChunkDesc(x, z);
+			ChunkDesc.FillBlocks(E_BLOCK_AIR, 0);
+			ChunkDesc.FillRelCuboid(0, cChunkDef::Width - 1, 0, 59, 0, cChunkDef::Width - 1, E_BLOCK_STONE, 0);
+			ChunkDesc.FillRelCuboid(0, cChunkDef::Width - 1, 60, 64, 0, cChunkDef::Width - 1, E_BLOCK_SAND, 0);
+			ChunkDesc.UpdateHeightmap();
+			auto Start = std::chrono::steady_clock::now();
+			a_Carver.GenFinish(ChunkDesc);
+			Total += std::chrono::steady_clock::now() - Start;
+		}
+	}
+	auto Duration = std::chrono::duration_cast<std::chrono::microseconds>(Total);
+	LOG("  %-28s %8.1f us", a_Name, static_cast<double>(Duration.count()) / (NUM_CHUNKS_SIDE * NUM_CHUNKS_SIDE));
+}
+
+
+
+
+
+/** Generates one chunk in each of NUM_STRUCTURES_SIDE x NUM_STRUCTURES_SIDE cells of the structure grid, so that each
+chunk needs new structures to be placed, and logs the average time per chunk. a_GridSize is the generator's grid size. */
+static void BenchmarkStructures(const char * a_Name, cFinishGen & a_StructGen, int a_GridSize)
+{
+	std::chrono::steady_clock::duration Total(0);
+	for (int z = 0; z < NUM_STRUCTURES_SIDE; z++)
+	{
+		for (int x = 0; x < NUM_STRUCTURES_SIDE; x++)
+		{
+			cChunkDesc ChunkDesc(x * a_GridSize / cChunkDef::Width, z * a_GridSize / cChunkDef::Width);
+			ChunkDesc.FillBlocks(E_BLOCK_AIR, 0);
+			ChunkDesc.FillRelCuboid(0, cChunkDef::Width - 1, 0, 63, 0, cChunkDef::Width - 1, E_BLOCK_STONE, 0);
+			ChunkDesc.UpdateHeightmap();
+			auto Start = std::chrono::steady_clock::now();
+			a_StructGen.GenFinish(ChunkDesc);
+			Total += std::chrono::steady_clock::now() - Start;
+		}
+	}
+	auto Duration = std::chrono::duration_cast<std::chrono::microseconds>(Total);
+	LOG("  %-28s %8.1f us", a_Name, static_cast<double>(Duration.count()) / (NUM_STRUCTURES_SIDE * NUM_STRUCTURES_SIDE));
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	cLogger::cListener * consoleLogListener = MakeConsoleListener();
+	cLogger::GetInstance().AttachListener(consoleLogListener);
+
+	LOG("LinearUpscale3DArray, %d repetitions of each shape:", NUM_REPETITIONS);
+	BenchmarkUpscale3D("Noise3D 33x5x5 @ 8x4x4", 33, 5, 5, 8, 4, 4);
+	BenchmarkUpscale3D("Noise3DComp 5x33x5 @ 4x8x4", 5, 33, 5, 4, 8, 4);
+	BenchmarkUpscale3D("DistHei 3x65x3 @ 8x4x8", 3, 65, 3, 8, 4, 8);
+	BenchmarkUpscale3D("EndGen 5x5x65 @ 4x4x4", 5, 5, 65, 4, 4, 4);
+
+	LOG("Overworld generator pipeline, %d x %d chunks, average per chunk:", NUM_CHUNKS_SIDE, NUM_CHUNKS_SIDE);
+	BenchmarkGenerators(false);
+	BenchmarkGenerators(true);
+	if (!VerifyFusedGenerator())
+	{
+		LOGWARNING("The fused generator doesn't produce the same terrain as the composable generator!");
+	}
+
+	// The carvers use their default settings from cComposableGenerator:
+	LOG("Carvers, %d x %d chunks, average per chunk:", NUM_CHUNKS_SIDE, NUM_CHUNKS_SIDE);
+	{
+		cStructGenWormNestCaves Caves(0, 64, 96, 32);
+		BenchmarkCarver("WormNestCaves", Caves);
+	}
+	{
+		cStructGenRavines Ravines(0, 128);
+		BenchmarkCarver("Ravines", Ravines);
+	}
+	{
+		cRoughRavines RoughRavines(0, 128, 64, 8, 2, 0.2f, 0.05f, 8, 30, 20, 6, 56, 38, 58, 36, 256, 128);
+		BenchmarkCarver("RoughRavines", RoughRavines);
+	}
+
+	// The structures use their default settings from cComposableGenerator, on flat plains:
+	LOG("Piece-based structures, %d x %d grid cells, average per chunk:", NUM_STRUCTURES_SIDE, NUM_STRUCTURES_SIDE);
+	{
+		cNetherFortGen NetherForts(0, 512, 128, 12);
+		BenchmarkStructures("NetherForts", NetherForts, 512);
+	}
+	{
+		cVillageGen Villages(0, 384, 128, 2, 128, 50, 80, std::make_shared<cBioGenConstant>(), std::make_shared<cHeiGenFlat>());
+		BenchmarkStructures("Villages", Villages, 384);
+	}
+
+	cLogger::GetInstance().DetachListener(consoleLogListener);
+	delete consoleLogListener;
+	return 0;
+}
+
+
+
+
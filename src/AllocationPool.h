@@ -72,16 +72,17 @@ class cListAllocationPool : public cAllocationPool<T>
 				{
 					return new(space) T;
 				}
-				else if (m_FreeList.size() == NumElementsInReserve)
-				{
-					m_Callbacks->OnStartUsingReserve();
-				}
 				else if (m_FreeList.empty())
 				{
+					// Checked first, with no reserve (NumElementsInReserve == 0) the list is also at its reserve size
 					m_Callbacks->OnOutOfReserve();
 					// Try again until the memory is avalable
 					return Allocate();
 				}
+				else if (m_FreeList.size() == NumElementsInReserve)
+				{
+					m_Callbacks->OnStartUsingReserve();
+				}
 			}
 			// placement new, used to initalize the object
 			T * ret = new (m_FreeList.front()) T;
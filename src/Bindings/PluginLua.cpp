@@ -34,6 +34,7 @@ cPluginLua::cPluginLua(const AString & a_PluginDirectory) :
 	cPlugin(a_PluginDirectory),
 	m_LuaState(Printf("plugin %s", a_PluginDirectory.c_str()))
 {
+	m_CriticalSection.SetName("cPluginLua::m_CriticalSection");
 }
 
 
@@ -33,6 +33,7 @@ cPluginManager * cPluginManager::Get(void)
 
 
 cPluginManager::cPluginManager(void) :
+	m_ConsoleCommandsGeneration(0),
 	m_bReloadPlugins(false)
 {
 }
@@ -1501,6 +1502,7 @@ void cPluginManager::UnloadPluginsNow()
 
 	m_Commands.clear();
 	m_ConsoleCommands.clear();
+	m_ConsoleCommandsGeneration += 1;
 }
 
 
@@ -1693,6 +1695,7 @@ void cPluginManager::RemovePluginConsoleCommands(cPlugin * a_Plugin)
 			++itr;
 		}
 	}  // for itr - m_Commands[]
+	m_ConsoleCommandsGeneration += 1;
 }
 
 
@@ -1718,6 +1721,7 @@ bool cPluginManager::BindConsoleCommand(const AString & a_Command, cPlugin * a_P
 	m_ConsoleCommands[a_Command].m_Plugin     = a_Plugin;
 	m_ConsoleCommands[a_Command].m_Permission = "";
 	m_ConsoleCommands[a_Command].m_HelpString = a_HelpString;
+	m_ConsoleCommandsGeneration += 1;
 	return true;
 }
 
@@ -1770,6 +1774,31 @@ bool cPluginManager::ExecuteConsoleCommand(const AStringVector & a_Split, cComma
 		return false;
 	}
 
+	return ExecutePluginConsoleCommand(*cmd->second.m_Plugin, a_Split, a_Output);
+}
+
+
+
+
+
+cPlugin * cPluginManager::GetConsoleCommandPlugin(const AString & a_Command)
+{
+	CommandMap::const_iterator cmd = m_ConsoleCommands.find(a_Command);
+	if (cmd == m_ConsoleCommands.end())
+	{
+		return nullptr;
+	}
+	return cmd->second.m_Plugin;
+}
+
+
+
+
+
+bool cPluginManager::ExecutePluginConsoleCommand(cPlugin & a_Plugin, const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	ASSERT(!a_Split.empty());
+
 	// Ask plugins first if a command is okay to execute the console command:
 	if (CallHookExecuteCommand(nullptr, a_Split))
 	{
@@ -1777,7 +1806,7 @@ bool cPluginManager::ExecuteConsoleCommand(const AStringVector & a_Split, cComma
 		return false;
 	}
 
-	return cmd->second.m_Plugin->HandleConsoleCommand(a_Split, a_Output);
+	return a_Plugin.HandleConsoleCommand(a_Split, a_Output);
 }
 
 
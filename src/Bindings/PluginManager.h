@@ -283,6 +283,18 @@ public:
 	
 	/** Executes the command split into a_Split, as if it was given on the console. Returns true if executed. Output is sent to the a_Output callback */
 	bool ExecuteConsoleCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+
+	/** Returns the plugin that has bound the specified console command; nullptr if the command is built-in or not bound at all.
+	The returned value is valid only as long as GetConsoleCommandsGeneration() doesn't change. */
+	cPlugin * GetConsoleCommandPlugin(const AString & a_Command);
+
+	/** Returns a number that changes whenever a console command is bound or unbound,
+	so that the callers caching GetConsoleCommandPlugin() results know when to look the command up again. */
+	UInt32 GetConsoleCommandsGeneration(void) const { return m_ConsoleCommandsGeneration; }
+
+	/** Executes the console command split into a_Split with the specified plugin, previously looked up by GetConsoleCommandPlugin().
+	Calls the HOOK_EXECUTE_COMMAND hook first. Returns true if executed. */
+	bool ExecutePluginConsoleCommand(cPlugin & a_Plugin, const AStringVector & a_Split, cCommandOutputCallback & a_Output);
 	
 	/** Appends all commands beginning with a_Text (case-insensitive) into a_Results.
 	If a_Player is not nullptr, only commands for which the player has permissions are added.
@@ -320,6 +332,9 @@ private:
 	CommandMap m_Commands;
 	CommandMap m_ConsoleCommands;
 
+	/** Incremented on each change to m_ConsoleCommands, see GetConsoleCommandsGeneration() */
+	UInt32 m_ConsoleCommandsGeneration;
+
 	bool m_bReloadPlugins;
 
 	cPluginManager();
@@ -56,3 +56,72 @@ cBlockEntity * cBlockEntity::CreateByBlockType(BLOCKTYPE a_BlockType, NIBBLETYPE
 
 
 
+
+bool cBlockEntity::GetCachedNBT(eNBTCacheKind a_Kind, AString & a_NBT) const
+{
+	if (!IsNBTCacheable())
+	{
+		return false;
+	}
+	cCSLock Lock(m_CSNBTCache);
+	if ((m_CachedNBT == nullptr) || m_CachedNBT->m_NBT[a_Kind].empty())
+	{
+		return false;
+	}
+	a_NBT = m_CachedNBT->m_NBT[a_Kind];
+	return true;
+}
+
+
+
+
+
+int cBlockEntity::GetNBTCacheGeneration(void) const
+{
+	cCSLock Lock(m_CSNBTCache);
+	return m_NBTCacheGeneration;
+}
+
+
+
+
+
+void cBlockEntity::SetCachedNBT(eNBTCacheKind a_Kind, const AString & a_NBT, int a_Generation) const
+{
+	if (!IsNBTCacheable())
+	{
+		return;
+	}
+	cCSLock Lock(m_CSNBTCache);
+	if (a_Generation != m_NBTCacheGeneration)
+	{
+		// The block entity has changed while it was being serialized
+		return;
+	}
+	if (m_CachedNBT == nullptr)
+	{
+		m_CachedNBT.reset(new sCachedNBT);
+	}
+	m_CachedNBT->m_NBT[a_Kind] = a_NBT;
+}
+
+
+
+
+
+void cBlockEntity::InvalidateNBTCache(void)
+{
+	cCSLock Lock(m_CSNBTCache);
+	m_NBTCacheGeneration++;
+	if (m_CachedNBT != nullptr)
+	{
+		for (size_t i = 0; i < ARRAYCOUNT(m_CachedNBT->m_NBT); i++)
+		{
+			m_CachedNBT->m_NBT[i].clear();
+		}
+	}
+}
+
+
+
+
@@ -47,13 +47,22 @@ protected:
 		m_RelX(a_BlockX - cChunkDef::Width * FAST_FLOOR_DIV(a_BlockX, cChunkDef::Width)),
 		m_RelZ(a_BlockZ - cChunkDef::Width * FAST_FLOOR_DIV(a_BlockZ, cChunkDef::Width)),
 		m_BlockType(a_BlockType),
-		m_World(a_World)
+		m_World(a_World),
+		m_NBTCacheGeneration(0)
 	{
 	}
 
 public:
 	// tolua_end
 	
+	/** The kinds of serialized NBT that a block entity can cache. */
+	enum eNBTCacheKind
+	{
+		nbtSave = 0,  ///< The compound's contents, as written into the chunk's TileEntities list by cNBTChunkSerializer
+		nbtNetwork,   ///< The whole NBT sent in the 1.8 protocol's Update Block Entity packet
+		nbtCount,
+	} ;
+	
 	virtual ~cBlockEntity() {}  // force a virtual destructor in all descendants
 	
 	virtual void Destroy(void) {}
@@ -115,6 +124,22 @@ public:
 		UNUSED(a_Dt);
 		return false;
 	}
+	
+	/** Returns true if the block entity calls InvalidateNBTCache() whenever its saved or sent state changes.
+	Only such block entities keep the NBT passed to SetCachedNBT(). Block entities whose state changes on (almost) every tick,
+	such as the mob spawners' countdown, must not be cacheable, the cache would be stale or invalidated all the time. */
+	virtual bool IsNBTCacheable(void) const { return false; }
+	
+	/** Copies the cached NBT of the specified kind into a_NBT.
+	Returns false if there's nothing cached, the caller then needs to serialize the block entity and call SetCachedNBT(). */
+	bool GetCachedNBT(eNBTCacheKind a_Kind, AString & a_NBT) const;
+	
+	/** Returns the current generation of the NBT cache. Query it before serializing and pass it to SetCachedNBT(). */
+	int GetNBTCacheGeneration(void) const;
+	
+	/** Stores the NBT of the specified kind for reuse.
+	Ignored if the block entity has changed since a_Generation was queried, because a_NBT might be stale. */
+	void SetCachedNBT(eNBTCacheKind a_Kind, const AString & a_NBT, int a_Generation) const;
 
 protected:
 	/// Position in absolute block coordinates
@@ -126,6 +151,25 @@ protected:
 	BLOCKTYPE m_BlockType;
 	
 	cWorld * m_World;
+	
+	/** The cached serialized NBT of a single block entity, indexed by eNBTCacheKind; empty if not cached */
+	struct sCachedNBT
+	{
+		AString m_NBT[nbtCount];
+	} ;
+	
+	/** Protects m_CachedNBT and m_NBTCacheGeneration; the cache is filled from the storage and client threads while the tick thread invalidates it */
+	mutable cCriticalSection m_CSNBTCache;
+	
+	/** The cached serialized NBT; allocated on the first SetCachedNBT(), so that the block entities that don't cache pay only for the pointer */
+	mutable std::unique_ptr<sCachedNBT> m_CachedNBT;
+	
+	/** Incremented on each invalidation, so that NBT serialized concurrently with a change is not cached */
+	int m_NBTCacheGeneration;
+	
+	
+	/** Drops all the cached NBT. Descendants that return true from IsNBTCacheable() must call this after each change to their state. */
+	void InvalidateNBTCache(void);
 } ;  // tolua_export
 
 
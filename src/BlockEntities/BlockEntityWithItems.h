@@ -78,6 +78,7 @@ protected:
 	{
 		UNUSED(a_SlotNum);
 		ASSERT(a_Grid == &m_Contents);
+		InvalidateNBTCache();
 		if (m_World != nullptr)
 		{
 			if (GetWindow() != nullptr)
@@ -9,6 +9,7 @@
 #include "../CommandOutput.h"
 #include "../Root.h"
 #include "../Server.h"  // ExecuteConsoleCommand()
+#include "../Bindings/PluginManager.h"
 #include "../ChatColor.h"
 #include "../World.h"
 #include "../ClientHandle.h"
@@ -21,6 +22,11 @@ cCommandBlockEntity::cCommandBlockEntity(int a_X, int a_Y, int a_Z, cWorld * a_W
 	super(E_BLOCK_COMMAND_BLOCK, a_X, a_Y, a_Z, a_World),
 	m_ShouldExecute(false),
 	m_IsPowered(false),
+	m_IsCommandParsed(false),
+	m_IsAdminCommand(false),
+	m_IsCommandResolved(false),
+	m_CommandPlugin(nullptr),
+	m_CommandPluginGeneration(0),
 	m_Result(0)
 {}
 
@@ -42,6 +48,8 @@ void cCommandBlockEntity::UsedBy(cPlayer * a_Player)
 void cCommandBlockEntity::SetCommand(const AString & a_Cmd)
 {
 	m_Command = a_Cmd;
+	m_IsCommandParsed = false;
+	InvalidateNBTCache();
 
 	/*
 	Vanilla requires that the server send a Block Entity Update after a command has been set
@@ -59,8 +67,9 @@ void cCommandBlockEntity::SetCommand(const AString & a_Cmd)
 
 void cCommandBlockEntity::SetLastOutput(const AString & a_LastOut)
 {
-	m_World->BroadcastBlockEntity(GetPosX(), GetPosY(), GetPosZ());
 	m_LastOutput = a_LastOut;
+	InvalidateNBTCache();
+	m_World->BroadcastBlockEntity(GetPosX(), GetPosY(), GetPosZ());
 }
 
 
@@ -70,6 +79,7 @@ void cCommandBlockEntity::SetLastOutput(const AString & a_LastOut)
 void cCommandBlockEntity::SetResult(const NIBBLETYPE a_Result)
 {
 	m_Result = a_Result;
+	InvalidateNBTCache();
 }
 
 
@@ -105,7 +115,13 @@ NIBBLETYPE cCommandBlockEntity::GetResult(void) const
 
 void cCommandBlockEntity::Activate(void)
 {
+	// Already waiting in the world's queue, the activation would execute the command only once anyway:
+	if (m_ShouldExecute)
+	{
+		return;
+	}
 	m_ShouldExecute = true;
+	m_World->QueueCommandBlockExecution(GetPosX(), GetPosY(), GetPosZ());
 }
 
 
@@ -125,15 +141,12 @@ void cCommandBlockEntity::SetRedstonePower(bool a_IsPowered)
 
 
 
-bool cCommandBlockEntity::Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
+bool cCommandBlockEntity::ExecuteQueued(void)
 {
-	UNUSED(a_Dt);
-	UNUSED(a_Chunk);
 	if (!m_ShouldExecute)
 	{
 		return false;
 	}
-	
 	m_ShouldExecute = false;
 	Execute();
 	return true;
@@ -176,18 +189,39 @@ void cCommandBlockEntity::Execute()
 		}
 	} CmdBlockOutCb(this);
 
+	// The command is parsed only once after each change, a redstone clock may trigger it every few ticks:
+	if (!m_IsCommandParsed)
+	{
+		ParseCommand();
+	}
+
 	// Administrator commands are not executable by command blocks:
-	if (
-		(m_Command != "stop") &&
-		(m_Command != "restart") &&
-		(m_Command != "kick") &&
-		(m_Command != "ban") &&
-		(m_Command != "ipban")
-	)
+	if (!m_IsAdminCommand)
 	{
-		cServer * Server = cRoot::Get()->GetServer();
 		LOGD("cCommandBlockEntity: Executing command %s", m_Command.c_str());
-		Server->ExecuteConsoleCommand(m_Command, CmdBlockOutCb);
+
+		// Look the command's plugin up again only if the console command bindings have changed since the last time:
+		cPluginManager * PluginManager = cPluginManager::Get();
+		if (!m_IsCommandResolved || (m_CommandPluginGeneration != PluginManager->GetConsoleCommandsGeneration()))
+		{
+			// The server's built-in commands take precedence over any plugin binding, same as for the console:
+			bool IsForServer = m_CommandSplit.empty() || cServer::IsBuiltInConsoleCommand(m_CommandSplit[0]);
+			m_CommandPlugin = IsForServer ? nullptr : PluginManager->GetConsoleCommandPlugin(m_CommandSplit[0]);
+			m_CommandPluginGeneration = PluginManager->GetConsoleCommandsGeneration();
+			m_IsCommandResolved = true;
+		}
+
+		if (m_CommandPlugin != nullptr)
+		{
+			if (!PluginManager->ExecutePluginConsoleCommand(*m_CommandPlugin, m_CommandSplit, CmdBlockOutCb))
+			{
+				CmdBlockOutCb.Out("Unknown command, type 'help' for all commands.");
+			}
+		}
+		else
+		{
+			cRoot::Get()->GetServer()->ExecuteConsoleCommand(m_CommandSplit, CmdBlockOutCb);
+		}
 	}
 	else
 	{
@@ -197,6 +231,25 @@ void cCommandBlockEntity::Execute()
 
 	// TODO 2014-01-18 xdot: Update the signal strength.
 	m_Result = 0;
+	InvalidateNBTCache();
+}
+
+
+
+
+
+void cCommandBlockEntity::ParseCommand(void)
+{
+	m_CommandSplit = StringSplit(m_Command, " ");
+	m_IsAdminCommand = (
+		(m_Command == "stop") ||
+		(m_Command == "restart") ||
+		(m_Command == "kick") ||
+		(m_Command == "ban") ||
+		(m_Command == "ipban")
+	);
+	m_IsCommandParsed = true;
+	m_IsCommandResolved = false;
 }
 
 
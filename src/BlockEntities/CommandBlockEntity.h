@@ -16,6 +16,13 @@
 
 
 
+// fwd:
+class cPlugin;
+
+
+
+
+
 // tolua_begin
 
 class cCommandBlockEntity :
@@ -33,20 +40,24 @@ public:
 	/// Creates a new empty command block entity
 	cCommandBlockEntity(int a_X, int a_Y, int a_Z, cWorld * a_World);
 
-	virtual bool Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk) override;
 	virtual void SendTo(cClientHandle & a_Client) override;
 	virtual void UsedBy(cPlayer * a_Player) override;
+	virtual bool IsNBTCacheable(void) const override { return true; }
 
 	void SetLastOutput(const AString & a_LastOut);
 
 	void SetResult(const NIBBLETYPE a_Result);
 
+	/// Executes the command if the command block has been activated; called by the world when the command block's turn in its queue comes.
+	/// Returns true if the command has been executed, the chunk needs saving then.
+	bool ExecuteQueued(void);
+
 	// tolua_begin
 
 	/// Sets the internal redstone power flag to "on" or "off", depending on the parameter. Calls Activate() if appropriate
 	virtual void SetRedstonePower(bool a_IsPowered) override;
 
-	/// Sets the command block to execute a command in the next tick
+	/// Queues the command block in its world to execute the command, in the next tick unless the world's per-tick limit is reached
 	void Activate(void);
 	
 	/// Sets the command
@@ -68,11 +79,32 @@ private:
 	/// Executes the associated command
 	void Execute();
 
+	/// Splits m_Command into m_CommandSplit and checks whether it is an administration command
+	void ParseCommand(void);
+
 	bool m_ShouldExecute;
 	bool m_IsPowered;
 
 	AString m_Command;
 
+	/// Set once m_Command has been parsed into m_CommandSplit and m_IsAdminCommand; reset when the command changes
+	bool m_IsCommandParsed;
+
+	/// m_Command split into words, valid if m_IsCommandParsed
+	AStringVector m_CommandSplit;
+
+	/// Set if m_Command is an administration command that command blocks refuse to execute, valid if m_IsCommandParsed
+	bool m_IsAdminCommand;
+
+	/// Set once m_CommandPlugin has been resolved for the current command
+	bool m_IsCommandResolved;
+
+	/// The plugin that has bound the command; nullptr for the server's built-in and unknown commands, which are left to cServer
+	cPlugin * m_CommandPlugin;
+
+	/// The plugin manager's console commands generation for which m_CommandPlugin was resolved
+	UInt32 m_CommandPluginGeneration;
+
 	AString m_LastOutput;
 
 	NIBBLETYPE m_Result;
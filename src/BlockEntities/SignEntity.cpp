@@ -37,6 +37,7 @@ void cSignEntity::SetLines(const AString & a_Line1, const AString & a_Line2, con
 	m_Line[1] = a_Line2;
 	m_Line[2] = a_Line3;
 	m_Line[3] = a_Line4;
+	InvalidateNBTCache();
 }
 
 
@@ -51,6 +52,7 @@ void cSignEntity::SetLine(int a_Index, const AString & a_Line)
 		return;
 	}
 	m_Line[a_Index] = a_Line;
+	InvalidateNBTCache();
 }
 
 
@@ -45,6 +45,7 @@ public:
 	
 	virtual void UsedBy(cPlayer * a_Player) override;
 	virtual void SendTo(cClientHandle & a_Client) override;
+	virtual bool IsNBTCacheable(void) const override { return true; }
 
 private:
 
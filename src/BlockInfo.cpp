@@ -778,3 +778,22 @@ void cBlockInfo::Initialize(cBlockInfoArray & a_Info)
 
 
 
+
+
+
+
+const bool * cBlockInfo::GetCanBeTerraformedTable(void)
+{
+	// Same singleton approach as Get(), the table is filled in on the first call:
+	static bool Table[256];
+	static bool IsTableInitialized = false;
+	if (!IsTableInitialized)
+	{
+		for (size_t i = 0; i < ARRAYCOUNT(Table); i++)
+		{
+			Table[i] = CanBeTerraformed(static_cast<BLOCKTYPE>(i));
+		}
+		IsTableInitialized = true;
+	}
+	return Table;
+}
@@ -86,6 +86,10 @@ public:
 
 	inline static cBlockHandler * GetHandler      (BLOCKTYPE a_Type) { return Get(a_Type).m_Handler;             }
 
+	/** Returns a compact table of the CanBeTerraformed() values, indexed by the block type.
+	Meant for the generators' carving loops, where the whole cBlockInfo structures would keep evicting each other from the cache. */
+	static const bool * GetCanBeTerraformedTable(void);
+
 protected:
 	/** Storage for all the BlockInfo structures. */
 	typedef cBlockInfo cBlockInfoArray[256];
@@ -52,6 +52,7 @@ class cRedstonePoweredEntity;
 class cSetChunkData;
 
 typedef std::list<cClientHandle *>         cClientHandleList;
+typedef std::vector<cClientHandle *>       cClientHandleVector;
 typedef cItemCallback<cEntity>             cEntityCallback;
 typedef cItemCallback<cBeaconEntity>       cBeaconCallback;
 typedef cItemCallback<cChestEntity>        cChestCallback;
@@ -135,7 +136,9 @@ public:
 	Modifies the BlockEntity list in a_SetChunkData - moves the block entities into the chunk. */
 	void SetAllData(cSetChunkData & a_SetChunkData);
 	
-	void SetLight(
+	/** Sets the light as calculated by cLightingThread.
+	Returns a bitmask of the sections whose light has changed. */
+	UInt16 SetLight(
 		const cChunkDef::BlockNibbles & a_BlockLight,
 		const cChunkDef::BlockNibbles & a_SkyLight
 	);
@@ -429,7 +432,7 @@ public:
 	cBlockEntity * GetBlockEntity(const Vector3i & a_BlockPos) { return GetBlockEntity(a_BlockPos.x, a_BlockPos.y, a_BlockPos.z); }
 	
 	/** Returns true if the chunk should be ticked in the tick-thread.
-	Checks if there are any clients and if the always-tick flag is set */
+	Checks if there are any clients within the world's simulation distance and if the always-tick flag is set */
 	bool ShouldBeTicked(void) const;
 	
 	/** Increments (a_AlwaysTicked == true) or decrements (false) the m_AlwaysTicked counter.
@@ -439,6 +442,11 @@ public:
 	as at least one requests is active the chunk will be ticked). */
 	void SetAlwaysTicked(bool a_AlwaysTicked);
 
+	/** Updates the light around the blocks whose lighting has changed since the last call, using cLightUpdater.
+	If the update cannot be done incrementally, marks the light as invalid, so that the chunk is relit in cLightingThread.
+	Called by cChunkMap for each valid chunk in each tick, regardless of whether the chunk itself is ticked. */
+	void ProcessPendingLightUpdates(void);
+
 private:
 
 	friend class cChunkMap;
@@ -458,6 +466,24 @@ private:
 	} ;
 
 	typedef std::vector<sSetBlockQueueItem> sSetBlockQueueVector;
+
+	/** A block whose lighting properties have changed, waiting for cLightUpdater */
+	struct sPendingLightUpdate
+	{
+		int m_RelX, m_RelY, m_RelZ;
+		int m_OldHeight;  ///< The heightmap value of the block's column before the change
+
+		sPendingLightUpdate(int a_RelX, int a_RelY, int a_RelZ, int a_OldHeight) :
+			m_RelX(a_RelX), m_RelY(a_RelY), m_RelZ(a_RelZ), m_OldHeight(a_OldHeight)
+		{
+		}
+	} ;
+
+	typedef std::vector<sPendingLightUpdate> sPendingLightUpdates;
+
+	/** Maximum number of pending light updates; if more blocks change in a single tick,
+	it is cheaper to relight the entire chunk in cLightingThread. */
+	static const size_t MAX_PENDING_LIGHT_UPDATES = 256;
 	
 
 	/** Holds the presence status of the chunk - if it is present, or in the loader / generator queue, or unloaded */
@@ -475,11 +501,13 @@ private:
 	sSetBlockVector       m_PendingSendBlocks;  ///< Blocks that have changed and need to be sent to all clients
 	
 	sSetBlockQueueVector m_SetBlockQueue;  ///< Block changes that are queued to a specific tick
+
+	sPendingLightUpdates m_PendingLightUpdates;  ///< Blocks whose light needs updating, processed in ProcessPendingLightUpdates()
 	
 	// A critical section is not needed, because all chunk access is protected by its parent ChunkMap's csLayers
-	cClientHandleList  m_LoadedByClient;
-	cEntityList        m_Entities;
-	cBlockEntityList   m_BlockEntities;
+	cClientHandleVector m_LoadedByClient;  // Unordered, RemoveClient() swaps the removed client with the last one
+	cEntityList         m_Entities;
+	cBlockEntityList    m_BlockEntities;
 	
 	/** Number of times the chunk has been requested to stay (by various cChunkStay objects); if zero, the chunk can be unloaded */
 	int m_StayCount;
@@ -532,7 +560,7 @@ private:
 	void WakeUpSimulators(void);
 	
 	// Makes a copy of the list
-	cClientHandleList GetAllClients(void) const {return m_LoadedByClient; }
+	cClientHandleVector GetAllClients(void) const {return m_LoadedByClient; }
 
 	/** Sends m_PendingSendBlocks to all clients */
 	void BroadcastPendingBlockChanges(void);
@@ -297,6 +297,47 @@ NIBBLETYPE cChunkData::GetBlockLight(int a_RelX, int a_RelY, int a_RelZ) const
 
 
 
+bool cChunkData::SetBlockLight(int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_Light)
+{
+	if (
+		(a_RelX >= cChunkDef::Width)  || (a_RelX < 0) ||
+		(a_RelY >= cChunkDef::Height) || (a_RelY < 0) ||
+		(a_RelZ >= cChunkDef::Width)  || (a_RelZ < 0)
+	)
+	{
+		ASSERT(!"cChunkData::SetBlockLight(): index out of range!");
+		return false;
+	}
+
+	int Section = a_RelY / SectionHeight;
+	if (m_Sections[Section] == nullptr)
+	{
+		if ((a_Light & 0xf) == 0x00)
+		{
+			// Non-existent sections are dark already
+			return false;
+		}
+		m_Sections[Section] = Allocate();
+		if (m_Sections[Section] == nullptr)
+		{
+			ASSERT(!"Failed to allocate a new section in Chunkbuffer");
+			return false;
+		}
+		ZeroSection(m_Sections[Section]);
+	}
+	int Index = cChunkDef::MakeIndexNoCheck(a_RelX, a_RelY - (Section * SectionHeight), a_RelZ);
+	NIBBLETYPE oldval = m_Sections[Section]->m_BlockLight[Index / 2] >> ((Index & 1) * 4) & 0xf;
+	m_Sections[Section]->m_BlockLight[Index / 2] = static_cast<NIBBLETYPE>(
+		(m_Sections[Section]->m_BlockLight[Index / 2] & (0xf0 >> ((Index & 1) * 4))) |  // The untouched nibble
+		((a_Light & 0x0f) << ((Index & 1) * 4))  // The nibble being set
+	);
+	return oldval != (a_Light & 0x0f);
+}
+
+
+
+
+
 NIBBLETYPE cChunkData::GetSkyLight(int a_RelX, int a_RelY, int a_RelZ) const
 {
 	if ((a_RelX < cChunkDef::Width) && (a_RelX > -1) && (a_RelY < cChunkDef::Height) && (a_RelY > -1) && (a_RelZ < cChunkDef::Width) && (a_RelZ > -1))
@@ -320,6 +361,47 @@ NIBBLETYPE cChunkData::GetSkyLight(int a_RelX, int a_RelY, int a_RelZ) const
 
 
 
+bool cChunkData::SetSkyLight(int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_Light)
+{
+	if (
+		(a_RelX >= cChunkDef::Width)  || (a_RelX < 0) ||
+		(a_RelY >= cChunkDef::Height) || (a_RelY < 0) ||
+		(a_RelZ >= cChunkDef::Width)  || (a_RelZ < 0)
+	)
+	{
+		ASSERT(!"cChunkData::SetSkyLight(): index out of range!");
+		return false;
+	}
+
+	int Section = a_RelY / SectionHeight;
+	if (m_Sections[Section] == nullptr)
+	{
+		if ((a_Light & 0xf) == 0x0f)
+		{
+			// Non-existent sections are fully skylit already
+			return false;
+		}
+		m_Sections[Section] = Allocate();
+		if (m_Sections[Section] == nullptr)
+		{
+			ASSERT(!"Failed to allocate a new section in Chunkbuffer");
+			return false;
+		}
+		ZeroSection(m_Sections[Section]);
+	}
+	int Index = cChunkDef::MakeIndexNoCheck(a_RelX, a_RelY - (Section * SectionHeight), a_RelZ);
+	NIBBLETYPE oldval = m_Sections[Section]->m_BlockSkyLight[Index / 2] >> ((Index & 1) * 4) & 0xf;
+	m_Sections[Section]->m_BlockSkyLight[Index / 2] = static_cast<NIBBLETYPE>(
+		(m_Sections[Section]->m_BlockSkyLight[Index / 2] & (0xf0 >> ((Index & 1) * 4))) |  // The untouched nibble
+		((a_Light & 0x0f) << ((Index & 1) * 4))  // The nibble being set
+	);
+	return oldval != (a_Light & 0x0f);
+}
+
+
+
+
+
 cChunkData cChunkData::Copy(void) const
 {
 	cChunkData copy(m_Pool);
@@ -338,6 +420,32 @@ cChunkData cChunkData::Copy(void) const
 
 
 
+void cChunkData::CopyFrom(const cChunkData & a_Src)
+{
+	if (&a_Src == this)
+	{
+		return;
+	}
+	for (size_t i = 0; i < NumSections; i++)
+	{
+		if (a_Src.m_Sections[i] == nullptr)
+		{
+			Free(m_Sections[i]);
+			m_Sections[i] = nullptr;
+			continue;
+		}
+		if (m_Sections[i] == nullptr)
+		{
+			m_Sections[i] = Allocate();
+		}
+		*m_Sections[i] = *a_Src.m_Sections[i];
+	}
+}
+
+
+
+
+
 void cChunkData::CopyBlockTypes(BLOCKTYPE * a_Dest, size_t a_Idx, size_t a_Length) const
 {
 	size_t ToSkip = a_Idx;
@@ -428,6 +536,40 @@ void cChunkData::CopySkyLight(NIBBLETYPE * a_Dest) const
 
 
 
+UInt16 cChunkData::GetLightDifferences(const NIBBLETYPE * a_BlockLight, const NIBBLETYPE * a_SkyLight) const
+{
+	UInt16 res = 0;
+	for (size_t i = 0; i < NumSections; i++)
+	{
+		const NIBBLETYPE * BlockLight = a_BlockLight + i * SectionBlockCount / 2;
+		const NIBBLETYPE * SkyLight   = a_SkyLight   + i * SectionBlockCount / 2;
+		if (m_Sections[i] == nullptr)
+		{
+			// Non-existent sections are dark and fully skylit:
+			if (
+				!IsAllValue(BlockLight, SectionBlockCount / 2, (NIBBLETYPE)0x00) ||
+				!IsAllValue(SkyLight,   SectionBlockCount / 2, (NIBBLETYPE)0xff)
+			)
+			{
+				res |= static_cast<UInt16>(1 << i);
+			}
+			continue;
+		}
+		if (
+			(memcmp(m_Sections[i]->m_BlockLight,    BlockLight, sizeof(m_Sections[i]->m_BlockLight)) != 0) ||
+			(memcmp(m_Sections[i]->m_BlockSkyLight, SkyLight,   sizeof(m_Sections[i]->m_BlockSkyLight)) != 0)
+		)
+		{
+			res |= static_cast<UInt16>(1 << i);
+		}
+	}  // for i - m_Sections[]
+	return res;
+}
+
+
+
+
+
 void cChunkData::SetBlockTypes(const BLOCKTYPE * a_Src)
 {
 	ASSERT(a_Src != nullptr);
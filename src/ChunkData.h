@@ -57,12 +57,30 @@ public:
 	bool SetMeta(int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_Nibble);
 	
 	NIBBLETYPE GetBlockLight(int a_RelX, int a_RelY, int a_RelZ) const;
+
+	/** Sets the blocklight of a single block. Returns true if the value has changed. */
+	bool SetBlockLight(int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_Light);
 	
 	NIBBLETYPE GetSkyLight(int a_RelX, int a_RelY, int a_RelZ) const;
+
+	/** Sets the skylight of a single block. Returns true if the value has changed. */
+	bool SetSkyLight(int a_RelX, int a_RelY, int a_RelZ, NIBBLETYPE a_Light);
 	
 	/** Creates a (deep) copy of self. */
 	cChunkData Copy(void) const;
 
+	/** Replaces the contents with a (deep) copy of a_Src, allocating the sections from this object's own pool.
+	Sections that are already allocated are reused, so repeatedly copying into the same object doesn't allocate. */
+	void CopyFrom(const cChunkData & a_Src);
+
+	/** Returns the specified 16-block-high section, or nullptr if the section is not allocated,
+	which means it is all air, with no blocklight and full skylight. */
+	const sChunkSection * GetSection(size_t a_SectionNum) const
+	{
+		ASSERT(a_SectionNum < NumSections);
+		return m_Sections[a_SectionNum];
+	}
+
 	/** Copies the blocktype data into the specified flat array.
 	Optionally, only a part of the data is copied, as specified by the a_Idx and a_Length parameters. */
 	void CopyBlockTypes(BLOCKTYPE * a_Dest, size_t a_Idx = 0, size_t a_Length = cChunkDef::NumBlocks) const;
@@ -75,6 +93,10 @@ public:
 
 	/** Copies the skylight data into the specified flat array. */
 	void CopySkyLight  (NIBBLETYPE * a_Dest) const;
+
+	/** Returns a bitmask of the sections whose blocklight or skylight differs from the specified flat arrays.
+	Bit N is set if the section N (blocks at heights [16 * N, 16 * N + 15]) differs. */
+	UInt16 GetLightDifferences(const NIBBLETYPE * a_BlockLight, const NIBBLETYPE * a_SkyLight) const;
 	
 	/** Copies the blocktype data from the specified flat array into the internal representation.
 	Allocates sections that are needed for the operation.
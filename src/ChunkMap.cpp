@@ -36,6 +36,8 @@
 
 cChunkMap::cChunkMap(cWorld * a_World) :
 	m_World(a_World),
+	m_NumTickedChunks(0),
+	m_NumVisibleOnlyChunks(0),
 	m_Pool(
 		new cListAllocationPool<cChunkData::sChunkSection, 1600>(
 			std::auto_ptr<cAllocationPool<cChunkData::sChunkSection>::cStarvationCallbacks>(
@@ -44,7 +46,7 @@ cChunkMap::cChunkMap(cWorld * a_World) :
 		)
 	)
 {
-
+	m_CSLayers.SetName("cChunkMap::m_CSLayers");
 }
 
 
@@ -476,6 +478,7 @@ void cChunkMap::BroadcastEntityEffect(const cEntity & a_Entity, int a_EffectID,
 void cChunkMap::BroadcastEntityEquipment(const cEntity & a_Entity, short a_SlotNum, const cItem & a_Item, const cClientHandle * a_Exclude)
 {
 	cCSLock Lock(m_CSLayers);
+	a_Entity.InvalidateSpawnPackets();  // The cached spawn packets contain the old state
 	cChunkPtr Chunk = GetChunkNoGen(a_Entity.GetChunkX(), a_Entity.GetChunkZ());
 	if (Chunk == nullptr)
 	{
@@ -524,6 +527,8 @@ void cChunkMap::BroadcastEntityLook(const cEntity & a_Entity, const cClientHandl
 void cChunkMap::BroadcastEntityMetadata(const cEntity & a_Entity, const cClientHandle * a_Exclude)
 {
 	cCSLock Lock(m_CSLayers);
+	a_Entity.InvalidateSpawnPackets();  // The cached spawn packets contain the old state
+	a_Entity.StartMetadataBroadcast();  // The clients' protocols compute the changed entries once per protocol version
 	cChunkPtr Chunk = GetChunkNoGen(a_Entity.GetChunkX(), a_Entity.GetChunkZ());
 	if (Chunk == nullptr)
 	{
@@ -531,6 +536,7 @@ void cChunkMap::BroadcastEntityMetadata(const cEntity & a_Entity, const cClientH
 	}
 	// It's perfectly legal to broadcast packets even to invalid chunks!
 	Chunk->BroadcastEntityMetadata(a_Entity, a_Exclude);
+	a_Entity.FinishMetadataBroadcast(a_Exclude != nullptr);  // The excluded client has missed the changes
 }
 
 
@@ -962,7 +968,7 @@ void cChunkMap::SetChunkData(cSetChunkData & a_SetChunkData)
 
 
 
-void cChunkMap::ChunkLighted(
+UInt16 cChunkMap::ChunkLighted(
 	int a_ChunkX, int a_ChunkZ,
 	const cChunkDef::BlockNibbles & a_BlockLight,
 	const cChunkDef::BlockNibbles & a_SkyLight
@@ -972,10 +978,11 @@ void cChunkMap::ChunkLighted(
 	cChunkPtr Chunk = GetChunkNoLoad(a_ChunkX, a_ChunkZ);
 	if (Chunk == nullptr)
 	{
-		return;
+		return 0;
 	}
-	Chunk->SetLight(a_BlockLight, a_SkyLight);
+	UInt16 ChangedSections = Chunk->SetLight(a_BlockLight, a_SkyLight);
 	Chunk->MarkDirty();
+	return ChangedSections;
 }
 
 
@@ -1475,6 +1482,28 @@ EMCSBiome cChunkMap::GetBiomeAt (int a_BlockX, int a_BlockZ)
 
 
 
+int cChunkMap::GetHeightAt(int a_BlockX, int a_BlockZ)
+{
+	int ChunkX, ChunkZ, X = a_BlockX, Y = 0, Z = a_BlockZ;
+	cChunkDef::AbsoluteToRelative(X, Y, Z, ChunkX, ChunkZ);
+
+	{
+		cCSLock Lock(m_CSLayers);
+		cChunkPtr Chunk = GetChunkNoLoad(ChunkX, ChunkZ);
+		if ((Chunk != nullptr) && Chunk->IsValid())
+		{
+			return Chunk->GetHeight(X, Z);
+		}
+	}
+
+	// Not loaded, ask the generator outside of the lock, it may take a while:
+	return m_World->GetGenerator().GetHeightAt(a_BlockX, a_BlockZ);
+}
+
+
+
+
+
 bool cChunkMap::SetBiomeAt(int a_BlockX, int a_BlockZ, EMCSBiome a_Biome)
 {
 	int ChunkX, ChunkZ, X = a_BlockX, Y = 0, Z = a_BlockZ;
@@ -1623,14 +1652,14 @@ void cChunkMap::CompareChunkClients(int a_ChunkX1, int a_ChunkZ1, int a_ChunkX2,
 
 void cChunkMap::CompareChunkClients(cChunk * a_Chunk1, cChunk * a_Chunk2, cClientDiffCallback & a_Callback)
 {
-	cClientHandleList Clients1(a_Chunk1->GetAllClients());
-	cClientHandleList Clients2(a_Chunk2->GetAllClients());
+	cClientHandleVector Clients1(a_Chunk1->GetAllClients());
+	cClientHandleVector Clients2(a_Chunk2->GetAllClients());
 	
 	// Find "removed" clients:
-	for (cClientHandleList::iterator itr1 = Clients1.begin(); itr1 != Clients1.end(); ++itr1)
+	for (cClientHandleVector::iterator itr1 = Clients1.begin(); itr1 != Clients1.end(); ++itr1)
 	{
 		bool Found = false;
-		for (cClientHandleList::iterator itr2 = Clients2.begin(); itr2 != Clients2.end(); ++itr2)
+		for (cClientHandleVector::iterator itr2 = Clients2.begin(); itr2 != Clients2.end(); ++itr2)
 		{
 			if (*itr1 == *itr2)
 			{
@@ -1645,10 +1674,10 @@ void cChunkMap::CompareChunkClients(cChunk * a_Chunk1, cChunk * a_Chunk2, cClien
 	}  // for itr1 - Clients1[]
 	
 	// Find "added" clients:
-	for (cClientHandleList::iterator itr2 = Clients2.begin(); itr2 != Clients2.end(); ++itr2)
+	for (cClientHandleVector::iterator itr2 = Clients2.begin(); itr2 != Clients2.end(); ++itr2)
 	{
 		bool Found = false;
-		for (cClientHandleList::iterator itr1 = Clients1.begin(); itr1 != Clients1.end(); ++itr1)
+		for (cClientHandleVector::iterator itr1 = Clients1.begin(); itr1 != Clients1.end(); ++itr1)
 		{
 			if (*itr1 == *itr2)
 			{
@@ -1701,10 +1730,21 @@ void cChunkMap::RemoveClientFromChunks(cClientHandle * a_Client)
 {
 	cCSLock Lock(m_CSLayers);
 	
-	for (cChunkLayerList::const_iterator itr = m_Layers.begin(); itr != m_Layers.end(); ++itr)
+	// Visit only the chunks that the client is registered in, instead of scanning all the layers:
+	cChunkCoordsVector Chunks = a_Client->GetRegisteredChunks(m_World);
+	for (cChunkCoordsVector::const_iterator itr = Chunks.begin(), end = Chunks.end(); itr != end; ++itr)
 	{
-		(*itr)->RemoveClient(a_Client);
-	}  // for itr - m_Layers[]
+		cChunkPtr Chunk = GetChunkNoLoad(itr->m_ChunkX, itr->m_ChunkZ);
+		if (Chunk != nullptr)
+		{
+			Chunk->RemoveClient(a_Client);
+		}
+		else
+		{
+			// Shouldn't happen, chunks with clients don't get unloaded; make sure the client doesn't keep the stale entry:
+			a_Client->RemoveRegisteredChunk(m_World, itr->m_ChunkX, itr->m_ChunkZ);
+		}
+	}  // for itr - Chunks[]
 }
 
 
@@ -2626,6 +2666,17 @@ void cChunkMap::GetChunkStats(int & a_NumChunksValid, int & a_NumChunksDirty)
 
 
 
+void cChunkMap::GetChunkTickStats(int & a_NumTicked, int & a_NumVisibleOnly)
+{
+	cCSLock Lock(m_CSLayers);
+	a_NumTicked = m_NumTickedChunks;
+	a_NumVisibleOnly = m_NumVisibleOnlyChunks;
+}
+
+
+
+
+
 void cChunkMap::GrowMelonPumpkin(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, MTRand & a_Rand)
 {
 	int ChunkX, ChunkZ;
@@ -2723,10 +2774,13 @@ void cChunkMap::SpawnMobs(cMobSpawner& a_MobSpawner)
 void cChunkMap::Tick(std::chrono::milliseconds a_Dt)
 {
 	cCSLock Lock(m_CSLayers);
+	int NumTicked = 0, NumVisibleOnly = 0;
 	for (cChunkLayerList::iterator itr = m_Layers.begin(); itr != m_Layers.end(); ++itr)
 	{
-		(*itr)->Tick(a_Dt);
+		(*itr)->Tick(a_Dt, NumTicked, NumVisibleOnly);
 	}  // for itr - m_Layers
+	m_NumTickedChunks = NumTicked;
+	m_NumVisibleOnlyChunks = NumVisibleOnly;
 }
 
 
@@ -2920,7 +2974,7 @@ void cChunkMap::cChunkLayer::CollectMobCensus(cMobCensus& a_ToFill)
 		// We do count every Mobs in the world. But we are assuming that every chunk not loaded by any client
 		// doesn't affect us. Normally they should not have mobs because every "too far" mobs despawn
 		// If they have (f.i. when player disconnect) we assume we don't have to make them live or despawn
-		if ((m_Chunks[i] != nullptr) && m_Chunks[i]->IsValid() && m_Chunks[i]->HasAnyClients())
+		if ((m_Chunks[i] != nullptr) && m_Chunks[i]->IsValid() && m_Chunks[i]->ShouldBeTicked())
 		{
 			m_Chunks[i]->CollectMobCensus(a_ToFill);
 		}
@@ -2937,7 +2991,7 @@ void cChunkMap::cChunkLayer::SpawnMobs(cMobSpawner& a_MobSpawner)
 	for (size_t i = 0; i < ARRAYCOUNT(m_Chunks); i++)
 	{
 		// We only spawn close to players
-		if ((m_Chunks[i] != nullptr) && m_Chunks[i]->IsValid() && m_Chunks[i]->HasAnyClients())
+		if ((m_Chunks[i] != nullptr) && m_Chunks[i]->IsValid() && m_Chunks[i]->ShouldBeTicked())
 		{
 			m_Chunks[i]->SpawnMobs(a_MobSpawner);
 		}
@@ -2948,30 +3002,29 @@ void cChunkMap::cChunkLayer::SpawnMobs(cMobSpawner& a_MobSpawner)
 
 
 
-void cChunkMap::cChunkLayer::Tick(std::chrono::milliseconds a_Dt)
+void cChunkMap::cChunkLayer::Tick(std::chrono::milliseconds a_Dt, int & a_NumTicked, int & a_NumVisibleOnly)
 {
 	for (size_t i = 0; i < ARRAYCOUNT(m_Chunks); i++)
 	{
-		// Only tick chunks that are valid and should be ticked:
-		if ((m_Chunks[i] != nullptr) && m_Chunks[i]->IsValid() && m_Chunks[i]->ShouldBeTicked())
+		if ((m_Chunks[i] == nullptr) || !m_Chunks[i]->IsValid())
 		{
-			m_Chunks[i]->Tick(a_Dt);
+			continue;
 		}
-	}  // for i - m_Chunks[]
-}
-
-
 
-
-
-void cChunkMap::cChunkLayer::RemoveClient(cClientHandle * a_Client)
-{
-	for (size_t i = 0; i < ARRAYCOUNT(m_Chunks); i++)
-	{
-		if (m_Chunks[i] != nullptr)
+		// Only tick chunks that should be ticked:
+		if (m_Chunks[i]->ShouldBeTicked())
 		{
-			m_Chunks[i]->RemoveClient(a_Client);
+			m_Chunks[i]->Tick(a_Dt);
+			a_NumTicked++;
 		}
+		else if (m_Chunks[i]->HasAnyClients())
+		{
+			// Outside the simulation distance, only sent to the clients
+			a_NumVisibleOnly++;
+		}
+
+		// Update the light after block changes, even in chunks that are not ticked, so that their light stays valid:
+		m_Chunks[i]->ProcessPendingLightUpdates();
 	}  // for i - m_Chunks[]
 }
 
@@ -122,7 +122,9 @@ public:
 	*/
 	void SetChunkData(cSetChunkData & a_SetChunkData);
 	
-	void ChunkLighted(
+	/** Sets the light calculated by cLightingThread into the chunk.
+	Returns a bitmask of the chunk sections whose light has changed (as used by cChunkDataSerializer). */
+	UInt16 ChunkLighted(
 		int a_ChunkX, int a_ChunkZ,
 		const cChunkDef::BlockNibbles & a_BlockLight,
 		const cChunkDef::BlockNibbles & a_SkyLight
@@ -170,6 +172,9 @@ public:
 	
 	/** Returns the biome at the specified coords. Reads the biome from the chunk, if loaded, otherwise uses the world generator to provide the biome value */
 	EMCSBiome GetBiomeAt (int a_BlockX, int a_BlockZ);
+
+	/** Returns the height at the specified coords; if the chunk is not loaded, asks the world generator (without loading or generating the chunk) */
+	int GetHeightAt(int a_BlockX, int a_BlockZ);
 	
 	/** Sets the biome at the specified coords. Returns true if successful, false if not (chunk not loaded).
 	Doesn't resend the chunk to clients. */
@@ -329,6 +334,9 @@ public:
 
 	/** Returns the number of valid chunks and the number of dirty chunks */
 	void GetChunkStats(int & a_NumChunksValid, int & a_NumChunksDirty);
+
+	/** Returns the number of chunks ticked in the last tick, and the number of chunks with clients that were not ticked (outside the simulation distance). */
+	void GetChunkTickStats(int & a_NumTicked, int & a_NumVisibleOnly);
 	
 	/** Grows a melon or a pumpkin next to the block specified (assumed to be the stem) */
 	void GrowMelonPumpkin(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, MTRand & a_Rand);
@@ -415,9 +423,9 @@ private:
 		/** Try to Spawn Monsters inside all Chunks */
 		void SpawnMobs(cMobSpawner& a_MobSpawner);
 
-		void Tick(std::chrono::milliseconds a_Dt);
-		
-		void RemoveClient(cClientHandle * a_Client);
+		/** Ticks all the chunks that should be ticked; adds the number of ticked chunks, and of the chunks
+		that have clients but are not ticked, to the respective counters. */
+		void Tick(std::chrono::milliseconds a_Dt, int & a_NumTicked, int & a_NumVisibleOnly);
 		
 		/** Calls the callback for each entity in the entire world; returns true if all entities processed, false if the callback aborted by returning true */
 		bool ForEachEntity(cEntityCallback & a_Callback);  // Lua-accessible
@@ -479,6 +487,12 @@ private:
 	cEvent           m_evtChunkValid;  // Set whenever any chunk becomes valid, via ChunkValidated()
 
 	cWorld * m_World;
+
+	/** Number of chunks ticked in the last tick, protected by m_CSLayers */
+	int m_NumTickedChunks;
+
+	/** Number of chunks with clients that were not ticked in the last tick (outside the simulation distance), protected by m_CSLayers */
+	int m_NumVisibleOnlyChunks;
 	
 	cCriticalSection m_CSFastSetBlock;
 	sSetBlockList    m_FastSetBlockQueue;
@@ -30,6 +30,22 @@ void cNotifyChunkSender::Call(int a_ChunkX, int a_ChunkZ)
 
 
 
+/** Starvation callbacks for cChunkSender's section pool; the pool has no reserve, so only the out-of-memory is reported. */
+class cChunkSenderPoolCallbacks :
+	public cAllocationPool<cChunkData::sChunkSection>::cStarvationCallbacks
+{
+	virtual void OnStartUsingReserve() override {}
+	virtual void OnEndUsingReserve() override {}
+	virtual void OnOutOfReserve() override
+	{
+		LOG("ChunkSender: Out of Memory");
+	}
+};
+
+
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // cChunkSender:
 
@@ -37,8 +53,11 @@ cChunkSender::cChunkSender(void) :
 	super("ChunkSender"),
 	m_World(nullptr),
 	m_RemoveCount(0),
-	m_Notify(nullptr)
+	m_Notify(nullptr),
+	m_Pool(std::auto_ptr<cAllocationPool<cChunkData::sChunkSection>::cStarvationCallbacks>(new cChunkSenderPoolCallbacks())),
+	m_Data(m_Pool)
 {
+	m_CS.SetName("cChunkSender::m_CS");
 	m_Notify.SetChunkSender(this);
 }
 
@@ -138,6 +157,28 @@ void cChunkSender::QueueSendChunkTo(int a_ChunkX, int a_ChunkZ, eChunkPriority a
 
 
 
+void cChunkSender::QueueSendChunkSections(int a_ChunkX, int a_ChunkZ, UInt16 a_SectionMask)
+{
+	{
+		cCSLock Lock(m_CS);
+		for (sSendSectionsList::iterator itr = m_SendSections.begin(), end = m_SendSections.end(); itr != end; ++itr)
+		{
+			if ((itr->m_ChunkX == a_ChunkX) && (itr->m_ChunkZ == a_ChunkZ))
+			{
+				// Already queued, just add the new sections:
+				itr->m_SectionMask |= a_SectionMask;
+				return;
+			}
+		}  // for itr - m_SendSections[]
+		m_SendSections.push_back(sSendSections(a_ChunkX, a_ChunkZ, a_SectionMask));
+	}
+	m_evtQueue.Set();
+}
+
+
+
+
+
 void cChunkSender::RemoveClient(cClientHandle * a_Client)
 {
 	{
@@ -184,7 +225,7 @@ void cChunkSender::Execute(void)
 	while (!m_ShouldTerminate)
 	{
 		cCSLock Lock(m_CS);
-		while (m_ChunksReady.empty() && m_SendChunksLowPriority.empty() && m_SendChunksMediumPriority.empty() && m_SendChunksHighPriority.empty())
+		while (m_ChunksReady.empty() && m_SendChunksLowPriority.empty() && m_SendChunksMediumPriority.empty() && m_SendChunksHighPriority.empty() && m_SendSections.empty())
 		{
 			int RemoveCount = m_RemoveCount;
 			m_RemoveCount = 0;
@@ -218,6 +259,15 @@ void cChunkSender::Execute(void)
 			
 			SendChunk(Coords.m_ChunkX, Coords.m_ChunkZ, nullptr);
 		}
+		else if (!m_SendSections.empty())
+		{
+			// Take one from the queue:
+			sSendSections Sections(m_SendSections.front());
+			m_SendSections.pop_front();
+			Lock.Unlock();
+
+			SendChunkSections(Sections.m_ChunkX, Sections.m_ChunkZ, Sections.m_SectionMask);
+		}
 		else if (!m_SendChunksMediumPriority.empty())
 		{
 			// Take one from the queue:
@@ -285,7 +335,7 @@ void cChunkSender::SendChunk(int a_ChunkX, int a_ChunkZ, cClientHandle * a_Clien
 	{
 		return;
 	}
-	cChunkDataSerializer Data(m_BlockTypes, m_BlockMetas, m_BlockLight, m_BlockSkyLight, m_BiomeMap);
+	cChunkDataSerializer Data(m_Data, m_BiomeMap);
 
 	// Send:
 	if (a_Client == nullptr)
@@ -318,6 +368,34 @@ void cChunkSender::SendChunk(int a_ChunkX, int a_ChunkZ, cClientHandle * a_Clien
 
 
 
+void cChunkSender::SendChunkSections(int a_ChunkX, int a_ChunkZ, UInt16 a_SectionMask)
+{
+	ASSERT(m_World != nullptr);
+	
+	// If the chunk is not lighted, it will be resent once the lighting finishes:
+	if (!m_World->IsChunkValid(a_ChunkX, a_ChunkZ) || !m_World->IsChunkLighted(a_ChunkX, a_ChunkZ))
+	{
+		return;
+	}
+
+	// Query and prepare chunk data:
+	if (!m_World->GetChunkData(a_ChunkX, a_ChunkZ, *this))
+	{
+		return;
+	}
+	cChunkDataSerializer Data(m_Data, m_BiomeMap, a_SectionMask);
+
+	// Send; the clients only accept the partial data for chunks they already have:
+	m_World->BroadcastChunkData(a_ChunkX, a_ChunkZ, Data);
+
+	// The block entities haven't changed, the clients already have them:
+	m_BlockEntities.clear();
+}
+
+
+
+
+
 void cChunkSender::BlockEntity(cBlockEntity * a_Entity)
 {
 	m_BlockEntities.push_back(sBlockCoord(a_Entity->GetPosX(), a_Entity->GetPosY(), a_Entity->GetPosZ()));
@@ -335,6 +413,16 @@ void cChunkSender::Entity(cEntity *)
 
 
 
+void cChunkSender::ChunkData(const cChunkData & a_Data)
+{
+	// Copy only the allocated sections, reusing our own sections from the previous chunk:
+	m_Data.CopyFrom(a_Data);
+}
+
+
+
+
+
 void cChunkSender::BiomeData(const cChunkDef::BiomeMap * a_BiomeMap)
 {
 	for (size_t i = 0; i < ARRAYCOUNT(m_BiomeMap); i++)
@@ -13,6 +13,8 @@ And once they do, it requests the chunk data and sends it all away, either
 	sends to a specific client (QueueSendChunkTo)
 Chunk data is queried using the cChunkDataCallback interface.
 It is cached inside the ChunkSender object during the query and then processed after the query ends.
+Only the allocated sections of the chunk's cChunkData are copied, into sections owned by the ChunkSender
+that are reused for each chunk, and the serializer then reads them directly, without any flat arrays.
 Note that the data needs to be compressed only *after* the query finishes,
 because the query callbacks run with ChunkMap's CS locked.
 
@@ -69,7 +71,7 @@ public:
 
 class cChunkSender:
 	public cIsThread,
-	public cChunkDataSeparateCollector
+	public cChunkDataCallback
 {
 	typedef cIsThread super;
 public:
@@ -93,6 +95,11 @@ public:
 	/// Queues a chunk to be sent to a specific client
 	void QueueSendChunkTo(int a_ChunkX, int a_ChunkZ, eChunkPriority a_Priority, cClientHandle * a_Client);
 	
+	/** Queues the specified sections of a chunk to be resent to all its clients that have already received the chunk.
+	Used when the chunk's light changes. a_SectionMask is the bitmask of the 16-block-high sections to send.
+	Multiple requests for the same chunk are merged together. */
+	void QueueSendChunkSections(int a_ChunkX, int a_ChunkZ, UInt16 a_SectionMask);
+	
 	/// Removes the a_Client from all waiting chunk send operations
 	void RemoveClient(cClientHandle * a_Client);
 	
@@ -123,6 +130,22 @@ protected:
 	} ;
 	typedef std::list<sSendChunk> sSendChunkList;
 
+	/// Used for resending parts of chunks to their clients
+	struct sSendSections
+	{
+		int m_ChunkX;
+		int m_ChunkZ;
+		UInt16 m_SectionMask;
+		
+		sSendSections(int a_ChunkX, int a_ChunkZ, UInt16 a_SectionMask) :
+			m_ChunkX(a_ChunkX),
+			m_ChunkZ(a_ChunkZ),
+			m_SectionMask(a_SectionMask)
+		{
+		}
+	} ;
+	typedef std::list<sSendSections> sSendSectionsList;
+
 	struct sBlockCoord
 	{
 		int m_BlockX;
@@ -146,14 +169,19 @@ protected:
 	sSendChunkList    m_SendChunksLowPriority;
 	sSendChunkList    m_SendChunksMediumPriority;
 	sSendChunkList    m_SendChunksHighPriority;
+	sSendSectionsList m_SendSections;
 	cEvent            m_evtQueue;  // Set when anything is added to m_ChunksReady
 	cEvent            m_evtRemoved;  // Set when removed clients are safe to be deleted
 	int               m_RemoveCount;  // Number of threads waiting for a client removal (m_evtRemoved needs to be set this many times)
 	
 	cNotifyChunkSender m_Notify;  // Used for chunks that don't have a valid lighting - they will be re-queued after lightcalc
 	
+	/** The pool for m_Data's sections; used only by the sender thread, separate from the chunkmap's pool,
+	because the sections are freed outside of the chunkmap's lock. */
+	cListAllocationPool<cChunkData::sChunkSection, 0> m_Pool;
+
 	// Data about the chunk that is being sent:
-	// NOTE that m_BlockData[] is inherited from the cChunkDataCollector
+	cChunkData    m_Data;
 	unsigned char m_BiomeMap[cChunkDef::Width * cChunkDef::Width];
 	sBlockCoords  m_BlockEntities;  // Coords of the block entities to send
 	// TODO: sEntityIDs    m_Entities;       // Entity-IDs of the entities to send
@@ -164,11 +192,15 @@ protected:
 	// cChunkDataCollector overrides:
 	// (Note that they are called while the ChunkMap's CS is locked - don't do heavy calculations here!)
 	virtual void BiomeData    (const cChunkDef::BiomeMap * a_BiomeMap) override;
+	virtual void ChunkData    (const cChunkData & a_Data) override;
 	virtual void Entity       (cEntity *      a_Entity) override;
 	virtual void BlockEntity  (cBlockEntity * a_Entity) override;
 
 	/// Sends the specified chunk to a_Client, or to all chunk clients if a_Client == nullptr
 	void SendChunk(int a_ChunkX, int a_ChunkZ, cClientHandle * a_Client);
+	
+	/// Resends the specified sections of the chunk to all chunk clients that have already received the chunk
+	void SendChunkSections(int a_ChunkX, int a_ChunkZ, UInt16 a_SectionMask);
 } ;
 
 
@@ -25,6 +25,7 @@
 
 #include "Protocol/Authenticator.h"
 #include "Protocol/ProtocolRecognizer.h"
+#include "Protocol/ChunkDataSerializer.h"
 #include "CompositeChat.h"
 #include "Items/ItemSword.h"
 
@@ -63,8 +64,6 @@ cClientHandle::cClientHandle(const cSocket * a_Socket, int a_ViewDistance) :
 	m_OutgoingData(64 KiB),
 	m_Player(nullptr),
 	m_HasSentDC(false),
-	m_LastStreamedChunkX(0x7fffffff),  // bogus chunk coords to force streaming upon login
-	m_LastStreamedChunkZ(0x7fffffff),
 	m_TimeSinceLastPacket(0),
 	m_Ping(1000),
 	m_PingID(1),
@@ -92,6 +91,7 @@ cClientHandle::cClientHandle(const cSocket * a_Socket, int a_ViewDistance) :
 	s_ClientCount++;  // Not protected by CS because clients are always constructed from the same thread
 	m_UniqueID = s_ClientCount;
 	m_PingStartTime = std::chrono::steady_clock::now();
+	SetLastStreamedChunk(0x7fffffff, 0x7fffffff);  // bogus chunk coords to force streaming upon login
 
 	LOGD("New ClientHandle created at %p", this);
 }
@@ -408,7 +408,9 @@ bool cClientHandle::StreamNextChunk(void)
 
 	int ChunkPosX = m_Player->GetChunkX();
 	int ChunkPosZ = m_Player->GetChunkZ();
-	if ((m_LastStreamedChunkX == ChunkPosX) && (m_LastStreamedChunkZ == ChunkPosZ))
+	int LastStreamedChunkX, LastStreamedChunkZ;
+	GetLastStreamedChunk(LastStreamedChunkX, LastStreamedChunkZ);
+	if ((LastStreamedChunkX == ChunkPosX) && (LastStreamedChunkZ == ChunkPosZ))
 	{
 		// All chunks are already loaded. Abort loading.
 		return true;
@@ -500,8 +502,7 @@ bool cClientHandle::StreamNextChunk(void)
 	}
 
 	// All chunks are loaded -> Sets the last loaded chunk coordinates to current coordinates
-	m_LastStreamedChunkX = ChunkPosX;
-	m_LastStreamedChunkZ = ChunkPosZ;
+	SetLastStreamedChunk(ChunkPosX, ChunkPosZ);
 	return true;
 }
 
@@ -584,6 +585,51 @@ void cClientHandle::StreamChunk(int a_ChunkX, int a_ChunkZ, cChunkSender::eChunk
 
 
 
+void cClientHandle::AddRegisteredChunk(cWorld * a_World, int a_ChunkX, int a_ChunkZ)
+{
+	cCSLock Lock(m_CSChunkLists);
+	m_RegisteredChunks[a_World].insert(cChunkCoords(a_ChunkX, a_ChunkZ));
+}
+
+
+
+
+
+void cClientHandle::RemoveRegisteredChunk(cWorld * a_World, int a_ChunkX, int a_ChunkZ)
+{
+	cCSLock Lock(m_CSChunkLists);
+	auto itr = m_RegisteredChunks.find(a_World);
+	if (itr == m_RegisteredChunks.end())
+	{
+		return;
+	}
+	itr->second.erase(cChunkCoords(a_ChunkX, a_ChunkZ));
+	if (itr->second.empty())
+	{
+		m_RegisteredChunks.erase(itr);
+	}
+}
+
+
+
+
+
+cChunkCoordsVector cClientHandle::GetRegisteredChunks(cWorld * a_World)
+{
+	cChunkCoordsVector res;
+	cCSLock Lock(m_CSChunkLists);
+	auto itr = m_RegisteredChunks.find(a_World);
+	if (itr != m_RegisteredChunks.end())
+	{
+		res.assign(itr->second.begin(), itr->second.end());
+	}
+	return res;
+}
+
+
+
+
+
 // Removes the client from all chunks. Used when switching worlds or destroying the player
 void cClientHandle::RemoveFromAllChunks()
 {
@@ -602,8 +648,7 @@ void cClientHandle::RemoveFromAllChunks()
 
 		// Also reset the LastStreamedChunk coords to bogus coords,
 		// so that all chunks are streamed in subsequent StreamChunks() call (FS #407)
-		m_LastStreamedChunkX = 0x7fffffff;
-		m_LastStreamedChunkZ = 0x7fffffff;
+		SetLastStreamedChunk(0x7fffffff, 0x7fffffff);
 	}
 }
 
@@ -1836,8 +1881,7 @@ void cClientHandle::RemoveFromWorld(void)
 	}  // for itr - Chunks[]
 
 	// Here, we set last streamed values to bogus ones so everything is resent
-	m_LastStreamedChunkX = 0x7fffffff;
-	m_LastStreamedChunkZ = 0x7fffffff;
+	SetLastStreamedChunk(0x7fffffff, 0x7fffffff);
 
 	m_HasSentPlayerChunk = false;
 }
@@ -2079,6 +2123,21 @@ void cClientHandle::SendChunkData(int a_ChunkX, int a_ChunkZ, cChunkDataSerializ
 {
 	ASSERT(m_Player != nullptr);
 	
+	// Partial chunk data only updates chunks that the client already has:
+	if (!a_Serializer.IsFullChunk())
+	{
+		bool HasChunk = false;
+		{
+			cCSLock Lock(m_CSChunkLists);
+			HasChunk = (std::find(m_SentChunks.begin(), m_SentChunks.end(), cChunkCoords(a_ChunkX, a_ChunkZ)) != m_SentChunks.end());
+		}
+		if (HasChunk)
+		{
+			m_Protocol->SendChunkData(a_ChunkX, a_ChunkZ, a_Serializer);
+		}
+		return;
+	}
+	
 	// Check chunks being sent, erase them from m_ChunksToSend:
 	bool Found = false;
 	{
@@ -2214,6 +2273,15 @@ void cClientHandle::SendEntityMetadata(const cEntity & a_Entity)
 
 
 
+void cClientHandle::SendEntityMetadataChanges(const cEntity & a_Entity)
+{
+	m_Protocol->SendEntityMetadataChanges(a_Entity);
+}
+
+
+
+
+
 void cClientHandle::SendEntityRelMove(const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ)
 {
 	ASSERT(a_Entity.GetUniqueID() != m_Player->GetUniqueID());  // Must not send for self
@@ -2556,6 +2624,15 @@ void cClientHandle::SendSoundParticleEffect(int a_EffectID, int a_SrcX, int a_Sr
 
 
 
+void cClientHandle::SendSpawnEntities(const cEntityList & a_Entities)
+{
+	m_Protocol->SendSpawnEntities(a_Entities);
+}
+
+
+
+
+
 void cClientHandle::SendSpawnFallingBlock(const cFallingBlock & a_FallingBlock)
 {
 	m_Protocol->SendSpawnFallingBlock(a_FallingBlock);
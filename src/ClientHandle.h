@@ -22,6 +22,7 @@
 #include "UI/SlotArea.h"
 #include "json/json.h"
 #include "ChunkSender.h"
+#include <unordered_set>
 
 
 
@@ -158,6 +159,7 @@ public:
 	void SendEntityHeadLook             (const cEntity & a_Entity);
 	void SendEntityLook                 (const cEntity & a_Entity);
 	void SendEntityMetadata             (const cEntity & a_Entity);
+	void SendEntityMetadataChanges      (const cEntity & a_Entity);  // Only the entries changed since the previous metadata broadcast; used only for broadcasts
 	void SendEntityProperties           (const cEntity & a_Entity);
 	void SendEntityRelMove              (const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ);
 	void SendEntityRelMoveLook          (const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ);
@@ -192,6 +194,7 @@ public:
 	void SendScoreboardObjective        (const AString & a_Name, const AString & a_DisplayName, Byte a_Mode);
 	void SendSoundEffect                (const AString & a_SoundName, double a_X, double a_Y, double a_Z, float a_Volume, float a_Pitch);  // tolua_export
 	void SendSoundParticleEffect        (int a_EffectID, int a_SrcX, int a_SrcY, int a_SrcZ, int a_Data);
+	void SendSpawnEntities              (const cEntityList & a_Entities);
 	void SendSpawnFallingBlock          (const cFallingBlock & a_FallingBlock);
 	void SendSpawnMob                   (const cMonster & a_Mob);
 	void SendSpawnObject                (const cEntity & a_Entity, char a_ObjectType, int a_ObjectData, Byte a_Yaw, Byte a_Pitch);
@@ -226,6 +229,18 @@ public:
 	/** Returns the view distance that the player request, not the used view distance. */
 	int GetRequestedViewDistance(void) const { return m_RequestedViewDistance; }
 
+	/** Returns true if the specified chunk is at most a_Distance chunks away from the chunk around which the client's chunks were last streamed.
+	Called from the world tick thread, while the client's own threads may be streaming the chunks. */
+	bool IsChunkWithinDistance(int a_ChunkX, int a_ChunkZ, int a_Distance) const
+	{
+		int LastStreamedChunkX, LastStreamedChunkZ;
+		GetLastStreamedChunk(LastStreamedChunkX, LastStreamedChunkZ);
+		return (
+			(std::abs(static_cast<Int64>(a_ChunkX) - LastStreamedChunkX) <= a_Distance) &&
+			(std::abs(static_cast<Int64>(a_ChunkZ) - LastStreamedChunkZ) <= a_Distance)
+		);
+	}
+
 	void SetLocale(AString & a_Locale) { m_Locale = a_Locale; }
 	AString GetLocale(void) const { return m_Locale; }
 
@@ -248,6 +263,15 @@ public:
 	/** Adds the chunk specified to the list of chunks wanted for sending (m_ChunksToSend) */
 	void AddWantedChunk(int a_ChunkX, int a_ChunkZ);
 	
+	/** Called by cChunk::AddClient() when the client gets registered in the specified chunk. */
+	void AddRegisteredChunk(cWorld * a_World, int a_ChunkX, int a_ChunkZ);
+	
+	/** Called by cChunk::RemoveClient() when the client gets unregistered from the specified chunk. */
+	void RemoveRegisteredChunk(cWorld * a_World, int a_ChunkX, int a_ChunkZ);
+	
+	/** Returns the coords of all the chunks in the specified world that the client is registered in. */
+	cChunkCoordsVector GetRegisteredChunks(cWorld * a_World);
+	
 	// Calls that cProtocol descendants use to report state:
 	void PacketBufferFull(void);
 	void PacketUnknown(UInt32 a_PacketType);
@@ -360,6 +384,10 @@ private:
 	cChunkCoordsList m_ChunksToSend;  // Chunks that need to be sent to the player (queued because they weren't generated yet or there's not enough time to send them)
 	cChunkCoordsList m_SentChunks;    // Chunks that are currently sent to the client
 
+	/** The chunks, per world, whose cChunk::m_LoadedByClient contains this client; protected by m_CSChunkLists.
+	Lets cChunkMap::RemoveClientFromChunks() visit only these chunks instead of all the loaded ones. */
+	std::map<cWorld *, std::unordered_set<cChunkCoords, cChunkCoordsHash> > m_RegisteredChunks;
+
 	cProtocol * m_Protocol;
 	
 	cCriticalSection m_CSIncomingData;
@@ -375,9 +403,10 @@ private:
 	
 	bool m_HasSentDC;  ///< True if a D/C packet has been sent in either direction
 
-	// Chunk position when the last StreamChunks() was called; used to avoid re-streaming while in the same chunk
-	int m_LastStreamedChunkX;
-	int m_LastStreamedChunkZ;
+	/** Chunk position when the last StreamChunks() was called; used to avoid re-streaming while in the same chunk.
+	Both coords are packed into a single atomic value, see SetLastStreamedChunk(), because the world tick thread reads them
+	in IsChunkWithinDistance() while the client's threads update them; it must never see the X of one position and the Z of another. */
+	std::atomic<UInt64> m_LastStreamedChunk;
 
 	/** Seconds since the last packet data was received (updated in Tick(), reset in DataReceived()) */
 	float m_TimeSinceLastPacket;
@@ -465,6 +494,20 @@ private:
 	/** Adds a single chunk to be streamed to the client; used by StreamChunks() */
 	void StreamChunk(int a_ChunkX, int a_ChunkZ, cChunkSender::eChunkPriority a_Priority);
 	
+	/** Stores the chunk position of the last StreamChunks() into m_LastStreamedChunk */
+	void SetLastStreamedChunk(int a_ChunkX, int a_ChunkZ)
+	{
+		m_LastStreamedChunk = (static_cast<UInt64>(static_cast<UInt32>(a_ChunkX)) << 32) | static_cast<UInt32>(a_ChunkZ);
+	}
+
+	/** Retrieves the chunk position stored by SetLastStreamedChunk() */
+	void GetLastStreamedChunk(int & a_ChunkX, int & a_ChunkZ) const
+	{
+		UInt64 LastStreamedChunk = m_LastStreamedChunk;
+		a_ChunkX = static_cast<int>(static_cast<UInt32>(LastStreamedChunk >> 32));
+		a_ChunkZ = static_cast<int>(static_cast<UInt32>(LastStreamedChunk));
+	}
+	
 	/** Handles the DIG_STARTED dig packet: */
 	void HandleBlockDigStarted (int a_BlockX, int a_BlockY, int a_BlockZ, eBlockFace a_BlockFace, BLOCKTYPE a_OldBlock, NIBBLETYPE a_OldMeta);
 	
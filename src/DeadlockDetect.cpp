@@ -7,6 +7,7 @@
 #include "DeadlockDetect.h"
 #include "Root.h"
 #include "World.h"
+#include "OSSupport/StackTrace.h"
 #include <cstdlib>
 
 
@@ -22,7 +23,8 @@ const int CYCLE_MILLISECONDS = 100;
 
 cDeadlockDetect::cDeadlockDetect(void) :
 	super("DeadlockDetect"),
-	m_IntervalSec(1000)
+	m_WarningIntervalSec(0),
+	m_KillIntervalSec(1000)
 {
 }
 
@@ -30,9 +32,10 @@ cDeadlockDetect::cDeadlockDetect(void) :
 
 
 
-bool cDeadlockDetect::Start(int a_IntervalSec)
+bool cDeadlockDetect::Start(int a_WarningIntervalSec, int a_KillIntervalSec)
 {
-	m_IntervalSec = a_IntervalSec;
+	m_WarningIntervalSec = a_WarningIntervalSec;
+	m_KillIntervalSec = a_KillIntervalSec;
 	
 	// Read the initial world data:
 	class cFillIn :
@@ -99,6 +102,7 @@ void cDeadlockDetect::SetWorldAge(const AString & a_WorldName, Int64 a_Age)
 {
 	m_WorldAges[a_WorldName].m_Age = a_Age;
 	m_WorldAges[a_WorldName].m_NumCyclesSame = 0;
+	m_WorldAges[a_WorldName].m_HasWarned = false;
 }
 
 
@@ -119,15 +123,30 @@ void cDeadlockDetect::CheckWorldAge(const AString & a_WorldName, Int64 a_Age)
 	if (WorldAge.m_Age == a_Age)
 	{
 		WorldAge.m_NumCyclesSame += 1;
-		if (WorldAge.m_NumCyclesSame > (m_IntervalSec * 1000) / CYCLE_MILLISECONDS)
+		if (HasIntervalPassed(WorldAge.m_NumCyclesSame, m_KillIntervalSec))
 		{
-			DeadlockDetected();
+			DeadlockDetected(a_WorldName);
+		}
+		if (!WorldAge.m_HasWarned && HasIntervalPassed(WorldAge.m_NumCyclesSame, m_WarningIntervalSec))
+		{
+			WorldAge.m_HasWarned = true;
+			LOGWARNING("World \"%s\" hasn't ticked for %d seconds, the server is either overloaded or deadlocked.",
+				a_WorldName.c_str(), m_WarningIntervalSec
+			);
+			LogAllThreadsStackTraces();
 		}
 	}
 	else
 	{
+		if (WorldAge.m_HasWarned)
+		{
+			LOGWARNING("World \"%s\" is ticking again after a stall of %d ms.",
+				a_WorldName.c_str(), WorldAge.m_NumCyclesSame * CYCLE_MILLISECONDS
+			);
+		}
 		WorldAge.m_Age = a_Age;
 		WorldAge.m_NumCyclesSame = 0;
+		WorldAge.m_HasWarned = false;
 	}
 }
 
@@ -135,9 +154,21 @@ void cDeadlockDetect::CheckWorldAge(const AString & a_WorldName, Int64 a_Age)
 
 
 
-void cDeadlockDetect::DeadlockDetected(void)
+bool cDeadlockDetect::HasIntervalPassed(int a_NumCycles, int a_IntervalSec)
+{
+	return (a_IntervalSec > 0) && (a_NumCycles > (a_IntervalSec * 1000) / CYCLE_MILLISECONDS);
+}
+
+
+
+
+
+void cDeadlockDetect::DeadlockDetected(const AString & a_WorldName)
 {
-	LOGERROR("Deadlock detected, aborting the server");
+	LOGERROR("Deadlock detected in world \"%s\", it hasn't ticked for %d seconds. Aborting the server.",
+		a_WorldName.c_str(), m_KillIntervalSec
+	);
+	LogAllThreadsStackTraces();
 	ASSERT(!"Deadlock detected");
 	abort();
 }
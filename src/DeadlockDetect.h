@@ -6,8 +6,10 @@
 /*
 This class simply monitors each world's m_WorldAge, which is expected to grow on each tick.
 If the world age doesn't grow for several seconds, it's either because the server is super-overloaded,
-or because the world tick thread hangs in a deadlock. We presume the latter and therefore kill the server.
-Once we learn to write crashdumps programmatically, we should do so just before killing, to enable debugging.
+or because the world tick thread hangs in a deadlock.
+After the warning interval the stack traces of all the threads are logged, together with the locks they are waiting for,
+so that a mere slowdown can be told apart from a deadlock. After the (longer) kill interval we presume a deadlock
+and kill the server, unless the killing is disabled.
 */
 
 
@@ -28,8 +30,10 @@ class cDeadlockDetect :
 public:
 	cDeadlockDetect(void);
 	
-	/** Starts the detection. Hides cIsThread's Start, because we need some initialization */
-	bool Start(int a_IntervalSec);
+	/** Starts the detection. Hides cIsThread's Start, because we need some initialization.
+	a_WarningIntervalSec is the stall after which the stack traces are logged, a_KillIntervalSec the stall after which the server is aborted.
+	Either can be zero or negative to disable it. */
+	bool Start(int a_WarningIntervalSec, int a_KillIntervalSec);
 	
 protected:
 	struct sWorldAge
@@ -39,6 +43,9 @@ protected:
 		
 		/// Number of cycles for which the age has been the same
 		int m_NumCyclesSame;
+
+		/// Set once the warning has been logged for the current stall
+		bool m_HasWarned;
 	} ;
 	
 	/// Maps world name -> sWorldAge
@@ -46,8 +53,11 @@ protected:
 	
 	WorldAges m_WorldAges;
 	
-	/// Number of secods for which the ages must be the same for the detection to trigger
-	int m_IntervalSec;
+	/// Number of seconds for which the ages must be the same for the stack traces to be logged; <= 0 to never log
+	int m_WarningIntervalSec;
+
+	/// Number of seconds for which the ages must be the same for the server to be aborted; <= 0 to never abort
+	int m_KillIntervalSec;
 	
 	
 	// cIsThread overrides:
@@ -56,11 +66,14 @@ protected:
 	/// Sets the initial world age
 	void SetWorldAge(const AString & a_WorldName, Int64 a_Age);
 	
-	/// Checks if the world's age has changed, updates the world's stats; calls DeadlockDetected() if deadlock detected
+	/// Checks if the world's age has changed, updates the world's stats; logs the stack traces or calls DeadlockDetected() if the world stalls
 	void CheckWorldAge(const AString & a_WorldName, Int64 a_Age);
 	
-	/// Called when a deadlock is detected. Aborts the server.
-	NORETURN void DeadlockDetected(void);
+	/// Returns true if a_NumCycles cycles span more than the specified number of seconds; false for a non-positive interval
+	static bool HasIntervalPassed(int a_NumCycles, int a_IntervalSec);
+	
+	/// Called when a deadlock is detected in the specified world. Logs the stack traces and aborts the server.
+	NORETURN void DeadlockDetected(const AString & a_WorldName);
 } ;
 
 
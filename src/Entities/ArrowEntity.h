@@ -63,7 +63,7 @@ public:
 	bool IsCritical(void) const { return m_IsCritical; }
 	
 	/** Sets the IsCritical flag */
-	void SetIsCritical(bool a_IsCritical) { m_IsCritical = a_IsCritical; }
+	void SetIsCritical(bool a_IsCritical) { m_IsCritical = a_IsCritical; InvalidateSpawnPackets(); }
 
 	/** Gets the block arrow is in */
 	Vector3i GetBlockHit(void) const { return m_HitBlockPos; }
@@ -1640,6 +1640,85 @@ void cEntity::TeleportToCoords(double a_PosX, double a_PosY, double a_PosZ)
 
 
 
+bool cEntity::GetCachedSpawnPackets(int a_ProtocolVersion, AString & a_Packets) const
+{
+	return m_SpawnPacketCache.Get(a_ProtocolVersion, cSpawnPacketCache::sState(m_Pos, m_Rot, m_Speed, m_HeadYaw, m_Health), a_Packets);
+}
+
+
+
+
+
+void cEntity::SetCachedSpawnPackets(int a_ProtocolVersion, const AString & a_Packets) const
+{
+	if (!CanCacheSpawnPackets())
+	{
+		return;
+	}
+	m_SpawnPacketCache.Set(a_ProtocolVersion, cSpawnPacketCache::sState(m_Pos, m_Rot, m_Speed, m_HeadYaw, m_Health), a_Packets);
+}
+
+
+
+
+
+void cEntity::InvalidateSpawnPackets(void) const
+{
+	m_SpawnPacketCache.Invalidate();
+}
+
+
+
+
+
+void cEntity::StartMetadataBroadcast(void) const
+{
+	m_MetadataBroadcastCache.StartBroadcast();
+}
+
+
+
+
+
+void cEntity::FinishMetadataBroadcast(bool a_HasExcludedClient) const
+{
+	if (a_HasExcludedClient)
+	{
+		m_MetadataBroadcastCache.Invalidate();
+	}
+}
+
+
+
+
+
+bool cEntity::GetMetadataBroadcastChanges(int a_ProtocolVersion, AString & a_Changes) const
+{
+	return m_MetadataBroadcastCache.GetBroadcastChanges(a_ProtocolVersion, a_Changes);
+}
+
+
+
+
+
+void cEntity::SetMetadataBroadcast(int a_ProtocolVersion, const cMetadataEntries & a_Entries, AString & a_Changes) const
+{
+	m_MetadataBroadcastCache.SetBroadcastEntries(a_ProtocolVersion, a_Entries, a_Changes);
+}
+
+
+
+
+
+void cEntity::MetadataSentFull(int a_ProtocolVersion, const cMetadataEntries & a_Entries) const
+{
+	m_MetadataBroadcastCache.SentFull(a_ProtocolVersion, a_Entries);
+}
+
+
+
+
+
 void cEntity::BroadcastMovementUpdate(const cClientHandle * a_Exclude)
 {
 	// Process packet sending every two ticks
@@ -3,6 +3,8 @@
 
 #include "../Item.h"
 #include "../Vector3.h"
+#include "SpawnPacketCache.h"
+#include "MetadataBroadcastCache.h"
 
 
 
@@ -376,6 +378,43 @@ public:
 	*/
 	virtual void SpawnOn(cClientHandle & a_Client) = 0;
 
+	/** Returns true if the packets sent by SpawnOn() are the same for all clients, so that they can be cached. */
+	virtual bool CanCacheSpawnPackets(void) const { return true; }
+
+	/** Retrieves the spawn packets cached by the specified protocol version into a_Packets.
+	Returns false if there are none, or if the entity has moved or changed since they were cached. */
+	bool GetCachedSpawnPackets(int a_ProtocolVersion, AString & a_Packets) const;
+
+	/** Caches the spawn packets built by the specified protocol version for the entity's current state. */
+	void SetCachedSpawnPackets(int a_ProtocolVersion, const AString & a_Packets) const;
+
+	/** Drops the cached spawn packets. This is the hook for all the changes of the entity's metadata and equipment:
+	the metadata and equipment broadcasts call it, and so must the setters of the state that the spawn packets encode
+	when they don't broadcast the change. */
+	void InvalidateSpawnPackets(void) const;
+
+	/** Encoded metadata entries of a single protocol version, keyed by the metadata index. */
+	typedef cMetadataBroadcastCache::cEntries cMetadataEntries;
+
+	/** Starts a new metadata broadcast; the changed entries are then computed only once per protocol version, for all the clients. */
+	void StartMetadataBroadcast(void) const;
+
+	/** Finishes the metadata broadcast started by StartMetadataBroadcast().
+	If a client has been excluded from it, that client has missed the changes, so the next broadcast sends all the entries. */
+	void FinishMetadataBroadcast(bool a_HasExcludedClient) const;
+
+	/** Retrieves the metadata entries changed in the current broadcast, if already computed for the specified protocol version.
+	Returns false if not computed yet; the protocol then encodes the full metadata and calls SetMetadataBroadcast(). */
+	bool GetMetadataBroadcastChanges(int a_ProtocolVersion, AString & a_Changes) const;
+
+	/** Computes the entries of the current broadcast that have changed since the previous broadcast in the specified protocol version,
+	given the full encoded metadata. Stores the changed entries, concatenated, into a_Changes; empty if nothing has changed. */
+	void SetMetadataBroadcast(int a_ProtocolVersion, const cMetadataEntries & a_Entries, AString & a_Changes) const;
+
+	/** Called when the full metadata in the specified protocol version is sent to a single client, such as in a spawn packet.
+	If it differs from the last broadcast, the clients no longer share the same state, so the next broadcast sends all the entries. */
+	void MetadataSentFull(int a_ProtocolVersion, const cMetadataEntries & a_Entries) const;
+
 	// tolua_begin
 	
 	/// Teleports to the entity specified
@@ -597,6 +636,14 @@ private:
 	/** If a player hit a entity, the entity receive a invulnerable of 10 ticks.
 	While this ticks, a player can't hit this entity. */
 	int m_InvulnerableTicks;
+
+	/** The spawn packets cached by SetCachedSpawnPackets().
+	The cache is only accessed with the chunkmap locked, same as the rest of the entity's state. */
+	mutable cSpawnPacketCache m_SpawnPacketCache;
+
+	/** The metadata last broadcast, per protocol version.
+	Has its own lock, the full metadata is sent to single clients from threads that don't hold the chunkmap lock. */
+	mutable cMetadataBroadcastCache m_MetadataBroadcastCache;
 } ;  // tolua_export
 
 typedef std::list<cEntity *> cEntityList;
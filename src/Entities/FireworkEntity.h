@@ -36,7 +36,7 @@ public:
 	const cItem & GetItem(void) const { return m_FireworkItem; }
 
 	/** Sets the item that is used to create the rocket (has all the firework effects on it) */
-	void SetItem(const cItem & a_Item) { m_FireworkItem = a_Item; }
+	void SetItem(const cItem & a_Item) { m_FireworkItem = a_Item; InvalidateSpawnPackets(); }
 
 	/** Returns the number of ticks left until the firework explosion. */
 	int GetTicksToExplosion(void) const { return m_TicksToExplosion; }
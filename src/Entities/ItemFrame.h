@@ -27,13 +27,13 @@ public:
 	const cItem & GetItem(void) { return m_Item; }
 
 	/** Set the item in the frame */
-	void SetItem(cItem & a_Item) { m_Item = a_Item; }
+	void SetItem(cItem & a_Item) { m_Item = a_Item; InvalidateSpawnPackets(); }
 
 	/** Returns the rotation from the item in the frame */
 	Byte GetItemRotation(void) const { return m_ItemRotation; }
 
 	/** Set the rotation from the item in the frame */
-	void SetItemRotation(Byte a_ItemRotation) { m_ItemRotation = a_ItemRotation; }
+	void SetItemRotation(Byte a_ItemRotation) { m_ItemRotation = a_ItemRotation; InvalidateSpawnPackets(); }
 
 	// tolua_end
 
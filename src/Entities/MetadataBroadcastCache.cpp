@@ -0,0 +1,108 @@
+
+// MetadataBroadcastCache.cpp
+
+// Implements the cMetadataBroadcastCache class representing the last broadcast metadata of a single entity, used for sending only the changed entries
+
+#include "Globals.h"
+#include "MetadataBroadcastCache.h"
+
+
+
+
+
+cMetadataBroadcastCache::cMetadataBroadcastCache(void) :
+	m_BroadcastNum(0)
+{
+}
+
+
+
+
+
+void cMetadataBroadcastCache::StartBroadcast(void)
+{
+	cCSLock Lock(m_CS);
+	m_BroadcastNum += 1;
+}
+
+
+
+
+
+bool cMetadataBroadcastCache::GetBroadcastChanges(int a_ProtocolVersion, AString & a_Changes)
+{
+	cCSLock Lock(m_CS);
+	std::map<int, sBroadcast>::const_iterator itr = m_Broadcasts.find(a_ProtocolVersion);
+	if ((itr == m_Broadcasts.end()) || (itr->second.m_BroadcastNum != m_BroadcastNum))
+	{
+		return false;
+	}
+	a_Changes = itr->second.m_Changes;
+	return true;
+}
+
+
+
+
+
+void cMetadataBroadcastCache::SetBroadcastEntries(int a_ProtocolVersion, const cEntries & a_Entries, AString & a_Changes)
+{
+	cCSLock Lock(m_CS);
+	sBroadcast & Broadcast = m_Broadcasts[a_ProtocolVersion];
+	if (Broadcast.m_BroadcastNum == m_BroadcastNum)
+	{
+		// Already computed for this broadcast by another client, the baseline is already updated:
+		a_Changes = Broadcast.m_Changes;
+		return;
+	}
+
+	a_Changes.clear();
+	for (cEntries::const_iterator itr = a_Entries.begin(), end = a_Entries.end(); itr != end; ++itr)
+	{
+		if (Broadcast.m_IsValid)
+		{
+			cEntries::const_iterator Prev = Broadcast.m_Entries.find(itr->first);
+			if ((Prev != Broadcast.m_Entries.end()) && (Prev->second == itr->second))
+			{
+				// Unchanged since the last broadcast, all the clients already have it
+				continue;
+			}
+		}
+		a_Changes.append(itr->second);
+	}
+	Broadcast.m_Entries = a_Entries;
+	Broadcast.m_IsValid = true;
+	Broadcast.m_BroadcastNum = m_BroadcastNum;
+	Broadcast.m_Changes = a_Changes;
+}
+
+
+
+
+
+void cMetadataBroadcastCache::SentFull(int a_ProtocolVersion, const cEntries & a_Entries)
+{
+	cCSLock Lock(m_CS);
+	std::map<int, sBroadcast>::iterator itr = m_Broadcasts.find(a_ProtocolVersion);
+	if ((itr != m_Broadcasts.end()) && (itr->second.m_Entries != a_Entries))
+	{
+		itr->second.m_IsValid = false;
+	}
+}
+
+
+
+
+
+void cMetadataBroadcastCache::Invalidate(void)
+{
+	cCSLock Lock(m_CS);
+	for (std::map<int, sBroadcast>::iterator itr = m_Broadcasts.begin(), end = m_Broadcasts.end(); itr != end; ++itr)
+	{
+		itr->second.m_IsValid = false;
+	}
+}
+
+
+
+
@@ -0,0 +1,92 @@
+
+// MetadataBroadcastCache.h
+
+// Declares the cMetadataBroadcastCache class representing the last broadcast metadata of a single entity, used for sending only the changed entries
+
+/*
+Each protocol version encodes the full metadata of the entity into per-index entries; the first client of that
+protocol version in a broadcast diffs them against the entries of the previous broadcast, the rest of the clients
+reuse the computed changes. The diff is only valid while all the clients have the state of the previous broadcast:
+	- A broadcast that excludes a client leaves that client behind, so the cache is invalidated after it.
+	- The full metadata sent to a single client (such as in a spawn packet) invalidates the cache if it differs.
+An invalidated cache makes the next broadcast send all the entries.
+
+The broadcasts run in the tick thread under the chunkmap lock, but the full metadata is sent to single clients from
+other threads, too; the cache has its own lock.
+*/
+
+
+
+
+
+#pragma once
+
+#include "../OSSupport/CriticalSection.h"
+
+
+
+
+
+class cMetadataBroadcastCache
+{
+public:
+	/** Encoded metadata entries of a single protocol version, keyed by the metadata index.
+	Each value is the complete encoded entry, including its index-and-type header. */
+	typedef std::map<int, AString> cEntries;
+
+
+	cMetadataBroadcastCache(void);
+
+	/** Starts a new broadcast; the changed entries are then computed only once per protocol version, for all the clients. */
+	void StartBroadcast(void);
+
+	/** Retrieves the entries changed in the current broadcast, if already computed for the specified protocol version.
+	Returns false if not computed yet; the protocol then encodes the full metadata and calls SetBroadcastEntries(). */
+	bool GetBroadcastChanges(int a_ProtocolVersion, AString & a_Changes);
+
+	/** Computes the entries of the current broadcast that have changed since the previous broadcast in the specified protocol version,
+	given the full encoded metadata. Stores the changed entries, concatenated in index order, into a_Changes; empty if nothing has changed.
+	If the changes have already been computed for the current broadcast, returns those. */
+	void SetBroadcastEntries(int a_ProtocolVersion, const cEntries & a_Entries, AString & a_Changes);
+
+	/** Called when the full metadata in the specified protocol version is sent to a single client.
+	If it differs from the last broadcast, the clients no longer share the same state, so the next broadcast sends all the entries. */
+	void SentFull(int a_ProtocolVersion, const cEntries & a_Entries);
+
+	/** Makes the next broadcast send all the entries, in all protocol versions.
+	Called after a broadcast that excluded a client, that client has missed the changes. */
+	void Invalidate(void);
+
+protected:
+	/** The metadata last broadcast in a single protocol version */
+	struct sBroadcast
+	{
+		/** The entries, as last broadcast */
+		cEntries m_Entries;
+
+		/** False if some clients may have a different state than m_Entries, the next broadcast then sends everything */
+		bool m_IsValid;
+
+		/** The broadcast for which m_Changes has been computed */
+		int m_BroadcastNum;
+
+		/** The changed entries in broadcast m_BroadcastNum, concatenated */
+		AString m_Changes;
+
+		sBroadcast(void) : m_IsValid(false), m_BroadcastNum(-1) {}
+	} ;
+
+
+	/** Protects all the members against concurrent access */
+	cCriticalSection m_CS;
+
+	/** Number of the current broadcast, incremented by StartBroadcast() */
+	int m_BroadcastNum;
+
+	/** The last broadcast metadata, per protocol version */
+	std::map<int, sBroadcast> m_Broadcasts;
+} ;
+
+
+
+
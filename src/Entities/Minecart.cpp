@@ -11,10 +11,7 @@
 #include "../Chunk.h"
 #include "Player.h"
 #include "../BoundingBox.h"
-
-#define NO_SPEED 0.0
-#define MAX_SPEED 8
-#define MAX_SPEED_NEGATIVE -MAX_SPEED
+#include "MinecartRailPhysics.h"
 
 
 
@@ -136,50 +133,8 @@ void cMinecart::HandlePhysics(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 		return;
 	}
 
-	BLOCKTYPE InsideType;
-	NIBBLETYPE InsideMeta;
-	Chunk->GetBlockTypeMeta(RelPosX, PosY, RelPosZ, InsideType, InsideMeta);
-
-	if (!IsBlockRail(InsideType))
-	{
-		// When a descending minecart hits a flat rail, it goes through the ground; check for this
-		Chunk->GetBlockTypeMeta(RelPosX, PosY + 1, RelPosZ, InsideType, InsideMeta);
-		if (IsBlockRail(InsideType))
-		{
-			// Push cart upwards
-			AddPosY(1);
-		}
-	}
-
-	bool WasDetectorRail = false;
-	if (IsBlockRail(InsideType))
-	{
-		if (InsideType == E_BLOCK_RAIL)
-		{
-			SnapToRail(InsideMeta);
-		}
-		else
-		{
-			SnapToRail(InsideMeta & 0x07);
-		}
-
-		switch (InsideType)
-		{
-			case E_BLOCK_RAIL: HandleRailPhysics(InsideMeta, a_Dt); break;
-			case E_BLOCK_ACTIVATOR_RAIL: break;
-			case E_BLOCK_POWERED_RAIL: HandlePoweredRailPhysics(InsideMeta); break;
-			case E_BLOCK_DETECTOR_RAIL:
-			{
-				HandleDetectorRailPhysics(InsideMeta, a_Dt);
-				WasDetectorRail = true;
-				break;
-			}
-			default: VERIFY(!"Unhandled rail type despite checking if block was rail!"); break;
-		}
-
-		AddPosition(GetSpeed() * (static_cast<double>(a_Dt.count()) / 1000));  // Commit changes; as we use our own engine when on rails, this needs to be done, whereas it is normally in Entity.cpp
-	}
-	else
+	BLOCKTYPE RailType = cRailPhysics::MoveAlongRail(*this, a_Dt, *Chunk);
+	if (RailType == E_BLOCK_AIR)
 	{
 		// Not on rail, default physics
 		SetPosY(floor(GetPosY()) + 0.35);  // HandlePhysics overrides this if minecart can fall, else, it is to stop ground clipping minecart bottom when off-rail
@@ -188,10 +143,10 @@ void cMinecart::HandlePhysics(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 
 	if (m_bIsOnDetectorRail && !Vector3i(POSX_TOINT, POSY_TOINT, POSZ_TOINT).Equals(m_DetectorRailPosition))
 	{
-		m_World->SetBlock(m_DetectorRailPosition.x, m_DetectorRailPosition.y, m_DetectorRailPosition.z, E_BLOCK_DETECTOR_RAIL, m_World->GetBlockMeta(m_DetectorRailPosition) & 0x07);
+		ReleaseDetectorRail(*Chunk);
 		m_bIsOnDetectorRail = false;
 	}
-	else if (WasDetectorRail)
+	else if (RailType == E_BLOCK_DETECTOR_RAIL)
 	{
 		m_bIsOnDetectorRail = true;
 		m_DetectorRailPosition = Vector3i(POSX_TOINT, POSY_TOINT, POSZ_TOINT);
@@ -205,628 +160,25 @@ void cMinecart::HandlePhysics(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 
 
 
-void cMinecart::HandleRailPhysics(NIBBLETYPE a_RailMeta, std::chrono::milliseconds a_Dt)
-{
-	/*
-	NOTE: Please bear in mind that taking away from negatives make them even more negative,
-	adding to negatives make them positive, etc.
-	*/
-	
-	switch (a_RailMeta)
-	{
-		case E_META_RAIL_ZM_ZP:  // NORTHSOUTH
-		{
-			SetYaw(270);
-			SetPosY(floor(GetPosY()) + 0.55);
-			SetSpeedY(0);  // Don't move vertically as on ground
-			SetSpeedX(0);  // Correct diagonal movement from curved rails
-
-			// Execute both the entity and block collision checks
-			bool BlckCol = TestBlockCollision(a_RailMeta), EntCol = TestEntityCollision(a_RailMeta);
-			if (EntCol || BlckCol)
-			{
-				return;
-			}
-			
-			if (GetSpeedZ() != NO_SPEED)  // Don't do anything if cart is stationary
-			{
-				if (GetSpeedZ() > 0)
-				{
-					// Going SOUTH, slow down
-					AddSpeedZ(-0.1);
-				}
-				else
-				{
-					// Going NORTH, slow down
-					AddSpeedZ(0.1);
-				}
-			}
-			break;
-		}
-		case E_META_RAIL_XM_XP:  // EASTWEST
-		{
-			SetYaw(180);
-			SetPosY(floor(GetPosY()) + 0.55);
-			SetSpeedY(NO_SPEED);
-			SetSpeedZ(NO_SPEED);
-
-			bool BlckCol = TestBlockCollision(a_RailMeta), EntCol = TestEntityCollision(a_RailMeta);
-			if (EntCol || BlckCol)
-			{
-				return;
-			}
-
-			if (GetSpeedX() != NO_SPEED)
-			{
-				if (GetSpeedX() > 0)
-				{
-					AddSpeedX(-0.1);
-				}
-				else
-				{
-					AddSpeedX(0.1);
-				}
-			}
-			break;
-		}
-		case E_META_RAIL_ASCEND_ZM:  // ASCEND NORTH
-		{
-			SetYaw(270);
-			SetSpeedX(0);
-
-			if (GetSpeedZ() >= 0)
-			{
-				// SpeedZ POSITIVE, going SOUTH
-				if (GetSpeedZ() <= MAX_SPEED)  // Speed limit
-				{
-					AddSpeedZ(0.5);  // Speed up
-					SetSpeedY(-GetSpeedZ());  // Downward movement is negative (0 minus positive numbers is negative)
-				}
-			}
-			else
-			{
-				// SpeedZ NEGATIVE, going NORTH
-				AddSpeedZ(1);  // Slow down
-				SetSpeedY(-GetSpeedZ());  // Upward movement is positive (0 minus negative number is positive number)
-			}
-			break;
-		}
-		case E_META_RAIL_ASCEND_ZP:  // ASCEND SOUTH
-		{
-			SetYaw(270);
-			SetSpeedX(0);
-
-			if (GetSpeedZ() > 0)
-			{
-				// SpeedZ POSITIVE, going SOUTH
-				AddSpeedZ(-1);  // Slow down
-				SetSpeedY(GetSpeedZ());  // Upward movement positive
-			}
-			else
-			{
-				if (GetSpeedZ() >= MAX_SPEED_NEGATIVE)  // Speed limit
-				{
-					// SpeedZ NEGATIVE, going NORTH
-					AddSpeedZ(-0.5);  // Speed up
-					SetSpeedY(GetSpeedZ());  // Downward movement negative
-				}
-			}
-			break;
-		}
-		case E_META_RAIL_ASCEND_XM:  // ASCEND EAST
-		{
-			SetYaw(180);
-			SetSpeedZ(NO_SPEED);
-
-			if (GetSpeedX() >= NO_SPEED)
-			{
-				if (GetSpeedX() <= MAX_SPEED)
-				{
-					AddSpeedX(0.5);
-					SetSpeedY(-GetSpeedX());
-				}
-			}
-			else
-			{
-				AddSpeedX(1);
-				SetSpeedY(-GetSpeedX());
-			}
-			break;
-		}
-		case E_META_RAIL_ASCEND_XP:  // ASCEND WEST
-		{
-			SetYaw(180);
-			SetSpeedZ(0);
-
-			if (GetSpeedX() > 0)
-			{
-				AddSpeedX(-1);
-				SetSpeedY(GetSpeedX());
-			}
-			else
-			{
-				if (GetSpeedX() >= MAX_SPEED_NEGATIVE)
-				{
-					AddSpeedX(-0.5);
-					SetSpeedY(GetSpeedX());
-				}
-			}
-			break;
-		}
-		case E_META_RAIL_CURVED_ZM_XM:  // Ends pointing NORTH and WEST
-		{
-			SetYaw(315);  // Set correct rotation server side
-			SetPosY(floor(GetPosY()) + 0.55);  // Levitate dat cart
-			SetSpeedY(0);
-
-			TestBlockCollision(a_RailMeta);
-			TestEntityCollision(a_RailMeta);
-
-			// SnapToRail handles turning
-
-			break;
-		}
-		case E_META_RAIL_CURVED_ZM_XP:  // Curved NORTH EAST
-		{
-			SetYaw(225);
-			SetPosY(floor(GetPosY()) + 0.55);
-			SetSpeedY(0);
-
-			TestBlockCollision(a_RailMeta);
-			TestEntityCollision(a_RailMeta);
-
-			break;
-		}
-		case E_META_RAIL_CURVED_ZP_XM:  // Curved SOUTH WEST
-		{
-			SetYaw(135);
-			SetPosY(floor(GetPosY()) + 0.55);
-			SetSpeedY(0);
-
-			TestBlockCollision(a_RailMeta);
-			TestEntityCollision(a_RailMeta);
-
-			break;
-		}
-		case E_META_RAIL_CURVED_ZP_XP:  // Curved SOUTH EAST
-		{
-			SetYaw(45);
-			SetPosY(floor(GetPosY()) + 0.55);
-			SetSpeedY(0);
-
-			TestBlockCollision(a_RailMeta);
-			TestEntityCollision(a_RailMeta);
-
-			break;
-		}
-		default:
-		{
-			ASSERT(!"Unhandled rail meta!");  // Dun dun DUN!
-			break;
-		}
-	}
-}
-
-
-
-
-void cMinecart::HandlePoweredRailPhysics(NIBBLETYPE a_RailMeta)
-{
-	// Initialise to 'slow down' values
-	int AccelDecelSpeed = -2;
-	int AccelDecelNegSpeed = 2;
-
-	if ((a_RailMeta & 0x8) == 0x8)
-	{
-		// Rail powered - set variables to 'speed up' values
-		AccelDecelSpeed = 1;
-		AccelDecelNegSpeed = -1;
-	}
-
-	switch (a_RailMeta & 0x07)
-	{
-		case E_META_RAIL_ZM_ZP:  // NORTHSOUTH
-		{
-			SetYaw(270);
-			SetPosY(floor(GetPosY()) + 0.55);
-			SetSpeedY(0);
-			SetSpeedX(0);
-
-			bool BlckCol = TestBlockCollision(a_RailMeta), EntCol = TestEntityCollision(a_RailMeta);
-			if (EntCol || BlckCol)
-			{
-				return;
-			}
-			
-			if (GetSpeedZ() != NO_SPEED)
-			{
-				if (GetSpeedZ() > NO_SPEED)
-				{
-					AddSpeedZ(AccelDecelSpeed);
-				}
-				else
-				{
-					AddSpeedZ(AccelDecelNegSpeed);
-				}
-			}
-			break;
-		}
-		case E_META_RAIL_XM_XP:  // EASTWEST
-		{
-			SetYaw(180);
-			SetPosY(floor(GetPosY()) + 0.55);
-			SetSpeedY(NO_SPEED);
-			SetSpeedZ(NO_SPEED);
-
-			bool BlckCol = TestBlockCollision(a_RailMeta), EntCol = TestEntityCollision(a_RailMeta);
-			if (EntCol || BlckCol)
-			{
-				return;
-			}
-
-			if (GetSpeedX() != NO_SPEED)
-			{
-				if (GetSpeedX() > NO_SPEED)
-				{
-					AddSpeedX(AccelDecelSpeed);
-				}
-				else
-				{
-					AddSpeedX(AccelDecelNegSpeed);
-				}
-			}
-			break;
-		}
-		case E_META_RAIL_ASCEND_XM:  // ASCEND EAST
-		{
-			SetYaw(180);
-			SetSpeedZ(NO_SPEED);
-
-			if (GetSpeedX() >= NO_SPEED)
-			{
-				if (GetSpeedX() <= MAX_SPEED)
-				{
-					AddSpeedX(AccelDecelSpeed);
-					SetSpeedY(-GetSpeedX());
-				}
-			}
-			else
-			{
-				AddSpeedX(AccelDecelNegSpeed);
-				SetSpeedY(-GetSpeedX());
-			}
-			break;
-		}
-		case E_META_RAIL_ASCEND_XP:  // ASCEND WEST
-		{
-			SetYaw(180);
-			SetSpeedZ(NO_SPEED);
-
-			if (GetSpeedX() > NO_SPEED)
-			{
-				AddSpeedX(AccelDecelSpeed);
-				SetSpeedY(GetSpeedX());
-			}
-			else
-			{
-				if (GetSpeedX() >= MAX_SPEED_NEGATIVE)
-				{
-					AddSpeedX(AccelDecelNegSpeed);
-					SetSpeedY(GetSpeedX());
-				}
-			}
-			break;
-		}
-		case E_META_RAIL_ASCEND_ZM:  // ASCEND NORTH
-		{
-			SetYaw(270);
-			SetSpeedX(NO_SPEED);
-
-			if (GetSpeedZ() >= NO_SPEED)
-			{
-				if (GetSpeedZ() <= MAX_SPEED)
-				{
-					AddSpeedZ(AccelDecelSpeed);
-					SetSpeedY(-GetSpeedZ());
-				}
-			}
-			else
-			{
-				AddSpeedZ(AccelDecelNegSpeed);
-				SetSpeedY(-GetSpeedZ());
-			}
-			break;
-		}
-		case E_META_RAIL_ASCEND_ZP:  // ASCEND SOUTH
-		{
-			SetYaw(270);
-			SetSpeedX(NO_SPEED);
-
-			if (GetSpeedZ() > NO_SPEED)
-			{
-				AddSpeedZ(AccelDecelSpeed);
-				SetSpeedY(GetSpeedZ());
-			}
-			else
-			{
-				if (GetSpeedZ() >= MAX_SPEED_NEGATIVE)
-				{
-					AddSpeedZ(AccelDecelNegSpeed);
-					SetSpeedY(GetSpeedZ());
-				}
-			}
-			break;
-		}
-		default: ASSERT(!"Unhandled powered rail metadata!"); break;
-	}
-}
-
-
-
-
-
-void cMinecart::HandleDetectorRailPhysics(NIBBLETYPE a_RailMeta, std::chrono::milliseconds a_Dt)
+void cMinecart::PowerDetectorRail(NIBBLETYPE a_RailMeta, cChunk & a_Chunk)
 {
-	m_World->SetBlockMeta(m_DetectorRailPosition, a_RailMeta | 0x08);
-
-	// No special handling
-	HandleRailPhysics(a_RailMeta & 0x07, a_Dt);
+	// a_Chunk is the chunk containing the rail the cart is on.
+	// cChunk::SetMeta() doesn't notify the simulators, wake them up so that the redstone simulator picks the new power source up:
+	int RelX = POSX_TOINT - a_Chunk.GetPosX() * cChunkDef::Width;
+	int RelZ = POSZ_TOINT - a_Chunk.GetPosZ() * cChunkDef::Width;
+	ASSERT((RelX >= 0) && (RelX < cChunkDef::Width) && (RelZ >= 0) && (RelZ < cChunkDef::Width));
+	a_Chunk.SetMeta(RelX, POSY_TOINT, RelZ, a_RailMeta | 0x08);
+	m_World->GetSimulatorManager()->WakeUp(POSX_TOINT, POSY_TOINT, POSZ_TOINT, &a_Chunk);
 }
 
 
 
 
-void cMinecart::HandleActivatorRailPhysics(NIBBLETYPE a_RailMeta, std::chrono::milliseconds a_Dt)
-{
-	HandleRailPhysics(a_RailMeta & 0x07, a_Dt);
-}
-
-
 
-
-
-void cMinecart::SnapToRail(NIBBLETYPE a_RailMeta)
-{
-	switch (a_RailMeta)
-	{
-		case E_META_RAIL_ASCEND_XM:
-		case E_META_RAIL_ASCEND_XP:
-		case E_META_RAIL_XM_XP:
-		{
-			SetSpeedZ(NO_SPEED);
-			SetPosZ(floor(GetPosZ()) + 0.5);
-			break;
-		}
-		case E_META_RAIL_ASCEND_ZM:
-		case E_META_RAIL_ASCEND_ZP:
-		case E_META_RAIL_ZM_ZP:
-		{
-			SetSpeedX(NO_SPEED);
-			SetPosX(floor(GetPosX()) + 0.5);
-			break;
-		}
-		// Curved rail physics: once minecart has reached more than half of the block in the direction that it is travelling in, jerk it in the direction of curvature
-		case E_META_RAIL_CURVED_ZM_XM:
-		{
-			if (GetPosZ() > floor(GetPosZ()) + 0.5)
-			{
-				if (GetSpeedZ() > NO_SPEED)
-				{
-					SetSpeedX(-GetSpeedZ() * 0.7);
-				}
-
-				SetSpeedZ(NO_SPEED);
-				SetPosZ(floor(GetPosZ()) + 0.5);
-			}
-			else if (GetPosX() > floor(GetPosX()) + 0.5)
-			{
-				if (GetSpeedX() > 0)
-				{
-					SetSpeedZ(-GetSpeedX() * 0.7);
-				}
-
-				SetSpeedX(NO_SPEED);
-				SetPosX(floor(GetPosX()) + 0.5);
-			}
-			SetSpeedY(NO_SPEED);
-			break;
-		}
-		case E_META_RAIL_CURVED_ZM_XP:
-		{
-			if (GetPosZ() > floor(GetPosZ()) + 0.5)
-			{
-				if (GetSpeedZ() > NO_SPEED)
-				{
-					SetSpeedX(GetSpeedZ() * 0.7);
-				}
-
-				SetSpeedZ(NO_SPEED);
-				SetPosZ(floor(GetPosZ()) + 0.5);
-			}
-			else if (GetPosX() < floor(GetPosX()) + 0.5)
-			{
-				if (GetSpeedX() < NO_SPEED)
-				{
-					SetSpeedZ(GetSpeedX() * 0.7);
-				}
-
-				SetSpeedX(NO_SPEED);
-				SetPosX(floor(GetPosX()) + 0.5);
-			}
-			SetSpeedY(NO_SPEED);
-			break;
-		}
-		case E_META_RAIL_CURVED_ZP_XM:
-		{
-			if (GetPosZ() < floor(GetPosZ()) + 0.5)
-			{
-				if (GetSpeedZ() < NO_SPEED)
-				{
-					SetSpeedX(GetSpeedZ() * 0.7);
-				}
-
-				SetSpeedZ(NO_SPEED);
-				SetPosZ(floor(GetPosZ()) + 0.5);
-			}
-			else if (GetPosX() > floor(GetPosX()) + 0.5)
-			{
-				if (GetSpeedX() > NO_SPEED)
-				{
-					SetSpeedZ(GetSpeedX() * 0.7);
-				}
-
-				SetSpeedX(NO_SPEED);
-				SetPosX(floor(GetPosX()) + 0.5);
-			}
-			SetSpeedY(NO_SPEED);
-			break;
-		}
-		case E_META_RAIL_CURVED_ZP_XP:
-		{
-			if (GetPosZ() < floor(GetPosZ()) + 0.5)
-			{
-				if (GetSpeedZ() < NO_SPEED)
-				{
-					SetSpeedX(-GetSpeedZ() * 0.7);
-				}
-
-				SetSpeedZ(NO_SPEED);
-				SetPosZ(floor(GetPosZ()) + 0.5);
-			}
-			else if (GetPosX() < floor(GetPosX()) + 0.5)
-			{
-				if (GetSpeedX() < NO_SPEED)
-				{
-					SetSpeedZ(-GetSpeedX() * 0.7);
-				}
-
-				SetSpeedX(NO_SPEED);
-				SetPosX(floor(GetPosX()) + 0.5);
-			}
-			SetSpeedY(0);
-			break;
-		}
-		default: break;
-	}
-}
-
-
-
-
-
-bool cMinecart::TestBlockCollision(NIBBLETYPE a_RailMeta)
-{
-	switch (a_RailMeta)
-	{
-		case E_META_RAIL_ZM_ZP:
-		{
-			if (GetSpeedZ() > 0)
-			{
-				BLOCKTYPE Block = m_World->GetBlock(POSX_TOINT, POSY_TOINT, (int)ceil(GetPosZ()));
-				if (!IsBlockRail(Block) && cBlockInfo::IsSolid(Block))
-				{
-					// We could try to detect a block in front based purely on coordinates, but xoft made a bounding box system - why not use? :P
-					cBoundingBox bbBlock(Vector3d(POSX_TOINT, POSY_TOINT, (int)ceil(GetPosZ())), 0.5, 1);
-					cBoundingBox bbMinecart(Vector3d(GetPosX(), floor(GetPosY()), GetPosZ()), GetWidth() / 2, GetHeight());
-
-					if (bbBlock.DoesIntersect(bbMinecart))
-					{
-						SetSpeed(0, 0, 0);
-						SetPosZ(floor(GetPosZ()) + 0.4);
-						return true;
-					}
-				}
-			}
-			else if (GetSpeedZ() < 0)
-			{
-				BLOCKTYPE Block = m_World->GetBlock(POSX_TOINT, POSY_TOINT, POSZ_TOINT - 1);
-				if (!IsBlockRail(Block) && cBlockInfo::IsSolid(Block))
-				{
-					cBoundingBox bbBlock(Vector3d(POSX_TOINT, POSY_TOINT, POSZ_TOINT - 1), 0.5, 1);
-					cBoundingBox bbMinecart(Vector3d(GetPosX(), floor(GetPosY()), GetPosZ() - 1), GetWidth() / 2, GetHeight());
-
-					if (bbBlock.DoesIntersect(bbMinecart))
-					{
-						SetSpeed(0, 0, 0);
-						SetPosZ(floor(GetPosZ()) + 0.65);
-						return true;
-					}
-				}
-			}
-			break;
-		}
-		case E_META_RAIL_XM_XP:
-		{
-			if (GetSpeedX() > 0)
-			{
-				BLOCKTYPE Block = m_World->GetBlock((int)ceil(GetPosX()), POSY_TOINT, POSZ_TOINT);
-				if (!IsBlockRail(Block) && cBlockInfo::IsSolid(Block))
-				{
-					cBoundingBox bbBlock(Vector3d((int)ceil(GetPosX()), POSY_TOINT, POSZ_TOINT), 0.5, 1);
-					cBoundingBox bbMinecart(Vector3d(GetPosX(), floor(GetPosY()), GetPosZ()), GetWidth() / 2, GetHeight());
-
-					if (bbBlock.DoesIntersect(bbMinecart))
-					{
-						SetSpeed(0, 0, 0);
-						SetPosX(floor(GetPosX()) + 0.4);
-						return true;
-					}
-				}
-			}
-			else if (GetSpeedX() < 0)
-			{
-				BLOCKTYPE Block = m_World->GetBlock(POSX_TOINT - 1, POSY_TOINT, POSZ_TOINT);
-				if (!IsBlockRail(Block) && cBlockInfo::IsSolid(Block))
-				{
-					cBoundingBox bbBlock(Vector3d(POSX_TOINT - 1, POSY_TOINT, POSZ_TOINT), 0.5, 1);
-					cBoundingBox bbMinecart(Vector3d(GetPosX() - 1, floor(GetPosY()), GetPosZ()), GetWidth() / 2, GetHeight());
-
-					if (bbBlock.DoesIntersect(bbMinecart))
-					{
-						SetSpeed(0, 0, 0);
-						SetPosX(floor(GetPosX()) + 0.65);
-						return true;
-					}
-				}
-			}
-			break;
-		}
-		case E_META_RAIL_CURVED_ZM_XM:
-		case E_META_RAIL_CURVED_ZM_XP:
-		case E_META_RAIL_CURVED_ZP_XM:
-		case E_META_RAIL_CURVED_ZP_XP:
-		{
-			BLOCKTYPE BlockXM = m_World->GetBlock(POSX_TOINT - 1, POSY_TOINT, POSZ_TOINT);
-			BLOCKTYPE BlockXP = m_World->GetBlock(POSX_TOINT + 1, POSY_TOINT, POSZ_TOINT);
-			BLOCKTYPE BlockZM = m_World->GetBlock(POSX_TOINT, POSY_TOINT, POSZ_TOINT - 1);
-			BLOCKTYPE BlockZP = m_World->GetBlock(POSX_TOINT, POSY_TOINT, POSZ_TOINT + 1);
-			if (
-				(!IsBlockRail(BlockXM) && cBlockInfo::IsSolid(BlockXM)) ||
-				(!IsBlockRail(BlockXP) && cBlockInfo::IsSolid(BlockXP)) ||
-				(!IsBlockRail(BlockZM) && cBlockInfo::IsSolid(BlockZM)) ||
-				(!IsBlockRail(BlockZP) && cBlockInfo::IsSolid(BlockZP))
-				)
-			{
-				SetSpeed(0, 0, 0);
-				SetPosition(POSX_TOINT + 0.5, GetPosY(), POSZ_TOINT + 0.5);
-				return true;
-			}
-			break;
-		}
-		default: break;
-	}
-	return false;
-}
-
-
-
-
-bool cMinecart::TestEntityCollision(NIBBLETYPE a_RailMeta)
+bool cMinecart::TestEntityCollision(NIBBLETYPE a_RailMeta, cChunk & a_Chunk)
 {
 	cMinecartCollisionCallback MinecartCollisionCallback(GetPosition(), GetHeight(), GetWidth(), GetUniqueID(), ((m_Attachee == nullptr) ? -1 : m_Attachee->GetUniqueID()));
-	int ChunkX, ChunkZ;
-	cChunkDef::BlockToChunk(POSX_TOINT, POSZ_TOINT, ChunkX, ChunkZ);
-	m_World->ForEachEntityInChunk(ChunkX, ChunkZ, MinecartCollisionCallback);
+	a_Chunk.ForEachEntity(MinecartCollisionCallback);
 
 	if (!MinecartCollisionCallback.FoundIntersection())
 	{
@@ -995,6 +347,32 @@ bool cMinecart::TestEntityCollision(NIBBLETYPE a_RailMeta)
 
 
 
+void cMinecart::ReleaseDetectorRail(cChunk & a_Chunk)
+{
+	int RelX = m_DetectorRailPosition.x - a_Chunk.GetPosX() * cChunkDef::Width;
+	int RelZ = m_DetectorRailPosition.z - a_Chunk.GetPosZ() * cChunkDef::Width;
+	cChunk * RailChunk = a_Chunk.GetRelNeighborChunkAdjustCoords(RelX, RelZ);
+	if ((RailChunk == nullptr) || !RailChunk->IsValid())
+	{
+		return;
+	}
+
+	// Only turn the rail off if it hasn't been broken in the meantime:
+	BLOCKTYPE BlockType;
+	NIBBLETYPE BlockMeta;
+	RailChunk->GetBlockTypeMeta(RelX, m_DetectorRailPosition.y, RelZ, BlockType, BlockMeta);
+	if (BlockType == E_BLOCK_DETECTOR_RAIL)
+	{
+		// cChunk::SetMeta() doesn't notify the simulators, wake them up so that the redstone simulator unpowers the circuit:
+		RailChunk->SetMeta(RelX, m_DetectorRailPosition.y, RelZ, BlockMeta & 0x07);
+		m_World->GetSimulatorManager()->WakeUp(m_DetectorRailPosition.x, m_DetectorRailPosition.y, m_DetectorRailPosition.z, RailChunk);
+	}
+}
+
+
+
+
+
 bool cMinecart::DoTakeDamage(TakeDamageInfo & TDI)
 {
 	if ((TDI.Attacker != nullptr) && TDI.Attacker->IsPlayer() && ((cPlayer *)TDI.Attacker)->IsGameModeCreative())
@@ -17,6 +17,13 @@
 
 
 
+// fwd: MinecartRailPhysics.h
+template <class CART, class CHUNK> class cMinecartRailPhysics;
+
+
+
+
+
 class cMinecart :
 	public cEntity
 {
@@ -51,33 +58,21 @@ protected:
 	Vector3i m_DetectorRailPosition;
 	bool m_bIsOnDetectorRail;
 	
-	cMinecart(ePayload a_Payload, double a_X, double a_Y, double a_Z);
+	/** The rail physics moving this cart, it calls back into TestEntityCollision() and PowerDetectorRail() */
+	typedef cMinecartRailPhysics<cMinecart, cChunk> cRailPhysics;
+	friend class cMinecartRailPhysics<cMinecart, cChunk>;
 
-	/** Handles physics on normal rails
-		For each tick, slow down on flat rails, speed up or slow down on ascending/descending rails (depending on direction), and turn on curved rails
-	*/
-	void HandleRailPhysics(NIBBLETYPE a_RailMeta, std::chrono::milliseconds a_Dt);
-
-	/** Handles powered rail physics
-		Each tick, speed up or slow down cart, depending on metadata of rail (powered or not)
-	*/
-	void HandlePoweredRailPhysics(NIBBLETYPE a_RailMeta);
+	cMinecart(ePayload a_Payload, double a_X, double a_Y, double a_Z);
 
-	/** Handles detector rail activation
-		Activates detector rails when a minecart is on them. Calls HandleRailPhysics() for physics simulations
-	*/
-	void HandleDetectorRailPhysics(NIBBLETYPE a_RailMeta, std::chrono::milliseconds a_Dt);
+	/** Tests if this mincecart's bounding box is intersecting another entity's bounding box (collision) and pushes mincecart away
+		Only the entities in the chunk the cart is in are checked, a_Chunk is that chunk */
+	bool TestEntityCollision(NIBBLETYPE a_RailMeta, cChunk & a_Chunk);
 
-	/** Handles activator rails - placeholder for future implementation */
-	void HandleActivatorRailPhysics(NIBBLETYPE a_RailMeta, std::chrono::milliseconds a_Dt);
+	/** Powers the unpowered detector rail the cart is on and wakes up the simulators there; a_Chunk is the chunk the cart is in */
+	void PowerDetectorRail(NIBBLETYPE a_RailMeta, cChunk & a_Chunk);
 
-	/** Snaps a mincecart to a rail's axis, resetting its speed
-		For curved rails, it changes the cart's direction as well as snapping it to axis */
-	void SnapToRail(NIBBLETYPE a_RailMeta);
-	/** Tests if a solid block is in front of a cart, and stops the cart (and returns true) if so; returns false if no obstruction */
-	bool TestBlockCollision(NIBBLETYPE a_RailMeta);
-	/** Tests if this mincecart's bounding box is intersecting another entity's bounding box (collision) and pushes mincecart away */
-	bool TestEntityCollision(NIBBLETYPE a_RailMeta);
+	/** Turns off the detector rail that the cart has left, if it is still there; a_Chunk is the chunk the cart is in */
+	void ReleaseDetectorRail(cChunk & a_Chunk);
 
 } ;
 
@@ -174,7 +169,7 @@ public:
 	virtual void Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk) override;
 
 	// Set functions.
-	void SetIsFueled(bool a_IsFueled, int a_FueledTimeLeft = -1) {m_IsFueled = a_IsFueled; m_FueledTimeLeft = a_FueledTimeLeft;}
+	void SetIsFueled(bool a_IsFueled, int a_FueledTimeLeft = -1) {m_IsFueled = a_IsFueled; m_FueledTimeLeft = a_FueledTimeLeft; InvalidateSpawnPackets();}
 
 	// Get functions.
 	int  GetFueledTimeLeft(void) const {return m_FueledTimeLeft; }
@@ -0,0 +1,768 @@
+
+// MinecartRailPhysics.h
+
+// Declares the cMinecartRailPhysics class template that moves a minecart along the rails it is on
+
+/*
+The rail physics only reads and writes the blocks around the cart through the chunk the cart is in and that chunk's
+neighbors, never through the world. It is a template over the cart and the chunk, so that it can be run over fixture
+chunks in the tests; cMinecart uses cMinecartRailPhysics<cMinecart, cChunk>.
+
+The CART class needs the cEntity position, speed and yaw accessors used in the functions below, and these two:
+	bool TestEntityCollision(NIBBLETYPE a_RailMeta, CHUNK & a_Chunk);  // Pushes the cart away from colliding entities, returns true if any
+	void PowerDetectorRail(NIBBLETYPE a_RailMeta, CHUNK & a_Chunk);    // Powers the unpowered detector rail the cart is on
+The CHUNK class needs GetPosX(), GetPosZ(), GetBlockTypeMeta() and UnboundedRelGetBlockType(), as in cChunk.
+*/
+
+
+
+
+
+#pragma once
+
+#include "../BlockInfo.h"
+#include "../BoundingBox.h"
+
+
+
+
+
+#define NO_SPEED 0.0
+#define MAX_SPEED 8
+#define MAX_SPEED_NEGATIVE -MAX_SPEED
+
+
+
+
+
+template <class CART, class CHUNK>
+class cMinecartRailPhysics
+{
+public:
+	/** Moves the cart along the rail at its position, if there is one; a_Chunk is the chunk containing the cart's block.
+	Snaps the cart to the rail, applies the rail's physics and commits the resulting speed to the cart's position.
+	Returns the type of the rail the cart has been moved along, or E_BLOCK_AIR if the cart is not on a rail (and was not moved). */
+	static BLOCKTYPE MoveAlongRail(CART & a_Cart, std::chrono::milliseconds a_Dt, CHUNK & a_Chunk);
+
+	/** Returns the type of the block at the specified absolute coords, read through a_Chunk and its neighbors,
+	without going through the world's chunkmap lock. Returns air if the chunk is not available. */
+	static BLOCKTYPE GetBlockTypeNear(CHUNK & a_Chunk, int a_BlockX, int a_BlockY, int a_BlockZ);
+
+	/** Handles physics on normal rails
+		For each tick, slow down on flat rails, speed up or slow down on ascending/descending rails (depending on direction), and turn on curved rails
+	*/
+	static void HandleRailPhysics(CART & a_Cart, NIBBLETYPE a_RailMeta, std::chrono::milliseconds a_Dt, CHUNK & a_Chunk);
+
+	/** Handles powered rail physics
+		Each tick, speed up or slow down cart, depending on metadata of rail (powered or not)
+	*/
+	static void HandlePoweredRailPhysics(CART & a_Cart, NIBBLETYPE a_RailMeta, CHUNK & a_Chunk);
+
+	/** Handles detector rail activation
+		Activates detector rails when a minecart is on them. Calls HandleRailPhysics() for physics simulations
+	*/
+	static void HandleDetectorRailPhysics(CART & a_Cart, NIBBLETYPE a_RailMeta, std::chrono::milliseconds a_Dt, CHUNK & a_Chunk);
+
+	/** Snaps a mincecart to a rail's axis, resetting its speed
+		For curved rails, it changes the cart's direction as well as snapping it to axis */
+	static void SnapToRail(CART & a_Cart, NIBBLETYPE a_RailMeta);
+
+	/** Tests if a solid block is in front of a cart, and stops the cart (and returns true) if so; returns false if no obstruction
+		The blocks are read through a_Chunk and its neighbors, the chunk the cart is in */
+	static bool TestBlockCollision(CART & a_Cart, NIBBLETYPE a_RailMeta, CHUNK & a_Chunk);
+} ;
+
+
+
+
+
+template <class CART, class CHUNK>
+BLOCKTYPE cMinecartRailPhysics<CART, CHUNK>::MoveAlongRail(CART & a_Cart, std::chrono::milliseconds a_Dt, CHUNK & a_Chunk)
+{
+	int PosY = FloorC(a_Cart.GetPosY());
+	int RelPosX = FloorC(a_Cart.GetPosX()) - a_Chunk.GetPosX() * cChunkDef::Width;
+	int RelPosZ = FloorC(a_Cart.GetPosZ()) - a_Chunk.GetPosZ() * cChunkDef::Width;
+	ASSERT((RelPosX >= 0) && (RelPosX < cChunkDef::Width) && (RelPosZ >= 0) && (RelPosZ < cChunkDef::Width));
+	ASSERT((PosY > 0) && (PosY < cChunkDef::Height));
+
+	BLOCKTYPE InsideType;
+	NIBBLETYPE InsideMeta;
+	a_Chunk.GetBlockTypeMeta(RelPosX, PosY, RelPosZ, InsideType, InsideMeta);
+
+	if (!IsBlockRail(InsideType))
+	{
+		// When a descending minecart hits a flat rail, it goes through the ground; check for this
+		a_Chunk.GetBlockTypeMeta(RelPosX, PosY + 1, RelPosZ, InsideType, InsideMeta);
+		if (IsBlockRail(InsideType))
+		{
+			// Push cart upwards
+			a_Cart.AddPosY(1);
+		}
+	}
+
+	if (!IsBlockRail(InsideType))
+	{
+		return E_BLOCK_AIR;
+	}
+
+	if (InsideType == E_BLOCK_RAIL)
+	{
+		SnapToRail(a_Cart, InsideMeta);
+	}
+	else
+	{
+		SnapToRail(a_Cart, InsideMeta & 0x07);
+	}
+
+	switch (InsideType)
+	{
+		case E_BLOCK_RAIL: HandleRailPhysics(a_Cart, InsideMeta, a_Dt, a_Chunk); break;
+		case E_BLOCK_ACTIVATOR_RAIL: break;
+		case E_BLOCK_POWERED_RAIL: HandlePoweredRailPhysics(a_Cart, InsideMeta, a_Chunk); break;
+		case E_BLOCK_DETECTOR_RAIL: HandleDetectorRailPhysics(a_Cart, InsideMeta, a_Dt, a_Chunk); break;
+		default: VERIFY(!"Unhandled rail type despite checking if block was rail!"); break;
+	}
+
+	a_Cart.AddPosition(a_Cart.GetSpeed() * (static_cast<double>(a_Dt.count()) / 1000));  // Commit changes; as we use our own engine when on rails, this needs to be done, whereas it is normally in Entity.cpp
+	return InsideType;
+}
+
+
+
+
+
+template <class CART, class CHUNK>
+BLOCKTYPE cMinecartRailPhysics<CART, CHUNK>::GetBlockTypeNear(CHUNK & a_Chunk, int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	BLOCKTYPE BlockType;
+	int RelX = a_BlockX - a_Chunk.GetPosX() * cChunkDef::Width;
+	int RelZ = a_BlockZ - a_Chunk.GetPosZ() * cChunkDef::Width;
+	if (!a_Chunk.UnboundedRelGetBlockType(RelX, a_BlockY, RelZ, BlockType))
+	{
+		return E_BLOCK_AIR;
+	}
+	return BlockType;
+}
+
+
+
+
+
+template <class CART, class CHUNK>
+void cMinecartRailPhysics<CART, CHUNK>::HandleDetectorRailPhysics(CART & a_Cart, NIBBLETYPE a_RailMeta, std::chrono::milliseconds a_Dt, CHUNK & a_Chunk)
+{
+	if ((a_RailMeta & 0x08) == 0)
+	{
+		a_Cart.PowerDetectorRail(a_RailMeta, a_Chunk);
+	}
+
+	// No special handling
+	HandleRailPhysics(a_Cart, a_RailMeta & 0x07, a_Dt, a_Chunk);
+}
+
+
+
+
+
+template <class CART, class CHUNK>
+void cMinecartRailPhysics<CART, CHUNK>::HandleRailPhysics(CART & a_Cart, NIBBLETYPE a_RailMeta, std::chrono::milliseconds a_Dt, CHUNK & a_Chunk)
+{
+	/*
+	NOTE: Please bear in mind that taking away from negatives make them even more negative,
+	adding to negatives make them positive, etc.
+	*/
+	
+	switch (a_RailMeta)
+	{
+		case E_META_RAIL_ZM_ZP:  // NORTHSOUTH
+		{
+			a_Cart.SetYaw(270);
+			a_Cart.SetPosY(floor(a_Cart.GetPosY()) + 0.55);
+			a_Cart.SetSpeedY(0);  // Don't move vertically as on ground
+			a_Cart.SetSpeedX(0);  // Correct diagonal movement from curved rails
+
+			// Execute both the entity and block collision checks
+			bool BlckCol = TestBlockCollision(a_Cart, a_RailMeta, a_Chunk), EntCol = a_Cart.TestEntityCollision(a_RailMeta, a_Chunk);
+			if (EntCol || BlckCol)
+			{
+				return;
+			}
+			
+			if (a_Cart.GetSpeedZ() != NO_SPEED)  // Don't do anything if cart is stationary
+			{
+				if (a_Cart.GetSpeedZ() > 0)
+				{
+					// Going SOUTH, slow down
+					a_Cart.AddSpeedZ(-0.1);
+				}
+				else
+				{
+					// Going NORTH, slow down
+					a_Cart.AddSpeedZ(0.1);
+				}
+			}
+			break;
+		}
+		case E_META_RAIL_XM_XP:  // EASTWEST
+		{
+			a_Cart.SetYaw(180);
+			a_Cart.SetPosY(floor(a_Cart.GetPosY()) + 0.55);
+			a_Cart.SetSpeedY(NO_SPEED);
+			a_Cart.SetSpeedZ(NO_SPEED);
+
+			bool BlckCol = TestBlockCollision(a_Cart, a_RailMeta, a_Chunk), EntCol = a_Cart.TestEntityCollision(a_RailMeta, a_Chunk);
+			if (EntCol || BlckCol)
+			{
+				return;
+			}
+
+			if (a_Cart.GetSpeedX() != NO_SPEED)
+			{
+				if (a_Cart.GetSpeedX() > 0)
+				{
+					a_Cart.AddSpeedX(-0.1);
+				}
+				else
+				{
+					a_Cart.AddSpeedX(0.1);
+				}
+			}
+			break;
+		}
+		case E_META_RAIL_ASCEND_ZM:  // ASCEND NORTH
+		{
+			a_Cart.SetYaw(270);
+			a_Cart.SetSpeedX(0);
+
+			if (a_Cart.GetSpeedZ() >= 0)
+			{
+				// SpeedZ POSITIVE, going SOUTH
+				if (a_Cart.GetSpeedZ() <= MAX_SPEED)  // Speed limit
+				{
+					a_Cart.AddSpeedZ(0.5);  // Speed up
+					a_Cart.SetSpeedY(-a_Cart.GetSpeedZ());  // Downward movement is negative (0 minus positive numbers is negative)
+				}
+			}
+			else
+			{
+				// SpeedZ NEGATIVE, going NORTH
+				a_Cart.AddSpeedZ(1);  // Slow down
+				a_Cart.SetSpeedY(-a_Cart.GetSpeedZ());  // Upward movement is positive (0 minus negative number is positive number)
+			}
+			break;
+		}
+		case E_META_RAIL_ASCEND_ZP:  // ASCEND SOUTH
+		{
+			a_Cart.SetYaw(270);
+			a_Cart.SetSpeedX(0);
+
+			if (a_Cart.GetSpeedZ() > 0)
+			{
+				// SpeedZ POSITIVE, going SOUTH
+				a_Cart.AddSpeedZ(-1);  // Slow down
+				a_Cart.SetSpeedY(a_Cart.GetSpeedZ());  // Upward movement positive
+			}
+			else
+			{
+				if (a_Cart.GetSpeedZ() >= MAX_SPEED_NEGATIVE)  // Speed limit
+				{
+					// SpeedZ NEGATIVE, going NORTH
+					a_Cart.AddSpeedZ(-0.5);  // Speed up
+					a_Cart.SetSpeedY(a_Cart.GetSpeedZ());  // Downward movement negative
+				}
+			}
+			break;
+		}
+		case E_META_RAIL_ASCEND_XM:  // ASCEND EAST
+		{
+			a_Cart.SetYaw(180);
+			a_Cart.SetSpeedZ(NO_SPEED);
+
+			if (a_Cart.GetSpeedX() >= NO_SPEED)
+			{
+				if (a_Cart.GetSpeedX() <= MAX_SPEED)
+				{
+					a_Cart.AddSpeedX(0.5);
+					a_Cart.SetSpeedY(-a_Cart.GetSpeedX());
+				}
+			}
+			else
+			{
+				a_Cart.AddSpeedX(1);
+				a_Cart.SetSpeedY(-a_Cart.GetSpeedX());
+			}
+			break;
+		}
+		case E_META_RAIL_ASCEND_XP:  // ASCEND WEST
+		{
+			a_Cart.SetYaw(180);
+			a_Cart.SetSpeedZ(0);
+
+			if (a_Cart.GetSpeedX() > 0)
+			{
+				a_Cart.AddSpeedX(-1);
+				a_Cart.SetSpeedY(a_Cart.GetSpeedX());
+			}
+			else
+			{
+				if (a_Cart.GetSpeedX() >= MAX_SPEED_NEGATIVE)
+				{
+					a_Cart.AddSpeedX(-0.5);
+					a_Cart.SetSpeedY(a_Cart.GetSpeedX());
+				}
+			}
+			break;
+		}
+		case E_META_RAIL_CURVED_ZM_XM:  // Ends pointing NORTH and WEST
+		{
+			a_Cart.SetYaw(315);  // Set correct rotation server side
+			a_Cart.SetPosY(floor(a_Cart.GetPosY()) + 0.55);  // Levitate dat cart
+			a_Cart.SetSpeedY(0);
+
+			TestBlockCollision(a_Cart, a_RailMeta, a_Chunk);
+			a_Cart.TestEntityCollision(a_RailMeta, a_Chunk);
+
+			// SnapToRail handles turning
+
+			break;
+		}
+		case E_META_RAIL_CURVED_ZM_XP:  // Curved NORTH EAST
+		{
+			a_Cart.SetYaw(225);
+			a_Cart.SetPosY(floor(a_Cart.GetPosY()) + 0.55);
+			a_Cart.SetSpeedY(0);
+
+			TestBlockCollision(a_Cart, a_RailMeta, a_Chunk);
+			a_Cart.TestEntityCollision(a_RailMeta, a_Chunk);
+
+			break;
+		}
+		case E_META_RAIL_CURVED_ZP_XM:  // Curved SOUTH WEST
+		{
+			a_Cart.SetYaw(135);
+			a_Cart.SetPosY(floor(a_Cart.GetPosY()) + 0.55);
+			a_Cart.SetSpeedY(0);
+
+			TestBlockCollision(a_Cart, a_RailMeta, a_Chunk);
+			a_Cart.TestEntityCollision(a_RailMeta, a_Chunk);
+
+			break;
+		}
+		case E_META_RAIL_CURVED_ZP_XP:  // Curved SOUTH EAST
+		{
+			a_Cart.SetYaw(45);
+			a_Cart.SetPosY(floor(a_Cart.GetPosY()) + 0.55);
+			a_Cart.SetSpeedY(0);
+
+			TestBlockCollision(a_Cart, a_RailMeta, a_Chunk);
+			a_Cart.TestEntityCollision(a_RailMeta, a_Chunk);
+
+			break;
+		}
+		default:
+		{
+			ASSERT(!"Unhandled rail meta!");  // Dun dun DUN!
+			break;
+		}
+	}
+}
+
+
+
+
+
+template <class CART, class CHUNK>
+void cMinecartRailPhysics<CART, CHUNK>::HandlePoweredRailPhysics(CART & a_Cart, NIBBLETYPE a_RailMeta, CHUNK & a_Chunk)
+{
+	// Initialise to 'slow down' values
+	int AccelDecelSpeed = -2;
+	int AccelDecelNegSpeed = 2;
+
+	if ((a_RailMeta & 0x8) == 0x8)
+	{
+		// Rail powered - set variables to 'speed up' values
+		AccelDecelSpeed = 1;
+		AccelDecelNegSpeed = -1;
+	}
+
+	switch (a_RailMeta & 0x07)
+	{
+		case E_META_RAIL_ZM_ZP:  // NORTHSOUTH
+		{
+			a_Cart.SetYaw(270);
+			a_Cart.SetPosY(floor(a_Cart.GetPosY()) + 0.55);
+			a_Cart.SetSpeedY(0);
+			a_Cart.SetSpeedX(0);
+
+			bool BlckCol = TestBlockCollision(a_Cart, a_RailMeta, a_Chunk), EntCol = a_Cart.TestEntityCollision(a_RailMeta, a_Chunk);
+			if (EntCol || BlckCol)
+			{
+				return;
+			}
+			
+			if (a_Cart.GetSpeedZ() != NO_SPEED)
+			{
+				if (a_Cart.GetSpeedZ() > NO_SPEED)
+				{
+					a_Cart.AddSpeedZ(AccelDecelSpeed);
+				}
+				else
+				{
+					a_Cart.AddSpeedZ(AccelDecelNegSpeed);
+				}
+			}
+			break;
+		}
+		case E_META_RAIL_XM_XP:  // EASTWEST
+		{
+			a_Cart.SetYaw(180);
+			a_Cart.SetPosY(floor(a_Cart.GetPosY()) + 0.55);
+			a_Cart.SetSpeedY(NO_SPEED);
+			a_Cart.SetSpeedZ(NO_SPEED);
+
+			bool BlckCol = TestBlockCollision(a_Cart, a_RailMeta, a_Chunk), EntCol = a_Cart.TestEntityCollision(a_RailMeta, a_Chunk);
+			if (EntCol || BlckCol)
+			{
+				return;
+			}
+
+			if (a_Cart.GetSpeedX() != NO_SPEED)
+			{
+				if (a_Cart.GetSpeedX() > NO_SPEED)
+				{
+					a_Cart.AddSpeedX(AccelDecelSpeed);
+				}
+				else
+				{
+					a_Cart.AddSpeedX(AccelDecelNegSpeed);
+				}
+			}
+			break;
+		}
+		case E_META_RAIL_ASCEND_XM:  // ASCEND EAST
+		{
+			a_Cart.SetYaw(180);
+			a_Cart.SetSpeedZ(NO_SPEED);
+
+			if (a_Cart.GetSpeedX() >= NO_SPEED)
+			{
+				if (a_Cart.GetSpeedX() <= MAX_SPEED)
+				{
+					a_Cart.AddSpeedX(AccelDecelSpeed);
+					a_Cart.SetSpeedY(-a_Cart.GetSpeedX());
+				}
+			}
+			else
+			{
+				a_Cart.AddSpeedX(AccelDecelNegSpeed);
+				a_Cart.SetSpeedY(-a_Cart.GetSpeedX());
+			}
+			break;
+		}
+		case E_META_RAIL_ASCEND_XP:  // ASCEND WEST
+		{
+			a_Cart.SetYaw(180);
+			a_Cart.SetSpeedZ(NO_SPEED);
+
+			if (a_Cart.GetSpeedX() > NO_SPEED)
+			{
+				a_Cart.AddSpeedX(AccelDecelSpeed);
+				a_Cart.SetSpeedY(a_Cart.GetSpeedX());
+			}
+			else
+			{
+				if (a_Cart.GetSpeedX() >= MAX_SPEED_NEGATIVE)
+				{
+					a_Cart.AddSpeedX(AccelDecelNegSpeed);
+					a_Cart.SetSpeedY(a_Cart.GetSpeedX());
+				}
+			}
+			break;
+		}
+		case E_META_RAIL_ASCEND_ZM:  // ASCEND NORTH
+		{
+			a_Cart.SetYaw(270);
+			a_Cart.SetSpeedX(NO_SPEED);
+
+			if (a_Cart.GetSpeedZ() >= NO_SPEED)
+			{
+				if (a_Cart.GetSpeedZ() <= MAX_SPEED)
+				{
+					a_Cart.AddSpeedZ(AccelDecelSpeed);
+					a_Cart.SetSpeedY(-a_Cart.GetSpeedZ());
+				}
+			}
+			else
+			{
+				a_Cart.AddSpeedZ(AccelDecelNegSpeed);
+				a_Cart.SetSpeedY(-a_Cart.GetSpeedZ());
+			}
+			break;
+		}
+		case E_META_RAIL_ASCEND_ZP:  // ASCEND SOUTH
+		{
+			a_Cart.SetYaw(270);
+			a_Cart.SetSpeedX(NO_SPEED);
+
+			if (a_Cart.GetSpeedZ() > NO_SPEED)
+			{
+				a_Cart.AddSpeedZ(AccelDecelSpeed);
+				a_Cart.SetSpeedY(a_Cart.GetSpeedZ());
+			}
+			else
+			{
+				if (a_Cart.GetSpeedZ() >= MAX_SPEED_NEGATIVE)
+				{
+					a_Cart.AddSpeedZ(AccelDecelNegSpeed);
+					a_Cart.SetSpeedY(a_Cart.GetSpeedZ());
+				}
+			}
+			break;
+		}
+		default: ASSERT(!"Unhandled powered rail metadata!"); break;
+	}
+}
+
+
+
+
+
+template <class CART, class CHUNK>
+void cMinecartRailPhysics<CART, CHUNK>::SnapToRail(CART & a_Cart, NIBBLETYPE a_RailMeta)
+{
+	switch (a_RailMeta)
+	{
+		case E_META_RAIL_ASCEND_XM:
+		case E_META_RAIL_ASCEND_XP:
+		case E_META_RAIL_XM_XP:
+		{
+			a_Cart.SetSpeedZ(NO_SPEED);
+			a_Cart.SetPosZ(floor(a_Cart.GetPosZ()) + 0.5);
+			break;
+		}
+		case E_META_RAIL_ASCEND_ZM:
+		case E_META_RAIL_ASCEND_ZP:
+		case E_META_RAIL_ZM_ZP:
+		{
+			a_Cart.SetSpeedX(NO_SPEED);
+			a_Cart.SetPosX(floor(a_Cart.GetPosX()) + 0.5);
+			break;
+		}
+		// Curved rail physics: once minecart has reached more than half of the block in the direction that it is travelling in, jerk it in the direction of curvature
+		case E_META_RAIL_CURVED_ZM_XM:
+		{
+			if (a_Cart.GetPosZ() > floor(a_Cart.GetPosZ()) + 0.5)
+			{
+				if (a_Cart.GetSpeedZ() > NO_SPEED)
+				{
+					a_Cart.SetSpeedX(-a_Cart.GetSpeedZ() * 0.7);
+				}
+
+				a_Cart.SetSpeedZ(NO_SPEED);
+				a_Cart.SetPosZ(floor(a_Cart.GetPosZ()) + 0.5);
+			}
+			else if (a_Cart.GetPosX() > floor(a_Cart.GetPosX()) + 0.5)
+			{
+				if (a_Cart.GetSpeedX() > 0)
+				{
+					a_Cart.SetSpeedZ(-a_Cart.GetSpeedX() * 0.7);
+				}
+
+				a_Cart.SetSpeedX(NO_SPEED);
+				a_Cart.SetPosX(floor(a_Cart.GetPosX()) + 0.5);
+			}
+			a_Cart.SetSpeedY(NO_SPEED);
+			break;
+		}
+		case E_META_RAIL_CURVED_ZM_XP:
+		{
+			if (a_Cart.GetPosZ() > floor(a_Cart.GetPosZ()) + 0.5)
+			{
+				if (a_Cart.GetSpeedZ() > NO_SPEED)
+				{
+					a_Cart.SetSpeedX(a_Cart.GetSpeedZ() * 0.7);
+				}
+
+				a_Cart.SetSpeedZ(NO_SPEED);
+				a_Cart.SetPosZ(floor(a_Cart.GetPosZ()) + 0.5);
+			}
+			else if (a_Cart.GetPosX() < floor(a_Cart.GetPosX()) + 0.5)
+			{
+				if (a_Cart.GetSpeedX() < NO_SPEED)
+				{
+					a_Cart.SetSpeedZ(a_Cart.GetSpeedX() * 0.7);
+				}
+
+				a_Cart.SetSpeedX(NO_SPEED);
+				a_Cart.SetPosX(floor(a_Cart.GetPosX()) + 0.5);
+			}
+			a_Cart.SetSpeedY(NO_SPEED);
+			break;
+		}
+		case E_META_RAIL_CURVED_ZP_XM:
+		{
+			if (a_Cart.GetPosZ() < floor(a_Cart.GetPosZ()) + 0.5)
+			{
+				if (a_Cart.GetSpeedZ() < NO_SPEED)
+				{
+					a_Cart.SetSpeedX(a_Cart.GetSpeedZ() * 0.7);
+				}
+
+				a_Cart.SetSpeedZ(NO_SPEED);
+				a_Cart.SetPosZ(floor(a_Cart.GetPosZ()) + 0.5);
+			}
+			else if (a_Cart.GetPosX() > floor(a_Cart.GetPosX()) + 0.5)
+			{
+				if (a_Cart.GetSpeedX() > NO_SPEED)
+				{
+					a_Cart.SetSpeedZ(a_Cart.GetSpeedX() * 0.7);
+				}
+
+				a_Cart.SetSpeedX(NO_SPEED);
+				a_Cart.SetPosX(floor(a_Cart.GetPosX()) + 0.5);
+			}
+			a_Cart.SetSpeedY(NO_SPEED);
+			break;
+		}
+		case E_META_RAIL_CURVED_ZP_XP:
+		{
+			if (a_Cart.GetPosZ() < floor(a_Cart.GetPosZ()) + 0.5)
+			{
+				if (a_Cart.GetSpeedZ() < NO_SPEED)
+				{
+					a_Cart.SetSpeedX(-a_Cart.GetSpeedZ() * 0.7);
+				}
+
+				a_Cart.SetSpeedZ(NO_SPEED);
+				a_Cart.SetPosZ(floor(a_Cart.GetPosZ()) + 0.5);
+			}
+			else if (a_Cart.GetPosX() < floor(a_Cart.GetPosX()) + 0.5)
+			{
+				if (a_Cart.GetSpeedX() < NO_SPEED)
+				{
+					a_Cart.SetSpeedZ(-a_Cart.GetSpeedX() * 0.7);
+				}
+
+				a_Cart.SetSpeedX(NO_SPEED);
+				a_Cart.SetPosX(floor(a_Cart.GetPosX()) + 0.5);
+			}
+			a_Cart.SetSpeedY(0);
+			break;
+		}
+		default: break;
+	}
+}
+
+
+
+
+
+template <class CART, class CHUNK>
+bool cMinecartRailPhysics<CART, CHUNK>::TestBlockCollision(CART & a_Cart, NIBBLETYPE a_RailMeta, CHUNK & a_Chunk)
+{
+	switch (a_RailMeta)
+	{
+		case E_META_RAIL_ZM_ZP:
+		{
+			if (a_Cart.GetSpeedZ() > 0)
+			{
+				BLOCKTYPE Block = GetBlockTypeNear(a_Chunk, FloorC(a_Cart.GetPosX()), FloorC(a_Cart.GetPosY()), (int)ceil(a_Cart.GetPosZ()));
+				if (!IsBlockRail(Block) && cBlockInfo::IsSolid(Block))
+				{
+					// We could try to detect a block in front based purely on coordinates, but xoft made a bounding box system - why not use? :P
+					cBoundingBox bbBlock(Vector3d(FloorC(a_Cart.GetPosX()), FloorC(a_Cart.GetPosY()), (int)ceil(a_Cart.GetPosZ())), 0.5, 1);
+					cBoundingBox bbMinecart(Vector3d(a_Cart.GetPosX(), floor(a_Cart.GetPosY()), a_Cart.GetPosZ()), a_Cart.GetWidth() / 2, a_Cart.GetHeight());
+
+					if (bbBlock.DoesIntersect(bbMinecart))
+					{
+						a_Cart.SetSpeed(0, 0, 0);
+						a_Cart.SetPosZ(floor(a_Cart.GetPosZ()) + 0.4);
+						return true;
+					}
+				}
+			}
+			else if (a_Cart.GetSpeedZ() < 0)
+			{
+				BLOCKTYPE Block = GetBlockTypeNear(a_Chunk, FloorC(a_Cart.GetPosX()), FloorC(a_Cart.GetPosY()), FloorC(a_Cart.GetPosZ()) - 1);
+				if (!IsBlockRail(Block) && cBlockInfo::IsSolid(Block))
+				{
+					cBoundingBox bbBlock(Vector3d(FloorC(a_Cart.GetPosX()), FloorC(a_Cart.GetPosY()), FloorC(a_Cart.GetPosZ()) - 1), 0.5, 1);
+					cBoundingBox bbMinecart(Vector3d(a_Cart.GetPosX(), floor(a_Cart.GetPosY()), a_Cart.GetPosZ() - 1), a_Cart.GetWidth() / 2, a_Cart.GetHeight());
+
+					if (bbBlock.DoesIntersect(bbMinecart))
+					{
+						a_Cart.SetSpeed(0, 0, 0);
+						a_Cart.SetPosZ(floor(a_Cart.GetPosZ()) + 0.65);
+						return true;
+					}
+				}
+			}
+			break;
+		}
+		case E_META_RAIL_XM_XP:
+		{
+			if (a_Cart.GetSpeedX() > 0)
+			{
+				BLOCKTYPE Block = GetBlockTypeNear(a_Chunk, (int)ceil(a_Cart.GetPosX()), FloorC(a_Cart.GetPosY()), FloorC(a_Cart.GetPosZ()));
+				if (!IsBlockRail(Block) && cBlockInfo::IsSolid(Block))
+				{
+					cBoundingBox bbBlock(Vector3d((int)ceil(a_Cart.GetPosX()), FloorC(a_Cart.GetPosY()), FloorC(a_Cart.GetPosZ())), 0.5, 1);
+					cBoundingBox bbMinecart(Vector3d(a_Cart.GetPosX(), floor(a_Cart.GetPosY()), a_Cart.GetPosZ()), a_Cart.GetWidth() / 2, a_Cart.GetHeight());
+
+					if (bbBlock.DoesIntersect(bbMinecart))
+					{
+						a_Cart.SetSpeed(0, 0, 0);
+						a_Cart.SetPosX(floor(a_Cart.GetPosX()) + 0.4);
+						return true;
+					}
+				}
+			}
+			else if (a_Cart.GetSpeedX() < 0)
+			{
+				BLOCKTYPE Block = GetBlockTypeNear(a_Chunk, FloorC(a_Cart.GetPosX()) - 1, FloorC(a_Cart.GetPosY()), FloorC(a_Cart.GetPosZ()));
+				if (!IsBlockRail(Block) && cBlockInfo::IsSolid(Block))
+				{
+					cBoundingBox bbBlock(Vector3d(FloorC(a_Cart.GetPosX()) - 1, FloorC(a_Cart.GetPosY()), FloorC(a_Cart.GetPosZ())), 0.5, 1);
+					cBoundingBox bbMinecart(Vector3d(a_Cart.GetPosX() - 1, floor(a_Cart.GetPosY()), a_Cart.GetPosZ()), a_Cart.GetWidth() / 2, a_Cart.GetHeight());
+
+					if (bbBlock.DoesIntersect(bbMinecart))
+					{
+						a_Cart.SetSpeed(0, 0, 0);
+						a_Cart.SetPosX(floor(a_Cart.GetPosX()) + 0.65);
+						return true;
+					}
+				}
+			}
+			break;
+		}
+		case E_META_RAIL_CURVED_ZM_XM:
+		case E_META_RAIL_CURVED_ZM_XP:
+		case E_META_RAIL_CURVED_ZP_XM:
+		case E_META_RAIL_CURVED_ZP_XP:
+		{
+			BLOCKTYPE BlockXM = GetBlockTypeNear(a_Chunk, FloorC(a_Cart.GetPosX()) - 1, FloorC(a_Cart.GetPosY()), FloorC(a_Cart.GetPosZ()));
+			BLOCKTYPE BlockXP = GetBlockTypeNear(a_Chunk, FloorC(a_Cart.GetPosX()) + 1, FloorC(a_Cart.GetPosY()), FloorC(a_Cart.GetPosZ()));
+			BLOCKTYPE BlockZM = GetBlockTypeNear(a_Chunk, FloorC(a_Cart.GetPosX()), FloorC(a_Cart.GetPosY()), FloorC(a_Cart.GetPosZ()) - 1);
+			BLOCKTYPE BlockZP = GetBlockTypeNear(a_Chunk, FloorC(a_Cart.GetPosX()), FloorC(a_Cart.GetPosY()), FloorC(a_Cart.GetPosZ()) + 1);
+			if (
+				(!IsBlockRail(BlockXM) && cBlockInfo::IsSolid(BlockXM)) ||
+				(!IsBlockRail(BlockXP) && cBlockInfo::IsSolid(BlockXP)) ||
+				(!IsBlockRail(BlockZM) && cBlockInfo::IsSolid(BlockZM)) ||
+				(!IsBlockRail(BlockZP) && cBlockInfo::IsSolid(BlockZP))
+				)
+			{
+				a_Cart.SetSpeed(0, 0, 0);
+				a_Cart.SetPosition(FloorC(a_Cart.GetPosX()) + 0.5, a_Cart.GetPosY(), FloorC(a_Cart.GetPosZ()) + 0.5);
+				return true;
+			}
+			break;
+		}
+		default: break;
+	}
+	return false;
+}
+
+
+
+
+
@@ -83,6 +83,7 @@ cPlayer::cPlayer(cClientHandle* a_Client, const AString & a_PlayerName) :
 	m_BowCharge(0),
 	m_FloaterID(-1),
 	m_Team(nullptr),
+	m_IsStatisticsDirty(false),
 	m_TicksUntilNextSave(PLAYER_INVENTORY_SAVE_INTERVAL),
 	m_bIsTeleporting(false),
 	m_UUID((a_Client != nullptr) ? a_Client->GetUUID() : ""),
@@ -231,6 +232,13 @@ void cPlayer::Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 		SendExperience();
 	}
 
+	// Send the statistics changed during the last tick, all achievements awarded at once:
+	if (m_IsStatisticsDirty && (m_ClientHandle != nullptr))
+	{
+		m_ClientHandle->SendStatistics(m_Stats);
+		m_IsStatisticsDirty = false;
+	}
+
 	bool CanMove = true;
 	if (!GetPosition().EqualsEps(m_LastPos, 0.01))  // Non negligible change in position from last tick?
 	{
@@ -1261,8 +1269,8 @@ unsigned int cPlayer::AwardAchievement(const eStatistic a_Ach)
 		// Increment the statistic
 		StatValue New = m_Stats.AddValue(a_Ach);
 
-		// Achievement Get!
-		m_ClientHandle->SendStatistics(m_Stats);
+		// Achievement Get! The client is sent the statistics in the next Tick():
+		m_IsStatisticsDirty = true;
 
 		return New;
 	}
@@ -45,6 +45,7 @@ public:
 	virtual ~cPlayer();
 
 	virtual void SpawnOn(cClientHandle & a_Client) override;
+	virtual bool CanCacheSpawnPackets(void) const override { return false; }  // SpawnOn() skips the player's own client
 	
 	virtual void Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk) override;
 
@@ -584,6 +585,10 @@ protected:
 
 	cStatManager m_Stats;
 
+	/** Set when the statistics have changed in a way the client should see (an achievement was awarded).
+	The statistics are sent at most once per tick, in Tick(). */
+	bool m_IsStatisticsDirty;
+
 	/** Flag representing whether the player is currently in a bed
 	Set by a right click on unoccupied bed, unset by a time fast forward or teleport */
 	bool m_bIsInBed;
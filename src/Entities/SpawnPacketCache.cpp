@@ -0,0 +1,90 @@
+
+// SpawnPacketCache.cpp
+
+// Implements the cSpawnPacketCache class representing the spawn packets of a single entity, cached for reuse by all the clients
+
+#include "Globals.h"
+#include "SpawnPacketCache.h"
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cSpawnPacketCache::sState:
+
+cSpawnPacketCache::sState::sState(const Vector3d & a_Pos, const Vector3d & a_Rot, const Vector3d & a_Speed, double a_HeadYaw, int a_Health) :
+	m_Pos(a_Pos),
+	m_Rot(a_Rot),
+	m_Speed(a_Speed),
+	m_HeadYaw(a_HeadYaw),
+	m_Health(a_Health)
+{
+}
+
+
+
+
+
+bool cSpawnPacketCache::sState::operator ==(const sState & a_Other) const
+{
+	return (
+		(m_Pos == a_Other.m_Pos) &&
+		(m_Rot == a_Other.m_Rot) &&
+		(m_Speed == a_Other.m_Speed) &&
+		(m_HeadYaw == a_Other.m_HeadYaw) &&
+		(m_Health == a_Other.m_Health)
+	);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cSpawnPacketCache:
+
+cSpawnPacketCache::cSpawnPacketCache(void) :
+	m_ProtocolVersion(-1),
+	m_State(Vector3d(), Vector3d(), Vector3d(), 0, 0)
+{
+}
+
+
+
+
+
+bool cSpawnPacketCache::Get(int a_ProtocolVersion, const sState & a_State, AString & a_Packets) const
+{
+	if ((m_ProtocolVersion != a_ProtocolVersion) || !(m_State == a_State))
+	{
+		return false;
+	}
+	a_Packets = m_Packets;
+	return true;
+}
+
+
+
+
+
+void cSpawnPacketCache::Set(int a_ProtocolVersion, const sState & a_State, const AString & a_Packets)
+{
+	m_ProtocolVersion = a_ProtocolVersion;
+	m_State = a_State;
+	m_Packets = a_Packets;
+}
+
+
+
+
+
+void cSpawnPacketCache::Invalidate(void)
+{
+	m_ProtocolVersion = -1;
+	m_Packets.clear();
+}
+
+
+
+
@@ -0,0 +1,64 @@
+
+// SpawnPacketCache.h
+
+// Declares the cSpawnPacketCache class representing the spawn packets of a single entity, cached for reuse by all the clients
+
+
+
+
+
+#pragma once
+
+#include "../Vector3.h"
+
+
+
+
+
+/** The spawn packets that a protocol has built for an entity, kept for the other clients of the same protocol version.
+The packets are valid while the entity's state that they encode stays the same. Position, rotation, speed, head yaw and health
+are compared on each use. The metadata and equipment can't be compared cheaply, so their changes must call Invalidate(). */
+class cSpawnPacketCache
+{
+public:
+	/** The entity's state encoded in the spawn packets that is compared on each use */
+	struct sState
+	{
+		Vector3d m_Pos;
+		Vector3d m_Rot;
+		Vector3d m_Speed;
+		double   m_HeadYaw;
+		int      m_Health;
+
+		sState(const Vector3d & a_Pos, const Vector3d & a_Rot, const Vector3d & a_Speed, double a_HeadYaw, int a_Health);
+
+		bool operator ==(const sState & a_Other) const;
+	} ;
+
+
+	cSpawnPacketCache(void);
+
+	/** Retrieves the cached packets into a_Packets.
+	Returns false if nothing is cached for the protocol version, or if the packets were built for a different state. */
+	bool Get(int a_ProtocolVersion, const sState & a_State, AString & a_Packets) const;
+
+	/** Caches the packets built by the specified protocol version for the specified state. */
+	void Set(int a_ProtocolVersion, const sState & a_State, const AString & a_Packets);
+
+	/** Drops the cached packets. */
+	void Invalidate(void);
+
+protected:
+	/** The protocol version that built m_Packets, -1 if nothing is cached */
+	int m_ProtocolVersion;
+
+	/** The cached packets, in the protocol's wire format before encryption */
+	AString m_Packets;
+
+	/** The state from which m_Packets was built */
+	sState m_State;
+} ;
+
+
+
+
@@ -44,7 +44,7 @@ public:
 	
 	void SetEntityEffectType(cEntityEffect::eType a_EntityEffectType) { m_EntityEffectType = a_EntityEffectType; }
 	void SetEntityEffect(cEntityEffect a_EntityEffect) { m_EntityEffect = a_EntityEffect; }
-	void SetPotionColor(int a_PotionColor) { m_PotionColor = a_PotionColor; }
+	void SetPotionColor(int a_PotionColor) { m_PotionColor = a_PotionColor; InvalidateSpawnPackets(); }
 
 	// tolua_end
 	
@@ -935,102 +935,98 @@ void cBioGenTwoLevel::InitializeBiomeGen(cIniFile & a_IniFile)
 ////////////////////////////////////////////////////////////////////////////////
 // cBioGenGrown:
 
-class cBioGenGrown:
-	public cBiomeGen
+cBioGenGrown::cBioGenGrown(int a_Seed)
 {
-public:
-	cBioGenGrown(int a_Seed)
-	{
-		auto FinalRivers =
-			std::make_shared<cIntGenSmooth<8>>   (a_Seed + 1,
-			std::make_shared<cIntGenZoom  <10>>  (a_Seed + 2,
-			std::make_shared<cIntGenRiver <7>>   (a_Seed + 3,
-			std::make_shared<cIntGenZoom  <9>>   (a_Seed + 4,
-			std::make_shared<cIntGenSmooth<6>>   (a_Seed + 5,
-			std::make_shared<cIntGenZoom  <8>>   (a_Seed + 8,
-			std::make_shared<cIntGenSmooth<6>>   (a_Seed + 5,
-			std::make_shared<cIntGenZoom  <8>>   (a_Seed + 9,
-			std::make_shared<cIntGenSmooth<6>>   (a_Seed + 5,
-			std::make_shared<cIntGenZoom  <8>>   (a_Seed + 10,
-			std::make_shared<cIntGenSmooth<6>>   (a_Seed + 5,
-			std::make_shared<cIntGenSmooth<8>>   (a_Seed + 6,
-			std::make_shared<cIntGenZoom  <10>>  (a_Seed + 11,
-			std::make_shared<cIntGenChoice<2, 7>>(a_Seed + 12
-		))))))))))))));
+	auto FinalRivers =
+		std::make_shared<cIntGenSmooth<8>>   (a_Seed + 1,
+		std::make_shared<cIntGenZoom  <10>>  (a_Seed + 2,
+		std::make_shared<cIntGenRiver <7>>   (a_Seed + 3,
+		std::make_shared<cIntGenZoom  <9>>   (a_Seed + 4,
+		std::make_shared<cIntGenSmooth<6>>   (a_Seed + 5,
+		std::make_shared<cIntGenZoom  <8>>   (a_Seed + 8,
+		std::make_shared<cIntGenSmooth<6>>   (a_Seed + 5,
+		std::make_shared<cIntGenZoom  <8>>   (a_Seed + 9,
+		std::make_shared<cIntGenSmooth<6>>   (a_Seed + 5,
+		std::make_shared<cIntGenZoom  <8>>   (a_Seed + 10,
+		std::make_shared<cIntGenSmooth<6>>   (a_Seed + 5,
+		std::make_shared<cIntGenSmooth<8>>   (a_Seed + 6,
+		std::make_shared<cIntGenZoom  <10>>  (a_Seed + 11,
+		std::make_shared<cIntGenChoice<2, 7>>(a_Seed + 12
+	))))))))))))));
+
+	auto alteration =
+		std::make_shared<cIntGenZoom     <8>>(a_Seed,
+		std::make_shared<cIntGenLandOcean<6>>(a_Seed, 20
+	));
+
+	auto alteration2 =
+		std::make_shared<cIntGenZoom     <8>>(a_Seed + 1,
+		std::make_shared<cIntGenZoom     <6>>(a_Seed + 2,
+		std::make_shared<cIntGenZoom     <5>>(a_Seed + 1,
+		std::make_shared<cIntGenZoom     <4>>(a_Seed + 2,
+		std::make_shared<cIntGenLandOcean<4>>(a_Seed + 1, 10
+	)))));
+
+	auto FinalBiomes =
+		std::make_shared<cIntGenSmooth         <8>> (a_Seed + 1,
+		std::make_shared<cIntGenZoom           <10>>(a_Seed + 15,
+		std::make_shared<cIntGenSmooth         <7>> (a_Seed + 1,
+		std::make_shared<cIntGenZoom           <9>> (a_Seed + 16,
+		std::make_shared<cIntGenBeaches        <6>> (
+		std::make_shared<cIntGenZoom           <8>> (a_Seed + 1,
+		std::make_shared<cIntGenAddIslands     <6>> (a_Seed + 2004, 10,
+		std::make_shared<cIntGenAddToOcean     <6>> (a_Seed + 10, 500, biDeepOcean,
+		std::make_shared<cIntGenReplaceRandomly<8>> (a_Seed + 1, biPlains, biSunflowerPlains, 20,
+		std::make_shared<cIntGenMBiomes        <8>> (a_Seed + 5, alteration2,
+		std::make_shared<cIntGenAlternateBiomes<8>> (a_Seed + 1, alteration,
+		std::make_shared<cIntGenBiomeEdges     <8>> (a_Seed + 3,
+		std::make_shared<cIntGenZoom           <10>>(a_Seed + 2,
+		std::make_shared<cIntGenZoom           <7>> (a_Seed + 4,
+		std::make_shared<cIntGenReplaceRandomly<5>> (a_Seed + 99, biIcePlains, biIcePlainsSpikes, 50,
+		std::make_shared<cIntGenZoom           <5>> (a_Seed + 8,
+		std::make_shared<cIntGenAddToOcean     <4>> (a_Seed + 10, 300, biDeepOcean,
+		std::make_shared<cIntGenAddToOcean     <6>> (a_Seed + 9, 8, biMushroomIsland,
+		std::make_shared<cIntGenBiomes         <8>> (a_Seed + 3000,
+		std::make_shared<cIntGenAddIslands     <8>> (a_Seed + 2000, 200,
+		std::make_shared<cIntGenZoom           <8>> (a_Seed + 5,
+		std::make_shared<cIntGenRareBiomeGroups<6>> (a_Seed + 5, 50,
+		std::make_shared<cIntGenBiomeGroupEdges<6>> (
+		std::make_shared<cIntGenAddIslands     <8>> (a_Seed + 2000, 200,
+		std::make_shared<cIntGenZoom           <8>> (a_Seed + 7,
+		std::make_shared<cIntGenSetRandomly    <6>> (a_Seed + 8, 50, bgOcean,
+		std::make_shared<cIntGenReplaceRandomly<6>> (a_Seed + 101, bgIce, bgTemperate, 150,
+		std::make_shared<cIntGenAddIslands     <6>> (a_Seed + 2000, 200,
+		std::make_shared<cIntGenSetRandomly    <6>> (a_Seed + 9, 50, bgOcean,
+		std::make_shared<cIntGenZoom           <6>> (a_Seed + 10,
+		std::make_shared<cIntGenLandOcean      <5>> (a_Seed + 100, 30
+	)))))))))))))))))))))))))))))));
+
+	m_Gen =
+		std::make_shared<cIntGenSmooth   <16>>(a_Seed,
+		std::make_shared<cIntGenZoom     <18>>(a_Seed,
+		std::make_shared<cIntGenSmooth   <11>>(a_Seed,
+		std::make_shared<cIntGenZoom     <13>>(a_Seed,
+		std::make_shared<cIntGenMixRivers<8>> (
+		FinalBiomes, FinalRivers
+	)))));
+}
 
-		auto alteration =
-			std::make_shared<cIntGenZoom     <8>>(a_Seed,
-			std::make_shared<cIntGenLandOcean<6>>(a_Seed, 20
-		));
 
-		auto alteration2 =
-			std::make_shared<cIntGenZoom     <8>>(a_Seed + 1,
-			std::make_shared<cIntGenZoom     <6>>(a_Seed + 2,
-			std::make_shared<cIntGenZoom     <5>>(a_Seed + 1,
-			std::make_shared<cIntGenZoom     <4>>(a_Seed + 2,
-			std::make_shared<cIntGenLandOcean<4>>(a_Seed + 1, 10
-		)))));
 
-		auto FinalBiomes =
-			std::make_shared<cIntGenSmooth         <8>> (a_Seed + 1,
-			std::make_shared<cIntGenZoom           <10>>(a_Seed + 15,
-			std::make_shared<cIntGenSmooth         <7>> (a_Seed + 1,
-			std::make_shared<cIntGenZoom           <9>> (a_Seed + 16,
-			std::make_shared<cIntGenBeaches        <6>> (
-			std::make_shared<cIntGenZoom           <8>> (a_Seed + 1,
-			std::make_shared<cIntGenAddIslands     <6>> (a_Seed + 2004, 10,
-			std::make_shared<cIntGenAddToOcean     <6>> (a_Seed + 10, 500, biDeepOcean,
-			std::make_shared<cIntGenReplaceRandomly<8>> (a_Seed + 1, biPlains, biSunflowerPlains, 20,
-			std::make_shared<cIntGenMBiomes        <8>> (a_Seed + 5, alteration2,
-			std::make_shared<cIntGenAlternateBiomes<8>> (a_Seed + 1, alteration,
-			std::make_shared<cIntGenBiomeEdges     <8>> (a_Seed + 3,
-			std::make_shared<cIntGenZoom           <10>>(a_Seed + 2,
-			std::make_shared<cIntGenZoom           <7>> (a_Seed + 4,
-			std::make_shared<cIntGenReplaceRandomly<5>> (a_Seed + 99, biIcePlains, biIcePlainsSpikes, 50,
-			std::make_shared<cIntGenZoom           <5>> (a_Seed + 8,
-			std::make_shared<cIntGenAddToOcean     <4>> (a_Seed + 10, 300, biDeepOcean,
-			std::make_shared<cIntGenAddToOcean     <6>> (a_Seed + 9, 8, biMushroomIsland,
-			std::make_shared<cIntGenBiomes         <8>> (a_Seed + 3000,
-			std::make_shared<cIntGenAddIslands     <8>> (a_Seed + 2000, 200,
-			std::make_shared<cIntGenZoom           <8>> (a_Seed + 5,
-			std::make_shared<cIntGenRareBiomeGroups<6>> (a_Seed + 5, 50,
-			std::make_shared<cIntGenBiomeGroupEdges<6>> (
-			std::make_shared<cIntGenAddIslands     <8>> (a_Seed + 2000, 200,
-			std::make_shared<cIntGenZoom           <8>> (a_Seed + 7,
-			std::make_shared<cIntGenSetRandomly    <6>> (a_Seed + 8, 50, bgOcean,
-			std::make_shared<cIntGenReplaceRandomly<6>> (a_Seed + 101, bgIce, bgTemperate, 150,
-			std::make_shared<cIntGenAddIslands     <6>> (a_Seed + 2000, 200,
-			std::make_shared<cIntGenSetRandomly    <6>> (a_Seed + 9, 50, bgOcean,
-			std::make_shared<cIntGenZoom           <6>> (a_Seed + 10,
-			std::make_shared<cIntGenLandOcean      <5>> (a_Seed + 100, 30
-		)))))))))))))))))))))))))))))));
 
-		m_Gen =
-			std::make_shared<cIntGenSmooth   <16>>(a_Seed,
-			std::make_shared<cIntGenZoom     <18>>(a_Seed,
-			std::make_shared<cIntGenSmooth   <11>>(a_Seed,
-			std::make_shared<cIntGenZoom     <13>>(a_Seed,
-			std::make_shared<cIntGenMixRivers<8>> (
-			FinalBiomes, FinalRivers
-		)))));
-	}
 
-	virtual void GenBiomes(int a_ChunkX, int a_ChunkZ, cChunkDef::BiomeMap & a_Biomes) override
+void cBioGenGrown::GenBiomes(int a_ChunkX, int a_ChunkZ, cChunkDef::BiomeMap & a_Biomes)
+{
+	cIntGen<16, 16>::Values vals;
+	m_Gen->GetInts(a_ChunkX * cChunkDef::Width, a_ChunkZ * cChunkDef::Width, vals);
+	for (int z = 0; z < cChunkDef::Width; z++)
 	{
-		cIntGen<16, 16>::Values vals;
-		m_Gen->GetInts(a_ChunkX * cChunkDef::Width, a_ChunkZ * cChunkDef::Width, vals);
-		for (int z = 0; z < cChunkDef::Width; z++)
+		for (int x = 0; x < cChunkDef::Width; x++)
 		{
-			for (int x = 0; x < cChunkDef::Width; x++)
-			{
-				cChunkDef::SetBiome(a_Biomes, x, z, (EMCSBiome)vals[x + cChunkDef::Width * z]);
-			}
+			cChunkDef::SetBiome(a_Biomes, x, z, (EMCSBiome)vals[x + cChunkDef::Width * z]);
 		}
 	}
-
-protected:
-	std::shared_ptr<cIntGen<16, 16>> m_Gen;
-};
+}
 
 
 
@@ -22,6 +22,13 @@ Interfaces to the various biome generators:
 
 
 
+// fwd: IntGen.h
+template <int SizeX, int SizeZ> class cIntGen;
+
+
+
+
+
 class cBioGenConstant :
 	public cBiomeGen
 {
@@ -317,3 +324,23 @@ protected:
 
 
 
+
+/** The biome generator that grows the biomes from a small-scale land / ocean map through a chain of cIntGen zooms
+and filters, in a way similar to the vanilla generator. */
+class cBioGenGrown:
+	public cBiomeGen
+{
+public:
+	cBioGenGrown(int a_Seed);
+
+	// cBiomeGen overrides:
+	virtual void GenBiomes(int a_ChunkX, int a_ChunkZ, cChunkDef::BiomeMap & a_Biomes) override;
+
+protected:
+	/** The final generator in the chain, producing the biomes for the whole chunk. */
+	std::shared_ptr<cIntGen<16, 16>> m_Gen;
+};
+
+
+
+
@@ -42,6 +42,17 @@ const int MAX_RADIUS = 8;
 
 
 
+/** Returns the largest distance from the center along one axis that can still be within sqrt(a_SqDist) of it.
+Used for clipping the carving loops to the sphere being carved. */
+static inline int SqDistToSpan(int a_SqDist)
+{
+	return static_cast<int>(ceilf(sqrtf(static_cast<float>(a_SqDist))));
+}
+
+
+
+
+
 struct cCaveDefPoint
 {
 	int m_BlockX;
@@ -475,6 +486,7 @@ void cCaveTunnel::ProcessChunk(
 	int BlockStartZ = a_ChunkZ * cChunkDef::Width;
 	int BlockEndX = BlockStartX + cChunkDef::Width;
 	int BlockEndZ = BlockStartZ + cChunkDef::Width;
+	const bool * CanBeTerraformed = cBlockInfo::GetCanBeTerraformedTable();
 	for (cCaveDefPoints::const_iterator itr = m_Points.begin(), end = m_Points.end(); itr != end; ++itr)
 	{
 		if (
@@ -493,38 +505,63 @@ void cCaveTunnel::ProcessChunk(
 		int DifY = itr->m_BlockY;
 		int DifZ = itr->m_BlockZ - BlockStartZ;  // substitution for faster calc
 		int Bottom = std::max(itr->m_BlockY - 3 * itr->m_Radius / 7, 1);
-		int Top    = std::min(itr->m_BlockY + 3 * itr->m_Radius / 7, (int)(cChunkDef::Height));
+		int Top    = std::min(itr->m_BlockY + 3 * itr->m_Radius / 7, cChunkDef::Height - 1);
 		int SqRad  = itr->m_Radius * itr->m_Radius;
-		for (int z = 0; z < cChunkDef::Width; z++) for (int x = 0; x < cChunkDef::Width; x++)
+
+		// Nothing further than sqrt(2 * SqRad) is touched, clip the rows, their spans and the columns to that:
+		int MaxSqDist = 2 * SqRad;
+		int SpanZ = SqDistToSpan(MaxSqDist);
+		int MinZ = std::max(DifZ - SpanZ, 0);
+		int MaxZ = std::min(DifZ + SpanZ, cChunkDef::Width - 1);
+		for (int z = MinZ; z <= MaxZ; z++)
 		{
-			for (int y = Bottom; y <= Top; y++)
+			int SqDistZ = (DifZ - z) * (DifZ - z);
+			if (SqDistZ > MaxSqDist)
 			{
-				int SqDist = (DifX - x) * (DifX - x) + (DifY - y) * (DifY - y) + (DifZ - z) * (DifZ - z);
-				if (4 * SqDist <= SqRad)
+				continue;
+			}
+			int SpanX = SqDistToSpan(MaxSqDist - SqDistZ);
+			int MinX = std::max(DifX - SpanX, 0);
+			int MaxX = std::min(DifX + SpanX, cChunkDef::Width - 1);
+			for (int x = MinX; x <= MaxX; x++)
+			{
+				int SqDistXZ = SqDistZ + (DifX - x) * (DifX - x);
+				if (SqDistXZ > MaxSqDist)
 				{
-					if (cBlockInfo::CanBeTerraformed(cChunkDef::GetBlock(a_BlockTypes, x, y, z)))
-					{
-						cChunkDef::SetBlock(a_BlockTypes, x, y, z, E_BLOCK_AIR);
-					}
+					continue;
 				}
-				else if (SqDist <= SqRad * 2)
+				int SpanY = SqDistToSpan(MaxSqDist - SqDistXZ);
+				int MinY = std::max(DifY - SpanY, Bottom);
+				int MaxY = std::min(DifY + SpanY, Top);
+				for (int y = MinY; y <= MaxY; y++)
 				{
-					if (cChunkDef::GetBlock(a_BlockTypes, x, y, z) == E_BLOCK_SAND)
+					int SqDist = SqDistXZ + (DifY - y) * (DifY - y);
+					int Index = cChunkDef::MakeIndexNoCheck(x, y, z);
+					if (4 * SqDist <= SqRad)
 					{
-						int Index = cChunkDef::MakeIndexNoCheck(x, y, z);
-						if (a_BlockMetas[Index] == 1)
+						if (CanBeTerraformed[a_BlockTypes[Index]])
 						{
-							a_BlockMetas[Index] = 0;
-							cChunkDef::SetBlock(a_BlockTypes, x, y, z, E_BLOCK_RED_SANDSTONE);
+							a_BlockTypes[Index] = E_BLOCK_AIR;
 						}
-						else
+					}
+					else if (SqDist <= MaxSqDist)
+					{
+						if (a_BlockTypes[Index] == E_BLOCK_SAND)
 						{
-							cChunkDef::SetBlock(a_BlockTypes, x, y, z, E_BLOCK_SANDSTONE);
+							if (a_BlockMetas[Index] == 1)
+							{
+								a_BlockMetas[Index] = 0;
+								a_BlockTypes[Index] = E_BLOCK_RED_SANDSTONE;
+							}
+							else
+							{
+								a_BlockTypes[Index] = E_BLOCK_SANDSTONE;
+							}
 						}
 					}
-				}
-			}  // for y
-		}  // for x, z
+				}  // for y
+			}  // for x
+		}  // for z
 	}  // for itr - m_Points[]
 
 	/*
@@ -5,6 +5,7 @@
 #include "../IniFile.h"
 #include "ChunkDesc.h"
 #include "ComposableGenerator.h"
+#include "FusedComposableGenerator.h"
 #include "Noise3DGenerator.h"
 #include "FastRandom.h"
 
@@ -18,6 +19,9 @@ const unsigned int QUEUE_WARNING_LIMIT = 1000;
 /// If the generation queue size exceeds this number, chunks with no clients will be skipped
 const unsigned int QUEUE_SKIP_LIMIT = 500;
 
+/// The default number of chunks whose biome map is kept in the output cache
+const int DEFAULT_OUTPUT_CACHE_SIZE = 256;
+
 
 
 
@@ -29,6 +33,7 @@ cChunkGenerator::cChunkGenerator(void) :
 	super("cChunkGenerator"),
 	m_Seed(0),  // Will be overwritten by the actual generator
 	m_Generator(nullptr),
+	m_QueryGenerator(nullptr),
 	m_PluginInterface(nullptr),
 	m_ChunkSink(nullptr)
 {
@@ -67,27 +72,35 @@ bool cChunkGenerator::Start(cPluginInterface & a_PluginInterface, cChunkSink & a
 	
 	// Get the generator engine based on the INI file settings:
 	AString GeneratorName = a_IniFile.GetValueSet("Generator", "Generator", "Composable");
-	if (NoCaseCompare(GeneratorName, "Noise3D") == 0)
+	if (
+		(NoCaseCompare(GeneratorName, "Noise3D") != 0) &&
+		(NoCaseCompare(GeneratorName, "composable") != 0) &&
+		(NoCaseCompare(GeneratorName, "Fused") != 0)
+	)
 	{
-		m_Generator = new cNoise3DGenerator(*this);
+		LOGWARN("[Generator]::Generator value \"%s\" not recognized, using \"Composable\".", GeneratorName.c_str());
 	}
-	else
+	m_Generator = CreateGenerator(GeneratorName, a_IniFile);
+	m_QueryGenerator = CreateGenerator(GeneratorName, a_IniFile);
+
+	// Prepare the output cache:
+	int OutputCacheSize = a_IniFile.GetValueSetI("Generator", "OutputCacheSize", DEFAULT_OUTPUT_CACHE_SIZE);
+	if (OutputCacheSize < 0)
 	{
-		if (NoCaseCompare(GeneratorName, "composable") != 0)
-		{
-			LOGWARN("[Generator]::Generator value \"%s\" not recognized, using \"Composable\".", GeneratorName.c_str());
-		}
-		m_Generator = new cComposableGenerator(*this);
+		OutputCacheSize = 0;
 	}
-
-	if (m_Generator == nullptr)
 	{
-		LOGERROR("Generator could not start, aborting the server");
-		return false;
+		cCSLock Lock(m_CSOutputCache);
+		m_OutputCache.resize(static_cast<size_t>(OutputCacheSize));
+		m_OutputCacheOrder.resize(static_cast<size_t>(OutputCacheSize));
+		for (size_t i = 0; i < m_OutputCache.size(); i++)
+		{
+			m_OutputCache[i].m_ChunkX = 0x7fffffff;
+			m_OutputCache[i].m_ChunkZ = 0x7fffffff;
+			m_OutputCacheOrder[i] = i;
+		}
 	}
 
-	m_Generator->Initialize(a_IniFile);
-
 	return super::Start();
 }
 
@@ -104,6 +117,10 @@ void cChunkGenerator::Stop(void)
 
 	delete m_Generator;
 	m_Generator = nullptr;
+
+	cCSLock Lock(m_CSQueryGenerator);
+	delete m_QueryGenerator;
+	m_QueryGenerator = nullptr;
 }
 
 
@@ -134,9 +151,33 @@ void cChunkGenerator::QueueGenerateChunk(int a_ChunkX, int a_ChunkZ, bool a_Forc
 
 void cChunkGenerator::GenerateBiomes(int a_ChunkX, int a_ChunkZ, cChunkDef::BiomeMap & a_BiomeMap)
 {
-	if (m_Generator != nullptr)
 	{
-		m_Generator->GenerateBiomes(a_ChunkX, a_ChunkZ, a_BiomeMap);
+		cCSLock Lock(m_CSOutputCache);
+		const sCachedOutput * Cached = FindInOutputCache(a_ChunkX, a_ChunkZ);
+		if (Cached != nullptr)
+		{
+			memcpy(a_BiomeMap, Cached->m_BiomeMap, sizeof(a_BiomeMap));
+			return;
+		}
+	}
+	
+	cCSLock Lock(m_CSQueryGenerator);
+	if (m_QueryGenerator != nullptr)
+	{
+		m_QueryGenerator->GenerateBiomes(a_ChunkX, a_ChunkZ, a_BiomeMap);
+	}
+}
+
+
+
+
+
+void cChunkGenerator::GenerateHeightMap(int a_ChunkX, int a_ChunkZ, cChunkDef::HeightMap & a_HeightMap)
+{
+	cCSLock Lock(m_CSQueryGenerator);
+	if (m_QueryGenerator != nullptr)
+	{
+		m_QueryGenerator->GenerateHeightMap(a_ChunkX, a_ChunkZ, a_HeightMap);
 	}
 }
 
@@ -170,8 +211,49 @@ int cChunkGenerator::GetQueueLength(void)
 
 EMCSBiome cChunkGenerator::GetBiomeAt(int a_BlockX, int a_BlockZ)
 {
-	ASSERT(m_Generator != nullptr);
-	return m_Generator->GetBiomeAt(a_BlockX, a_BlockZ);
+	int ChunkX, ChunkZ, X = a_BlockX, Y = 0, Z = a_BlockZ;
+	cChunkDef::AbsoluteToRelative(X, Y, Z, ChunkX, ChunkZ);
+	{
+		cCSLock Lock(m_CSOutputCache);
+		const sCachedOutput * Cached = FindInOutputCache(ChunkX, ChunkZ);
+		if (Cached != nullptr)
+		{
+			return cChunkDef::GetBiome(Cached->m_BiomeMap, X, Z);
+		}
+	}
+	
+	cCSLock Lock(m_CSQueryGenerator);
+	ASSERT(m_QueryGenerator != nullptr);
+	return m_QueryGenerator->GetBiomeAt(a_BlockX, a_BlockZ);
+}
+
+
+
+
+
+int cChunkGenerator::GetHeightAt(int a_BlockX, int a_BlockZ)
+{
+	int ChunkX, ChunkZ, X = a_BlockX, Y = 0, Z = a_BlockZ;
+	cChunkDef::AbsoluteToRelative(X, Y, Z, ChunkX, ChunkZ);
+	cChunkDef::HeightMap HeightMap;
+	GenerateHeightMap(ChunkX, ChunkZ, HeightMap);
+	return cChunkDef::GetHeight(HeightMap, X, Z);
+}
+
+
+
+
+
+bool cChunkGenerator::GetCachedOutput(int a_ChunkX, int a_ChunkZ, cChunkDef::BiomeMap & a_BiomeMap)
+{
+	cCSLock Lock(m_CSOutputCache);
+	const sCachedOutput * Cached = FindInOutputCache(a_ChunkX, a_ChunkZ);
+	if (Cached == nullptr)
+	{
+		return false;
+	}
+	memcpy(a_BiomeMap, Cached->m_BiomeMap, sizeof(a_BiomeMap));
+	return true;
 }
 
 
@@ -284,6 +366,29 @@ void cChunkGenerator::Execute(void)
 
 
 
+cChunkGenerator::cGenerator * cChunkGenerator::CreateGenerator(const AString & a_GeneratorName, cIniFile & a_IniFile)
+{
+	cGenerator * Generator;
+	if (NoCaseCompare(a_GeneratorName, "Noise3D") == 0)
+	{
+		Generator = new cNoise3DGenerator(*this);
+	}
+	else if (NoCaseCompare(a_GeneratorName, "Fused") == 0)
+	{
+		Generator = CreateFusedComposableGenerator(*this, a_IniFile);
+	}
+	else
+	{
+		Generator = new cComposableGenerator(*this);
+	}
+	Generator->Initialize(a_IniFile);
+	return Generator;
+}
+
+
+
+
+
 void cChunkGenerator::DoGenerate(int a_ChunkX, int a_ChunkZ)
 {
 	ASSERT(m_PluginInterface != nullptr);
@@ -300,6 +405,7 @@ void cChunkGenerator::DoGenerate(int a_ChunkX, int a_ChunkZ)
 	ChunkDesc.VerifyHeightmap();
 	#endif
 
+	AddToOutputCache(ChunkDesc);
 	m_ChunkSink->OnChunkGenerated(ChunkDesc);
 }
 
@@ -307,6 +413,63 @@ void cChunkGenerator::DoGenerate(int a_ChunkX, int a_ChunkZ)
 
 
 
+void cChunkGenerator::AddToOutputCache(cChunkDesc & a_ChunkDesc)
+{
+	cCSLock Lock(m_CSOutputCache);
+	if (m_OutputCache.empty())
+	{
+		// The cache has been disabled in the INI file
+		return;
+	}
+	
+	// If the chunk is already cached (regenerating), overwrite it; otherwise overwrite the least recently used item:
+	const sCachedOutput * Cached = FindInOutputCache(a_ChunkDesc.GetChunkX(), a_ChunkDesc.GetChunkZ());
+	if (Cached == nullptr)
+	{
+		size_t Idx = m_OutputCacheOrder.back();
+		for (size_t i = m_OutputCacheOrder.size() - 1; i > 0; i--)
+		{
+			m_OutputCacheOrder[i] = m_OutputCacheOrder[i - 1];
+		}
+		m_OutputCacheOrder[0] = Idx;
+	}
+	sCachedOutput & Item = m_OutputCache[m_OutputCacheOrder[0]];
+	Item.m_ChunkX = a_ChunkDesc.GetChunkX();
+	Item.m_ChunkZ = a_ChunkDesc.GetChunkZ();
+	memcpy(Item.m_BiomeMap, a_ChunkDesc.GetBiomeMap(), sizeof(Item.m_BiomeMap));
+}
+
+
+
+
+
+const cChunkGenerator::sCachedOutput * cChunkGenerator::FindInOutputCache(int a_ChunkX, int a_ChunkZ)
+{
+	ASSERT(m_CSOutputCache.IsLockedByCurrentThread());
+	
+	for (size_t i = 0; i < m_OutputCacheOrder.size(); i++)
+	{
+		size_t Idx = m_OutputCacheOrder[i];
+		if ((m_OutputCache[Idx].m_ChunkX != a_ChunkX) || (m_OutputCache[Idx].m_ChunkZ != a_ChunkZ))
+		{
+			continue;
+		}
+		
+		// Found it, move to front:
+		for (size_t j = i; j > 0; j--)
+		{
+			m_OutputCacheOrder[j] = m_OutputCacheOrder[j - 1];
+		}
+		m_OutputCacheOrder[0] = Idx;
+		return &m_OutputCache[Idx];
+	}
+	return nullptr;
+}
+
+
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // cChunkGenerator::cGenerator:
 
@@ -341,3 +504,14 @@ EMCSBiome cChunkGenerator::cGenerator::GetBiomeAt(int a_BlockX, int a_BlockZ)
 
 
 
+
+void cChunkGenerator::cGenerator::GenerateHeightMap(int a_ChunkX, int a_ChunkZ, cChunkDef::HeightMap & a_HeightMap)
+{
+	cChunkDesc ChunkDesc(a_ChunkX, a_ChunkZ);
+	DoGenerate(a_ChunkX, a_ChunkZ, ChunkDesc);
+	memcpy(a_HeightMap, ChunkDesc.GetHeightMap(), sizeof(a_HeightMap));
+}
+
+
+
+
@@ -55,6 +55,9 @@ public:
 		/// Returns the biome at the specified coords. Used by ChunkMap if an invalid chunk is queried for biome. Default implementation uses GenerateBiomes().
 		virtual EMCSBiome GetBiomeAt(int a_BlockX, int a_BlockZ);
 
+		/// Generates the heightmap for the specified chunk (directly, not in a separate thread). Default implementation generates the whole chunk using DoGenerate().
+		virtual void GenerateHeightMap(int a_ChunkX, int a_ChunkZ, cChunkDef::HeightMap & a_HeightMap);
+
 		/// Called in a separate thread to do the actual chunk generation. Generator should generate into a_ChunkDesc.
 		virtual void DoGenerate(int a_ChunkX, int a_ChunkZ, cChunkDesc & a_ChunkDesc) = 0;
 		
@@ -126,9 +129,15 @@ public:
 	If the generator becomes overloaded and skips this chunk, the callback is still called. */
 	void QueueGenerateChunk(int a_ChunkX, int a_ChunkZ, bool a_ForceGenerate, cChunkCoordCallback * a_Callback = nullptr);
 	
-	/// Generates the biomes for the specified chunk (directly, not in a separate thread). Used by the world loader if biomes failed loading.
+	/** Generates the biomes for the specified chunk (directly, not in a separate thread). Used by the world loader if biomes failed loading.
+	Uses the cached generator output, if available. */
 	void GenerateBiomes(int a_ChunkX, int a_ChunkZ, cChunkDef::BiomeMap & a_BiomeMap);
 	
+	/** Generates the terrain heightmap for the specified chunk (directly, not in a separate thread), without generating the whole chunk if possible.
+	The heights are those of the generated terrain, before the finishers (trees, structures) and the plugins' changes. They don't come from
+	the output cache, so that they are the same whether the chunk has been generated recently or not. */
+	void GenerateHeightMap(int a_ChunkX, int a_ChunkZ, cChunkDef::HeightMap & a_HeightMap);
+	
 	void WaitForQueueEmpty(void);
 	
 	int GetQueueLength(void);
@@ -138,6 +147,13 @@ public:
 	/** Returns the biome at the specified coords. Used by ChunkMap if an invalid chunk is queried for biome */
 	EMCSBiome GetBiomeAt(int a_BlockX, int a_BlockZ);
 
+	/** Returns the terrain height at the specified coords, see GenerateHeightMap(). Used by ChunkMap if an invalid chunk is queried for height */
+	int GetHeightAt(int a_BlockX, int a_BlockZ);
+
+	/** Retrieves the biome map of the specified chunk, as last output by the generator (including the plugins' changes).
+	Returns false if the chunk is not in the output cache. */
+	bool GetCachedOutput(int a_ChunkX, int a_ChunkZ, cChunkDef::BiomeMap & a_BiomeMap);
+
 	/** Reads a block type from the ini file; returns the blocktype on success, emits a warning and returns a_Default's representation on failure. */
 	static BLOCKTYPE GetIniBlock(cIniFile & a_IniFile, const AString & a_SectionName, const AString & a_ValueName, const AString & a_Default);
 	
@@ -157,6 +173,15 @@ private:
 
 	typedef std::list<cQueueItem> cGenQueue;
 
+	/** The biome map of a single generated chunk, kept in the output cache */
+	struct sCachedOutput
+	{
+		int m_ChunkX, m_ChunkZ;
+		cChunkDef::BiomeMap m_BiomeMap;
+	};
+
+	typedef std::vector<sCachedOutput> sCachedOutputs;
+
 
 	/** Seed used for the generator. */
 	int m_Seed;
@@ -173,21 +198,49 @@ private:
 	/** Set when an item is removed from the queue. */
 	cEvent m_evtRemoved;
 	
-	/** The actual generator engine used to generate chunks. */
+	/** The actual generator engine used to generate chunks. Used only by the generator thread. */
 	cGenerator * m_Generator;
+
+	/** A separate instance of the generator engine, answering the biome and height queries for unloaded chunks
+	from the caller's thread (world tick, plugins, storage). The generator's internal caches aren't thread-safe,
+	having a separate instance lets the queries run without waiting for the chunk being generated. */
+	cGenerator * m_QueryGenerator;
+
+	/** CS serializing the access to m_QueryGenerator, the queries may come from several threads. */
+	cCriticalSection m_CSQueryGenerator;
 	
 	/** The plugin interface that may modify the generated chunks */
 	cPluginInterface * m_PluginInterface;
 	
 	/** The destination where the generated chunks are sent */
 	cChunkSink * m_ChunkSink;
+
+	/** CS protecting the output cache (m_OutputCache and m_OutputCacheOrder). */
+	cCriticalSection m_CSOutputCache;
+
+	/** The biome maps of the most recently generated chunks.
+	Lets the biome queries for unloaded chunks skip the generator. */
+	sCachedOutputs m_OutputCache;
+
+	/** MRU-ized order of the items in m_OutputCache, indices into m_OutputCache; m_OutputCache[m_OutputCacheOrder[0]] is the most recently used. */
+	std::vector<size_t> m_OutputCacheOrder;
 	
 
 	// cIsThread override:
 	virtual void Execute(void) override;
 
+	/** Creates and initializes the generator engine of the specified name. */
+	cGenerator * CreateGenerator(const AString & a_GeneratorName, cIniFile & a_IniFile);
+
 	/** Generates the specified chunk and sets it into the chunksink. */
 	void DoGenerate(int a_ChunkX, int a_ChunkZ);
+
+	/** Stores the biome map of the generated chunk in the output cache, replacing the least recently used item. */
+	void AddToOutputCache(cChunkDesc & a_ChunkDesc);
+
+	/** Returns the output cache item for the specified chunk and makes it the most recently used one.
+	Returns nullptr if not cached. The caller must hold m_CSOutputCache. */
+	const sCachedOutput * FindInOutputCache(int a_ChunkX, int a_ChunkZ);
 };
 
 
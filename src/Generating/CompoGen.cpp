@@ -382,6 +382,31 @@ void cCompoGenCache::ComposeTerrain(cChunkDesc & a_ChunkDesc, const cChunkDesc::
 	}
 	#endif  // _DEBUG
 	
+	if (ComposeFromCache(a_ChunkDesc))
+	{
+		return;
+	}
+	
+	// Not in the cache:
+	ComposeUncached(a_ChunkDesc, a_Shape);
+}
+
+
+
+
+
+void cCompoGenCache::ComposeUncached(cChunkDesc & a_ChunkDesc, const cChunkDesc::Shape & a_Shape)
+{
+	m_Underlying->ComposeTerrain(a_ChunkDesc, a_Shape);
+	AddToCache(a_ChunkDesc);
+}
+
+
+
+
+
+bool cCompoGenCache::ComposeFromCache(cChunkDesc & a_ChunkDesc)
+{
 	int ChunkX = a_ChunkDesc.GetChunkX();
 	int ChunkZ = a_ChunkDesc.GetChunkZ();
 	
@@ -411,13 +436,19 @@ void cCompoGenCache::ComposeTerrain(cChunkDesc & a_ChunkDesc, const cChunkDesc::
 		
 		m_NumHits++;
 		m_TotalChain += i;
-		return;
+		return true;
 	}  // for i - cache
 	
-	// Not in the cache:
 	m_NumMisses++;
-	m_Underlying->ComposeTerrain(a_ChunkDesc, a_Shape);
-	
+	return false;
+}
+
+
+
+
+
+void cCompoGenCache::AddToCache(cChunkDesc & a_ChunkDesc)
+{
 	// Insert it as the first item in the MRU order:
 	int Idx = m_CacheOrder[m_CacheSize - 1];
 	for (int i = m_CacheSize - 1; i > 0; i--)
@@ -428,8 +459,8 @@ void cCompoGenCache::ComposeTerrain(cChunkDesc & a_ChunkDesc, const cChunkDesc::
 	memcpy(m_CacheData[Idx].m_BlockTypes, a_ChunkDesc.GetBlockTypes(),             sizeof(a_ChunkDesc.GetBlockTypes()));
 	memcpy(m_CacheData[Idx].m_BlockMetas, a_ChunkDesc.GetBlockMetasUncompressed(), sizeof(a_ChunkDesc.GetBlockMetasUncompressed()));
 	memcpy(m_CacheData[Idx].m_HeightMap,  a_ChunkDesc.GetHeightMap(),              sizeof(a_ChunkDesc.GetHeightMap()));
-	m_CacheData[Idx].m_ChunkX = ChunkX;
-	m_CacheData[Idx].m_ChunkZ = ChunkZ;
+	m_CacheData[Idx].m_ChunkX = a_ChunkDesc.GetChunkX();
+	m_CacheData[Idx].m_ChunkZ = a_ChunkDesc.GetChunkZ();
 }
 
 
@@ -122,6 +122,14 @@ public:
 	virtual void ComposeTerrain(cChunkDesc & a_ChunkDesc, const cChunkDesc::Shape & a_Shape) override;
 	virtual void InitializeCompoGen(cIniFile & a_IniFile) override;
 	
+	/** If the chunk's composition is cached, copies it (blocktypes, metas and heightmap) into a_ChunkDesc and returns true.
+	Returns false if the chunk is not in the cache, a_ChunkDesc is left untouched then. */
+	bool ComposeFromCache(cChunkDesc & a_ChunkDesc);
+	
+	/** Composes the terrain using the underlying generator and stores it into the cache.
+	Used by callers that have already found out, using ComposeFromCache(), that the chunk is not cached. */
+	void ComposeUncached(cChunkDesc & a_ChunkDesc, const cChunkDesc::Shape & a_Shape);
+	
 protected:
 
 	cTerrainCompositionGenPtr m_Underlying;
@@ -140,6 +148,9 @@ protected:
 	int *        m_CacheOrder;  // MRU-ized order, indices into m_CacheData array
 	sCacheData * m_CacheData;   // m_CacheData[m_CacheOrder[0]] is the most recently used
 	
+	/** Stores the composition in a_ChunkDesc into the cache, as the most recently used item. */
+	void AddToCache(cChunkDesc & a_ChunkDesc);
+	
 	// Cache statistics
 	int m_NumHits;
 	int m_NumMisses;
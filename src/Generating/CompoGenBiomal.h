@@ -1,6 +1,8 @@
 
 // CompoGenBiomal.h
 
+// Declares the cCompoGenBiomal class representing the biome-aware composition generator
+
 
 
 
@@ -8,6 +10,94 @@
 #pragma once
 
 #include "ComposableGenerator.h"
+#include "../Noise/Noise.h"
+
+
+
+
+
+/** This class is used to store a column pattern initialized at runtime,
+so that the program doesn't need to explicitly set 256 values for each pattern
+Each pattern has 256 blocks so that there's no need to check pattern bounds when assigning the
+pattern - there will always be enough pattern left, even for the whole-chunk-height columns. */
+class cPattern
+{
+public:
+	struct BlockInfo
+	{
+		BLOCKTYPE  m_BlockType;
+		NIBBLETYPE m_BlockMeta;
+	};
+
+	cPattern(BlockInfo * a_TopBlocks, size_t a_Count)
+	{
+		// Copy the pattern into the top:
+		for (size_t i = 0; i < a_Count; i++)
+		{
+			m_Pattern[i] = a_TopBlocks[i];
+		}
+		
+		// Fill the rest with stone:
+		static BlockInfo Stone = {E_BLOCK_STONE, 0};
+		for (int i = static_cast<int>(a_Count); i < cChunkDef::Height; i++)
+		{
+			m_Pattern[i] = Stone;
+		}
+	}
+	
+	const BlockInfo * Get(void) const { return m_Pattern; }
+	
+protected:
+	BlockInfo m_Pattern[cChunkDef::Height];
+} ;
+
+
+
+
+
+/** The composition generator that covers the terrain shape with block patterns chosen by the biome in each column
+(grass and dirt, sand, mycelium, mesa clay layers, ...), and fills everything below the sealevel with water. */
+class cCompoGenBiomal :
+	public cTerrainCompositionGen
+{
+public:
+	cCompoGenBiomal(int a_Seed);
+
+	// cTerrainCompositionGen overrides:
+	virtual void ComposeTerrain(cChunkDesc & a_ChunkDesc, const cChunkDesc::Shape & a_Shape) override;
+	virtual void InitializeCompoGen(cIniFile & a_IniFile) override;
+
+protected:
+	/** The block height at which water is generated instead of air. */
+	int m_SeaLevel;
+
+	/** The pattern used for mesa biomes. Initialized by seed on generator creation. */
+	cPattern::BlockInfo m_MesaPattern[2 * cChunkDef::Height];
+	
+	/** Noise used for selecting between dirt and sand on the ocean floor. */
+	cNoise m_OceanFloorSelect;
+
+	/** Noise used for the floor of the clay blocks in mesa biomes. */
+	cNoise m_MesaFloor;
+
+
+	/** Initializes the m_MesaPattern with a pattern based on the generator's seed. */
+	void initMesaPattern(int a_Seed);
+
+	/** Composes a single column in a_ChunkDesc. Chooses what to do based on the biome in that column. */
+	void ComposeColumn(cChunkDesc & a_ChunkDesc, int a_RelX, int a_RelZ, const Byte * a_ShapeColumn);
+
+	/** Fills the specified column with the specified pattern; restarts the pattern when air is reached,
+	switches to ocean floor pattern if ocean is reached. Always adds bedrock at the very bottom. */
+	void FillColumnPattern(cChunkDesc & a_ChunkDesc, int a_RelX, int a_RelZ, const cPattern::BlockInfo * a_Pattern, const Byte * a_ShapeColumn);
+
+	/** Fills the specified column with mesa pattern, based on the column height */
+	void FillColumnMesa(cChunkDesc & a_ChunkDesc, int a_RelX, int a_RelZ, const Byte * a_ShapeColumn);
+
+	/** Returns the pattern to use for an ocean floor in the specified column.
+	The returned pattern is guaranteed to be 256 blocks long. */
+	const cPattern::BlockInfo * ChooseOceanFloorPattern(int a_ChunkX, int a_ChunkZ, int a_RelX, int a_RelZ);
+} ;
 
 
 
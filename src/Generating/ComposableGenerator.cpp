@@ -152,44 +152,81 @@ void cComposableGenerator::GenerateBiomes(int a_ChunkX, int a_ChunkZ, cChunkDef:
 
 
 
-void cComposableGenerator::DoGenerate(int a_ChunkX, int a_ChunkZ, cChunkDesc & a_ChunkDesc)
+void cComposableGenerator::GenerateHeightMap(int a_ChunkX, int a_ChunkZ, cChunkDef::HeightMap & a_HeightMap)
 {
-	if (a_ChunkDesc.IsUsingDefaultBiomes())
+	// Use the composited terrain heights; these don't include the finishers (trees, structures), but don't need the chunk generated.
+	// cChunkGenerator calls this only on its separate query instance, under its lock, so these caches aren't shared with the generator thread:
+	if (m_CompositedHeightCache != nullptr)
 	{
-		m_BiomeGen->GenBiomes(a_ChunkX, a_ChunkZ, a_ChunkDesc.GetBiomeMap());
-	}
-	
-	cChunkDesc::Shape shape;
-	if (a_ChunkDesc.IsUsingDefaultHeight())
-	{
-		m_ShapeGen->GenShape(a_ChunkX, a_ChunkZ, shape);
-		a_ChunkDesc.SetHeightFromShape(shape);
+		m_CompositedHeightCache->GenHeightMap(a_ChunkX, a_ChunkZ, a_HeightMap);
 	}
 	else
 	{
-		// Convert the heightmap in a_ChunkDesc into shape:
-		a_ChunkDesc.GetShapeFromHeight(shape);
+		super::GenerateHeightMap(a_ChunkX, a_ChunkZ, a_HeightMap);
 	}
-	
-	bool ShouldUpdateHeightmap = false;
-	if (a_ChunkDesc.IsUsingDefaultComposition())
+}
+
+
+
+
+
+void cComposableGenerator::DoGenerate(int a_ChunkX, int a_ChunkZ, cChunkDesc & a_ChunkDesc)
+{
+	if (a_ChunkDesc.IsUsingDefaultBiomes())
 	{
-		m_CompositionGen->ComposeTerrain(a_ChunkDesc, shape);
+		m_BiomeGen->GenBiomes(a_ChunkX, a_ChunkZ, a_ChunkDesc.GetBiomeMap());
 	}
-
-	if (a_ChunkDesc.IsUsingDefaultFinish())
+	
+	// The composition of a chunk is often cached already, the finishers of the neighbors ask for its composited heightmap.
+	// The cached composition includes the heightmap, so the shape needn't be generated at all then:
+	bool ShouldQueryCompositionCache = (
+		a_ChunkDesc.IsUsingDefaultHeight() &&
+		a_ChunkDesc.IsUsingDefaultComposition() &&
+		(m_CompositionCache != nullptr)
+	);
+	if (!ShouldQueryCompositionCache || !m_CompositionCache->ComposeFromCache(a_ChunkDesc))
 	{
-		for (cFinishGenList::iterator itr = m_FinishGens.begin(); itr != m_FinishGens.end(); ++itr)
+		cChunkDesc::Shape shape;
+		if (a_ChunkDesc.IsUsingDefaultHeight())
+		{
+			m_ShapeGen->GenShape(a_ChunkX, a_ChunkZ, shape);
+			a_ChunkDesc.SetHeightFromShape(shape);
+		}
+		else
+		{
+			// Convert the heightmap in a_ChunkDesc into shape:
+			a_ChunkDesc.GetShapeFromHeight(shape);
+		}
+		
+		if (ShouldQueryCompositionCache)
+		{
+			// Already known not to be in the cache, don't look it up again:
+			m_CompositionCache->ComposeUncached(a_ChunkDesc, shape);
+		}
+		else if (a_ChunkDesc.IsUsingDefaultComposition())
 		{
-			(*itr)->GenFinish(a_ChunkDesc);
-		}  // for itr - m_FinishGens[]
-		ShouldUpdateHeightmap = true;
+			m_CompositionGen->ComposeTerrain(a_ChunkDesc, shape);
+		}
 	}
 	
-	if (ShouldUpdateHeightmap)
+	GenerateFinish(a_ChunkDesc);
+}
+
+
+
+
+
+void cComposableGenerator::GenerateFinish(cChunkDesc & a_ChunkDesc)
+{
+	if (!a_ChunkDesc.IsUsingDefaultFinish())
 	{
-		a_ChunkDesc.UpdateHeightmap();
+		return;
 	}
+	for (cFinishGenList::iterator itr = m_FinishGens.begin(); itr != m_FinishGens.end(); ++itr)
+	{
+		(*itr)->GenFinish(a_ChunkDesc);
+	}  // for itr - m_FinishGens[]
+	a_ChunkDesc.UpdateHeightmap();
 }
 
 
@@ -200,9 +237,17 @@ void cComposableGenerator::InitBiomeGen(cIniFile & a_IniFile)
 {
 	bool CacheOffByDefault = false;
 	m_BiomeGen = cBiomeGen::CreateBiomeGen(a_IniFile, m_ChunkGenerator.GetSeed(), CacheOffByDefault);
-	
+	AddBiomeGenCache(a_IniFile, CacheOffByDefault);
+}
+
+
+
+
+
+void cComposableGenerator::AddBiomeGenCache(cIniFile & a_IniFile, bool a_CacheOffByDefault)
+{
 	// Add a cache, if requested:
-	int CacheSize = a_IniFile.GetValueSetI("Generator", "BiomeGenCacheSize", CacheOffByDefault ? 0 : 64);
+	int CacheSize = a_IniFile.GetValueSetI("Generator", "BiomeGenCacheSize", a_CacheOffByDefault ? 0 : 64);
 
 	if (CacheSize <= 0)
 	{
@@ -264,13 +309,22 @@ void cComposableGenerator::InitShapeGen(cIniFile & a_IniFile)
 void cComposableGenerator::InitCompositionGen(cIniFile & a_IniFile)
 {
 	m_CompositionGen = cTerrainCompositionGen::CreateCompositionGen(a_IniFile, m_BiomeGen, m_ShapeGen, m_ChunkGenerator.GetSeed());
-	
+	AddCompositionGenCaches(a_IniFile);
+}
+
+
+
+
+
+void cComposableGenerator::AddCompositionGenCaches(cIniFile & a_IniFile)
+{
 	// Add a cache over the composition generator:
 	// Even a cache of size 1 is useful due to the CompositedHeiGen cache after us doing re-composition on its misses
 	int CompoGenCacheSize = a_IniFile.GetValueSetI("Generator", "CompositionGenCacheSize", 64);
 	if (CompoGenCacheSize > 0)
 	{
-		m_CompositionGen = std::make_shared<cCompoGenCache>(m_CompositionGen, CompoGenCacheSize);
+		m_CompositionCache = std::make_shared<cCompoGenCache>(m_CompositionGen, CompoGenCacheSize);
+		m_CompositionGen = m_CompositionCache;
 	}
 
 	// Create a cache of the composited heightmaps, so that finishers may use it:
@@ -30,6 +30,7 @@ class cTerrainShapeGen;
 class cTerrainHeightGen;
 class cTerrainCompositionGen;
 class cFinishGen;
+class cCompoGenCache;
 typedef SharedPtr<cBiomeGen>              cBiomeGenPtr;
 typedef SharedPtr<cTerrainShapeGen>       cTerrainShapeGenPtr;
 typedef SharedPtr<cTerrainHeightGen>      cTerrainHeightGenPtr;
@@ -181,6 +182,7 @@ public:
 	// cChunkGenerator::cGenerator overrides:
 	virtual void Initialize(cIniFile & a_IniFile) override;
 	virtual void GenerateBiomes(int a_ChunkX, int a_ChunkZ, cChunkDef::BiomeMap & a_BiomeMap) override;
+	virtual void GenerateHeightMap(int a_ChunkX, int a_ChunkZ, cChunkDef::HeightMap & a_HeightMap) override;
 	virtual void DoGenerate(int a_ChunkX, int a_ChunkZ, cChunkDesc & a_ChunkDesc) override;
 
 protected:
@@ -194,6 +196,10 @@ protected:
 	/** The terrain composition generator. */
 	cTerrainCompositionGenPtr m_CompositionGen;
 
+	/** The cache wrapped around the composition generator, also held in m_CompositionGen; nullptr if the cache is disabled.
+	DoGenerate() queries it before generating the shape, a cached composition doesn't need the shape. */
+	SharedPtr<cCompoGenCache> m_CompositionCache;
+
 	/** The cache for the heights of the composited terrain. */
 	cTerrainHeightGenPtr m_CompositedHeightCache;
 
@@ -204,14 +210,23 @@ protected:
 	/** Reads the BiomeGen settings from the ini and initializes m_BiomeGen accordingly */
 	void InitBiomeGen(cIniFile & a_IniFile);
 	
+	/** Wraps m_BiomeGen in a cache, if the ini settings ask for one. */
+	void AddBiomeGenCache(cIniFile & a_IniFile, bool a_CacheOffByDefault);
+	
 	/** Reads the ShapeGen settings from the ini and initializes m_ShapeGen accordingly */
 	void InitShapeGen(cIniFile & a_IniFile);
 	
 	/** Reads the CompositionGen settings from the ini and initializes m_CompositionGen accordingly */
 	void InitCompositionGen(cIniFile & a_IniFile);
 	
+	/** Wraps m_CompositionGen in m_CompositionCache, if the ini settings ask for one, and creates m_CompositedHeightCache over it. */
+	void AddCompositionGenCaches(cIniFile & a_IniFile);
+	
 	/** Reads the finishers from the ini and initializes m_FinishGens accordingly */
 	void InitFinishGens(cIniFile & a_IniFile);
+	
+	/** Applies the finishers to the chunk and updates its heightmap, unless a plugin has disabled the default finish. */
+	void GenerateFinish(cChunkDesc & a_ChunkDesc);
 } ;
 
 
@@ -0,0 +1,28 @@
+
+// FusedComposableGenerator.cpp
+
+// Implements the function creating the fused composable generators for the preset named in world.ini
+
+#include "Globals.h"
+#include "FusedComposableGenerator.h"
+#include "../IniFile.h"
+
+
+
+
+
+cChunkGenerator::cGenerator * CreateFusedComposableGenerator(cChunkGenerator & a_ChunkGenerator, cIniFile & a_IniFile)
+{
+	AString PresetName = a_IniFile.GetValueSet("Generator", "FusedPreset", "Overworld");
+
+	if (NoCaseCompare(PresetName, "Overworld") != 0)
+	{
+		LOGWARN("[Generator]::FusedPreset value \"%s\" not recognized, using \"Overworld\".", PresetName.c_str());
+		a_IniFile.SetValue("Generator", "FusedPreset", "Overworld");
+	}
+	return new cFusedComposableGenerator<cFusedPresetOverworld>(a_ChunkGenerator);
+}
+
+
+
+
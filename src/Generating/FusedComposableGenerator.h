@@ -0,0 +1,181 @@
+
+// FusedComposableGenerator.h
+
+// Declares the cFusedComposableGenerator class template representing a composable generator whose biome, shape and
+// composition stages are fixed at compile time, and the presets it is instantiated with
+
+/*
+cComposableGenerator builds its stages by the names given in world.ini and calls each of them through the virtual
+stage interfaces and the caches wrapped around them. A fused generator is instantiated over a preset class that names
+the concrete stage classes instead, so DoGenerate() calls the stages directly (non-virtually) and can take shortcuts
+without going through the stage interfaces:
+	- The shape and composition stages are called directly, not through their virtual interfaces, so the compiler can
+	inline them into the per-chunk loop.
+	- The shape is generated into a buffer owned by the generator, instead of a 64 KiB array on the stack for each chunk.
+Both paths query the composition cache before generating the shape, so a chunk whose composition is already cached
+(because a finisher of a neighbor chunk asked for its heightmap) skips the shape stage either way. The
+GeneratorPerformanceTest tool measures the two paths side by side.
+The stages and caches are still wired together the same way as in cComposableGenerator, and the finishers are still
+read from world.ini, so the structure generators and the heightmap queries work the same with either path.
+
+A preset is a class providing the typedefs cBiomeStage, cShapeStage and cCompositionStage and the static functions
+CreateBiomeGen(), CreateShapeGen() and CreateCompositionGen(). The stage functions called by DoGenerate() must be
+public in the stage classes.
+
+To use a fused generator, set [Generator] Generator=Fused and FusedPreset=<PresetName> in world.ini; the BiomeGen,
+ShapeGen and CompositionGen values are not used then.
+*/
+
+
+
+
+
+#pragma once
+
+#include "ComposableGenerator.h"
+#include "BioGen.h"
+#include "CompoGen.h"
+#include "CompoGenBiomal.h"
+#include "Noise3DGenerator.h"
+
+
+
+
+
+/** The stages of the default overworld, as set into world.ini for new overworld worlds:
+BiomeGen = Grown, ShapeGen = BiomalNoise3D, CompositionGen = Biomal */
+class cFusedPresetOverworld
+{
+public:
+	typedef cBioGenGrown             cBiomeStage;
+	typedef cBiomalNoise3DComposable cShapeStage;
+	typedef cCompoGenBiomal          cCompositionStage;
+
+	static SharedPtr<cBiomeStage> CreateBiomeGen(int a_Seed)
+	{
+		return std::make_shared<cBiomeStage>(a_Seed);
+	}
+
+	static SharedPtr<cShapeStage> CreateShapeGen(int a_Seed, cBiomeGenPtr a_BiomeGen)
+	{
+		return std::make_shared<cShapeStage>(a_Seed, a_BiomeGen);
+	}
+
+	static SharedPtr<cCompositionStage> CreateCompositionGen(int a_Seed)
+	{
+		return std::make_shared<cCompositionStage>(a_Seed);
+	}
+} ;
+
+
+
+
+
+template <class PRESET>
+class cFusedComposableGenerator :
+	public cComposableGenerator
+{
+	typedef cComposableGenerator super;
+
+public:
+	typedef typename PRESET::cBiomeStage       cBiomeStage;
+	typedef typename PRESET::cShapeStage       cShapeStage;
+	typedef typename PRESET::cCompositionStage cCompositionStage;
+
+
+	cFusedComposableGenerator(cChunkGenerator & a_ChunkGenerator) :
+		super(a_ChunkGenerator)
+	{
+	}
+
+
+	// cChunkGenerator::cGenerator overrides:
+	virtual void Initialize(cIniFile & a_IniFile) override
+	{
+		// Bypass cComposableGenerator's ini-driven stage creation, only initialize the generic part:
+		cChunkGenerator::cGenerator::Initialize(a_IniFile);
+
+		int Seed = m_ChunkGenerator.GetSeed();
+		m_BiomeStage = PRESET::CreateBiomeGen(Seed);
+		m_BiomeGen = m_BiomeStage;
+		m_BiomeGen->InitializeBiomeGen(a_IniFile);
+		AddBiomeGenCache(a_IniFile, false);
+
+		// The shape stage queries the biomes around the chunk, let it use the cache:
+		m_ShapeStage = PRESET::CreateShapeGen(Seed, m_BiomeGen);
+		m_ShapeGen = m_ShapeStage;
+		m_ShapeGen->InitializeShapeGen(a_IniFile);
+
+		m_CompositionStage = PRESET::CreateCompositionGen(Seed);
+		m_CompositionGen = m_CompositionStage;
+		m_CompositionGen->InitializeCompoGen(a_IniFile);
+		AddCompositionGenCaches(a_IniFile);
+
+		InitFinishGens(a_IniFile);
+	}
+
+
+	virtual void DoGenerate(int a_ChunkX, int a_ChunkZ, cChunkDesc & a_ChunkDesc) override
+	{
+		if (a_ChunkDesc.IsUsingDefaultBiomes())
+		{
+			// Go through the biome cache, the shape stage asks it for this chunk's biomes again:
+			m_BiomeGen->GenBiomes(a_ChunkX, a_ChunkZ, a_ChunkDesc.GetBiomeMap());
+		}
+
+		// A cached composition includes the heightmap, the shape is not needed then:
+		bool ShouldQueryCompositionCache = (
+			a_ChunkDesc.IsUsingDefaultHeight() &&
+			a_ChunkDesc.IsUsingDefaultComposition() &&
+			(m_CompositionCache != nullptr)
+		);
+		if (!ShouldQueryCompositionCache || !m_CompositionCache->ComposeFromCache(a_ChunkDesc))
+		{
+			if (a_ChunkDesc.IsUsingDefaultHeight())
+			{
+				m_ShapeStage->cShapeStage::GenShape(a_ChunkX, a_ChunkZ, m_Shape);
+				a_ChunkDesc.SetHeightFromShape(m_Shape);
+			}
+			else
+			{
+				a_ChunkDesc.GetShapeFromHeight(m_Shape);
+			}
+
+			if (ShouldQueryCompositionCache)
+			{
+				// Already known not to be in the cache, don't look it up again:
+				m_CompositionCache->ComposeUncached(a_ChunkDesc, m_Shape);
+			}
+			else if (a_ChunkDesc.IsUsingDefaultComposition())
+			{
+				m_CompositionStage->cCompositionStage::ComposeTerrain(a_ChunkDesc, m_Shape);
+			}
+		}
+
+		GenerateFinish(a_ChunkDesc);
+	}
+
+protected:
+	/** The biome stage, without the cache. m_BiomeGen points to the cache over it (if enabled). */
+	SharedPtr<cBiomeStage> m_BiomeStage;
+
+	/** The shape stage, same object as m_ShapeGen. */
+	SharedPtr<cShapeStage> m_ShapeStage;
+
+	/** The composition stage, without the cache. m_CompositionGen points to the cache over it (if enabled). */
+	SharedPtr<cCompositionStage> m_CompositionStage;
+
+	/** The buffer for the generated shape, reused for all chunks. DoGenerate() is only called from the generator thread. */
+	cChunkDesc::Shape m_Shape;
+} ;
+
+
+
+
+
+/** Creates the fused generator for the preset named in the FusedPreset value in world.ini. */
+cChunkGenerator::cGenerator * CreateFusedComposableGenerator(cChunkGenerator & a_ChunkGenerator, cIniFile & a_IniFile);
+
+
+
+
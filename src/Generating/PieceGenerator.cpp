@@ -473,7 +473,7 @@ bool cPieceGenerator::TryPlacePieceAtConnector(
 				// Doesn't support this rotation
 				continue;
 			}
-			if (!CheckConnection(a_Connector, ConnPos, **itrP, *itrC, NumCCWRotations, a_OutPieces))
+			if (!CheckConnection(a_Connector, ConnPos, **itrP, *itrC, NumCCWRotations))
 			{
 				// Doesn't fit in this rotation
 				continue;
@@ -509,6 +509,7 @@ bool cPieceGenerator::TryPlacePieceAtConnector(
 	ConnPos -= NewPos;
 	cPlacedPiece * PlacedPiece = new cPlacedPiece(&a_ParentPiece, *(Conn.m_Piece), ConnPos, Conn.m_NumCCWRotations);
 	a_OutPieces.push_back(PlacedPiece);
+	m_HitBoxGrid.Add(*PlacedPiece);
 	
 	// Add the new piece's connectors to the list of free connectors:
 	cPiece::cConnectors Connectors = Conn.m_Piece->GetConnectors();
@@ -534,21 +535,13 @@ bool cPieceGenerator::CheckConnection(
 	const Vector3i & a_ToPos,
 	const cPiece & a_Piece,
 	const cPiece::cConnector & a_NewConnector,
-	int a_NumCCWRotations,
-	const cPlacedPieces & a_OutPieces
+	int a_NumCCWRotations
 )
 {
-	// For each placed piece, test the hitbox against the new piece:
+	// Test the hitbox against the placed pieces nearby:
 	cCuboid RotatedHitBox = a_Piece.RotateHitBoxToConnector(a_NewConnector, a_ToPos, a_NumCCWRotations);
 	RotatedHitBox.Sort();
-	for (cPlacedPieces::const_iterator itr = a_OutPieces.begin(), end = a_OutPieces.end(); itr != end; ++itr)
-	{
-		if ((*itr)->GetHitBox().DoesIntersect(RotatedHitBox))
-		{
-			return false;
-		}
-	}
-	return true;
+	return !m_HitBoxGrid.DoesIntersect(RotatedHitBox);
 }
 
 
@@ -606,6 +599,68 @@ cPieceGenerator::cFreeConnector::cFreeConnector(cPlacedPiece * a_Piece, const cP
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+// cPieceGenerator::cHitBoxGrid:
+
+void cPieceGenerator::cHitBoxGrid::Clear(void)
+{
+	m_Cells.clear();
+}
+
+
+
+
+
+void cPieceGenerator::cHitBoxGrid::Add(const cPlacedPiece & a_Piece)
+{
+	const cCuboid & HitBox = a_Piece.GetHitBox();
+	ASSERT(HitBox.IsSorted());
+	int MaxCellX = FAST_FLOOR_DIV(HitBox.p2.x, CELL_SIZE);
+	int MaxCellZ = FAST_FLOOR_DIV(HitBox.p2.z, CELL_SIZE);
+	for (int CellZ = FAST_FLOOR_DIV(HitBox.p1.z, CELL_SIZE); CellZ <= MaxCellZ; CellZ++)
+	{
+		for (int CellX = FAST_FLOOR_DIV(HitBox.p1.x, CELL_SIZE); CellX <= MaxCellX; CellX++)
+		{
+			m_Cells[MakeKey(CellX, CellZ)].push_back(&a_Piece);
+		}
+	}
+}
+
+
+
+
+
+bool cPieceGenerator::cHitBoxGrid::DoesIntersect(const cCuboid & a_HitBox) const
+{
+	// Any two intersecting hitboxes share at least one cell; a piece spanning multiple cells may get tested more than once, which is harmless:
+	ASSERT(a_HitBox.IsSorted());
+	int MaxCellX = FAST_FLOOR_DIV(a_HitBox.p2.x, CELL_SIZE);
+	int MaxCellZ = FAST_FLOOR_DIV(a_HitBox.p2.z, CELL_SIZE);
+	for (int CellZ = FAST_FLOOR_DIV(a_HitBox.p1.z, CELL_SIZE); CellZ <= MaxCellZ; CellZ++)
+	{
+		for (int CellX = FAST_FLOOR_DIV(a_HitBox.p1.x, CELL_SIZE); CellX <= MaxCellX; CellX++)
+		{
+			cCells::const_iterator itrCell = m_Cells.find(MakeKey(CellX, CellZ));
+			if (itrCell == m_Cells.end())
+			{
+				continue;
+			}
+			for (cCellPieces::const_iterator itr = itrCell->second.begin(), end = itrCell->second.end(); itr != end; ++itr)
+			{
+				if ((*itr)->GetHitBox().DoesIntersect(a_HitBox))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // cBFSPieceGenerator:
 
@@ -621,10 +676,12 @@ cBFSPieceGenerator::cBFSPieceGenerator(cPiecePool & a_PiecePool, int a_Seed) :
 void cBFSPieceGenerator::PlacePieces(int a_BlockX, int a_BlockY, int a_BlockZ, int a_MaxDepth, cPlacedPieces & a_OutPieces)
 {
 	a_OutPieces.clear();
+	m_HitBoxGrid.Clear();
 	cFreeConnectors ConnectorPool;
 	
 	// Place the starting piece:
 	a_OutPieces.push_back(PlaceStartingPiece(a_BlockX, a_BlockY, a_BlockZ, ConnectorPool));
+	m_HitBoxGrid.Add(*a_OutPieces.back());
 	
 	/*
 	// DEBUG:
@@ -676,6 +733,9 @@ void cBFSPieceGenerator::PlacePieces(int a_BlockX, int a_BlockY, int a_BlockZ, i
 			NumProcessed = 0;
 		}
 	}
+	
+	// The pieces are now owned by the caller, who may move or free them; don't keep pointers to them:
+	m_HitBoxGrid.Clear();
 }
 
 
@@ -21,6 +21,7 @@ Each uses a slightly different approach to generating:
 #include "../Defines.h"
 #include "../Cuboid.h"
 #include "../Noise/Noise.h"
+#include <unordered_map>
 
 
 
@@ -222,11 +223,46 @@ protected:
 		cFreeConnector(cPlacedPiece * a_Piece, const cPiece::cConnector & a_Connector);
 	};
 	typedef std::vector<cFreeConnector> cFreeConnectors;
+	
+	/** Spatial index of the placed pieces' hitboxes, so that testing a new piece doesn't need to go through
+	all the pieces placed so far. The XZ plane is split into square cells, each cell lists the pieces whose
+	hitbox reaches into it. Filled during a single PlacePieces() call. */
+	class cHitBoxGrid
+	{
+	public:
+		/** Removes all the pieces from the grid. */
+		void Clear(void);
+		
+		/** Adds the piece into all the cells that its hitbox reaches. */
+		void Add(const cPlacedPiece & a_Piece);
+		
+		/** Returns true if the specified (sorted) hitbox intersects the hitbox of any piece in the grid. */
+		bool DoesIntersect(const cCuboid & a_HitBox) const;
+		
+	protected:
+		/** Size of a single cell's side, in blocks. */
+		static const int CELL_SIZE = 16;
+		
+		typedef std::vector<const cPlacedPiece *> cCellPieces;
+		typedef std::unordered_map<Int64, cCellPieces> cCells;
+		
+		/** The cells that have at least one piece, mapped by MakeKey() of their coords. */
+		cCells m_Cells;
+		
+		/** Returns the key into m_Cells for the specified cell coords. */
+		static Int64 MakeKey(int a_CellX, int a_CellZ)
+		{
+			return (static_cast<Int64>(a_CellX) << 32) | static_cast<UInt32>(a_CellZ);
+		}
+	};
 
 
 	cPiecePool & m_PiecePool;
 	cNoise m_Noise;
 	int m_Seed;
+	
+	/** The hitboxes of the pieces placed so far in the current PlacePieces() call. */
+	cHitBoxGrid m_HitBoxGrid;
 
 	
 	/** Selects a starting piece and places it, including the rotations.
@@ -237,7 +273,7 @@ protected:
 	bool TryPlacePieceAtConnector(
 		const cPlacedPiece & a_ParentPiece,      // The existing piece to a new piece should be placed
 		const cPiece::cConnector & a_Connector,  // The existing connector (world-coords) to which a new piece should be placed
-		cPlacedPieces & a_OutPieces,             // Already placed pieces, to be checked for intersections
+		cPlacedPieces & a_OutPieces,             // Already placed pieces, the new piece is added here (and into m_HitBoxGrid)
 		cFreeConnectors & a_OutConnectors        // List of free connectors to which the new connectors will be placed
 	);
 
@@ -246,14 +282,14 @@ protected:
 	a_ExistingConnector is in world-coords and is already rotated properly
 	a_ToPos is the world-coords position on which the new connector should be placed (1 block away from a_ExistingConnector, in its Direction)
 	a_NewConnector is in the original (non-rotated) coords.
+	The already-placed pieces are checked through m_HitBoxGrid.
 	Returns true if the piece fits, false if not. */
 	bool CheckConnection(
 		const cPiece::cConnector & a_ExistingConnector,  // The existing connector
 		const Vector3i & a_ToPos,                        // The position on which the new connector should be placed
 		const cPiece & a_Piece,                          // The new piece
 		const cPiece::cConnector & a_NewConnector,       // The connector of the new piece
-		int a_NumCCWRotations,                           // Number of rotations for the new piece to align the connector
-		const cPlacedPieces & a_OutPieces                // All the already-placed pieces to check
+		int a_NumCCWRotations                            // Number of rotations for the new piece to align the connector
 	);
 	
 	/** DEBUG: Outputs all the connectors in the pool into stdout.
@@ -15,6 +15,42 @@ static const int NUM_RAVINE_POINTS = 4;
 
 
 
+/** The block types that the ravines carve out, indexed by the block type */
+static const struct sRavineCarvable
+{
+	bool m_IsCarvable[256];
+
+	sRavineCarvable(void)
+	{
+		memset(m_IsCarvable, 0, sizeof(m_IsCarvable));
+		static const BLOCKTYPE Carvable[] =
+		{
+			E_BLOCK_DIRT,
+			E_BLOCK_GRASS,
+			E_BLOCK_STONE,
+			E_BLOCK_COBBLESTONE,
+			E_BLOCK_GRAVEL,
+			E_BLOCK_SAND,
+			E_BLOCK_SANDSTONE,
+			E_BLOCK_NETHERRACK,
+			E_BLOCK_COAL_ORE,
+			E_BLOCK_IRON_ORE,
+			E_BLOCK_GOLD_ORE,
+			E_BLOCK_DIAMOND_ORE,
+			E_BLOCK_REDSTONE_ORE,
+			E_BLOCK_REDSTONE_ORE_GLOWING,
+		};
+		for (size_t i = 0; i < ARRAYCOUNT(Carvable); i++)
+		{
+			m_IsCarvable[Carvable[i]] = true;
+		}
+	}
+} g_RavineCarvable;
+
+
+
+
+
 struct cRavDefPoint
 {
 	int m_BlockX;
@@ -332,6 +368,7 @@ void cStructGenRavines::cRavine::DrawIntoChunk(cChunkDesc & a_ChunkDesc)
 	int BlockStartZ = a_ChunkDesc.GetChunkZ() * cChunkDef::Width;
 	int BlockEndX = BlockStartX + cChunkDef::Width;
 	int BlockEndZ = BlockStartZ + cChunkDef::Width;
+	cChunkDef::BlockTypes & BlockTypes = a_ChunkDesc.GetBlockTypes();
 	for (cRavDefPoints::const_iterator itr = m_Points.begin(), end = m_Points.end(); itr != end; ++itr)
 	{
 		if (
@@ -349,48 +386,48 @@ void cStructGenRavines::cRavine::DrawIntoChunk(cChunkDesc & a_ChunkDesc)
 		int RadiusSq = itr->m_Radius * itr->m_Radius;  // instead of doing sqrt for each distance, we do sqr of the radius
 		int DifX = BlockStartX - itr->m_BlockX;  // substitution for faster calc
 		int DifZ = BlockStartZ - itr->m_BlockZ;  // substitution for faster calc
-		for (int x = 0; x < cChunkDef::Width; x++) for (int z = 0; z < cChunkDef::Width; z++)
+		int Bottom = std::max(itr->m_Bottom, 1);
+		int Top = std::min(itr->m_Top, cChunkDef::Height - 1);
+
+		// Clip the rows to the cylinder, and each row to the cylinder's span in that row:
+		int MinZ = std::max(-DifZ - itr->m_Radius, 0);
+		int MaxZ = std::min(-DifZ + itr->m_Radius, cChunkDef::Width - 1);
+		for (int z = MinZ; z <= MaxZ; z++)
 		{
-			#ifdef _DEBUG
-			// DEBUG: Make the ravine shapepoints visible on a single layer (so that we can see with Minutor what's going on)
-			if ((DifX + x == 0) && (DifZ + z == 0))
+			int DistSqZ = (DifZ + z) * (DifZ + z);
+			if (DistSqZ > RadiusSq)
 			{
-				a_ChunkDesc.SetBlockType(x, 4, z, E_BLOCK_LAPIS_ORE);
+				continue;
 			}
-			#endif  // _DEBUG
-			
-			int DistSq = (DifX + x) * (DifX + x) + (DifZ + z) * (DifZ + z);
-			if (DistSq <= RadiusSq)
+			int SpanX = static_cast<int>(ceilf(sqrtf(static_cast<float>(RadiusSq - DistSqZ))));
+			int MinX = std::max(-DifX - SpanX, 0);
+			int MaxX = std::min(-DifX + SpanX, cChunkDef::Width - 1);
+			for (int x = MinX; x <= MaxX; x++)
 			{
-				int Top = std::min(itr->m_Top, (int)(cChunkDef::Height));  // Stupid gcc needs int cast
-				for (int y = std::max(itr->m_Bottom, 1); y <= Top; y++)
+				#ifdef _DEBUG
+				// DEBUG: Make the ravine shapepoints visible on a single layer (so that we can see with Minutor what's going on)
+				if ((DifX + x == 0) && (DifZ + z == 0))
 				{
-					switch (a_ChunkDesc.GetBlockType(x, y, z))
+					cChunkDef::SetBlock(BlockTypes, x, 4, z, E_BLOCK_LAPIS_ORE);
+				}
+				#endif  // _DEBUG
+				
+				int DistSq = (DifX + x) * (DifX + x) + DistSqZ;
+				if (DistSq > RadiusSq)
+				{
+					continue;
+				}
+				for (int y = Bottom; y <= Top; y++)
+				{
+					// Only carve out specific block types
+					int Index = cChunkDef::MakeIndexNoCheck(x, y, z);
+					if (g_RavineCarvable.m_IsCarvable[BlockTypes[Index]])
 					{
-						// Only carve out these specific block types
-						case E_BLOCK_DIRT:
-						case E_BLOCK_GRASS:
-						case E_BLOCK_STONE:
-						case E_BLOCK_COBBLESTONE:
-						case E_BLOCK_GRAVEL:
-						case E_BLOCK_SAND:
-						case E_BLOCK_SANDSTONE:
-						case E_BLOCK_NETHERRACK:
-						case E_BLOCK_COAL_ORE:
-						case E_BLOCK_IRON_ORE:
-						case E_BLOCK_GOLD_ORE:
-						case E_BLOCK_DIAMOND_ORE:
-						case E_BLOCK_REDSTONE_ORE:
-						case E_BLOCK_REDSTONE_ORE_GLOWING:
-						{
-							a_ChunkDesc.SetBlockType(x, y, z, E_BLOCK_AIR);
-							break;
-						}
-						default: break;
+						BlockTypes[Index] = E_BLOCK_AIR;
 					}
 				}
-			}
-		}  // for x, z - a_BlockTypes
+			}  // for x
+		}  // for z
 	}  // for itr - m_Points[]
 }
 
@@ -158,6 +158,8 @@ protected:
 		int BlockStartZ = a_ChunkDesc.GetChunkZ() * cChunkDef::Width;
 		int BlockEndX = BlockStartX + cChunkDef::Width;
 		int BlockEndZ = BlockStartZ + cChunkDef::Width;
+		cChunkDef::BlockTypes & BlockTypes = a_ChunkDesc.GetBlockTypes();
+		const bool * CanBeTerraformed = cBlockInfo::GetCanBeTerraformedTable();
 		for (sRavineDefPoints::const_iterator itr = m_DefPoints.begin(), end = m_DefPoints.end(); itr != end; ++itr)
 		{
 			if (
@@ -177,37 +179,54 @@ protected:
 			float RadiusSq = (itr->m_Radius + 2) * (itr->m_Radius + 2);
 			float DifX = BlockStartX - itr->m_X;  // substitution for faster calc
 			float DifZ = BlockStartZ - itr->m_Z;  // substitution for faster calc
-			for (int x = 0; x < cChunkDef::Width; x++) for (int z = 0; z < cChunkDef::Width; z++)
+			int Bottom = std::max((int)floorf(itr->m_Bottom), 1);
+			int Top = std::min((int)ceilf(itr->m_Top), cChunkDef::Height - 1);
+			
+			// Clip the rows to the enlarged cylinder, and each row to the enlarged cylinder's span in that row:
+			int MinZ = std::max((int)floorf(-DifZ - itr->m_Radius - 2), 0);
+			int MaxZ = std::min((int)ceilf(-DifZ + itr->m_Radius + 2), cChunkDef::Width - 1);
+			for (int z = MinZ; z <= MaxZ; z++)
 			{
-				#ifdef _DEBUG
-				// DEBUG: Make the roughravine shapepoints visible on a single layer (so that we can see with Minutor what's going on)
-				if ((DifX + x == 0) && (DifZ + z == 0))
-				{
-					a_ChunkDesc.SetBlockType(x, 4, z, E_BLOCK_LAPIS_ORE);
-				}
-				#endif  // _DEBUG
-				
-				// If the column is outside the enlarged radius, bail out completely
-				float DistSq = (DifX + x) * (DifX + x) + (DifZ + z) * (DifZ + z);
-				if (DistSq > RadiusSq)
+				float DistSqZ = (DifZ + z) * (DifZ + z);
+				if (DistSqZ > RadiusSq)
 				{
 					continue;
 				}
-				
-				int Top = std::min((int)ceilf(itr->m_Top), +cChunkDef::Height);
-				for (int y = std::max((int)floorf(itr->m_Bottom), 1); y <= Top; y++)
+				float SpanX = sqrtf(RadiusSq - DistSqZ);
+				int MinX = std::max((int)floorf(-DifX - SpanX), 0);
+				int MaxX = std::min((int)ceilf(-DifX + SpanX), cChunkDef::Width - 1);
+				for (int x = MinX; x <= MaxX; x++)
 				{
-					if ((itr->m_Radius + m_PerHeightRadius[y]) * (itr->m_Radius + m_PerHeightRadius[y]) < DistSq)
+					#ifdef _DEBUG
+					// DEBUG: Make the roughravine shapepoints visible on a single layer (so that we can see with Minutor what's going on)
+					if ((DifX + x == 0) && (DifZ + z == 0))
 					{
-						continue;
+						cChunkDef::SetBlock(BlockTypes, x, 4, z, E_BLOCK_LAPIS_ORE);
 					}
-
-					if (cBlockInfo::CanBeTerraformed(a_ChunkDesc.GetBlockType(x, y, z)))
+					#endif  // _DEBUG
+					
+					// If the column is outside the enlarged radius, bail out completely
+					float DistSq = (DifX + x) * (DifX + x) + (DifZ + z) * (DifZ + z);
+					if (DistSq > RadiusSq)
 					{
-						a_ChunkDesc.SetBlockType(x, y, z, E_BLOCK_AIR);
+						continue;
 					}
-				}  // for y
-			}  // for x, z - a_BlockTypes
+					
+					for (int y = Bottom; y <= Top; y++)
+					{
+						if ((itr->m_Radius + m_PerHeightRadius[y]) * (itr->m_Radius + m_PerHeightRadius[y]) < DistSq)
+						{
+							continue;
+						}
+						
+						int Index = cChunkDef::MakeIndexNoCheck(x, y, z);
+						if (CanBeTerraformed[BlockTypes[Index]])
+						{
+							BlockTypes[Index] = E_BLOCK_AIR;
+						}
+					}  // for y
+				}  // for x
+			}  // for z
 		}  // for itr - m_Points[]
 	}
 };
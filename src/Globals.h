@@ -451,6 +451,11 @@ using cTickTimeLong = std::chrono::duration<Int64,  cTickTime::period>;
 #include "BlockID.h"
 #include "BlockInfo.h"
 
+#ifdef TEST_GLOBALS
+	// VERIFY() prints the stack trace in the tests, too, they link OSSupport/StackTrace.cpp when using it:
+	#include "OSSupport/StackTrace.h"
+#endif
+
 
 
 
@@ -12,7 +12,8 @@
 
 cEnvelopeParser::cEnvelopeParser(cCallbacks & a_Callbacks) :
 	m_Callbacks(a_Callbacks),
-	m_IsInHeaders(true)
+	m_IsInHeaders(true),
+	m_EnvelopeSize(0)
 {
 }
 
@@ -27,43 +28,60 @@ size_t cEnvelopeParser::Parse(const char * a_Data, size_t a_Size)
 		return 0;
 	}
 	
-	// Start searching 1 char from the end of the already received data, if available:
-	size_t SearchStart = m_IncomingData.size();
-	SearchStart = (SearchStart > 1) ? SearchStart - 1 : 0;
-	
-	m_IncomingData.append(a_Data, a_Size);
-	
-	size_t idxCRLF = m_IncomingData.find("\r\n", SearchStart);
-	if (idxCRLF == AString::npos)
-	{
-		// Not a complete line yet, all input consumed:
-		return a_Size;
-	}
-	
-	// Parse as many lines as found:
-	size_t Last = 0;
-	do
+	size_t LineStart = 0;
+	for (;;)
 	{
-		if (idxCRLF == Last)
+		const char * LF = static_cast<const char *>(memchr(a_Data + LineStart, '\n', a_Size - LineStart));
+		if (LF == nullptr)
+		{
+			// Not a complete line yet, keep it until the rest arrives; all input consumed:
+			m_IncomingData.append(a_Data + LineStart, a_Size - LineStart);
+			if (m_EnvelopeSize + m_IncomingData.size() > MAX_ENVELOPE_SIZE)
+			{
+				m_IsInHeaders = false;
+				return AString::npos;
+			}
+			return a_Size;
+		}
+		size_t LineEnd = static_cast<size_t>(LF - a_Data);
+		
+		// Parse the line directly from the input, unless its beginning has been buffered by the previous call:
+		const char * Line = a_Data + LineStart;
+		size_t LineLength = LineEnd - LineStart;
+		if (!m_IncomingData.empty())
+		{
+			m_IncomingData.append(Line, LineLength);
+			Line = m_IncomingData.data();
+			LineLength = m_IncomingData.size();
+		}
+		m_EnvelopeSize += LineLength + 1;
+		LineStart = LineEnd + 1;
+		
+		// Each line must end with a CRLF:
+		if ((m_EnvelopeSize > MAX_ENVELOPE_SIZE) || (LineLength == 0) || (Line[LineLength - 1] != '\r'))
+		{
+			m_IsInHeaders = false;
+			return AString::npos;
+		}
+		LineLength -= 1;
+		
+		if (LineLength == 0)
 		{
 			// This was the last line of the data. Finish whatever value has been cached and return:
+			m_IncomingData.clear();
 			NotifyLast();
 			m_IsInHeaders = false;
-			return a_Size - (m_IncomingData.size() - idxCRLF) + 2;
+			return LineStart;
 		}
-		if (!ParseLine(m_IncomingData.c_str() + Last, idxCRLF - Last))
+		bool IsValid = ParseLine(Line, LineLength);
+		m_IncomingData.clear();
+		if (!IsValid)
 		{
 			// An error has occurred
 			m_IsInHeaders = false;
 			return AString::npos;
 		}
-		Last = idxCRLF + 2;
-		idxCRLF = m_IncomingData.find("\r\n", idxCRLF + 2);
-	} while (idxCRLF != AString::npos);
-	m_IncomingData.erase(0, Last);
-	
-	// Parsed all lines and still expecting more
-	return a_Size;
+	}
 }
 
 
@@ -74,6 +92,7 @@ void cEnvelopeParser::Reset(void)
 {
 	m_IsInHeaders = true;
 	m_IncomingData.clear();
+	m_EnvelopeSize = 0;
 	m_LastKey.clear();
 	m_LastValue.clear();
 }
@@ -113,18 +132,23 @@ bool cEnvelopeParser::ParseLine(const char * a_Data, size_t a_Size)
 	
 	// This is a line with a new key:
 	NotifyLast();
-	for (size_t i = 0; i < a_Size; i++)
+	const char * Colon = static_cast<const char *>(memchr(a_Data, ':', a_Size));
+	if ((Colon == nullptr) || (Colon == a_Data))
 	{
-		if (a_Data[i] == ':')
-		{
-			m_LastKey.assign(a_Data, i);
-			m_LastValue.assign(a_Data + i + 2, a_Size - i - 2);
-			return true;
-		}
-	}  // for i - a_Data[]
+		// No colon was found or no key before it, key-less header??
+		return false;
+	}
 	
-	// No colon was found, key-less header??
-	return false;
+	// Skip the whitespace between the colon and the value:
+	size_t KeyLength = static_cast<size_t>(Colon - a_Data);
+	size_t ValueStart = KeyLength + 1;
+	while ((ValueStart < a_Size) && ((a_Data[ValueStart] == ' ') || (a_Data[ValueStart] == '\t')))
+	{
+		ValueStart++;
+	}
+	m_LastKey.assign(a_Data, KeyLength);
+	m_LastValue.assign(a_Data + ValueStart, a_Size - ValueStart);
+	return true;
 }
 
 
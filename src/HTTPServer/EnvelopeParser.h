@@ -27,11 +27,17 @@ public:
 	} ;
 	
 	
+	/** The maximum size of the whole envelope, in bytes. Longer envelopes are considered an error,
+	so that a client cannot make us buffer an endless header. */
+	static const size_t MAX_ENVELOPE_SIZE = 16 KiB;
+	
+	
 	cEnvelopeParser(cCallbacks & a_Callbacks);
 	
 	/** Parses the incoming data.
+	The complete lines are parsed directly from a_Data, only an incomplete line at the end is buffered until the rest of it arrives.
 	Returns the number of bytes consumed from the input. The bytes not consumed are not part of the envelope header.
-	Returns AString::npos on error
+	Returns AString::npos on error, including an envelope larger than MAX_ENVELOPE_SIZE
 	*/
 	size_t Parse(const char * a_Data, size_t a_Size);
 	
@@ -51,9 +57,12 @@ public:
 	/** Set to true while the parser is still parsing the envelope headers. Once set to true, the parser will not consume any more data. */
 	bool m_IsInHeaders;
 	
-	/** Buffer for the incoming data until it is parsed */
+	/** Buffer for an incomplete line at the end of the data given to Parse() */
 	AString m_IncomingData;
 	
+	/** Number of bytes of the complete lines parsed so far, checked against MAX_ENVELOPE_SIZE */
+	size_t m_EnvelopeSize;
+	
 	/** Holds the last parsed key; used for line-wrapped values */
 	AString m_LastKey;
 	
@@ -64,7 +73,7 @@ public:
 	/** Notifies the callback of the key/value stored in m_LastKey/m_LastValue, then erases them */
 	void NotifyLast(void);
 	
-	/** Parses one line of header data. Returns true if successful */
+	/** Parses one line of header data, without the CRLF. Returns true if successful */
 	bool ParseLine(const char * a_Data, size_t a_Size);
 } ;
 
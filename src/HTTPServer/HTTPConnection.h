@@ -72,9 +72,6 @@ protected:
 	/** The parent webserver that is to be notified of events on this connection */
 	cHTTPServer & m_HTTPServer;
 	
-	/** All the incoming data until the entire request header is parsed */
-	AString m_IncomingHeaderData;
-	
 	/** Status in which the request currently is */
 	eState m_State;
 	
@@ -156,33 +156,22 @@ void cHTTPFormParser::BeginMultipart(const cHTTPRequest & a_Request)
 void cHTTPFormParser::ParseFormUrlEncoded(void)
 {
 	// Parse m_IncomingData for all the variables; no more data is incoming, since this is called from Finish()
-	// This may not be the most performant version, but we don't care, the form data is small enough and we're not a full-fledged web server anyway
-	AStringVector Lines = StringSplit(m_IncomingData, "&");
-	for (AStringVector::iterator itr = Lines.begin(), end = Lines.end(); itr != end; ++itr)
+	// The data is walked in place, only the decoded names and values are copied out of it
+	size_t Len = m_IncomingData.size();
+	for (size_t Start = 0; Start < Len;)
 	{
-		AStringVector Components = StringSplit(*itr, "=");
-		switch (Components.size())
+		size_t End = m_IncomingData.find('&', Start);
+		if (End == AString::npos)
 		{
-			default:
-			{
-				// Neither name nor value, or too many "="s, mark this as invalid form:
-				m_IsValid = false;
-				return;
-			}
-			case 1:
-			{
-				// Only name present
-				(*this)[URLDecode(ReplaceAllCharOccurrences(Components[0], '+', ' '))] = "";
-				break;
-			}
-			case 2:
-			{
-				// name=value format:
-				(*this)[URLDecode(ReplaceAllCharOccurrences(Components[0], '+', ' '))] = URLDecode(ReplaceAllCharOccurrences(Components[1], '+', ' '));
-				break;
-			}
+			End = Len;
+		}
+		if (!ParseFormUrlEncodedVariable(Start, End))
+		{
+			m_IsValid = false;
+			return;
 		}
-	}  // for itr - Lines[]
+		Start = End + 1;
+	}  // for Start - m_IncomingData[]
 	m_IncomingData.clear();
 }
 
@@ -190,6 +179,56 @@ void cHTTPFormParser::ParseFormUrlEncoded(void)
 
 
 
+bool cHTTPFormParser::ParseFormUrlEncodedVariable(size_t a_Start, size_t a_End)
+{
+	if (a_Start == a_End)
+	{
+		// Neither name nor value:
+		return false;
+	}
+
+	// Split into the name and the value, a single trailing "=" is allowed, more "="s make the form invalid:
+	size_t NameEnd = m_IncomingData.find('=', a_Start);
+	size_t ValueStart = a_End;
+	if ((NameEnd == AString::npos) || (NameEnd >= a_End))
+	{
+		// Only name present
+		NameEnd = a_End;
+	}
+	else
+	{
+		ValueStart = NameEnd + 1;
+	}
+	size_t ValueEnd = a_End;
+	if ((ValueEnd > ValueStart) && (m_IncomingData[ValueEnd - 1] == '='))
+	{
+		ValueEnd -= 1;
+	}
+	size_t Equals = m_IncomingData.find('=', ValueStart);
+	if ((Equals != AString::npos) && (Equals < ValueEnd))
+	{
+		return false;
+	}
+
+	(*this)[DecodeFormUrlEncoded(a_Start, NameEnd)] = DecodeFormUrlEncoded(ValueStart, ValueEnd);
+	return true;
+}
+
+
+
+
+
+AString cHTTPFormParser::DecodeFormUrlEncoded(size_t a_Start, size_t a_End) const
+{
+	AString res(m_IncomingData, a_Start, a_End - a_Start);
+	std::replace(res.begin(), res.end(), '+', ' ');
+	return URLDecode(res);
+}
+
+
+
+
+
 void cHTTPFormParser::OnPartStart(void)
 {
 	m_CurrentPartFileName.clear();
@@ -232,14 +271,14 @@ void cHTTPFormParser::OnPartHeader(const AString & a_Key, const AString & a_Valu
 		// Parse the field name and optional filename from this header:
 		cNameValueParser Parser(a_Value.data() + ParamsStart, a_Value.size() - ParamsStart);
 		Parser.Finish();
-		m_CurrentPartName = Parser["name"];
+		std::swap(m_CurrentPartName, Parser["name"]);
 		if (!Parser.IsValid() || m_CurrentPartName.empty())
 		{
 			// The required parameter "name" is missing, mark the whole form invalid:
 			m_IsValid = false;
 			return;
 		}
-		m_CurrentPartFileName = Parser["filename"];
+		std::swap(m_CurrentPartFileName, Parser["filename"]);
 	}
 }
 
@@ -256,16 +295,8 @@ void cHTTPFormParser::OnPartData(const char * a_Data, size_t a_Size)
 	}
 	if (m_CurrentPartFileName.empty())
 	{
-		// This is a variable, store it in the map
-		iterator itr = find(m_CurrentPartName);
-		if (itr == end())
-		{
-			(*this)[m_CurrentPartName] = AString(a_Data, a_Size);
-		}
-		else
-		{
-			itr->second.append(a_Data, a_Size);
-		}
+		// This is a variable, store it in the map, appending to the data received so far:
+		(*this)[m_CurrentPartName].append(a_Data, a_Size);
 	}
 	else
 	{
@@ -103,6 +103,12 @@ protected:
 	/// Parses m_IncomingData as form-urlencoded data (fpkURL or fpkFormUrlEncoded kinds)
 	void ParseFormUrlEncoded(void);
 	
+	/// Parses a single "name=value" variable from the [a_Start, a_End) range of m_IncomingData into the map. Returns false if the variable is malformed
+	bool ParseFormUrlEncodedVariable(size_t a_Start, size_t a_End);
+	
+	/// Returns the URL-decoded [a_Start, a_End) range of m_IncomingData, with the "+"s decoded as spaces
+	AString DecodeFormUrlEncoded(size_t a_Start, size_t a_End) const;
+	
 	// cMultipartParser::cCallbacks overrides:
 	virtual void OnPartStart (void) override;
 	virtual void OnPartHeader(const AString & a_Key, const AString & a_Value) override;
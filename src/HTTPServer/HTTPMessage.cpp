@@ -39,7 +39,7 @@ void cHTTPMessage::AddHeader(const AString & a_Key, const AString & a_Value)
 	cNameValueMap::iterator itr = m_Headers.find(Key);
 	if (itr == m_Headers.end())
 	{
-		m_Headers[Key] = a_Value;
+		itr = m_Headers.insert(std::make_pair(Key, a_Value)).first;
 	}
 	else
 	{
@@ -51,11 +51,11 @@ void cHTTPMessage::AddHeader(const AString & a_Key, const AString & a_Value)
 	// Special processing for well-known headers:
 	if (Key == "content-type")
 	{
-		m_ContentType = m_Headers[Key];
+		m_ContentType = itr->second;
 	}
 	else if (Key == "content-length")
 	{
-		m_ContentLength = static_cast<size_t>(atol(m_Headers[Key].c_str()));
+		m_ContentLength = static_cast<size_t>(atol(itr->second.c_str()));
 	}
 }
 
@@ -139,81 +139,90 @@ AString cHTTPRequest::GetBareURL(void) const
 
 size_t cHTTPRequest::ParseRequestLine(const char * a_Data, size_t a_Size)
 {
-	m_IncomingHeaderData.append(a_Data, a_Size);
-	size_t IdxEnd = m_IncomingHeaderData.size();
-
 	// Ignore the initial CRLFs (HTTP spec's "should")
 	size_t LineStart = 0;
-	while (
-		(LineStart < IdxEnd) &&
-		(
-			(m_IncomingHeaderData[LineStart] == '\r') ||
-			(m_IncomingHeaderData[LineStart] == '\n')
-		)
-	)
+	if (m_IncomingHeaderData.empty())
 	{
-		LineStart++;
+		while ((LineStart < a_Size) && ((a_Data[LineStart] == '\r') || (a_Data[LineStart] == '\n')))
+		{
+			LineStart++;
+		}
 	}
-	if (LineStart >= IdxEnd)
+	
+	const char * LF = static_cast<const char *>(memchr(a_Data + LineStart, '\n', a_Size - LineStart));
+	if (LF == nullptr)
+	{
+		// CRLF hasn't been encountered yet, keep the line start until the rest arrives and consider all data consumed
+		m_IncomingHeaderData.append(a_Data + LineStart, a_Size - LineStart);
+		if (m_IncomingHeaderData.size() > MAX_REQUEST_LINE_LENGTH)
+		{
+			m_IsValid = false;
+			return AString::npos;
+		}
+		return a_Size;
+	}
+	size_t LineEnd = static_cast<size_t>(LF - a_Data);
+	
+	// Parse the line directly from the input, unless its beginning has been buffered by the previous call:
+	bool IsValid;
+	if (m_IncomingHeaderData.empty())
+	{
+		IsValid = ParseRequestLineContents(a_Data + LineStart, LineEnd - LineStart);
+	}
+	else
+	{
+		m_IncomingHeaderData.append(a_Data + LineStart, LineEnd - LineStart);
+		IsValid = ParseRequestLineContents(m_IncomingHeaderData.data(), m_IncomingHeaderData.size());
+		m_IncomingHeaderData.clear();
+	}
+	if (!IsValid)
 	{
 		m_IsValid = false;
 		return AString::npos;
 	}
+	return LineEnd + 1;
+}
+
+
+
+
+
+bool cHTTPRequest::ParseRequestLineContents(const char * a_Line, size_t a_Size)
+{
+	// The line must end with a CR, the LF has already been stripped:
+	if ((a_Size == 0) || (a_Size > MAX_REQUEST_LINE_LENGTH) || (a_Line[a_Size - 1] != '\r'))
+	{
+		return false;
+	}
+	const char * LineEnd = a_Line + a_Size - 1;
 	
-	int NumSpaces = 0;
-	size_t MethodEnd = 0;
-	size_t URLEnd = 0;
-	for (size_t i = LineStart; i < IdxEnd; i++)
+	// Method, URL and version, separated by exactly two spaces:
+	const char * MethodEnd = static_cast<const char *>(memchr(a_Line, ' ', static_cast<size_t>(LineEnd - a_Line)));
+	if ((MethodEnd == nullptr) || (MethodEnd == a_Line))
 	{
-		switch (m_IncomingHeaderData[i])
-		{
-			case ' ':
-			{
-				switch (NumSpaces)
-				{
-					case 0:
-					{
-						MethodEnd = i;
-						break;
-					}
-					case 1:
-					{
-						URLEnd = i;
-						break;
-					}
-					default:
-					{
-						// Too many spaces in the request
-						m_IsValid = false;
-						return AString::npos;
-					}
-				}
-				NumSpaces += 1;
-				break;
-			}
-			case '\n':
-			{
-				if ((i == 0) || (m_IncomingHeaderData[i - 1] != '\r') || (NumSpaces != 2) || (i < URLEnd + 7))
-				{
-					// LF too early, without a CR, without two preceeding spaces or too soon after the second space
-					m_IsValid = false;
-					return AString::npos;
-				}
-				// Check that there's HTTP/version at the end
-				if (strncmp(m_IncomingHeaderData.c_str() + URLEnd + 1, "HTTP/1.", 7) != 0)
-				{
-					m_IsValid = false;
-					return AString::npos;
-				}
-				m_Method = m_IncomingHeaderData.substr(LineStart, MethodEnd - LineStart);
-				m_URL = m_IncomingHeaderData.substr(MethodEnd + 1, URLEnd - MethodEnd - 1);
-				return i + 1;
-			}
-		}  // switch (m_IncomingHeaderData[i])
-	}  // for i - m_IncomingHeaderData[]
+		return false;
+	}
+	const char * URLStart = MethodEnd + 1;
+	const char * URLEnd = static_cast<const char *>(memchr(URLStart, ' ', static_cast<size_t>(LineEnd - URLStart)));
+	if ((URLEnd == nullptr) || (URLEnd == URLStart))
+	{
+		return false;
+	}
+	const char * Version = URLEnd + 1;
+	size_t VersionLength = static_cast<size_t>(LineEnd - Version);
+	if (
+		(VersionLength < 8) ||
+		(strncmp(Version, "HTTP/1.", 7) != 0) ||
+		(memchr(Version, ' ', VersionLength) != nullptr)
+	)
+	{
+		// Not a HTTP/1.x request, or too many spaces in the request
+		return false;
+	}
 	
-	// CRLF hasn't been encountered yet, consider all data consumed
-	return a_Size;
+	m_Method.assign(a_Line, static_cast<size_t>(MethodEnd - a_Line));
+	m_URL.assign(URLStart, static_cast<size_t>(URLEnd - URLStart));
+	return true;
 }
 
 
@@ -71,6 +71,10 @@ class cHTTPRequest :
 	typedef cHTTPMessage super;
 	
 public:
+	/** The maximum length of the request line (method, URL and version), in bytes. Longer requests are considered an error. */
+	static const size_t MAX_REQUEST_LINE_LENGTH = 8 KiB;
+	
+	
 	cHTTPRequest(void);
 	
 	/** Parses the request line and then headers from the received data.
@@ -118,7 +122,7 @@ protected:
 	/** True if the data received so far is parsed successfully. When false, all further parsing is skipped */
 	bool m_IsValid;
 	
-	/** Bufferred incoming data, while parsing for the request line */
+	/** Buffer for an incomplete request line, while waiting for the rest of it */
 	AString m_IncomingHeaderData;
 	
 	/** Method of the request (GET / PUT / POST / ...) */
@@ -145,10 +149,14 @@ protected:
 	
 	
 	/** Parses the incoming data for the first line (RequestLine)
-	Returns the number of bytes consumed, or -1 for an error
+	Only an incomplete line is buffered, a complete one is parsed directly from a_Data.
+	Returns the number of bytes consumed, or AString::npos for an error
 	*/
 	size_t ParseRequestLine(const char * a_Data, size_t a_Size);
 	
+	/** Parses the complete request line, without the LF, into m_Method and m_URL. Returns true if successful */
+	bool ParseRequestLineContents(const char * a_Line, size_t a_Size);
+	
 	// cEnvelopeParser::cCallbacks overrides:
 	virtual void OnHeaderLine(const AString & a_Key, const AString & a_Value) override;
 } ;
@@ -152,56 +152,47 @@ void cMultipartParser::Parse(const char * a_Data, size_t a_Size)
 		return;
 	}
 	
-	// Append to buffer, then parse it:
+	// Append to buffer, then parse it. The parsed data is only skipped over and gets erased once at the end:
 	m_IncomingData.append(a_Data, a_Size);
+	size_t Start = 0;
 	for (;;)
 	{
 		if (m_EnvelopeParser.IsInHeaders())
 		{
-			size_t BytesConsumed = m_EnvelopeParser.Parse(m_IncomingData.data(), m_IncomingData.size());
+			size_t BytesConsumed = m_EnvelopeParser.Parse(m_IncomingData.data() + Start, m_IncomingData.size() - Start);
 			if (BytesConsumed == AString::npos)
 			{
 				m_IsValid = false;
 				return;
 			}
-			if ((BytesConsumed == a_Size) && m_EnvelopeParser.IsInHeaders())
+			Start += BytesConsumed;
+			if (m_EnvelopeParser.IsInHeaders())
 			{
 				// All the incoming data has been consumed and still waiting for more
-				return;
+				break;
 			}
-			m_IncomingData.erase(0, BytesConsumed);
 		}
 
 		// Search for boundary / boundary end:
-		size_t idxBoundary = m_IncomingData.find("\r\n--");
+		size_t idxBoundary = m_IncomingData.find("\r\n--", Start);
 		if (idxBoundary == AString::npos)
 		{
 			// Boundary string start not present, present as much data to the part callback as possible
-			if (m_IncomingData.size() > m_Boundary.size() + 8)
-			{
-				size_t BytesToReport = m_IncomingData.size() - m_Boundary.size() - 8;
-				m_Callbacks.OnPartData(m_IncomingData.data(), BytesToReport);
-				m_IncomingData.erase(0, BytesToReport);
-			}
-			return;
+			Start += ReportPartData(Start);
+			break;
 		}
-		if (idxBoundary > 0)
+		if (idxBoundary > Start)
 		{
-			m_Callbacks.OnPartData(m_IncomingData.data(), idxBoundary);
-			m_IncomingData.erase(0, idxBoundary);
+			m_Callbacks.OnPartData(m_IncomingData.data() + Start, idxBoundary - Start);
+			Start = idxBoundary;
 		}
-		idxBoundary = 4;
+		idxBoundary = Start + 4;
 		size_t LineEnd = m_IncomingData.find("\r\n", idxBoundary);
 		if (LineEnd == AString::npos)
 		{
 			// Not a complete line yet, present as much data to the part callback as possible
-			if (m_IncomingData.size() > m_Boundary.size() + 8)
-			{
-				size_t BytesToReport = m_IncomingData.size() - m_Boundary.size() - 8;
-				m_Callbacks.OnPartData(m_IncomingData.data(), BytesToReport);
-				m_IncomingData.erase(0, BytesToReport);
-			}
-			return;
+			Start += ReportPartData(Start);
+			break;
 		}
 		if (
 			(LineEnd - idxBoundary != m_Boundary.size()) &&  // Line length not equal to boundary
@@ -209,8 +200,8 @@ void cMultipartParser::Parse(const char * a_Data, size_t a_Size)
 		)
 		{
 			// Got a line, but it's not a boundary, report it as data:
-			m_Callbacks.OnPartData(m_IncomingData.data(), LineEnd);
-			m_IncomingData.erase(0, LineEnd);
+			m_Callbacks.OnPartData(m_IncomingData.data() + Start, LineEnd - Start);
+			Start = LineEnd;
 			continue;
 		}
 		
@@ -227,7 +218,7 @@ void cMultipartParser::Parse(const char * a_Data, size_t a_Size)
 				return;
 			}
 			m_Callbacks.OnPartStart();
-			m_IncomingData.erase(0, LineEnd + 2);
+			Start = LineEnd + 2;
 			
 			// Keep parsing for the headers that may have come with this data:
 			m_EnvelopeParser.Reset();
@@ -235,9 +226,27 @@ void cMultipartParser::Parse(const char * a_Data, size_t a_Size)
 		}
 		
 		// It's a line, but not a boundary. It can be fully sent to the data receiver, since a boundary cannot cross lines
-		m_Callbacks.OnPartData(m_IncomingData.c_str(), LineEnd);
-		m_IncomingData.erase(0, LineEnd);
+		m_Callbacks.OnPartData(m_IncomingData.data() + Start, LineEnd - Start);
+		Start = LineEnd;
 	}  // while (true)
+	m_IncomingData.erase(0, Start);
+}
+
+
+
+
+
+size_t cMultipartParser::ReportPartData(size_t a_Start)
+{
+	// Keep enough data for a boundary that may be starting at the end of the buffer:
+	size_t Size = m_IncomingData.size() - a_Start;
+	if (Size <= m_Boundary.size() + 8)
+	{
+		return 0;
+	}
+	size_t BytesToReport = Size - m_Boundary.size() - 8;
+	m_Callbacks.OnPartData(m_IncomingData.data() + a_Start, BytesToReport);
+	return BytesToReport;
 }
 
 
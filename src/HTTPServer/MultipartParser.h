@@ -54,7 +54,7 @@ protected:
 	/** Parser for each part's envelope */
 	cEnvelopeParser m_EnvelopeParser;
 	
-	/** Buffer for the incoming data until it is parsed */
+	/** Buffer for the incoming data that couldn't be parsed yet (an incomplete line that may be a boundary) */
 	AString m_IncomingData;
 	
 	/** The boundary, excluding both the initial "--" and the terminating CRLF */
@@ -64,6 +64,10 @@ protected:
 	bool m_HasHadData;
 	
 	
+	/** Reports the data in m_IncomingData from a_Start on to the part callback, except for the tail that may be a start of a boundary.
+	Returns the number of bytes reported. */
+	size_t ReportPartData(size_t a_Start);
+	
 	/** Parse one line of incoming data. The CRLF has already been stripped from a_Data / a_Size */
 	void ParseLine(const char * a_Data, size_t a_Size);
 	
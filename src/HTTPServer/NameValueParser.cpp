@@ -154,8 +154,7 @@ void cNameValueParser::Parse(const char * a_Data, size_t a_Size)
 						m_CurrentKey.append(a_Data + Last, i - Last);
 						i++;
 						Last = i;
-						(*this)[m_CurrentKey] = "";
-						m_CurrentKey.clear();
+						StoreCurrentPair();
 						m_State = psKeySpace;
 						break;
 					}
@@ -197,8 +196,7 @@ void cNameValueParser::Parse(const char * a_Data, size_t a_Size)
 						}
 						i++;
 						Last = i;
-						(*this)[m_CurrentKey] = "";
-						m_CurrentKey.clear();
+						StoreCurrentPair();
 						m_State = psKeySpace;
 						break;
 					}
@@ -226,8 +224,7 @@ void cNameValueParser::Parse(const char * a_Data, size_t a_Size)
 						}
 						i++;
 						Last = i;
-						(*this)[m_CurrentKey] = "";
-						m_CurrentKey.clear();
+						StoreCurrentPair();
 						m_State = psKeySpace;
 						break;
 					}
@@ -264,9 +261,7 @@ void cNameValueParser::Parse(const char * a_Data, size_t a_Size)
 					if (a_Data[i] == '\"')
 					{
 						m_CurrentValue.append(a_Data + Last, i - Last);
-						(*this)[m_CurrentKey] = m_CurrentValue;
-						m_CurrentKey.clear();
-						m_CurrentValue.clear();
+						StoreCurrentPair();
 						m_State = psAfterValue;
 						i++;
 						Last = i;
@@ -288,9 +283,7 @@ void cNameValueParser::Parse(const char * a_Data, size_t a_Size)
 					if (a_Data[i] == '\'')
 					{
 						m_CurrentValue.append(a_Data + Last, i - Last);
-						(*this)[m_CurrentKey] = m_CurrentValue;
-						m_CurrentKey.clear();
-						m_CurrentValue.clear();
+						StoreCurrentPair();
 						m_State = psAfterValue;
 						i++;
 						Last = i;
@@ -312,9 +305,7 @@ void cNameValueParser::Parse(const char * a_Data, size_t a_Size)
 					if (a_Data[i] == ';')
 					{
 						m_CurrentValue.append(a_Data + Last, i - Last);
-						(*this)[m_CurrentKey] = m_CurrentValue;
-						m_CurrentKey.clear();
-						m_CurrentValue.clear();
+						StoreCurrentPair();
 						m_State = psKeySpace;
 						i++;
 						Last = i;
@@ -359,6 +350,18 @@ void cNameValueParser::Parse(const char * a_Data, size_t a_Size)
 
 
 
+void cNameValueParser::StoreCurrentPair(void)
+{
+	// Move the parsed strings into the map rather than copying them, the moved-from strings are cleared for the next pair:
+	(*this)[std::move(m_CurrentKey)] = std::move(m_CurrentValue);
+	m_CurrentKey.clear();
+	m_CurrentValue.clear();
+}
+
+
+
+
+
 bool cNameValueParser::Finish(void)
 {
 	switch (m_State)
@@ -377,7 +380,7 @@ bool cNameValueParser::Finish(void)
 		{
 			if ((m_AllowsKeyOnly) && !m_CurrentKey.empty())
 			{
-				(*this)[m_CurrentKey] = "";
+				StoreCurrentPair();
 				m_State = psFinished;
 				return true;
 			}
@@ -386,7 +389,7 @@ bool cNameValueParser::Finish(void)
 		}
 		case psValueRaw:
 		{
-			(*this)[m_CurrentKey] = m_CurrentValue;
+			StoreCurrentPair();
 			m_State = psFinished;
 			return true;
 		}
@@ -63,6 +63,8 @@ protected:
 	AString m_CurrentValue;
 	
 	
+	/// Moves m_CurrentKey and m_CurrentValue into the map and clears them for the next pair
+	void StoreCurrentPair(void);
 } ;
 
 
@@ -0,0 +1,275 @@
+
+// LightUpdater.cpp
+
+// Implements the cLightUpdater class that incrementally updates the light around a single changed block
+
+#include "Globals.h"
+#include "LightUpdater.h"
+#include "ChunkData.h"
+#include "BlockInfo.h"
+
+
+
+
+
+/** The six neighbor directions in which the light spreads */
+static const struct
+{
+	int x, y, z;
+} g_NeighborOffsets[] =
+{
+	{ 1,  0,  0},
+	{-1,  0,  0},
+	{ 0,  1,  0},
+	{ 0, -1,  0},
+	{ 0,  0,  1},
+	{ 0,  0, -1},
+} ;
+
+
+
+
+
+cLightUpdater::cLightUpdater(cChunkData * a_ChunkData[9], const cChunkDef::HeightMap * a_HeightMaps[9]) :
+	m_ModifiedChunks(0),
+	m_NumVisited(0)
+{
+	for (size_t i = 0; i < ARRAYCOUNT(m_ChunkData); i++)
+	{
+		ASSERT(a_ChunkData[i] != nullptr);
+		ASSERT(a_HeightMaps[i] != nullptr);
+		m_ChunkData[i] = a_ChunkData[i];
+		m_HeightMaps[i] = a_HeightMaps[i];
+	}
+}
+
+
+
+
+
+bool cLightUpdater::BlockChanged(int a_RelX, int a_RelY, int a_RelZ, int a_OldHeight)
+{
+	ASSERT((a_RelX >= 0) && (a_RelX < cChunkDef::Width));
+	ASSERT((a_RelY >= 0) && (a_RelY < cChunkDef::Height));
+	ASSERT((a_RelZ >= 0) && (a_RelZ < cChunkDef::Width));
+
+	sCoords Changed(a_RelX, a_RelY, a_RelZ);
+
+	// Blocklight: only the changed block itself may have changed its emission or falloff:
+	m_Decrease.clear();
+	m_Decrease.push_back(sDecrease(Changed, GetLight(ltBlock, Changed)));
+	if (!UpdateLight(ltBlock))
+	{
+		return false;
+	}
+
+	// Skylight: the changed block, plus all the blocks in the column between the old and the new height,
+	// because their skylight source has changed:
+	m_Decrease.clear();
+	m_Decrease.push_back(sDecrease(Changed, GetLight(ltSky, Changed)));
+	int NewHeight = cChunkDef::GetHeight(*m_HeightMaps[4], a_RelX, a_RelZ);
+	int MinY = std::min(a_OldHeight, NewHeight) + 1;
+	int MaxY = std::max(a_OldHeight, NewHeight);
+	for (int y = MinY; y <= MaxY; y++)
+	{
+		if (y != a_RelY)
+		{
+			sCoords Column(a_RelX, y, a_RelZ);
+			m_Decrease.push_back(sDecrease(Column, GetLight(ltSky, Column)));
+		}
+	}
+	return UpdateLight(ltSky);
+}
+
+
+
+
+
+bool cLightUpdater::UpdateLight(eLightType a_LightType)
+{
+	m_Increase.clear();
+
+	// Zero out the seed blocks; they will be re-lit from their sources and neighbors:
+	for (sDecreaseVector::const_iterator itr = m_Decrease.begin(), end = m_Decrease.end(); itr != end; ++itr)
+	{
+		SetLight(a_LightType, itr->m_Coords, 0);
+	}
+
+	// Decrease pass: remove all light that may have come from the blocks in the queue:
+	for (size_t i = 0; i < m_Decrease.size(); i++)
+	{
+		sCoords Coords = m_Decrease[i].m_Coords;
+		NIBBLETYPE RemovedLight = m_Decrease[i].m_Light;
+		if (++m_NumVisited > MAX_VISITED_BLOCKS)
+		{
+			return false;
+		}
+
+		// If the block is a light source by itself, re-light it:
+		NIBBLETYPE Source = GetSourceLight(a_LightType, Coords);
+		if (Source > 0)
+		{
+			SetLight(a_LightType, Coords, Source);
+			m_Increase.push_back(Coords);
+		}
+
+		for (size_t n = 0; n < ARRAYCOUNT(g_NeighborOffsets); n++)
+		{
+			sCoords Neighbor(Coords.x + g_NeighborOffsets[n].x, Coords.y + g_NeighborOffsets[n].y, Coords.z + g_NeighborOffsets[n].z);
+			if ((Neighbor.y < 0) || (Neighbor.y >= cChunkDef::Height))
+			{
+				continue;
+			}
+			NIBBLETYPE NeighborLight = GetLight(a_LightType, Neighbor);
+			if (NeighborLight == 0)
+			{
+				continue;
+			}
+			if (NeighborLight < RemovedLight)
+			{
+				// The neighbor may have been lit by the removed light, remove its light, too:
+				SetLight(a_LightType, Neighbor, 0);
+				m_Decrease.push_back(sDecrease(Neighbor, NeighborLight));
+			}
+			else
+			{
+				// The neighbor has light from elsewhere, spread it back into the removed area:
+				m_Increase.push_back(Neighbor);
+			}
+		}
+	}
+
+	// Increase pass: spread the light from the queued blocks:
+	for (size_t i = 0; i < m_Increase.size(); i++)
+	{
+		sCoords Coords = m_Increase[i];
+		if (++m_NumVisited > MAX_VISITED_BLOCKS)
+		{
+			return false;
+		}
+		NIBBLETYPE Light = GetLight(a_LightType, Coords);
+		if (Light <= 1)
+		{
+			// Not enough light to spread anywhere
+			continue;
+		}
+		for (size_t n = 0; n < ARRAYCOUNT(g_NeighborOffsets); n++)
+		{
+			sCoords Neighbor(Coords.x + g_NeighborOffsets[n].x, Coords.y + g_NeighborOffsets[n].y, Coords.z + g_NeighborOffsets[n].z);
+			if ((Neighbor.y < 0) || (Neighbor.y >= cChunkDef::Height))
+			{
+				continue;
+			}
+			NIBBLETYPE Falloff = cBlockInfo::GetSpreadLightFalloff(GetBlockType(Neighbor));
+			if (Light <= GetLight(a_LightType, Neighbor) + Falloff)
+			{
+				// We're not offering more light than the neighbor already has
+				continue;
+			}
+			SetLight(a_LightType, Neighbor, Light - Falloff);
+			m_Increase.push_back(Neighbor);
+		}
+	}
+	return true;
+}
+
+
+
+
+
+int cLightUpdater::GetChunkIdx(int & a_RelX, int & a_RelZ) const
+{
+	if (
+		(a_RelX < -cChunkDef::Width) || (a_RelX >= 2 * cChunkDef::Width) ||
+		(a_RelZ < -cChunkDef::Width) || (a_RelZ >= 2 * cChunkDef::Width)
+	)
+	{
+		return -1;
+	}
+	int ChunkX = (a_RelX + cChunkDef::Width) / cChunkDef::Width;
+	int ChunkZ = (a_RelZ + cChunkDef::Width) / cChunkDef::Width;
+	a_RelX -= (ChunkX - 1) * cChunkDef::Width;
+	a_RelZ -= (ChunkZ - 1) * cChunkDef::Width;
+	return ChunkX + 3 * ChunkZ;
+}
+
+
+
+
+
+NIBBLETYPE cLightUpdater::GetLight(eLightType a_LightType, const sCoords & a_Coords) const
+{
+	int RelX = a_Coords.x;
+	int RelZ = a_Coords.z;
+	int Idx = GetChunkIdx(RelX, RelZ);
+	if (Idx < 0)
+	{
+		return 0;
+	}
+	const cChunkData & Data = *m_ChunkData[Idx];
+	return (a_LightType == ltBlock) ? Data.GetBlockLight(RelX, a_Coords.y, RelZ) : Data.GetSkyLight(RelX, a_Coords.y, RelZ);
+}
+
+
+
+
+
+void cLightUpdater::SetLight(eLightType a_LightType, const sCoords & a_Coords, NIBBLETYPE a_Light)
+{
+	int RelX = a_Coords.x;
+	int RelZ = a_Coords.z;
+	int Idx = GetChunkIdx(RelX, RelZ);
+	if (Idx < 0)
+	{
+		return;
+	}
+	bool HasChanged = (a_LightType == ltBlock) ?
+		m_ChunkData[Idx]->SetBlockLight(RelX, a_Coords.y, RelZ, a_Light) :
+		m_ChunkData[Idx]->SetSkyLight  (RelX, a_Coords.y, RelZ, a_Light);
+	if (HasChanged)
+	{
+		m_ModifiedChunks |= (1 << Idx);
+	}
+}
+
+
+
+
+
+NIBBLETYPE cLightUpdater::GetSourceLight(eLightType a_LightType, const sCoords & a_Coords) const
+{
+	int RelX = a_Coords.x;
+	int RelZ = a_Coords.z;
+	int Idx = GetChunkIdx(RelX, RelZ);
+	if (Idx < 0)
+	{
+		return 0;
+	}
+	if (a_LightType == ltBlock)
+	{
+		return cBlockInfo::GetLightValue(m_ChunkData[Idx]->GetBlock(RelX, a_Coords.y, RelZ));
+	}
+
+	// Skylight is full above the heightmap, same as in cLightingThread:
+	return (a_Coords.y > cChunkDef::GetHeight(*m_HeightMaps[Idx], RelX, RelZ)) ? 15 : 0;
+}
+
+
+
+
+
+BLOCKTYPE cLightUpdater::GetBlockType(const sCoords & a_Coords) const
+{
+	int RelX = a_Coords.x;
+	int RelZ = a_Coords.z;
+	int Idx = GetChunkIdx(RelX, RelZ);
+	if (Idx < 0)
+	{
+		return E_BLOCK_STONE;
+	}
+	return m_ChunkData[Idx]->GetBlock(RelX, a_Coords.y, RelZ);
+}
+
+
+
+
@@ -0,0 +1,132 @@
+
+// LightUpdater.h
+
+// Declares the cLightUpdater class that incrementally updates the light around a single changed block
+
+/*
+While cLightingThread lights whole chunks (reading the entire 3x3 chunk neighborhood), the cLightUpdater only
+visits the blocks that are affected by a single block change. It is used by cChunk on the tick thread, for
+block changes in chunks that already have valid light, so that placing a torch or breaking a block doesn't
+invalidate the light of the entire chunk.
+
+The update is done separately for the blocklight and the skylight, each in two BFS passes:
+1. Decrease: starting at the changed blocks, all the light that could have come from them is removed.
+	Blocks on the border of the removed area that still have light are queued for the increase pass,
+	as are any removed blocks that are light sources themselves.
+2. Increase: the light is spread from the queued blocks into their neighbors, the same way as in cLightingThread.
+
+Since light cannot travel further than 15 blocks, all the affected blocks lie within the 3x3 chunk
+neighborhood of the changed block. If any of those chunks is not available, or the update grows beyond
+the configured limit, the update fails and the caller falls back to relighting the chunk in cLightingThread.
+*/
+
+
+
+
+
+#pragma once
+
+#include "ChunkDef.h"
+
+
+
+
+
+// fwd: ChunkData.h
+class cChunkData;
+
+
+
+
+
+class cLightUpdater
+{
+public:
+
+	/** Maximum number of blocks that a single update may visit before giving up.
+	A single torch affects about 5000 blocks, a column of skylight under an overhang somewhat more. */
+	static const int MAX_VISITED_BLOCKS = 64 * 1024;
+
+	/** Creates a new updater for blocks in the specified chunk.
+	a_ChunkData and a_HeightMaps are the data of the 3x3 chunk neighborhood, indexed as [x + 3 * z], with the chunk itself at index 4.
+	All the chunks must be valid and have valid light. The updater writes the light directly into a_ChunkData. */
+	cLightUpdater(cChunkData * a_ChunkData[9], const cChunkDef::HeightMap * a_HeightMaps[9]);
+
+	/** Updates the light after the block at the specified coords (relative to the middle chunk) has changed.
+	a_OldHeight is the heightmap value of the block's column before the change.
+	Returns true if successful, false if the update was too large and the light in the chunks is not to be trusted. */
+	bool BlockChanged(int a_RelX, int a_RelY, int a_RelZ, int a_OldHeight);
+
+	/** Returns a bitmask of the chunks (indexed the same way as the neighbors in the constructor) whose light has been modified. */
+	int GetModifiedChunks(void) const { return m_ModifiedChunks; }
+
+protected:
+
+	/** Coords of a block in the 3x3 chunk neighborhood, relative to the middle chunk, x and z in range [-16, 32). */
+	struct sCoords
+	{
+		int x, y, z;
+
+		sCoords(int a_X, int a_Y, int a_Z) : x(a_X), y(a_Y), z(a_Z) {}
+	};
+
+	/** An item in the decrease queue - the block and the light level that has been removed from it. */
+	struct sDecrease
+	{
+		sCoords m_Coords;
+		NIBBLETYPE m_Light;
+
+		sDecrease(const sCoords & a_Coords, NIBBLETYPE a_Light) : m_Coords(a_Coords), m_Light(a_Light) {}
+	};
+
+	typedef std::vector<sCoords>   sCoordsVector;
+	typedef std::vector<sDecrease> sDecreaseVector;
+
+	/** The type of light being processed by UpdateLight() */
+	enum eLightType
+	{
+		ltBlock,
+		ltSky,
+	};
+
+	/** The data of the 3x3 chunk neighborhood, indexed as [x + 3 * z] */
+	cChunkData * m_ChunkData[9];
+
+	/** The heightmaps of the 3x3 chunk neighborhood, indexed as [x + 3 * z] */
+	const cChunkDef::HeightMap * m_HeightMaps[9];
+
+	/** Bitmask of the chunks whose light has been modified */
+	int m_ModifiedChunks;
+
+	/** Number of blocks visited so far by this update, checked against MAX_VISITED_BLOCKS */
+	int m_NumVisited;
+
+	// The BFS queues, kept as members so that their memory is reused between the passes:
+	sDecreaseVector m_Decrease;
+	sCoordsVector   m_Increase;
+
+
+	/** Runs both BFS passes for the specified light type, starting with the blocks in m_Decrease.
+	Returns false if the update has grown too large. */
+	bool UpdateLight(eLightType a_LightType);
+
+	/** Returns the index of the chunk containing the specified block into m_ChunkData and m_HeightMaps, or -1 if outside the 3x3 neighborhood.
+	Adjusts the coords to be relative to the returned chunk. */
+	int GetChunkIdx(int & a_RelX, int & a_RelZ) const;
+
+	/** Returns the light of the specified type at the specified coords, 0 if outside the neighborhood. */
+	NIBBLETYPE GetLight(eLightType a_LightType, const sCoords & a_Coords) const;
+
+	/** Sets the light of the specified type at the specified coords, marks the chunk as modified. */
+	void SetLight(eLightType a_LightType, const sCoords & a_Coords, NIBBLETYPE a_Light);
+
+	/** Returns the amount of light that the block at the specified coords emits by itself, for the specified light type. */
+	NIBBLETYPE GetSourceLight(eLightType a_LightType, const sCoords & a_Coords) const;
+
+	/** Returns the block type at the specified coords, E_BLOCK_STONE if outside the neighborhood. */
+	BLOCKTYPE GetBlockType(const sCoords & a_Coords) const;
+} ;
+
+
+
+
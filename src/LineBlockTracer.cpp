@@ -8,6 +8,7 @@
 #include "Vector3.h"
 #include "World.h"
 #include "Chunk.h"
+#include "BlockInfo.h"
 
 
 
@@ -59,7 +60,77 @@ bool cLineBlockTracer::Trace(cWorld & a_World, cBlockTracer::cCallbacks &a_Callb
 
 
 
+bool cLineBlockTracer::LineOfSightTrace(cChunk & a_Chunk, const Vector3d & a_Start, const Vector3d & a_End)
+{
+	class cSolidBlockCallbacks :
+		public cBlockTracer::cCallbacks
+	{
+		virtual bool OnNextBlock(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta, char a_EntryFace) override
+		{
+			UNUSED(a_BlockX);
+			UNUSED(a_BlockY);
+			UNUSED(a_BlockZ);
+			UNUSED(a_BlockMeta);
+			UNUSED(a_EntryFace);
+			return cBlockInfo::IsSolid(a_BlockType);
+		}
+
+		virtual bool OnNextBlockNoData(int a_BlockX, int a_BlockY, int a_BlockZ, char a_EntryFace) override
+		{
+			UNUSED(a_BlockX);
+			UNUSED(a_BlockY);
+			UNUSED(a_BlockZ);
+			UNUSED(a_EntryFace);
+			
+			// Cannot see through the chunks that aren't loaded yet:
+			return true;
+		}
+	} Callbacks;
+	cLineBlockTracer Tracer(*a_Chunk.GetWorld(), Callbacks);
+	return Tracer.Trace(a_Chunk, a_Start, a_End);
+}
+
+
+
+
+
 bool cLineBlockTracer::Trace(double a_StartX, double a_StartY, double a_StartZ, double a_EndX, double a_EndY, double a_EndZ)
+{
+	if (!InitTrace(a_StartX, a_StartY, a_StartZ, a_EndX, a_EndY, a_EndZ))
+	{
+		// Nothing to trace
+		return true;
+	}
+	
+	// The actual trace is handled with ChunkMapCS locked by calling our Item() for the specified chunk
+	int BlockX = (int)floor(m_StartX);
+	int BlockZ = (int)floor(m_StartZ);
+	int ChunkX, ChunkZ;
+	cChunkDef::BlockToChunk(BlockX, BlockZ, ChunkX, ChunkZ);
+	return m_World->DoWithChunk(ChunkX, ChunkZ, *this);
+}
+
+
+
+
+
+bool cLineBlockTracer::Trace(cChunk & a_Chunk, const Vector3d & a_Start, const Vector3d & a_End)
+{
+	if (!InitTrace(a_Start.x, a_Start.y, a_Start.z, a_End.x, a_End.y, a_End.z))
+	{
+		// Nothing to trace
+		return true;
+	}
+	
+	// The caller has the chunk locked in place, walk from it directly through its neighbors:
+	return Item(a_Chunk.GetNeighborChunk(m_CurrentX, m_CurrentZ));
+}
+
+
+
+
+
+bool cLineBlockTracer::InitTrace(double a_StartX, double a_StartY, double a_StartZ, double a_EndX, double a_EndY, double a_EndZ)
 {
 	// Initialize the member veriables:
 	m_StartX = a_StartX;
@@ -80,7 +151,7 @@ bool cLineBlockTracer::Trace(double a_StartX, double a_StartY, double a_StartZ,
 		{
 			// Nothing to trace
 			m_Callbacks->OnNoMoreHits();
-			return true;
+			return false;
 		}
 		FixStartBelowWorld();
 		m_Callbacks->OnIntoWorld(m_StartX, m_StartY, m_StartZ);
@@ -90,7 +161,7 @@ bool cLineBlockTracer::Trace(double a_StartX, double a_StartY, double a_StartZ,
 		if (m_EndY >= cChunkDef::Height)
 		{
 			m_Callbacks->OnNoMoreHits();
-			return true;
+			return false;
 		}
 		FixStartAboveWorld();
 		m_Callbacks->OnIntoWorld(m_StartX, m_StartY, m_StartZ);
@@ -103,13 +174,7 @@ bool cLineBlockTracer::Trace(double a_StartX, double a_StartY, double a_StartZ,
 	m_DiffX = m_EndX - m_StartX;
 	m_DiffY = m_EndY - m_StartY;
 	m_DiffZ = m_EndZ - m_StartZ;
-	
-	// The actual trace is handled with ChunkMapCS locked by calling our Item() for the specified chunk
-	int BlockX = (int)floor(m_StartX);
-	int BlockZ = (int)floor(m_StartZ);
-	int ChunkX, ChunkZ;
-	cChunkDef::BlockToChunk(BlockX, BlockZ, ChunkX, ChunkZ);
-	return m_World->DoWithChunk(ChunkX, ChunkZ, *this);
+	return true;
 }
 
 
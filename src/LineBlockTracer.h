@@ -37,6 +37,10 @@ public:
 	
 	/// Traces one line between Start and End; returns true if the entire line was traced (until OnNoMoreHits())
 	bool Trace(double a_StartX, double a_StartY, double a_StartZ, double a_EndX, double a_EndY, double a_EndZ);
+	
+	/** Traces one line between Start and End, starting from a_Chunk and walking its neighbors, without locking the chunkmap.
+	a_Chunk must stay valid for the duration of the call. Returns true if the entire line was traced (until OnNoMoreHits()) */
+	bool Trace(cChunk & a_Chunk, const Vector3d & a_Start, const Vector3d & a_End);
 
 	// Utility functions for simple one-line usage:
 	/// Traces one line between Start and End; returns true if the entire line was traced (until OnNoMoreHits())
@@ -45,6 +49,11 @@ public:
 	/// Traces one line between Start and End; returns true if the entire line was traced (until OnNoMoreHits())
 	static bool Trace(cWorld & a_World, cCallbacks & a_Callbacks, const Vector3d & a_Start, const Vector3d & a_End);
 	
+	/** Returns true if there are no solid blocks on the line between Start and End.
+	The trace walks the chunk data directly from a_Chunk through its neighbors, instead of looking each block up in the world.
+	a_Chunk must stay valid for the duration of the call, such as the chunk being ticked; the unloaded chunks block the line. */
+	static bool LineOfSightTrace(cChunk & a_Chunk, const Vector3d & a_Start, const Vector3d & a_End);
+	
 protected:
 	// The start point of the trace
 	double m_StartX, m_StartY, m_StartZ;
@@ -65,6 +74,10 @@ protected:
 	char m_CurrentFace;
 
 	
+	/** Initializes the member variables for tracing the line between Start and End.
+	Returns false if there is nothing to trace (the line is entirely outside the world), OnNoMoreHits() has been called in such a case. */
+	bool InitTrace(double a_StartX, double a_StartY, double a_StartZ, double a_EndX, double a_EndY, double a_EndZ);
+	
 	/// Adjusts the start point above the world to just at the world's top
 	void FixStartAboveWorld(void);
 	
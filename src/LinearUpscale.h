@@ -21,6 +21,11 @@ been interspersed into the array to the cell boundaries.
 Specifically, a_Array[x * AnchorStepX + y * AnchorStepY] contains the anchor value.
 
 Regular upscaling takes two arrays and "moves" the input from src to dst; src is expected packed.
+It computes each dst value exactly once, row by row, from the last cell that contains it (the cells share
+their border values). For the common X upscale factors (4, 8 and 16) the rows are processed by template
+instances with a compile-time factor; the fixed-length loops along X are then unrolled and vectorized
+by the compiler, using whatever SIMD instructions the build targets (SSE2 at least on x64, AVX2 with
+-march=native). The arithmetic is the same for all the instances, so the results are bit-identical.
 */
 
 
@@ -82,8 +87,10 @@ void LinearUpscale2DArrayInPlace(TYPE * a_Array)
 /**
 Linearly interpolates values in the array between the equidistant anchor points (upscales).
 Works on two arrays, input is packed and output is to be completely constructed.
+If FixedUpscaleX is nonzero, it is the X upscale factor known at compile time and must be equal to a_UpscaleX.
+Use LinearUpscale2DArray(), which picks the proper instance.
 */
-template <typename TYPE> void LinearUpscale2DArray(
+template <int FixedUpscaleX, typename TYPE> void LinearUpscale2DArrayImpl(
 	TYPE * a_Src,                    ///< Source array of size a_SrcSizeX x a_SrcSizeY
 	int a_SrcSizeX, int a_SrcSizeY,  ///< Dimensions of the src array
 	TYPE * a_Dst,                    ///< Dest array, of size (a_SrcSizeX * a_UpscaleX + 1) x (a_SrcSizeY * a_UpscaleY + 1)
@@ -97,52 +104,59 @@ template <typename TYPE> void LinearUpscale2DArray(
 
 	ASSERT(a_Src != nullptr);
 	ASSERT(a_Dst != nullptr);
-	ASSERT(a_SrcSizeX > 0);
-	ASSERT(a_SrcSizeY > 0);
+	ASSERT(a_SrcSizeX > 1);
+	ASSERT(a_SrcSizeY > 1);
 	ASSERT(a_UpscaleX > 0);
 	ASSERT(a_UpscaleY > 0);
 	ASSERT(a_UpscaleX <= MAX_UPSCALE_X);
 	ASSERT(a_UpscaleY <= MAX_UPSCALE_Y);
+	ASSERT((FixedUpscaleX == 0) || (FixedUpscaleX == a_UpscaleX));
+	const int UpscaleX = (FixedUpscaleX > 0) ? FixedUpscaleX : a_UpscaleX;
 
 	// Pre-calculate the upscaling ratios:
-	TYPE RatioX[MAX_UPSCALE_X];
-	TYPE RatioY[MAX_UPSCALE_Y];
-	for (int x = 0; x <= a_UpscaleX; x++)
+	TYPE RatioX[MAX_UPSCALE_X + 1];
+	TYPE RatioY[MAX_UPSCALE_Y + 1];
+	for (int x = 0; x <= UpscaleX; x++)
 	{
-		RatioX[x] = (TYPE)x / a_UpscaleX;
+		RatioX[x] = (TYPE)x / UpscaleX;
 	}
 	for (int y = 0; y <= a_UpscaleY; y++)
 	{
 		RatioY[y] = (TYPE)y / a_UpscaleY;
 	}
 
-	// Interpolate each XY cell:
-	int DstSizeX = (a_SrcSizeX - 1) * a_UpscaleX + 1;
+	// Interpolate each dst row; the rows on the cell borders belong to the upper cell, except for the very last row:
+	int DstSizeX = (a_SrcSizeX - 1) * UpscaleX + 1;
 	int DstSizeY = (a_SrcSizeY - 1) * a_UpscaleY + 1;
-	for (int y = 0; y < (a_SrcSizeY - 1); y++)
+	int LastCellX = a_SrcSizeX - 2;
+	for (int DstY = 0; DstY < DstSizeY; DstY++)
 	{
-		int DstY = y * a_UpscaleY;
-		int idx = y * a_SrcSizeX;
-		for (int x = 0; x < (a_SrcSizeX - 1); x++, idx++)
+		int y = std::min(DstY / a_UpscaleY, a_SrcSizeY - 2);
+		int CellY = DstY - y * a_UpscaleY;
+		const TYPE * SrcRow = a_Src + y * a_SrcSizeX;
+		TYPE * DstRow = a_Dst + DstY * DstSizeX;
+		for (int x = 0; x <= LastCellX; x++)
 		{
-			int DstX = x * a_UpscaleX;
-			TYPE LoXLoY = a_Src[idx];
-			TYPE LoXHiY = a_Src[idx + a_SrcSizeX];
-			TYPE HiXLoY = a_Src[idx + 1];
-			TYPE HiXHiY = a_Src[idx + 1 + a_SrcSizeX];
-			for (int CellY = 0; CellY <= a_UpscaleY; CellY++)
+			TYPE LoXLoY = SrcRow[x];
+			TYPE LoXHiY = SrcRow[x + a_SrcSizeX];
+			TYPE HiXLoY = SrcRow[x + 1];
+			TYPE HiXHiY = SrcRow[x + 1 + a_SrcSizeX];
+			TYPE LoXInY = LoXLoY + (LoXHiY - LoXLoY) * RatioY[CellY];
+			TYPE HiXInY = HiXLoY + (HiXHiY - HiXLoY) * RatioY[CellY];
+			TYPE DiffX = HiXInY - LoXInY;
+
+			// The cell's last column belongs to the next cell, except for the last cell:
+			TYPE * Dst = DstRow + x * UpscaleX;
+			for (int CellX = 0; CellX < UpscaleX; CellX++)
 			{
-				int DestIdx = (DstY + CellY) * DstSizeX + DstX;
-				ASSERT(DestIdx + a_UpscaleX < DstSizeX * DstSizeY);
-				TYPE LoXInY = LoXLoY + (LoXHiY - LoXLoY) * RatioY[CellY];
-				TYPE HiXInY = HiXLoY + (HiXHiY - HiXLoY) * RatioY[CellY];
-				for (int CellX = 0; CellX <= a_UpscaleX; CellX++, DestIdx++)
-				{
-					a_Dst[DestIdx] = LoXInY + (HiXInY - LoXInY) * RatioX[CellX];
-				}
-			}  // for CellY
+				Dst[CellX] = LoXInY + DiffX * RatioX[CellX];
+			}
+			if (x == LastCellX)
+			{
+				Dst[UpscaleX] = LoXInY + DiffX * RatioX[UpscaleX];
+			}
 		}  // for x
-	}  // for y
+	}  // for DstY
 }
 
 
@@ -153,7 +167,33 @@ template <typename TYPE> void LinearUpscale2DArray(
 Linearly interpolates values in the array between the equidistant anchor points (upscales).
 Works on two arrays, input is packed and output is to be completely constructed.
 */
-template <typename TYPE> void LinearUpscale3DArray(
+template <typename TYPE> void LinearUpscale2DArray(
+	TYPE * a_Src,                    ///< Source array of size a_SrcSizeX x a_SrcSizeY
+	int a_SrcSizeX, int a_SrcSizeY,  ///< Dimensions of the src array
+	TYPE * a_Dst,                    ///< Dest array, of size (a_SrcSizeX * a_UpscaleX + 1) x (a_SrcSizeY * a_UpscaleY + 1)
+	int a_UpscaleX, int a_UpscaleY   ///< Upscale factor for each direction
+)
+{
+	switch (a_UpscaleX)
+	{
+		case 4:  LinearUpscale2DArrayImpl<4> (a_Src, a_SrcSizeX, a_SrcSizeY, a_Dst, a_UpscaleX, a_UpscaleY); return;
+		case 8:  LinearUpscale2DArrayImpl<8> (a_Src, a_SrcSizeX, a_SrcSizeY, a_Dst, a_UpscaleX, a_UpscaleY); return;
+		case 16: LinearUpscale2DArrayImpl<16>(a_Src, a_SrcSizeX, a_SrcSizeY, a_Dst, a_UpscaleX, a_UpscaleY); return;
+	}
+	LinearUpscale2DArrayImpl<0>(a_Src, a_SrcSizeX, a_SrcSizeY, a_Dst, a_UpscaleX, a_UpscaleY);
+}
+
+
+
+
+
+/**
+Linearly interpolates values in the array between the equidistant anchor points (upscales).
+Works on two arrays, input is packed and output is to be completely constructed.
+If FixedUpscaleX is nonzero, it is the X upscale factor known at compile time and must be equal to a_UpscaleX.
+Use LinearUpscale3DArray(), which picks the proper instance.
+*/
+template <int FixedUpscaleX, typename TYPE> void LinearUpscale3DArrayImpl(
 	TYPE * a_Src,                                    ///< Source array of size a_SrcSizeX x a_SrcSizeY x a_SrcSizeZ
 	int a_SrcSizeX, int a_SrcSizeY, int a_SrcSizeZ,  ///< Dimensions of the src array
 	TYPE * a_Dst,                                    ///< Dest array, of size (a_SrcSizeX * a_UpscaleX + 1) x (a_SrcSizeY * a_UpscaleY + 1) x (a_SrcSizeZ * a_UpscaleZ + 1)
@@ -168,23 +208,25 @@ template <typename TYPE> void LinearUpscale3DArray(
 
 	ASSERT(a_Src != nullptr);
 	ASSERT(a_Dst != nullptr);
-	ASSERT(a_SrcSizeX > 0);
-	ASSERT(a_SrcSizeY > 0);
-	ASSERT(a_SrcSizeZ > 0);
+	ASSERT(a_SrcSizeX > 1);
+	ASSERT(a_SrcSizeY > 1);
+	ASSERT(a_SrcSizeZ > 1);
 	ASSERT(a_UpscaleX > 0);
 	ASSERT(a_UpscaleY > 0);
 	ASSERT(a_UpscaleZ > 0);
 	ASSERT(a_UpscaleX <= MAX_UPSCALE_X);
 	ASSERT(a_UpscaleY <= MAX_UPSCALE_Y);
 	ASSERT(a_UpscaleZ <= MAX_UPSCALE_Z);
+	ASSERT((FixedUpscaleX == 0) || (FixedUpscaleX == a_UpscaleX));
+	const int UpscaleX = (FixedUpscaleX > 0) ? FixedUpscaleX : a_UpscaleX;
 
 	// Pre-calculate the upscaling ratios:
-	TYPE RatioX[MAX_UPSCALE_X];
-	TYPE RatioY[MAX_UPSCALE_Y];
-	TYPE RatioZ[MAX_UPSCALE_Z];
-	for (int x = 0; x <= a_UpscaleX; x++)
+	TYPE RatioX[MAX_UPSCALE_X + 1];
+	TYPE RatioY[MAX_UPSCALE_Y + 1];
+	TYPE RatioZ[MAX_UPSCALE_Z + 1];
+	for (int x = 0; x <= UpscaleX; x++)
 	{
-		RatioX[x] = (TYPE)x / a_UpscaleX;
+		RatioX[x] = (TYPE)x / UpscaleX;
 	}
 	for (int y = 0; y <= a_UpscaleY; y++)
 	{
@@ -195,52 +237,83 @@ template <typename TYPE> void LinearUpscale3DArray(
 		RatioZ[z] = (TYPE)z / a_UpscaleZ;
 	}
 
-	// Interpolate each XYZ cell:
-	int DstSizeX = (a_SrcSizeX - 1) * a_UpscaleX + 1;
+	// The values interpolated in Z along the four X-parallel edges of each cell in the current row of cells:
+	int NumCellsX = a_SrcSizeX - 1;
+	std::vector<TYPE> InZ(4 * static_cast<size_t>(NumCellsX));
+	TYPE * LoXLoYInZ = &InZ[0];
+	TYPE * LoXHiYInZ = LoXLoYInZ + NumCellsX;
+	TYPE * HiXLoYInZ = LoXHiYInZ + NumCellsX;
+	TYPE * HiXHiYInZ = HiXLoYInZ + NumCellsX;
+
+	// Interpolate each dst row; the points on the cell borders belong to the upper cell, except for the very last ones:
+	int DstSizeX = (a_SrcSizeX - 1) * UpscaleX + 1;
 	int DstSizeY = (a_SrcSizeY - 1) * a_UpscaleY + 1;
 	int DstSizeZ = (a_SrcSizeZ - 1) * a_UpscaleZ + 1;
-	for (int z = 0; z < (a_SrcSizeZ - 1); z++)
+	int SrcSizeXY = a_SrcSizeX * a_SrcSizeY;
+	for (int DstZ = 0; DstZ < DstSizeZ; DstZ++)
 	{
-		int DstZ = z * a_UpscaleZ;
+		int z = std::min(DstZ / a_UpscaleZ, a_SrcSizeZ - 2);
+		int CellZ = DstZ - z * a_UpscaleZ;
 		for (int y = 0; y < (a_SrcSizeY - 1); y++)
 		{
-			int DstY = y * a_UpscaleY;
-			int idx = y * a_SrcSizeX + z * a_SrcSizeX * a_SrcSizeY;
-			for (int x = 0; x < (a_SrcSizeX - 1); x++, idx++)
+			const TYPE * Src = a_Src + y * a_SrcSizeX + z * SrcSizeXY;
+			for (int x = 0; x < NumCellsX; x++)
+			{
+				LoXLoYInZ[x] = Src[x]                  + (Src[x + SrcSizeXY]                  - Src[x])                  * RatioZ[CellZ];
+				LoXHiYInZ[x] = Src[x + a_SrcSizeX]     + (Src[x + a_SrcSizeX + SrcSizeXY]     - Src[x + a_SrcSizeX])     * RatioZ[CellZ];
+				HiXLoYInZ[x] = Src[x + 1]              + (Src[x + 1 + SrcSizeXY]              - Src[x + 1])              * RatioZ[CellZ];
+				HiXHiYInZ[x] = Src[x + 1 + a_SrcSizeX] + (Src[x + 1 + a_SrcSizeX + SrcSizeXY] - Src[x + 1 + a_SrcSizeX]) * RatioZ[CellZ];
+			}
+			int LastCellY = (y == a_SrcSizeY - 2) ? a_UpscaleY : a_UpscaleY - 1;
+			for (int CellY = 0; CellY <= LastCellY; CellY++)
 			{
-				int DstX = x * a_UpscaleX;
-				TYPE LoXLoYLoZ = a_Src[idx];
-				TYPE LoXLoYHiZ = a_Src[idx + a_SrcSizeX * a_SrcSizeY];
-				TYPE LoXHiYLoZ = a_Src[idx + a_SrcSizeX];
-				TYPE LoXHiYHiZ = a_Src[idx + a_SrcSizeX + a_SrcSizeX * a_SrcSizeY];
-				TYPE HiXLoYLoZ = a_Src[idx + 1];
-				TYPE HiXLoYHiZ = a_Src[idx + 1 + a_SrcSizeX * a_SrcSizeY];
-				TYPE HiXHiYLoZ = a_Src[idx + 1 + a_SrcSizeX];
-				TYPE HiXHiYHiZ = a_Src[idx + 1 + a_SrcSizeX + a_SrcSizeX * a_SrcSizeY];
-				for (int CellZ = 0; CellZ <= a_UpscaleZ; CellZ++)
+				TYPE * DstRow = a_Dst + DstZ * DstSizeX * DstSizeY + (y * a_UpscaleY + CellY) * DstSizeX;
+				for (int x = 0; x < NumCellsX; x++)
 				{
-					TYPE LoXLoYInZ = LoXLoYLoZ + (LoXLoYHiZ - LoXLoYLoZ) * RatioZ[CellZ];
-					TYPE LoXHiYInZ = LoXHiYLoZ + (LoXHiYHiZ - LoXHiYLoZ) * RatioZ[CellZ];
-					TYPE HiXLoYInZ = HiXLoYLoZ + (HiXLoYHiZ - HiXLoYLoZ) * RatioZ[CellZ];
-					TYPE HiXHiYInZ = HiXHiYLoZ + (HiXHiYHiZ - HiXHiYLoZ) * RatioZ[CellZ];
-					for (int CellY = 0; CellY <= a_UpscaleY; CellY++)
+					TYPE LoXInY = LoXLoYInZ[x] + (LoXHiYInZ[x] - LoXLoYInZ[x]) * RatioY[CellY];
+					TYPE HiXInY = HiXLoYInZ[x] + (HiXHiYInZ[x] - HiXLoYInZ[x]) * RatioY[CellY];
+					TYPE DiffX = HiXInY - LoXInY;
+
+					// The cell's last column belongs to the next cell, except for the last cell:
+					TYPE * Dst = DstRow + x * UpscaleX;
+					for (int CellX = 0; CellX < UpscaleX; CellX++)
+					{
+						Dst[CellX] = LoXInY + DiffX * RatioX[CellX];
+					}
+					if (x == NumCellsX - 1)
 					{
-						int DestIdx = (DstZ + CellZ) * DstSizeX * DstSizeY + (DstY + CellY) * DstSizeX + DstX;
-						ASSERT(DestIdx + a_UpscaleX < DstSizeX * DstSizeY * DstSizeZ);
-						TYPE LoXInY = LoXLoYInZ + (LoXHiYInZ - LoXLoYInZ) * RatioY[CellY];
-						TYPE HiXInY = HiXLoYInZ + (HiXHiYInZ - HiXLoYInZ) * RatioY[CellY];
-						for (int CellX = 0; CellX <= a_UpscaleX; CellX++, DestIdx++)
-						{
-							a_Dst[DestIdx] = LoXInY + (HiXInY - LoXInY) * RatioX[CellX];
-						}
-					}  // for CellY
-				}  // for CellZ
-			}  // for x
+						Dst[UpscaleX] = LoXInY + DiffX * RatioX[UpscaleX];
+					}
+				}  // for x
+			}  // for CellY
 		}  // for y
-	}  // for z
+	}  // for DstZ
 }
 
 
 
 
 
+/**
+Linearly interpolates values in the array between the equidistant anchor points (upscales).
+Works on two arrays, input is packed and output is to be completely constructed.
+*/
+template <typename TYPE> void LinearUpscale3DArray(
+	TYPE * a_Src,                                    ///< Source array of size a_SrcSizeX x a_SrcSizeY x a_SrcSizeZ
+	int a_SrcSizeX, int a_SrcSizeY, int a_SrcSizeZ,  ///< Dimensions of the src array
+	TYPE * a_Dst,                                    ///< Dest array, of size (a_SrcSizeX * a_UpscaleX + 1) x (a_SrcSizeY * a_UpscaleY + 1) x (a_SrcSizeZ * a_UpscaleZ + 1)
+	int a_UpscaleX, int a_UpscaleY, int a_UpscaleZ   ///< Upscale factor for each direction
+)
+{
+	switch (a_UpscaleX)
+	{
+		case 4:  LinearUpscale3DArrayImpl<4> (a_Src, a_SrcSizeX, a_SrcSizeY, a_SrcSizeZ, a_Dst, a_UpscaleX, a_UpscaleY, a_UpscaleZ); return;
+		case 8:  LinearUpscale3DArrayImpl<8> (a_Src, a_SrcSizeX, a_SrcSizeY, a_SrcSizeZ, a_Dst, a_UpscaleX, a_UpscaleY, a_UpscaleZ); return;
+		case 16: LinearUpscale3DArrayImpl<16>(a_Src, a_SrcSizeX, a_SrcSizeY, a_SrcSizeZ, a_Dst, a_UpscaleX, a_UpscaleY, a_UpscaleZ); return;
+	}
+	LinearUpscale3DArrayImpl<0>(a_Src, a_SrcSizeX, a_SrcSizeY, a_SrcSizeZ, a_Dst, a_UpscaleX, a_UpscaleY, a_UpscaleZ);
+}
+
+
+
+
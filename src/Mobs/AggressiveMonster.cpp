@@ -5,7 +5,7 @@
 
 #include "../World.h"
 #include "../Entities/Player.h"
-#include "../Tracer.h"
+#include "../LineBlockTracer.h"
 
 
 
@@ -69,9 +69,9 @@ void cAggressiveMonster::Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 	{
 		CheckEventLostPlayer();
 	}
-	else
+	else if (((GetTicksAlive() + GetUniqueID()) % SIGHT_CHECK_INTERVAL) == 0)
 	{
-		CheckEventSeePlayer();
+		CheckEventSeePlayer(a_Chunk);
 	}
 
 	if (m_Target == nullptr)
@@ -79,10 +79,8 @@ void cAggressiveMonster::Tick(std::chrono::milliseconds a_Dt, cChunk & a_Chunk)
 		return;
 	}
 
-	cTracer LineOfSight(GetWorld());
-	Vector3d AttackDirection(m_Target->GetPosition() - GetPosition());
-
-	if (ReachedFinalDestination() && !LineOfSight.Trace(GetPosition(), AttackDirection, (int)AttackDirection.Length()))
+	Vector3d TargetCenter = m_Target->GetPosition() + Vector3d(0, m_Target->GetHeight() / 2, 0);
+	if (ReachedFinalDestination() && cLineBlockTracer::LineOfSightTrace(a_Chunk, GetEyePosition(), TargetCenter))
 	{
 		// Attack if reached destination, target isn't null, and have a clear line of sight to target (so won't attack through walls)
 		Attack(a_Dt / 1000);
@@ -13,6 +13,9 @@ class cAggressiveMonster :
 	typedef cMonster super;
 	
 public:
+	/** Number of ticks between two looks for a player to target. Each mob looks in a different tick, to spread the sight checks over the ticks. */
+	static const int SIGHT_CHECK_INTERVAL = 4;
+	
 
 	cAggressiveMonster(const AString & a_ConfigName, eMonsterType a_MobType, const AString & a_SoundHurt, const AString & a_SoundDeath, double a_Width, double a_Height);
 
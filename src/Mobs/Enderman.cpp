@@ -3,7 +3,7 @@
 
 #include "Enderman.h"
 #include "../Entities/Player.h"
-#include "../Tracer.h"
+#include "../LineBlockTracer.h"
 
 
 
@@ -14,48 +14,33 @@ class cPlayerLookCheck :
 	public cPlayerListCallback
 {
 public:
-	cPlayerLookCheck(Vector3d a_EndermanPos, int a_SightDistance) :
+	cPlayerLookCheck(cChunk & a_Chunk, const Vector3d & a_EndermanEyes) :
 		m_Player(nullptr),
-		m_EndermanPos(a_EndermanPos),
-		m_SightDistance(a_SightDistance)
+		m_Chunk(a_Chunk),
+		m_EndermanEyes(a_EndermanEyes)
 	{
 	}
 
 	virtual bool Item(cPlayer * a_Player) override
 	{
-		// Don't check players who are in creative gamemode
-		if (a_Player->IsGameModeCreative())
-		{
-			return false;
-		}
-		
-		Vector3d Direction = m_EndermanPos - a_Player->GetPosition();
-		
-		// Don't check players who are more then SightDistance (64) blocks away
-		if (Direction.Length() > m_SightDistance)
-		{
-			return false;
-		}
-		
 		// Don't check if the player has a pumpkin on his head
 		if (a_Player->GetEquippedHelmet().m_ItemType == E_BLOCK_PUMPKIN)
 		{
 			return false;
 		}
 
-		
-		Vector3d LookVector = a_Player->GetLookVector();
-		double dot = Direction.Dot(LookVector);
+		Vector3d PlayerEyes = a_Player->GetEyePosition();
+		Vector3d Direction = m_EndermanEyes - PlayerEyes;
+		Direction.Normalize();
 		
 		// 0.09 rad ~ 5 degrees
 		// If the player's crosshair is within 5 degrees of the enderman, it counts as looking
-		if (dot <= cos(0.09))
+		if (Direction.Dot(a_Player->GetLookVector()) <= cos(0.09))
 		{
 			return false;
 		}
 		
-		cTracer LineOfSight(a_Player->GetWorld());
-		if (LineOfSight.Trace(m_EndermanPos, Direction, (int)Direction.Length()))
+		if (!cLineBlockTracer::LineOfSightTrace(m_Chunk, m_EndermanEyes, PlayerEyes))
 		{
 			// No direct line of sight
 			return false;
@@ -69,8 +54,8 @@ public:
 
 protected:
 	cPlayer * m_Player;
-	Vector3d m_EndermanPos;
-	int m_SightDistance;
+	cChunk & m_Chunk;
+	Vector3d m_EndermanEyes;
 } ;
 
 
@@ -102,15 +87,16 @@ void cEnderman::GetDrops(cItems & a_Drops, cEntity * a_Killer)
 
 
 
-void cEnderman::CheckEventSeePlayer()
+void cEnderman::CheckEventSeePlayer(cChunk & a_Chunk)
 {
 	if (m_Target != nullptr)
 	{
 		return;
 	}
 
-	cPlayerLookCheck Callback(GetPosition(), m_SightDistance);
-	if (m_World->ForEachPlayer(Callback))
+	// The creative players and the players farther than the sight distance (64) are skipped by the world:
+	cPlayerLookCheck Callback(a_Chunk, GetEyePosition());
+	if (m_World->ForEachTargetablePlayerInRange(GetPosition(), m_SightDistance, Callback))
 	{
 		return;
 	}
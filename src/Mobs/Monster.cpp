@@ -12,6 +12,7 @@
 
 #include "../Chunk.h"
 #include "../FastRandom.h"
+#include "../LineBlockTracer.h"
 
 
 
@@ -583,14 +584,46 @@ void cMonster::OnRightClicked(cPlayer & a_Player)
 
 // Checks to see if EventSeePlayer should be fired
 // monster sez: Do I see the player
-void cMonster::CheckEventSeePlayer(void)
+void cMonster::CheckEventSeePlayer(cChunk & a_Chunk)
 {
-	// TODO: Rewrite this to use cWorld's DoWithPlayers()
-	cPlayer * Closest = m_World->FindClosestPlayer(GetPosition(), (float)m_SightDistance, false);
+	/** Finds the closest player in the line of sight; the line is traced only for the players closer than the closest one found so far. */
+	class cClosestVisiblePlayer :
+		public cPlayerListCallback
+	{
+	public:
+		cClosestVisiblePlayer(cChunk & a_Chunk, const Vector3d & a_EyePosition) :
+			m_Chunk(a_Chunk),
+			m_EyePosition(a_EyePosition),
+			m_Closest(nullptr),
+			m_ClosestDistanceSq(std::numeric_limits<double>::max())
+		{
+		}
+
+		virtual bool Item(cPlayer * a_Player) override
+		{
+			Vector3d PlayerEyes = a_Player->GetEyePosition();
+			double DistanceSq = (PlayerEyes - m_EyePosition).SqrLength();
+			if ((DistanceSq < m_ClosestDistanceSq) && cLineBlockTracer::LineOfSightTrace(m_Chunk, m_EyePosition, PlayerEyes))
+			{
+				m_Closest = a_Player;
+				m_ClosestDistanceSq = DistanceSq;
+			}
+			return false;
+		}
+
+		cPlayer * GetClosest(void) const { return m_Closest; }
+
+	protected:
+		cChunk & m_Chunk;
+		Vector3d m_EyePosition;
+		cPlayer * m_Closest;
+		double m_ClosestDistanceSq;
+	} Callback(a_Chunk, GetEyePosition());
 
-	if (Closest != nullptr)
+	m_World->ForEachTargetablePlayerInRange(GetPosition(), m_SightDistance, Callback);
+	if (Callback.GetClosest() != nullptr)
 	{
-		EventSeePlayer(Closest);
+		EventSeePlayer(Callback.GetClosest());
 	}
 }
 
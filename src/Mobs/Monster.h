@@ -68,9 +68,14 @@ public:
 	eFamily GetMobFamily(void) const;
 	// tolua_end
 
-	virtual void CheckEventSeePlayer(void);
+	/** Looks for the closest player within the sight distance that the mob can see, and fires EventSeePlayer() if there is one.
+	a_Chunk is the chunk being ticked, the line of sight is traced from it. */
+	virtual void CheckEventSeePlayer(cChunk & a_Chunk);
 	virtual void EventSeePlayer(cEntity * a_Player);
 
+	/** Returns the position of the mob's eyes, from where it looks for the players. */
+	Vector3d GetEyePosition(void) const { return GetPosition() + Vector3d(0, GetHeight() * 0.85, 0); }
+
 	/// Reads the monster configuration for the specified monster name and assigns it to this object.
 	void GetMonsterConfig(const AString & a_Name);
 
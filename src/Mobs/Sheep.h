@@ -33,10 +33,10 @@ public:
 	static NIBBLETYPE GenerateNaturalRandomColor(void);
 
 	bool IsSheared(void) const { return m_IsSheared; }
-	void SetSheared(bool a_IsSheared) { m_IsSheared = a_IsSheared; }
+	void SetSheared(bool a_IsSheared) { m_IsSheared = a_IsSheared; InvalidateSpawnPackets(); }
 
 	int GetFurColor(void) const { return m_WoolColor; }
-	void SetFurColor(int a_WoolColor) { m_WoolColor = a_WoolColor; }
+	void SetFurColor(int a_WoolColor) { m_WoolColor = a_WoolColor; InvalidateSpawnPackets(); }
 
 private:
 	bool m_IsSheared;
@@ -19,7 +19,7 @@ public:
 
 	unsigned int GetWitherInvulnerableTicks(void) const { return m_WitherInvulnerableTicks; }
 
-	void SetWitherInvulnerableTicks(unsigned int a_Ticks) { m_WitherInvulnerableTicks = a_Ticks; }
+	void SetWitherInvulnerableTicks(unsigned int a_Ticks) { m_WitherInvulnerableTicks = a_Ticks; InvalidateSpawnPackets(); }
 
 	/** Returns whether the wither is invulnerable to arrows. */
 	bool IsArmored(void) const;
@@ -34,15 +34,16 @@ public:
 	int     GetCollarColor(void) const { return m_CollarColor; }
 
 	// Set functions
-	void SetIsSitting  (bool a_IsSitting)   { m_IsSitting = a_IsSitting; }
-	void SetIsTame     (bool a_IsTame)      { m_IsTame = a_IsTame; }
-	void SetIsBegging  (bool a_IsBegging)   { m_IsBegging = a_IsBegging; }
-	void SetIsAngry    (bool a_IsAngry)     { m_IsAngry = a_IsAngry; }
-	void SetCollarColor(int a_CollarColor)  { m_CollarColor = a_CollarColor; }
+	void SetIsSitting  (bool a_IsSitting)   { m_IsSitting = a_IsSitting; InvalidateSpawnPackets(); }
+	void SetIsTame     (bool a_IsTame)      { m_IsTame = a_IsTame; InvalidateSpawnPackets(); }
+	void SetIsBegging  (bool a_IsBegging)   { m_IsBegging = a_IsBegging; InvalidateSpawnPackets(); }
+	void SetIsAngry    (bool a_IsAngry)     { m_IsAngry = a_IsAngry; InvalidateSpawnPackets(); }
+	void SetCollarColor(int a_CollarColor)  { m_CollarColor = a_CollarColor; InvalidateSpawnPackets(); }
 	void SetOwner      (const AString & a_NewOwnerName, const AString & a_NewOwnerUUID)
 	{
 		m_OwnerName = a_NewOwnerName;
 		m_OwnerUUID = a_NewOwnerUUID;
+		InvalidateSpawnPackets();
 	}
 
 protected:
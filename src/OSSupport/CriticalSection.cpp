@@ -6,15 +6,82 @@
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+// cCriticalSection::sStatsCounters:
+
+/** The counters shared by all the CSs of the same name. Updated concurrently by the lock owners and the waiters, hence atomic. */
+struct cCriticalSection::sStatsCounters
+{
+	std::atomic<UInt64> m_NumAcquires;
+	std::atomic<UInt64> m_NumContended;
+	std::atomic<UInt64> m_WaitNSec;
+	std::atomic<UInt64> m_MaxWaitNSec;
+	std::atomic<UInt64> m_HoldNSec;
+
+	sStatsCounters(void) :
+		m_NumAcquires(0),
+		m_NumContended(0),
+		m_WaitNSec(0),
+		m_MaxWaitNSec(0),
+		m_HoldNSec(0)
+	{
+	}
+} ;
+
+/** Map of name -> counters. The counters are never removed, so the CSs may keep pointers to them.
+Guarded by a plain mutex, a cCriticalSection cannot be used for its own bookkeeping.
+Both are intentionally leaked, the static CSs may still be locked during the static destruction. */
+typedef std::map<std::string, cCriticalSection::sStatsCounters> cStatsCountersMap;
+
+static std::mutex & GetStatsMutex(void)
+{
+	static std::mutex * Mutex = new std::mutex;
+	return *Mutex;
+}
+
+static cStatsCountersMap & GetStatsMap(void)
+{
+	static cStatsCountersMap * Map = new cStatsCountersMap;
+	return *Map;
+}
+
+/** The slot where the calling thread publishes the CS it is blocked on, see cCriticalSection::SetThreadWaitSlot().
+A plain pointer in the thread-local storage, the compilers we support don't all have the C++11 thread_local yet. */
+#ifdef _MSC_VER
+	static __declspec(thread) std::atomic<const cCriticalSection *> * g_ThreadWaitSlot = nullptr;
+#else
+	static __thread std::atomic<const cCriticalSection *> * g_ThreadWaitSlot = nullptr;
+#endif
+
+/** Returns the nanoseconds elapsed since a_Start */
+static UInt64 NSecSince(std::chrono::steady_clock::time_point a_Start)
+{
+	return static_cast<UInt64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - a_Start).count());
+}
+
+
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // cCriticalSection:
 
-#ifdef _DEBUG
-cCriticalSection::cCriticalSection()
+std::atomic<bool> cCriticalSection::s_IsProfilingEnabled(false);
+
+
+
+
+
+cCriticalSection::cCriticalSection() :
+	m_Name(nullptr),
+	m_Stats(nullptr),
+	m_LockDepth(0),
+	m_IsHoldTimed(false)
 {
-	m_IsLocked = 0;
+	#ifdef _DEBUG
+		m_IsLocked = 0;
+	#endif  // _DEBUG
 }
-#endif  // _DEBUG
 
 
 
@@ -22,7 +89,24 @@ cCriticalSection::cCriticalSection()
 
 void cCriticalSection::Lock()
 {
-	m_Mutex.lock();
+	if (m_Mutex.try_lock())
+	{
+		// The fast path, the CS was free or is already held by this thread:
+		if ((m_Stats != nullptr) && (m_LockDepth == 0) && s_IsProfilingEnabled.load(std::memory_order_relaxed))
+		{
+			m_Stats->m_NumAcquires.fetch_add(1, std::memory_order_relaxed);
+			m_IsHoldTimed = true;
+			m_HoldStart = std::chrono::steady_clock::now();
+		}
+	}
+	else
+	{
+		LockContended();
+	}
+	if (m_Stats != nullptr)
+	{
+		m_LockDepth += 1;
+	}
 	
 	#ifdef _DEBUG
 		m_IsLocked += 1;
@@ -34,12 +118,73 @@ void cCriticalSection::Lock()
 
 
 
+void cCriticalSection::LockContended(void)
+{
+	// Publish the CS this thread is blocked on, for the watchdog:
+	std::atomic<const cCriticalSection *> * WaitSlot = g_ThreadWaitSlot;
+	if (WaitSlot != nullptr)
+	{
+		WaitSlot->store(this, std::memory_order_relaxed);
+	}
+
+	if ((m_Stats == nullptr) || !s_IsProfilingEnabled.load(std::memory_order_relaxed))
+	{
+		m_Mutex.lock();
+	}
+	else
+	{
+		LockContendedProfiled();
+	}
+
+	if (WaitSlot != nullptr)
+	{
+		WaitSlot->store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+
+
+
+
+void cCriticalSection::LockContendedProfiled(void)
+{
+	// A recursive lock never gets here, so this is always the outermost lock:
+	auto WaitStart = std::chrono::steady_clock::now();
+	m_Mutex.lock();
+	m_HoldStart = std::chrono::steady_clock::now();
+	UInt64 WaitNSec = static_cast<UInt64>(std::chrono::duration_cast<std::chrono::nanoseconds>(m_HoldStart - WaitStart).count());
+	m_Stats->m_NumAcquires.fetch_add(1, std::memory_order_relaxed);
+	m_Stats->m_NumContended.fetch_add(1, std::memory_order_relaxed);
+	m_Stats->m_WaitNSec.fetch_add(WaitNSec, std::memory_order_relaxed);
+	UInt64 MaxWait = m_Stats->m_MaxWaitNSec.load(std::memory_order_relaxed);
+	while ((WaitNSec > MaxWait) && !m_Stats->m_MaxWaitNSec.compare_exchange_weak(MaxWait, WaitNSec, std::memory_order_relaxed))
+	{
+		// MaxWait has been reloaded by the failed exchange, retry
+	}
+	m_IsHoldTimed = true;
+}
+
+
+
+
+
 void cCriticalSection::Unlock()
 {
 	#ifdef _DEBUG
 		ASSERT(m_IsLocked > 0);
 		m_IsLocked -= 1;
 	#endif  // _DEBUG
+
+	if (m_Stats != nullptr)
+	{
+		ASSERT(m_LockDepth > 0);
+		m_LockDepth -= 1;
+		if ((m_LockDepth == 0) && m_IsHoldTimed)
+		{
+			m_IsHoldTimed = false;
+			m_Stats->m_HoldNSec.fetch_add(NSecSince(m_HoldStart), std::memory_order_relaxed);
+		}
+	}
 	
 	m_Mutex.unlock();
 }
@@ -48,6 +193,94 @@ void cCriticalSection::Unlock()
 
 
 
+void cCriticalSection::SetName(const char * a_Name)
+{
+	ASSERT(a_Name != nullptr);
+	m_Name = a_Name;
+	m_Stats = GetStatsCounters(a_Name);
+}
+
+
+
+
+
+void cCriticalSection::SetThreadWaitSlot(std::atomic<const cCriticalSection *> * a_Slot)
+{
+	g_ThreadWaitSlot = a_Slot;
+}
+
+
+
+
+
+void cCriticalSection::SetProfilingEnabled(bool a_IsEnabled)
+{
+	s_IsProfilingEnabled.store(a_IsEnabled, std::memory_order_relaxed);
+}
+
+
+
+
+
+cCriticalSection::sLockStatsVector cCriticalSection::GetLockStats(void)
+{
+	sLockStatsVector res;
+	{
+		std::lock_guard<std::mutex> Lock(GetStatsMutex());
+		cStatsCountersMap & Map = GetStatsMap();
+		res.reserve(Map.size());
+		for (cStatsCountersMap::const_iterator itr = Map.begin(), end = Map.end(); itr != end; ++itr)
+		{
+			sLockStats Stats;
+			Stats.m_Name         = itr->first.c_str();
+			Stats.m_NumAcquires  = itr->second.m_NumAcquires.load(std::memory_order_relaxed);
+			Stats.m_NumContended = itr->second.m_NumContended.load(std::memory_order_relaxed);
+			Stats.m_WaitNSec     = itr->second.m_WaitNSec.load(std::memory_order_relaxed);
+			Stats.m_MaxWaitNSec  = itr->second.m_MaxWaitNSec.load(std::memory_order_relaxed);
+			Stats.m_HoldNSec     = itr->second.m_HoldNSec.load(std::memory_order_relaxed);
+			res.push_back(Stats);
+		}
+	}
+	std::sort(res.begin(), res.end(), [](const sLockStats & a_First, const sLockStats & a_Second)
+		{
+			return (a_First.m_WaitNSec > a_Second.m_WaitNSec);
+		}
+	);
+	return res;
+}
+
+
+
+
+
+void cCriticalSection::ResetLockStats(void)
+{
+	std::lock_guard<std::mutex> Lock(GetStatsMutex());
+	cStatsCountersMap & Map = GetStatsMap();
+	for (cStatsCountersMap::iterator itr = Map.begin(), end = Map.end(); itr != end; ++itr)
+	{
+		itr->second.m_NumAcquires  = 0;
+		itr->second.m_NumContended = 0;
+		itr->second.m_WaitNSec     = 0;
+		itr->second.m_MaxWaitNSec  = 0;
+		itr->second.m_HoldNSec     = 0;
+	}
+}
+
+
+
+
+
+cCriticalSection::sStatsCounters * cCriticalSection::GetStatsCounters(const char * a_Name)
+{
+	std::lock_guard<std::mutex> Lock(GetStatsMutex());
+	return &(GetStatsMap()[a_Name]);
+}
+
+
+
+
+
 #ifdef _DEBUG
 bool cCriticalSection::IsLocked(void)
 {
@@ -2,6 +2,8 @@
 #pragma once
 #include <mutex>
 #include <thread>
+#include <atomic>
+#include <vector>
 
 
 
@@ -11,13 +13,53 @@ class cCriticalSection
 {
 public:
 
+	/** The contention statistics of a single named CS, or of all the CSs sharing the name, as reported by GetLockStats(). */
+	struct sLockStats
+	{
+		const char * m_Name;
+		UInt64 m_NumAcquires;   ///< Number of times the CS was locked (outermost locks only) while profiling
+		UInt64 m_NumContended;  ///< Number of those acquires that had to wait for another thread
+		UInt64 m_WaitNSec;      ///< Total time spent waiting for the CS, in nanoseconds
+		UInt64 m_MaxWaitNSec;   ///< The longest single wait for the CS, in nanoseconds
+		UInt64 m_HoldNSec;      ///< Total time the CS was held, in nanoseconds
+	} ;
+	typedef std::vector<sLockStats> sLockStatsVector;
+
+	/** The atomic counters shared by the CSs of the same name; defined in the .cpp file */
+	struct sStatsCounters;
+
+	cCriticalSection(void);
+
 	void Lock(void);
 	void Unlock(void);
+
+	/** Names the CS for the contention profiling; only named CSs are profiled.
+	All the CSs with the same name (such as the same member in each world) share the statistics.
+	a_Name must stay valid for the whole lifetime of the program, a string literal is expected. */
+	void SetName(const char * a_Name);
+
+	/** Returns the name set by SetName(), nullptr if the CS is unnamed. */
+	const char * GetName(void) const { return m_Name; }
+
+	/** Sets the slot in which the calling thread publishes the CS it is blocked on while waiting in Lock(), nullptr when not waiting.
+	Pass nullptr to stop publishing. Used by the stack trace registry, so that the watchdog can tell which lock each thread waits for. */
+	static void SetThreadWaitSlot(std::atomic<const cCriticalSection *> * a_Slot);
+
+	/** Turns the contention profiling on or off for all the named CSs.
+	While off, locking a named CS costs only one extra relaxed atomic load on top of the try_lock() fast path. */
+	static void SetProfilingEnabled(bool a_IsEnabled);
+
+	static bool IsProfilingEnabled(void) { return s_IsProfilingEnabled.load(std::memory_order_relaxed); }
+
+	/** Returns the statistics gathered so far for all the names, sorted by the total wait time, longest first. */
+	static sLockStatsVector GetLockStats(void);
+
+	/** Zeroes the statistics for all the names. */
+	static void ResetLockStats(void);
 	
 	// IsLocked/IsLockedByCurrentThread are only used in ASSERT statements, but because of the changes with ASSERT they must always be defined
 	// The fake versions (in Release) will not effect the program in any way
 	#ifdef _DEBUG
-	cCriticalSection(void);
 	bool IsLocked(void);
 	bool IsLockedByCurrentThread(void);
 	#else
@@ -32,6 +74,33 @@ private:
 	#endif  // _DEBUG
 	
 	std::recursive_mutex m_Mutex;
+
+	/** The name for the profiling and the watchdog reports, nullptr if not named */
+	const char * m_Name;
+
+	/** The shared counters for the CS's name, nullptr if the CS is not named (not profiled) */
+	sStatsCounters * m_Stats;
+
+	/** Recursion depth of the current owner, maintained only for named CSs, so that the hold time is measured by the outermost lock only.
+	Accessed only by the thread holding the CS. */
+	int m_LockDepth;
+
+	/** Set if the outermost lock was taken while profiling, so the matching unlock adds the hold time */
+	bool m_IsHoldTimed;
+
+	/** When the outermost lock was taken, valid only if m_IsHoldTimed is set */
+	std::chrono::steady_clock::time_point m_HoldStart;
+
+	static std::atomic<bool> s_IsProfilingEnabled;
+
+	/** Locks the mutex once the fast path in Lock() has failed, publishing the wait for the watchdog. */
+	void LockContended(void);
+
+	/** Locks the mutex in LockContended() while profiling, timing the wait. */
+	void LockContendedProfiled(void);
+
+	/** Returns the counters shared by all the CSs of the given name, creating them on first use. */
+	static sStatsCounters * GetStatsCounters(const char * a_Name);
 } ALIGN_8;
 
 
@@ -63,6 +63,13 @@ bool cEvent::Wait(unsigned a_TimeoutMSec)
 		}  // switch (wait_until())
 	}  // while (m_ShouldWait && not timeout)
 
+	// The event may have been set before waiting started:
+	if (!m_ShouldWait)
+	{
+		m_ShouldWait = true;
+		return true;
+	}
+
 	// The wait timed out in the while condition:
 	return false;
 }
@@ -6,6 +6,7 @@
 
 #include "Globals.h"
 #include "IsThread.h"
+#include "StackTrace.h"
 
 
 
@@ -71,7 +72,9 @@ cIsThread::~cIsThread()
 void cIsThread::DoExecute(void)
 {
 	m_evtStart.Wait();
+	RegisterThreadForStackTrace(m_ThreadName);
 	Execute();
+	UnregisterThreadForStackTrace();
 }
 
 
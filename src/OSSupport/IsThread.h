@@ -17,6 +17,7 @@ In the descending class' constructor call the Start() method to start the thread
 
 #pragma once
 #include <thread>
+#include "Event.h"
 
 
 
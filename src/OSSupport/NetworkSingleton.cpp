@@ -13,6 +13,7 @@
 #include <event2/listener.h>
 #include "IPLookup.h"
 #include "HostnameLookup.h"
+#include "StackTrace.h"
 
 
 
@@ -128,7 +129,9 @@ void cNetworkSingleton::LogCallback(int a_Severity, const char * a_Msg)
 
 void cNetworkSingleton::RunEventLoop(cNetworkSingleton * a_Self)
 {
+	RegisterThreadForStackTrace("LibEvent");
 	event_base_loop(a_Self->m_EventBase, EVLOOP_NO_EXIT_ON_EMPTY);
+	UnregisterThreadForStackTrace();
 	a_Self->m_EventLoopTerminated.Set();
 }
 
@@ -135,6 +135,9 @@ bool cServerHandleImpl::Listen(UInt16 a_Port)
 			return false;
 		}
 
+		// Allow the port to be bound again right after a previous listener on it has been closed:
+		evutil_make_listen_socket_reuseable(MainSock);
+
 		// Bind to all interfaces:
 		sockaddr_in name;
 		memset(&name, 0, sizeof(name));
@@ -165,6 +168,9 @@ bool cServerHandleImpl::Listen(UInt16 a_Port)
 			setsockopt(MainSock, IPPROTO_IPV6, IPV6_V6ONLY, reinterpret_cast<const char *>(&Zero), sizeof(Zero));
 		#endif
 
+		// Allow the port to be bound again right after a previous listener on it has been closed:
+		evutil_make_listen_socket_reuseable(MainSock);
+
 		// Bind to all interfaces:
 		sockaddr_in6 name;
 		memset(&name, 0, sizeof(name));
@@ -5,17 +5,173 @@
 
 #include "Globals.h"
 #include "StackTrace.h"
+#include "CriticalSection.h"
 #ifdef _WIN32
 	#include "../StackWalker.h"
 #else
 	#include <execinfo.h>
 	#include <unistd.h>
+	#include <signal.h>
+	#include <pthread.h>
 #endif
 
 
 
 
 
+/** The maximum number of frames captured for each thread by LogAllThreadsStackTraces() */
+static const int MAX_FRAMES = 30;
+
+#ifdef _WIN32
+	/** Size of the top of a suspended thread's stack that is copied for walking it after the thread is resumed */
+	static const size_t STACK_SNAPSHOT_SIZE = 128 KiB;
+#else
+	/** The signal used to make a registered thread capture its own stack trace */
+	static const int STACK_TRACE_SIGNAL = SIGUSR2;
+
+	/** How long to wait for a thread to capture its stack trace, in milliseconds */
+	static const int STACK_TRACE_TIMEOUT_MSEC = 1000;
+#endif
+
+
+
+
+
+/** A thread registered by RegisterThreadForStackTrace() */
+struct sRegisteredThread
+{
+	AString m_Name;
+
+	/** The CS the thread is blocked on, published by cCriticalSection::Lock() */
+	std::atomic<const cCriticalSection *> m_WaitingFor;
+
+	#ifdef _WIN32
+		/** A real handle to the thread; GetCurrentThread() returns only a pseudo-handle */
+		HANDLE m_Handle;
+	#else
+		pthread_t m_Handle;
+
+		/** The frames captured by the thread in its signal handler */
+		void * m_Frames[MAX_FRAMES];
+
+		/** Number of valid frames in m_Frames, -1 while the capture is pending */
+		std::atomic<int> m_NumFrames;
+	#endif
+
+	sRegisteredThread(const AString & a_Name) :
+		m_Name(a_Name),
+		m_WaitingFor(nullptr)
+	{
+	}
+} ;
+
+typedef std::list<sRegisteredThread *> cRegisteredThreads;
+
+/** The registered thread entry of the calling thread, nullptr if not registered.
+A plain pointer in the thread-local storage, the signal handler uses it to find where to store the frames. */
+#ifdef _MSC_VER
+	static __declspec(thread) sRegisteredThread * g_CurrentThread = nullptr;
+#else
+	static __thread sRegisteredThread * g_CurrentThread = nullptr;
+#endif
+
+/** Guards the registered threads list. A plain mutex, so that it doesn't publish waits of its own.
+Both are intentionally leaked, threads owned by static objects (LibEvent) unregister during the static destruction. */
+static std::mutex & GetRegisteredThreadsMutex(void)
+{
+	static std::mutex * Mutex = new std::mutex;
+	return *Mutex;
+}
+
+static cRegisteredThreads & GetRegisteredThreads(void)
+{
+	static cRegisteredThreads * Threads = new cRegisteredThreads;
+	return *Threads;
+}
+
+
+
+
+
+#ifdef _WIN32
+/** The state of a thread copied while the thread was suspended, so that its stack can be walked after resuming it.
+The suspended thread may hold the heap lock, so nothing may be allocated while it is suspended, hence the fixed buffer. */
+struct sStackSnapshot
+{
+	CONTEXT m_Context;
+	DWORD64 m_Start;  ///< The address in the thread's stack where m_Data was copied from
+	SIZE_T  m_Size;   ///< Number of valid bytes in m_Data
+	char    m_Data[STACK_SNAPSHOT_SIZE];
+} ;
+
+/** The single snapshot buffer, used by CaptureStackTrace() under the registered threads' mutex. */
+static sStackSnapshot g_StackSnapshot;
+
+
+
+
+
+/** Reads the process memory for the StackWalker, serving the stack of the walked thread from the snapshot. */
+static BOOL __stdcall ReadSnapshotMemory(HANDLE a_Process, DWORD64 a_Address, PVOID a_Buffer, DWORD a_Size, LPDWORD a_NumBytesRead, LPVOID a_UserData)
+{
+	const sStackSnapshot & Snapshot = *static_cast<const sStackSnapshot *>(a_UserData);
+	if ((a_Address >= Snapshot.m_Start) && (a_Address + a_Size <= Snapshot.m_Start + Snapshot.m_Size))
+	{
+		memcpy(a_Buffer, Snapshot.m_Data + (a_Address - Snapshot.m_Start), a_Size);
+		*a_NumBytesRead = a_Size;
+		return TRUE;
+	}
+
+	// Not in the snapshot (code and unwind data, or stack deeper than the snapshot), read the live memory:
+	SIZE_T NumBytesRead = 0;
+	BOOL res = ReadProcessMemory(a_Process, reinterpret_cast<LPCVOID>(static_cast<DWORD_PTR>(a_Address)), a_Buffer, a_Size, &NumBytesRead);
+	*a_NumBytesRead = static_cast<DWORD>(NumBytesRead);
+	return res;
+}
+
+
+
+
+
+/** Copies the context and the top of the stack of the thread into a_Snapshot. The thread is suspended only for the copying,
+which doesn't allocate anything nor take any locks. Returns false if the thread cannot be suspended or its context cannot be read. */
+static bool TakeStackSnapshot(HANDLE a_Thread, sStackSnapshot & a_Snapshot)
+{
+	memset(&a_Snapshot.m_Context, 0, sizeof(a_Snapshot.m_Context));
+	a_Snapshot.m_Context.ContextFlags = CONTEXT_FULL;
+	a_Snapshot.m_Start = 0;
+	a_Snapshot.m_Size = 0;
+	if (SuspendThread(a_Thread) == static_cast<DWORD>(-1))
+	{
+		return false;
+	}
+	bool res = (GetThreadContext(a_Thread, &a_Snapshot.m_Context) != FALSE);
+	if (res)
+	{
+		#ifdef _M_X64
+			DWORD_PTR StackPointer = a_Snapshot.m_Context.Rsp;
+		#else
+			DWORD_PTR StackPointer = a_Snapshot.m_Context.Esp;
+		#endif
+		MEMORY_BASIC_INFORMATION Info;
+		if (VirtualQuery(reinterpret_cast<LPCVOID>(StackPointer), &Info, sizeof(Info)) != 0)
+		{
+			// The stack grows down, the used part is from the stack pointer up to the end of the committed region:
+			SIZE_T Available = reinterpret_cast<DWORD_PTR>(Info.BaseAddress) + Info.RegionSize - StackPointer;
+			a_Snapshot.m_Start = StackPointer;
+			a_Snapshot.m_Size = std::min<SIZE_T>(Available, sizeof(a_Snapshot.m_Data));
+			memcpy(a_Snapshot.m_Data, reinterpret_cast<const void *>(StackPointer), a_Snapshot.m_Size);
+		}
+	}
+	ResumeThread(a_Thread);
+	return res;
+}
+#endif  // _WIN32
+
+
+
+
+
 void PrintStackTrace(void)
 {
 	#ifdef _WIN32
@@ -42,3 +198,192 @@ void PrintStackTrace(void)
 
 
 
+
+#ifndef _WIN32
+/** Handles STACK_TRACE_SIGNAL: stores the interrupted thread's frames into its registered entry.
+backtrace() isn't guaranteed to be async-signal-safe, it is primed in RegisterThreadForStackTrace() so that it doesn't need to load libgcc here. */
+static void StackTraceSignalHandler(int a_Signal)
+{
+	UNUSED(a_Signal);
+	sRegisteredThread * Thread = g_CurrentThread;
+	if (Thread == nullptr)
+	{
+		return;
+	}
+	int NumFrames = backtrace(Thread->m_Frames, MAX_FRAMES);
+	Thread->m_NumFrames.store(NumFrames);
+}
+#endif
+
+
+
+
+
+void RegisterThreadForStackTrace(const AString & a_ThreadName)
+{
+	ASSERT(g_CurrentThread == nullptr);
+	sRegisteredThread * Thread = new sRegisteredThread(a_ThreadName);
+	#ifdef _WIN32
+		DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &Thread->m_Handle, 0, FALSE, DUPLICATE_SAME_ACCESS);
+	#else
+		Thread->m_Handle = pthread_self();
+		Thread->m_NumFrames = 0;
+
+		// Install the signal handler on first use; SA_RESTART lets the interrupted system calls continue afterwards:
+		static std::once_flag HandlerInstalled;
+		std::call_once(HandlerInstalled, []()
+			{
+				struct sigaction Action;
+				memset(&Action, 0, sizeof(Action));
+				Action.sa_handler = StackTraceSignalHandler;
+				Action.sa_flags = SA_RESTART;
+				sigemptyset(&Action.sa_mask);
+				sigaction(STACK_TRACE_SIGNAL, &Action, nullptr);
+			}
+		);
+
+		// Prime backtrace(), see StackTraceSignalHandler():
+		backtrace(Thread->m_Frames, MAX_FRAMES);
+	#endif
+
+	g_CurrentThread = Thread;
+	cCriticalSection::SetThreadWaitSlot(&Thread->m_WaitingFor);
+
+	std::lock_guard<std::mutex> Lock(GetRegisteredThreadsMutex());
+	GetRegisteredThreads().push_back(Thread);
+}
+
+
+
+
+
+void UnregisterThreadForStackTrace(void)
+{
+	sRegisteredThread * Thread = g_CurrentThread;
+	if (Thread == nullptr)
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> Lock(GetRegisteredThreadsMutex());
+		GetRegisteredThreads().remove(Thread);
+	}
+	cCriticalSection::SetThreadWaitSlot(nullptr);
+	g_CurrentThread = nullptr;
+	#ifdef _WIN32
+		CloseHandle(Thread->m_Handle);
+	#endif
+	delete Thread;
+}
+
+
+
+
+
+/** Returns the stack trace of the specified registered thread, one frame per item.
+Assumes the registered threads' mutex is held, so that the thread cannot unregister meanwhile; it also guards g_StackSnapshot. */
+static AStringVector CaptureStackTrace(sRegisteredThread & a_Thread)
+{
+	#ifdef _WIN32
+		// The StackWalker would keep the thread suspended while walking its stack, and the walking allocates memory;
+		// that deadlocks if the thread holds the heap lock. Copy the thread's state while it is suspended, walk the copy afterwards:
+		AStringVector res;
+		if (!TakeStackSnapshot(a_Thread.m_Handle, g_StackSnapshot))
+		{
+			res.push_back("(cannot suspend the thread)");
+			return res;
+		}
+
+		// Collect the output, it is logged along with the lock the thread waits for:
+		class cCollectingStackWalker :
+			public StackWalker
+		{
+		public:
+			AString m_Output;
+
+			virtual void OnOutput(LPCSTR szText) override
+			{
+				m_Output.append(szText);
+			}
+		} sw;
+		sw.ShowCallstack(a_Thread.m_Handle, &g_StackSnapshot.m_Context, ReadSnapshotMemory, &g_StackSnapshot);
+		return StringSplit(sw.m_Output, "\n");
+	#else
+		AStringVector res;
+		a_Thread.m_NumFrames.store(-1);
+		if (pthread_kill(a_Thread.m_Handle, STACK_TRACE_SIGNAL) != 0)
+		{
+			res.push_back("(cannot signal the thread)");
+			return res;
+		}
+		for (int i = 0; a_Thread.m_NumFrames.load() < 0; i++)
+		{
+			if (i >= STACK_TRACE_TIMEOUT_MSEC)
+			{
+				res.push_back("(the thread didn't respond)");
+				return res;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		int NumFrames = a_Thread.m_NumFrames.load();
+		char ** Symbols = backtrace_symbols(a_Thread.m_Frames, NumFrames);
+		if (Symbols == nullptr)
+		{
+			res.push_back("(cannot resolve the symbols)");
+			return res;
+		}
+		for (int i = 0; i < NumFrames; i++)
+		{
+			res.push_back(Symbols[i]);
+		}
+		free(Symbols);
+		return res;
+	#endif
+}
+
+
+
+
+
+void LogAllThreadsStackTraces(void)
+{
+	std::lock_guard<std::mutex> Lock(GetRegisteredThreadsMutex());
+	cRegisteredThreads & Threads = GetRegisteredThreads();
+	LOGWARNING("Stack traces of the running threads:");
+	for (cRegisteredThreads::iterator itr = Threads.begin(), end = Threads.end(); itr != end; ++itr)
+	{
+		sRegisteredThread & Thread = **itr;
+		if (&Thread == g_CurrentThread)
+		{
+			// The calling thread's own stack is of no interest
+			continue;
+		}
+
+		// Capture the stack first, so that the reported lock is the one that the captured stack waits on:
+		AStringVector Frames = CaptureStackTrace(Thread);
+		const cCriticalSection * WaitingFor = Thread.m_WaitingFor.load(std::memory_order_relaxed);
+		if (WaitingFor == nullptr)
+		{
+			LOGWARNING("Thread \"%s\", not waiting for any lock:", Thread.m_Name.c_str());
+		}
+		else if (WaitingFor->GetName() != nullptr)
+		{
+			LOGWARNING("Thread \"%s\", waiting to lock %s:", Thread.m_Name.c_str(), WaitingFor->GetName());
+		}
+		else
+		{
+			LOGWARNING("Thread \"%s\", waiting to lock an unnamed critical section at %p:", Thread.m_Name.c_str(), static_cast<const void *>(WaitingFor));
+		}
+		for (AStringVector::const_iterator itrF = Frames.begin(), endF = Frames.end(); itrF != endF; ++itrF)
+		{
+			if (!itrF->empty())
+			{
+				LOGWARNING("  %s", itrF->c_str());
+			}
+		}
+	}
+}
+
+
+
+
@@ -1,7 +1,13 @@
 
 // StackTrace.h
 
-// Declares the functions to print current stack trace
+// Declares the functions to print current stack traces
+
+
+
+
+
+#pragma once
 
 
 
@@ -10,6 +16,17 @@
 /** Prints the stacktrace for the current thread. */
 extern void PrintStackTrace(void);
 
+/** Adds the calling thread to the threads whose stack traces are logged by LogAllThreadsStackTraces().
+Must be paired with UnregisterThreadForStackTrace() called from the same thread before it exits. */
+extern void RegisterThreadForStackTrace(const AString & a_ThreadName);
+
+/** Removes the calling thread from the threads whose stack traces are logged. */
+extern void UnregisterThreadForStackTrace(void);
+
+/** Logs the stack traces of all the registered threads, together with the critical section each one is waiting to lock, if any.
+Used by the watchdog when a tick stalls; the threads are interrupted only briefly, they continue running afterwards. */
+extern void LogAllThreadsStackTraces(void);
+
 
 
 
@@ -7,6 +7,18 @@
 #include "TCPLinkImpl.h"
 #include "NetworkSingleton.h"
 #include "ServerHandleImpl.h"
+#include <event2/buffer.h>
+
+
+
+
+
+/** The options for the links' bufferevents.
+The links may be written to from any thread (RCON sends the command output from the root thread), so the bufferevent is thread-safe.
+The callbacks are called without the bufferevent's lock held, otherwise a callback that takes its own lock would deadlock
+against another thread that holds that lock and sends data. LibEvent supports the unlocked callbacks only when they are deferred;
+the deferred callbacks still run in the network thread's event loop iteration, in order, they only aren't nested inside the I/O call. */
+static const int LINK_BEV_OPTIONS = BEV_OPT_CLOSE_ON_FREE | BEV_OPT_THREADSAFE | BEV_OPT_DEFER_CALLBACKS | BEV_OPT_UNLOCK_CALLBACKS;
 
 
 
@@ -17,7 +29,8 @@
 
 cTCPLinkImpl::cTCPLinkImpl(cTCPLink::cCallbacksPtr a_LinkCallbacks):
 	super(a_LinkCallbacks),
-	m_BufferEvent(bufferevent_socket_new(cNetworkSingleton::Get().GetEventBase(), -1, BEV_OPT_CLOSE_ON_FREE))
+	m_BufferEvent(bufferevent_socket_new(cNetworkSingleton::Get().GetEventBase(), -1, LINK_BEV_OPTIONS)),
+	m_ShouldShutdown(false)
 {
 }
 
@@ -27,8 +40,9 @@ cTCPLinkImpl::cTCPLinkImpl(cTCPLink::cCallbacksPtr a_LinkCallbacks):
 
 cTCPLinkImpl::cTCPLinkImpl(evutil_socket_t a_Socket, cTCPLink::cCallbacksPtr a_LinkCallbacks, cServerHandleImplPtr a_Server, const sockaddr * a_Address, socklen_t a_AddrLen):
 	super(a_LinkCallbacks),
-	m_BufferEvent(bufferevent_socket_new(cNetworkSingleton::Get().GetEventBase(), a_Socket, BEV_OPT_CLOSE_ON_FREE)),
-	m_Server(a_Server)
+	m_BufferEvent(bufferevent_socket_new(cNetworkSingleton::Get().GetEventBase(), a_Socket, LINK_BEV_OPTIONS)),
+	m_Server(a_Server),
+	m_ShouldShutdown(false)
 {
 	// Update the endpoint addresses:
 	UpdateLocalAddress();
@@ -107,7 +121,7 @@ void cTCPLinkImpl::Enable(cTCPLinkImplPtr a_Self)
 	m_Self = a_Self;
 
 	// Set the LibEvent callbacks and enable processing:
-	bufferevent_setcb(m_BufferEvent, ReadCallback, nullptr, EventCallback, this);
+	bufferevent_setcb(m_BufferEvent, ReadCallback, WriteCallback, EventCallback, this);
 	bufferevent_enable(m_BufferEvent, EV_READ | EV_WRITE);
 }
 
@@ -117,7 +131,18 @@ void cTCPLinkImpl::Enable(cTCPLinkImplPtr a_Self)
 
 bool cTCPLinkImpl::Send(const void * a_Data, size_t a_Length)
 {
-	return (bufferevent_write(m_BufferEvent, a_Data, a_Length) == 0);
+	// The bufferevent is created thread-safe, with the callbacks called unlocked, so the data may be sent from any thread,
+	// including from within the link's own callbacks. The shutdown check and the write must be atomic against Shutdown():
+	bufferevent_lock(m_BufferEvent);
+	if (m_ShouldShutdown)
+	{
+		bufferevent_unlock(m_BufferEvent);
+		LOGD("%s: Cannot send data, the link is already shut down.", __FUNCTION__);
+		return false;
+	}
+	bool res = (bufferevent_write(m_BufferEvent, a_Data, a_Length) == 0);
+	bufferevent_unlock(m_BufferEvent);
+	return res;
 }
 
 
@@ -125,6 +150,23 @@ bool cTCPLinkImpl::Send(const void * a_Data, size_t a_Length)
 
 
 void cTCPLinkImpl::Shutdown(void)
+{
+	// No more data may be sent; if there's no outgoing data, shutdown now:
+	bufferevent_lock(m_BufferEvent);
+	m_ShouldShutdown = true;
+	if (evbuffer_get_length(bufferevent_get_output(m_BufferEvent)) == 0)
+	{
+		DoActualShutdown();
+	}
+	// Otherwise there's still outgoing data in the LibEvent buffer, shut down once it's written to the OS TCP stack (in WriteCallback())
+	bufferevent_unlock(m_BufferEvent);
+}
+
+
+
+
+
+void cTCPLinkImpl::DoActualShutdown(void)
 {
 	#ifdef _WIN32
 		shutdown(bufferevent_getfd(m_BufferEvent), SD_SEND);
@@ -177,6 +219,24 @@ void cTCPLinkImpl::ReadCallback(bufferevent * a_BufferEvent, void * a_Self)
 
 
 
+void cTCPLinkImpl::WriteCallback(bufferevent * a_BufferEvent, void * a_Self)
+{
+	ASSERT(a_Self != nullptr);
+	cTCPLinkImpl * Self = static_cast<cTCPLinkImpl *>(a_Self);
+
+	// If there's a shutdown pending and all the data has been written, do the shutdown:
+	bufferevent_lock(a_BufferEvent);
+	if (Self->m_ShouldShutdown && (evbuffer_get_length(bufferevent_get_output(a_BufferEvent)) == 0))
+	{
+		Self->DoActualShutdown();
+	}
+	bufferevent_unlock(a_BufferEvent);
+}
+
+
+
+
+
 void cTCPLinkImpl::EventCallback(bufferevent * a_BufferEvent, short a_What, void * a_Self)
 {
 	ASSERT(a_Self != nullptr);
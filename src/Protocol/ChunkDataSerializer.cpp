@@ -9,29 +9,71 @@
 #include "ChunkDataSerializer.h"
 #include "zlib/zlib.h"
 #include "ByteBuffer.h"
-#include "Protocol18x.h"
+#include "StringCompression.h"
+#include "PacketFraming.h"
+
+
+
+
+/** A section with all the default values, used for the sections that are not allocated in cChunkData. */
+static const class cEmptySection :
+	public cChunkData::sChunkSection
+{
+public:
+	cEmptySection(void)
+	{
+		memset(m_BlockTypes,    0x00, sizeof(m_BlockTypes));
+		memset(m_BlockMetas,    0x00, sizeof(m_BlockMetas));
+		memset(m_BlockLight,    0x00, sizeof(m_BlockLight));
+		memset(m_BlockSkyLight, 0xff, sizeof(m_BlockSkyLight));
+	}
+} g_EmptySection;
+
+
+
+
+
+cChunkDataSerializer::cChunkDataSerializer(
+	const cChunkData &    a_Data,
+	const unsigned char * a_BiomeData
+) :
+	m_Data(a_Data),
+	m_BiomeData(a_BiomeData),
+	m_SectionMask(0xffff),
+	m_IsFullChunk(true),
+	m_SentSections(0xffff)
+{
+	// Leave out the empty sections, the client fills in empty sections for a full chunk by itself:
+	for (int Section = 0; Section < NumSections; Section++)
+	{
+		if (m_Data.GetSection(static_cast<size_t>(Section)) == nullptr)
+		{
+			m_SentSections &= static_cast<UInt16>(~(1 << Section));
+		}
+	}
+}
+
 
 
 
 
 cChunkDataSerializer::cChunkDataSerializer(
-	const cChunkDef::BlockTypes   & a_BlockTypes,
-	const cChunkDef::BlockNibbles & a_BlockMetas,
-	const cChunkDef::BlockNibbles & a_BlockLight,
-	const cChunkDef::BlockNibbles & a_BlockSkyLight,
-	const unsigned char *           a_BiomeData
+	const cChunkData &    a_Data,
+	const unsigned char * a_BiomeData,
+	UInt16                a_SectionMask
 ) :
-	m_BlockTypes(a_BlockTypes),
-	m_BlockMetas(a_BlockMetas),
-	m_BlockLight(a_BlockLight),
-	m_BlockSkyLight(a_BlockSkyLight),
-	m_BiomeData(a_BiomeData)
+	m_Data(a_Data),
+	m_BiomeData(a_BiomeData),
+	m_SectionMask(a_SectionMask),
+	m_IsFullChunk(false),
+	m_SentSections(a_SectionMask)
 {
 }
 
 
 
 
+
 const AString & cChunkDataSerializer::Serialize(int a_Version, int a_ChunkX, int a_ChunkZ)
 {
 	Serializations::const_iterator itr = m_Serializations.find(a_Version);
@@ -69,22 +111,23 @@ const AString & cChunkDataSerializer::Serialize(int a_Version, int a_ChunkX, int
 void cChunkDataSerializer::Serialize29(AString & a_Data)
 {
 	// TODO: Do not copy data and then compress it; rather, compress partial blocks of data (zlib *can* stream)
+	// NOTE: This always serializes the full chunk, regardless of m_SectionMask; the client simply receives more data than needed.
 
 	const int BiomeDataSize    = cChunkDef::Width * cChunkDef::Width;
-	const int MetadataOffset   = sizeof(m_BlockTypes);
-	const int BlockLightOffset = MetadataOffset   + sizeof(m_BlockMetas);
-	const int SkyLightOffset   = BlockLightOffset + sizeof(m_BlockLight);
-	const int BiomeOffset      = SkyLightOffset   + sizeof(m_BlockSkyLight);
+	const int MetadataOffset   = cChunkDef::NumBlocks;
+	const int BlockLightOffset = MetadataOffset   + cChunkDef::NumBlocks / 2;
+	const int SkyLightOffset   = BlockLightOffset + cChunkDef::NumBlocks / 2;
+	const int BiomeOffset      = SkyLightOffset   + cChunkDef::NumBlocks / 2;
 	const int DataSize         = BiomeOffset      + BiomeDataSize;
 	
 	// Temporary buffer for the composed data:
 	char AllData [DataSize];
 
-	memcpy(AllData, m_BlockTypes, sizeof(m_BlockTypes));
-	memcpy(AllData + MetadataOffset,   m_BlockMetas,    sizeof(m_BlockMetas));
-	memcpy(AllData + BlockLightOffset, m_BlockLight,    sizeof(m_BlockLight));
-	memcpy(AllData + SkyLightOffset,   m_BlockSkyLight, sizeof(m_BlockSkyLight));
-	memcpy(AllData + BiomeOffset,      m_BiomeData,     BiomeDataSize);
+	m_Data.CopyBlockTypes(reinterpret_cast<BLOCKTYPE *>(AllData));
+	m_Data.CopyMetas     (reinterpret_cast<NIBBLETYPE *>(AllData + MetadataOffset));
+	m_Data.CopyBlockLight(reinterpret_cast<NIBBLETYPE *>(AllData + BlockLightOffset));
+	m_Data.CopySkyLight  (reinterpret_cast<NIBBLETYPE *>(AllData + SkyLightOffset));
+	memcpy(AllData + BiomeOffset, m_BiomeData, BiomeDataSize);
 
 	// Compress the data:
 	// In order not to use allocation, use a fixed-size buffer, with the size
@@ -92,12 +135,12 @@ void cChunkDataSerializer::Serialize29(AString & a_Data)
 	const uLongf CompressedMaxSize = DataSize + (DataSize >> 12) + (DataSize >> 14) + (DataSize >> 25) + 16;
 	char CompressedBlockData[CompressedMaxSize];
 
-	uLongf CompressedSize = compressBound(DataSize);
+	size_t CompressedSize = compressBound(DataSize);
 	
 	// Run-time check that our compile-time guess about CompressedMaxSize was enough:
 	ASSERT(CompressedSize <= CompressedMaxSize);
 	
-	compress2((Bytef*)CompressedBlockData, &CompressedSize, (const Bytef*)AllData, sizeof(AllData), Z_DEFAULT_COMPRESSION);
+	CompressBuffer(AllData, sizeof(AllData), CompressedBlockData, CompressedSize, Z_DEFAULT_COMPRESSION);
 
 	// Now put all those data into a_Data:
 	
@@ -128,44 +171,60 @@ void cChunkDataSerializer::Serialize39(AString & a_Data)
 {
 	// TODO: Do not copy data and then compress it; rather, compress partial blocks of data (zlib *can* stream)
 
-	const int BiomeDataSize    = cChunkDef::Width * cChunkDef::Width;
-	const int MetadataOffset   = sizeof(m_BlockTypes);
-	const int BlockLightOffset = MetadataOffset   + sizeof(m_BlockMetas);
-	const int SkyLightOffset   = BlockLightOffset + sizeof(m_BlockLight);
-	const int BiomeOffset      = SkyLightOffset   + sizeof(m_BlockSkyLight);
+	const int SectionBlocks    = cChunkDef::NumBlocks / NumSections;
+	const int NumSent          = GetNumSentSections();
+	const int BiomeDataSize    = IsFullChunk() ? (cChunkDef::Width * cChunkDef::Width) : 0;
+	const int MetadataOffset   = NumSent * SectionBlocks;
+	const int BlockLightOffset = MetadataOffset   + NumSent * SectionBlocks / 2;
+	const int SkyLightOffset   = BlockLightOffset + NumSent * SectionBlocks / 2;
+	const int BiomeOffset      = SkyLightOffset   + NumSent * SectionBlocks / 2;
 	const int DataSize         = BiomeOffset      + BiomeDataSize;
+	const int MaxDataSize      = cChunkDef::NumBlocks * 5 / 2 + cChunkDef::Width * cChunkDef::Width;
 	
 	// Temporary buffer for the composed data:
-	char AllData [DataSize];
+	char AllData [MaxDataSize];
 
-	memcpy(AllData, m_BlockTypes, sizeof(m_BlockTypes));
-	memcpy(AllData + MetadataOffset,   m_BlockMetas,    sizeof(m_BlockMetas));
-	memcpy(AllData + BlockLightOffset, m_BlockLight,    sizeof(m_BlockLight));
-	memcpy(AllData + SkyLightOffset,   m_BlockSkyLight, sizeof(m_BlockSkyLight));
-	memcpy(AllData + BiomeOffset,      m_BiomeData,     BiomeDataSize);
+	// Each of the arrays is sent for all the sent sections, then the next array follows:
+	int SentIdx = 0;
+	for (int Section = 0; Section < NumSections; Section++)
+	{
+		if ((m_SentSections & (1 << Section)) == 0)
+		{
+			continue;
+		}
+		const cChunkData::sChunkSection & Data = GetSection(Section);
+		memcpy(AllData + SentIdx * SectionBlocks,                        Data.m_BlockTypes,    SectionBlocks);
+		memcpy(AllData + MetadataOffset   + SentIdx * SectionBlocks / 2, Data.m_BlockMetas,    SectionBlocks / 2);
+		memcpy(AllData + BlockLightOffset + SentIdx * SectionBlocks / 2, Data.m_BlockLight,    SectionBlocks / 2);
+		memcpy(AllData + SkyLightOffset   + SentIdx * SectionBlocks / 2, Data.m_BlockSkyLight, SectionBlocks / 2);
+		SentIdx++;
+	}
+	if (IsFullChunk())
+	{
+		memcpy(AllData + BiomeOffset, m_BiomeData, BiomeDataSize);
+	}
 
 	// Compress the data:
 	// In order not to use allocation, use a fixed-size buffer, with the size
 	// that uses the same calculation as compressBound():
-	const uLongf CompressedMaxSize = DataSize + (DataSize >> 12) + (DataSize >> 14) + (DataSize >> 25) + 16;
+	const uLongf CompressedMaxSize = MaxDataSize + (MaxDataSize >> 12) + (MaxDataSize >> 14) + (MaxDataSize >> 25) + 16;
 	char CompressedBlockData[CompressedMaxSize];
 
-	uLongf CompressedSize = compressBound(DataSize);
+	size_t CompressedSize = compressBound(DataSize);
 	
 	// Run-time check that our compile-time guess about CompressedMaxSize was enough:
 	ASSERT(CompressedSize <= CompressedMaxSize);
 	
-	compress2((Bytef*)CompressedBlockData, &CompressedSize, (const Bytef*)AllData, sizeof(AllData), Z_DEFAULT_COMPRESSION);
+	CompressBuffer(AllData, DataSize, CompressedBlockData, CompressedSize, Z_DEFAULT_COMPRESSION);
 
 	// Now put all those data into a_Data:
 	
 	// "Ground-up continuous", or rather, "biome data present" flag:
-	a_Data.push_back('\x01');
+	a_Data.push_back(IsFullChunk() ? '\x01' : '\x00');
 	
-	// Two bitmaps; we're aways sending the full chunk with no additional data, so the bitmaps are 0xffff and 0, respectively
-	// Also, no endian flipping is needed because of the const values
-	unsigned short BitMap1 = 0xffff;
-	unsigned short BitMap2 = 0;
+	// Two bitmaps; we're aways sending the sections with no additional data, so the second bitmap is 0
+	UInt16 BitMap1 = htons(m_SentSections);
+	UInt16 BitMap2 = 0;
 	a_Data.append((const char *)&BitMap1, sizeof(short));
 	a_Data.append((const char *)&BitMap2, sizeof(short));
 	
@@ -185,67 +244,117 @@ void cChunkDataSerializer::Serialize47(AString & a_Data, int a_ChunkX, int a_Chu
 {
 	// This function returns the fully compressed packet (including packet size), not the raw packet!
 
-	// Create the packet:
-	cByteBuffer Packet(512 KiB);
-	Packet.WriteVarInt(0x21);  // Packet id (Chunk Data packet)
-	Packet.WriteBEInt(a_ChunkX);
-	Packet.WriteBEInt(a_ChunkZ);
-	Packet.WriteBool(true);  // "Ground-up continuous", or rather, "biome data present" flag
-	Packet.WriteBEUShort(0xffff);  // We're aways sending the full chunk with no additional data, so the bitmap is 0xffff
+	// Create the packet header:
+	cByteBuffer Header(32);
+	Header.WriteVarInt(0x21);  // Packet id (Chunk Data packet)
+	Header.WriteBEInt(a_ChunkX);
+	Header.WriteBEInt(a_ChunkZ);
+	Header.WriteBool(IsFullChunk());  // "Ground-up continuous", or rather, "biome data present" flag
+	Header.WriteBEUShort(m_SentSections);
 
 	// Write the chunk size:
-	const int BiomeDataSize = cChunkDef::Width * cChunkDef::Width;
+	const int SectionBlocks = cChunkDef::NumBlocks / NumSections;
+	const int BiomeDataSize = IsFullChunk() ? (cChunkDef::Width * cChunkDef::Width) : 0;
+	const int NumSent = GetNumSentSections();
 	UInt32 ChunkSize = (
-		(cChunkDef::NumBlocks * 2) +  // Block meta + type
-		sizeof(m_BlockLight) +        // Block light
-		sizeof(m_BlockSkyLight) +     // Block sky light
-		BiomeDataSize                 // Biome data
+		NumSent * (
+			(SectionBlocks * 2) +    // Block meta + type
+			(SectionBlocks / 2) +    // Block light
+			(SectionBlocks / 2)      // Block sky light
+		) +
+		BiomeDataSize              // Biome data
 	);
-	Packet.WriteVarInt(ChunkSize);
+	Header.WriteVarInt(ChunkSize);
+
+	AString Packet;
+	Header.ReadAll(Packet);
+	size_t HeaderSize = Packet.size();
+	Packet.resize(HeaderSize + ChunkSize);
+	unsigned char * Out = reinterpret_cast<unsigned char *>(&Packet[HeaderSize]);
 
-	// Write the block types to the packet:
-	for (size_t Index = 0; Index < cChunkDef::NumBlocks; Index++)
+	// Write the block types and metas, straight from the sections, as little-endian 16-bit (type << 4) | meta values.
+	// Two consecutive blocks share a meta byte, so they are processed in pairs, in a loop simple enough for the compiler to vectorize:
+	for (int Section = 0; Section < NumSections; Section++)
 	{
-		BLOCKTYPE BlockType = m_BlockTypes[Index] & 0xFF;
-		NIBBLETYPE BlockMeta = m_BlockMetas[Index / 2] >> ((Index & 1) * 4) & 0x0f;
-		Packet.WriteByte((unsigned char)(BlockType << 4) | BlockMeta);
-		Packet.WriteByte((unsigned char)(BlockType >> 4));
+		if ((m_SentSections & (1 << Section)) == 0)
+		{
+			continue;
+		}
+		const cChunkData::sChunkSection & Data = GetSection(Section);
+		const BLOCKTYPE * Types = Data.m_BlockTypes;
+		const NIBBLETYPE * Metas = Data.m_BlockMetas;
+		for (int i = 0; i < SectionBlocks / 2; i++)
+		{
+			unsigned char Type1 = Types[2 * i];
+			unsigned char Type2 = Types[2 * i + 1];
+			unsigned char Meta = Metas[i];
+			Out[4 * i]     = static_cast<unsigned char>((Type1 << 4) | (Meta & 0x0f));
+			Out[4 * i + 1] = static_cast<unsigned char>(Type1 >> 4);
+			Out[4 * i + 2] = static_cast<unsigned char>((Type2 << 4) | (Meta >> 4));
+			Out[4 * i + 3] = static_cast<unsigned char>(Type2 >> 4);
+		}
+		Out += SectionBlocks * 2;
 	}
 
 	// Write the rest:
-	Packet.WriteBuf(m_BlockLight,    sizeof(m_BlockLight));
-	Packet.WriteBuf(m_BlockSkyLight, sizeof(m_BlockSkyLight));
-	Packet.WriteBuf(m_BiomeData,     BiomeDataSize);
-
-	AString PacketData;
-	Packet.ReadAll(PacketData);
-	Packet.CommitRead();
-
-	cByteBuffer Buffer(20);
-	if (PacketData.size() >= 256)
+	for (int Section = 0; Section < NumSections; Section++)
 	{
-		if (!cProtocol180::CompressPacket(PacketData, a_Data))
+		if ((m_SentSections & (1 << Section)) != 0)
 		{
-			ASSERT(!"Packet compression failed.");
-			a_Data.clear();
-			return;
+			memcpy(Out, GetSection(Section).m_BlockLight, SectionBlocks / 2);
+			Out += SectionBlocks / 2;
 		}
 	}
-	else
+	for (int Section = 0; Section < NumSections; Section++)
 	{
-		AString PostData;
-		Buffer.WriteVarInt((UInt32)Packet.GetUsedSpace() + 1);
-		Buffer.WriteVarInt(0);
-		Buffer.ReadAll(PostData);
-		Buffer.CommitRead();
+		if ((m_SentSections & (1 << Section)) != 0)
+		{
+			memcpy(Out, GetSection(Section).m_BlockSkyLight, SectionBlocks / 2);
+			Out += SectionBlocks / 2;
+		}
+	}
+	if (IsFullChunk())
+	{
+		memcpy(Out, m_BiomeData, BiomeDataSize);
+		Out += BiomeDataSize;
+	}
+	ASSERT(Out == reinterpret_cast<unsigned char *>(&Packet[0]) + Packet.size());
 
+	a_Data.clear();
+	if (!FrameCompressedPacket(Packet, a_Data))
+	{
+		ASSERT(!"Packet compression failed.");
 		a_Data.clear();
-		a_Data.reserve(PostData.size() + PacketData.size());
-		a_Data.append(PostData.data(), PostData.size());
-		a_Data.append(PacketData.data(), PacketData.size());
 	}
 }
 
 
 
 
+
+int cChunkDataSerializer::GetNumSentSections(void) const
+{
+	int res = 0;
+	for (int Section = 0; Section < NumSections; Section++)
+	{
+		if ((m_SentSections & (1 << Section)) != 0)
+		{
+			res++;
+		}
+	}
+	return res;
+}
+
+
+
+
+
+const cChunkData::sChunkSection & cChunkDataSerializer::GetSection(int a_Section) const
+{
+	const cChunkData::sChunkSection * Section = m_Data.GetSection(static_cast<size_t>(a_Section));
+	return (Section != nullptr) ? *Section : g_EmptySection;
+}
+
+
+
+
@@ -9,15 +9,36 @@
 
 
 
+#pragma once
+
+#include "ChunkData.h"
+
+
+
+
+
 class cChunkDataSerializer
 {
 protected:
-	const cChunkDef::BlockTypes   & m_BlockTypes;
-	const cChunkDef::BlockNibbles & m_BlockMetas;
-	const cChunkDef::BlockNibbles & m_BlockLight;
-	const cChunkDef::BlockNibbles & m_BlockSkyLight;
+	/** The chunk's block data; read directly section by section, without making flat copies. */
+	const cChunkData & m_Data;
+
 	const unsigned char * m_BiomeData;
 	
+	/** Number of the 16-block-high sections in a chunk */
+	static const int NumSections = cChunkDef::Height / 16;
+	
+	/** Bitmask of the 16-block-high sections requested to be serialized. */
+	UInt16 m_SectionMask;
+
+	/** True if the full chunk is serialized ("ground-up continuous", with biomes), false for the changed sections only.
+	Set explicitly by the constructor used, a partial update with all the sections set is still a partial update. */
+	bool m_IsFullChunk;
+
+	/** Bitmask of the sections actually sent by the sectioned formats (1.3+).
+	For full chunks, the empty (unallocated) sections are left out, the client treats missing sections as empty. */
+	UInt16 m_SentSections;
+	
 	typedef std::map<int, AString> Serializations;
 	
 	Serializations m_Serializations;
@@ -26,6 +47,12 @@ protected:
 	void Serialize39(AString & a_Data);  // Release 1.3.1 to 1.7.10
 	void Serialize47(AString & a_Data, int a_ChunkX, int a_ChunkZ);  // Release 1.8
 	
+	/** Returns the number of sections set in m_SentSections */
+	int GetNumSentSections(void) const;
+
+	/** Returns the data of the specified section; for an unallocated section returns an all-default section. */
+	const cChunkData::sChunkSection & GetSection(int a_Section) const;
+	
 public:
 	enum
 	{
@@ -34,15 +61,28 @@ public:
 		RELEASE_1_8_0 = 47,
 	} ;
 	
+	/** Creates a serializer for the full chunk, to be sent to the clients that don't have the chunk yet.
+	The data must stay unchanged for the lifetime of the serializer. */
 	cChunkDataSerializer(
-		const cChunkDef::BlockTypes   & a_BlockTypes,
-		const cChunkDef::BlockNibbles & a_BlockMetas,
-		const cChunkDef::BlockNibbles & a_BlockLight,
-		const cChunkDef::BlockNibbles & a_BlockSkyLight,
-		const unsigned char *           a_BiomeData
+		const cChunkData &    a_Data,
+		const unsigned char * a_BiomeData
+	);
+
+	/** Creates a serializer for the specified sections of a chunk that the clients already have, such as for resending changed light.
+	The result is never a full chunk, even if all the sections are set in a_SectionMask.
+	The data must stay unchanged for the lifetime of the serializer. */
+	cChunkDataSerializer(
+		const cChunkData &    a_Data,
+		const unsigned char * a_BiomeData,
+		UInt16                a_SectionMask
 	);
 
 	const AString & Serialize(int a_Version, int a_ChunkX, int a_ChunkZ);  // Returns one of the internal m_Serializations[]
+	
+	/** Returns true if the serializer produces the full chunk.
+	If not, only the sections in the section mask are serialized, without the biomes, and the client
+	replaces just those sections in a chunk that it already has. Used for resending changed light. */
+	bool IsFullChunk(void) const { return m_IsFullChunk; }
 } ;
 
 
@@ -0,0 +1,81 @@
+
+// PacketFraming.cpp
+
+// Implements the functions that frame the 1.8 protocol packets for sending once the compression is enabled
+
+#include "Globals.h"
+#include "PacketFraming.h"
+#include "../ByteBuffer.h"
+#include "../StringCompression.h"
+
+
+
+
+
+const uLongf MAX_COMPRESSED_PACKET_LEN = 200 KiB;  // Maximum size of compressed packets.
+
+
+
+
+
+bool CompressPacket(const char * a_Packet, size_t a_Size, AString & a_CompressedData)
+{
+	// Compress the data:
+	char CompressedData[MAX_COMPRESSED_PACKET_LEN];
+
+	size_t CompressedSize = compressBound(a_Size);
+	if (CompressedSize >= MAX_COMPRESSED_PACKET_LEN)
+	{
+		ASSERT(!"Too high packet size.");
+		return false;
+	}
+
+	// Use the pooled zlib stream, setting up a new one for each packet would cost more than the compression itself:
+	int Status = CompressBuffer(a_Packet, a_Size, CompressedData, CompressedSize, Z_DEFAULT_COMPRESSION);
+	if (Status != Z_OK)
+	{
+		return false;
+	}
+
+	AString LengthData;
+	cByteBuffer Buffer(20);
+	Buffer.WriteVarInt((UInt32)a_Size);
+	Buffer.ReadAll(LengthData);
+	Buffer.CommitRead();
+
+	Buffer.WriteVarInt(CompressedSize + LengthData.size());
+	Buffer.WriteVarInt(a_Size);
+	Buffer.ReadAll(LengthData);
+	Buffer.CommitRead();
+
+	a_CompressedData.append(LengthData.data(), LengthData.size());
+	a_CompressedData.append(CompressedData, CompressedSize);
+	return true;
+}
+
+
+
+
+
+bool FrameCompressedPacket(const char * a_Packet, size_t a_Size, AString & a_Out)
+{
+	if (a_Size >= 256)
+	{
+		return CompressPacket(a_Packet, a_Size, a_Out);
+	}
+
+	// Not compressed, only prefixed with a zero data length:
+	cByteBuffer Buffer(20);
+	Buffer.WriteVarInt((UInt32)a_Size + 1);
+	Buffer.WriteVarInt(0);
+	AString LengthData;
+	Buffer.ReadAll(LengthData);
+	a_Out.append(LengthData);
+	a_Out.append(a_Packet, a_Size);
+	return true;
+}
+
+
+
+
+
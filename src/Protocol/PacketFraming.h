@@ -0,0 +1,34 @@
+
+// PacketFraming.h
+
+// Declares the functions that frame the 1.8 protocol packets for sending once the compression is enabled.
+// They don't depend on any protocol state, so that both the protocol and the chunk data serializer can use them.
+
+
+
+
+
+#pragma once
+
+
+
+
+
+/** Compress the packet. a_Packet must be without packet length.
+The compressed packet, including the packet length and data length, is appended to a_Compressed.
+If compression fails, the function returns false and a_Compressed is left unchanged. */
+extern bool CompressPacket(const char * a_Packet, size_t a_Size, AString & a_Compressed);
+
+/** Frames the packet (without packet length) the way it is sent in the game state, where the compression is enabled:
+packets over the compression threshold are compressed, the rest are sent with a zero data length.
+Appends the result to a_Out. If compression fails, the function returns false. */
+extern bool FrameCompressedPacket(const char * a_Packet, size_t a_Size, AString & a_Out);
+
+inline bool FrameCompressedPacket(const AString & a_Packet, AString & a_Out)
+{
+	return FrameCompressedPacket(a_Packet.data(), a_Packet.size(), a_Out);
+}
+
+
+
+
@@ -0,0 +1,426 @@
+
+// PacketWorkers.cpp
+
+// Implements the cPacketWorkers class representing the thread pool that compresses and encrypts the outgoing packets,
+// and the cPacketPipeline class representing a single client's queue of outgoing packets
+
+#include "Globals.h"
+#include "PacketWorkers.h"
+#include "PacketFraming.h"
+#include "../ClientHandle.h"
+#include "../CommandOutput.h"
+
+
+
+
+
+/** Returns the number of microseconds elapsed between the two timepoints. */
+static Int64 USecBetween(std::chrono::steady_clock::time_point a_Start, std::chrono::steady_clock::time_point a_End)
+{
+	return static_cast<Int64>(std::chrono::duration_cast<std::chrono::microseconds>(a_End - a_Start).count());
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cPacketWorkers:
+
+cPacketWorkers::cPacketWorkers(void)
+{
+}
+
+
+
+
+
+cPacketWorkers::~cPacketWorkers()
+{
+	Stop();
+}
+
+
+
+
+
+void cPacketWorkers::Start(int a_NumThreads)
+{
+	cCSLock Lock(m_CS);
+	ASSERT(m_Threads.empty());  // Not started yet
+	for (int i = 0; i < a_NumThreads; i++)
+	{
+		cWorkerThread * Thread = new cWorkerThread(*this);
+		if (!Thread->Start())
+		{
+			LOGWARNING("Cannot start a network worker thread, %d threads running.", i);
+			delete Thread;
+			break;
+		}
+		m_Threads.push_back(Thread);
+	}
+}
+
+
+
+
+
+void cPacketWorkers::Stop(void)
+{
+	// Signal all the threads to terminate and wait for them. Pipelines scheduled meanwhile are still added to m_Ready:
+	cWorkerThreads Threads;
+	{
+		cCSLock Lock(m_CS);
+		Threads = m_Threads;
+	}
+	for (cWorkerThreads::iterator itr = Threads.begin(), end = Threads.end(); itr != end; ++itr)
+	{
+		(*itr)->SignalStop();
+	}
+	m_evtWork.Set();  // Each terminating thread wakes up the next one
+	for (cWorkerThreads::iterator itr = Threads.begin(), end = Threads.end(); itr != end; ++itr)
+	{
+		(*itr)->Wait();
+	}
+
+	// From now on, the pipelines are processed inline; process the ones left waiting:
+	cPacketPipelines Ready;
+	{
+		cCSLock Lock(m_CS);
+		m_Threads.clear();
+		std::swap(Ready, m_Ready);
+	}
+	for (cPacketPipelines::iterator itr = Ready.begin(), end = Ready.end(); itr != end; ++itr)
+	{
+		ProcessPipelineInline(**itr);
+	}
+	for (cWorkerThreads::iterator itr = Threads.begin(), end = Threads.end(); itr != end; ++itr)
+	{
+		delete *itr;
+	}
+}
+
+
+
+
+
+void cPacketWorkers::Schedule(cPacketPipeline & a_Pipeline)
+{
+	{
+		cCSLock Lock(m_CS);
+		if (!m_Threads.empty())
+		{
+			m_Ready.push_back(&a_Pipeline);
+			m_evtWork.Set();
+			return;
+		}
+	}
+
+	// There are no workers, process right away:
+	ProcessPipelineInline(a_Pipeline);
+}
+
+
+
+
+
+void cPacketWorkers::LogStats(cCommandOutputCallback & a_Output)
+{
+	sStats Stats;
+	size_t NumThreads, NumReady;
+	{
+		cCSLock Lock(m_CS);
+		NumThreads = m_Threads.size();
+		NumReady = m_Ready.size();
+	}
+	{
+		cCSLock Lock(m_CSStats);
+		Stats = m_Stats;
+	}
+
+	a_Output.Out("Network workers: " SIZE_T_FMT " threads, " SIZE_T_FMT " clients waiting", NumThreads, NumReady);
+	const struct
+	{
+		const char * m_Name;
+		const sStageStats & m_Stats;
+	} Stages[] =
+	{
+		{ "queue wait", Stats.m_Queue },
+		{ "compression", Stats.m_Compression },
+		{ "encryption", Stats.m_Encryption },
+	};
+	for (size_t i = 0; i < ARRAYCOUNT(Stages); i++)
+	{
+		const sStageStats & Stage = Stages[i].m_Stats;
+		a_Output.Out("  %s: %lld items, avg %.1f us, max %lld us",
+			Stages[i].m_Name,
+			static_cast<long long>(Stage.m_NumItems),
+			(Stage.m_NumItems > 0) ? static_cast<double>(Stage.m_TotalUSec) / Stage.m_NumItems : 0.0,
+			static_cast<long long>(Stage.m_MaxUSec)
+		);
+	}
+}
+
+
+
+
+
+cPacketPipeline * cPacketWorkers::GetNextPipeline(void)
+{
+	cCSLock Lock(m_CS);
+	if (m_Ready.empty())
+	{
+		return nullptr;
+	}
+	cPacketPipeline * res = m_Ready.front();
+	m_Ready.pop_front();
+	if (!m_Ready.empty())
+	{
+		// Wake up another worker for the rest:
+		m_evtWork.Set();
+	}
+	return res;
+}
+
+
+
+
+
+void cPacketWorkers::ProcessPipeline(cPacketPipeline & a_Pipeline)
+{
+	sStats Stats;
+	bool ShouldReschedule = a_Pipeline.ProcessQueue(Stats);
+	{
+		cCSLock Lock(m_CSStats);
+		m_Stats.m_Queue.Add(Stats.m_Queue);
+		m_Stats.m_Compression.Add(Stats.m_Compression);
+		m_Stats.m_Encryption.Add(Stats.m_Encryption);
+	}
+	if (ShouldReschedule)
+	{
+		// Put the pipeline at the end of the queue, so that a single busy client doesn't starve the others:
+		cCSLock Lock(m_CS);
+		m_Ready.push_back(&a_Pipeline);
+		m_evtWork.Set();
+	}
+}
+
+
+
+
+
+void cPacketWorkers::ProcessPipelineInline(cPacketPipeline & a_Pipeline)
+{
+	sStats Stats;
+	while (a_Pipeline.ProcessQueue(Stats))
+	{
+		// Nothing needed, just process until the pipeline gets empty
+	}
+	cCSLock Lock(m_CSStats);
+	m_Stats.m_Queue.Add(Stats.m_Queue);
+	m_Stats.m_Compression.Add(Stats.m_Compression);
+	m_Stats.m_Encryption.Add(Stats.m_Encryption);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cPacketWorkers::cWorkerThread:
+
+cPacketWorkers::cWorkerThread::cWorkerThread(cPacketWorkers & a_Parent) :
+	super("cPacketWorkers::cWorkerThread"),
+	m_Parent(a_Parent)
+{
+}
+
+
+
+
+
+void cPacketWorkers::cWorkerThread::Execute(void)
+{
+	while (!m_ShouldTerminate)
+	{
+		cPacketPipeline * Pipeline = m_Parent.GetNextPipeline();
+		if (Pipeline == nullptr)
+		{
+			m_Parent.m_evtWork.Wait();
+			continue;
+		}
+		m_Parent.ProcessPipeline(*Pipeline);
+	}
+
+	// Wake up the next thread, so that it terminates as well:
+	m_Parent.m_evtWork.Set();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cPacketPipeline:
+
+cPacketPipeline::cPacketPipeline(cClientHandle & a_Client, cPacketWorkers & a_Workers) :
+	m_Client(a_Client),
+	m_Workers(a_Workers),
+	m_IsScheduled(false),
+	m_IsEncrypted(false)
+{
+}
+
+
+
+
+
+cPacketPipeline::~cPacketPipeline()
+{
+	// The workers may still be processing the queue, wait for them to finish:
+	Flush();
+}
+
+
+
+
+
+void cPacketPipeline::QueuePacket(const AString & a_Packet)
+{
+	Queue(sItem::ikPacket, a_Packet.data(), a_Packet.size());
+}
+
+
+
+
+
+void cPacketPipeline::QueueData(const char * a_Data, size_t a_Size)
+{
+	if (a_Size > 0)
+	{
+		Queue(sItem::ikData, a_Data, a_Size);
+	}
+}
+
+
+
+
+
+void cPacketPipeline::QueueStartEncryption(const Byte * a_Key)
+{
+	Queue(sItem::ikStartEncryption, reinterpret_cast<const char *>(a_Key), 16);
+}
+
+
+
+
+
+void cPacketPipeline::Flush(void)
+{
+	std::unique_lock<std::mutex> Lock(m_Mutex);
+	m_IdleCondVar.wait(Lock, [this]() { return !m_IsScheduled; });
+}
+
+
+
+
+
+void cPacketPipeline::Queue(sItem::eKind a_Kind, const char * a_Data, size_t a_Size)
+{
+	{
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		m_Queue.m_Items.push_back(sItem(a_Kind, m_Queue.m_Data.size(), a_Size));
+		m_Queue.m_Data.append(a_Data, a_Size);
+		if (m_IsScheduled)
+		{
+			// Already waiting for a worker or being processed, the worker will pick the item up
+			return;
+		}
+		m_IsScheduled = true;
+	}
+	m_Workers.Schedule(*this);
+}
+
+
+
+
+
+bool cPacketPipeline::ProcessQueue(cPacketWorkers::sStats & a_Stats)
+{
+	ASSERT(m_Processing.m_Items.empty());
+	{
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		if (m_Queue.m_Items.empty())
+		{
+			// Notify while still locked, so that Flush() in the destructor cannot finish before we're done with the object:
+			m_IsScheduled = false;
+			m_IdleCondVar.notify_all();
+			return false;
+		}
+		std::swap(m_Queue, m_Processing);
+	}
+
+	// Frame all the items into m_Outgoing, so that they are encrypted and sent at once:
+	ASSERT(m_Outgoing.empty());
+	std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+	for (sItems::const_iterator itr = m_Processing.m_Items.begin(), end = m_Processing.m_Items.end(); itr != end; ++itr)
+	{
+		a_Stats.m_Queue.Add(USecBetween(itr->m_QueuedAt, Start));
+		const char * Data = m_Processing.m_Data.data() + itr->m_Start;
+		switch (itr->m_Kind)
+		{
+			case sItem::ikPacket:
+			{
+				// A packet that fails to compress is dropped, FrameCompressedPacket() doesn't append anything then:
+				FrameCompressedPacket(Data, itr->m_Size, m_Outgoing);
+				a_Stats.m_Compression.Add(USecBetween(Start, std::chrono::steady_clock::now()));
+				break;
+			}
+			case sItem::ikData:
+			{
+				m_Outgoing.append(Data, itr->m_Size);
+				break;
+			}
+			case sItem::ikStartEncryption:
+			{
+				// The data framed so far is to be sent unencrypted:
+				SendOutgoing(a_Stats);
+				const Byte * Key = reinterpret_cast<const Byte *>(Data);
+				m_Encryptor.Init(Key, Key);
+				m_IsEncrypted = true;
+				break;
+			}
+		}
+		Start = std::chrono::steady_clock::now();
+	}
+	SendOutgoing(a_Stats);
+	m_Processing.Clear();
+	return true;
+}
+
+
+
+
+
+void cPacketPipeline::SendOutgoing(cPacketWorkers::sStats & a_Stats)
+{
+	if (m_Outgoing.empty())
+	{
+		return;
+	}
+
+	if (m_IsEncrypted)
+	{
+		// The encryptor processes the data byte by byte, it may encrypt in place:
+		std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+		Byte * Data = reinterpret_cast<Byte *>(&m_Outgoing[0]);
+		m_Encryptor.ProcessData(Data, Data, m_Outgoing.size());
+		a_Stats.m_Encryption.Add(USecBetween(Start, std::chrono::steady_clock::now()));
+	}
+	m_Client.SendData(m_Outgoing.data(), m_Outgoing.size());
+	m_Outgoing.clear();
+}
+
+
+
+
@@ -0,0 +1,277 @@
+
+// PacketWorkers.h
+
+// Declares the cPacketWorkers class representing the thread pool that compresses and encrypts the outgoing packets,
+// and the cPacketPipeline class representing a single client's queue of outgoing packets
+
+/*
+Packets are composed on whatever thread is sending them - often the world tick thread (broadcasts) or the cChunkSender.
+Compressing and encrypting them there would make the tick pay for the network CPU, so cProtocol180 only queues the
+raw packets into its cPacketPipeline. Whenever a pipeline has queued packets, it is scheduled into cPacketWorkers;
+one of the worker threads then frames and compresses the packets, encrypts them and hands them over to the cClientHandle.
+
+A pipeline is processed by at most one worker at a time, and the worker processes the packets in the queue order,
+so the order of the packets sent to a single client is preserved. The encryptor state lives in the pipeline and is
+only ever touched by the thread processing it; even starting the encryption is queued as an item, so that the
+packets queued before it are sent unencrypted.
+
+When there are no worker threads (configured to zero, or already stopped), the pipelines are processed directly
+in the thread that queues the packets, same as before the workers existed.
+*/
+
+
+
+
+
+#pragma once
+
+#include "OSSupport/IsThread.h"
+#include "PolarSSL++/AesCfb128Encryptor.h"
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+
+
+
+
+
+// fwd:
+class cClientHandle;
+class cCommandOutputCallback;
+class cPacketPipeline;
+
+
+
+
+
+class cPacketWorkers
+{
+public:
+
+	/** Statistics of a single processing stage */
+	struct sStageStats
+	{
+		Int64 m_NumItems;
+		Int64 m_TotalUSec;
+		Int64 m_MaxUSec;
+
+		sStageStats(void) : m_NumItems(0), m_TotalUSec(0), m_MaxUSec(0) {}
+
+		void Add(Int64 a_USec)
+		{
+			m_NumItems += 1;
+			m_TotalUSec += a_USec;
+			m_MaxUSec = std::max(m_MaxUSec, a_USec);
+		}
+
+		void Add(const sStageStats & a_Other)
+		{
+			m_NumItems += a_Other.m_NumItems;
+			m_TotalUSec += a_Other.m_TotalUSec;
+			m_MaxUSec = std::max(m_MaxUSec, a_Other.m_MaxUSec);
+		}
+	};
+
+	/** Statistics of all the processing stages */
+	struct sStats
+	{
+		/** Time between queueing an item and a worker starting to process it */
+		sStageStats m_Queue;
+
+		/** Time spent framing and compressing a packet */
+		sStageStats m_Compression;
+
+		/** Time spent encrypting a packet */
+		sStageStats m_Encryption;
+	};
+
+
+	cPacketWorkers(void);
+	~cPacketWorkers();
+
+	/** Starts the specified number of worker threads.
+	With zero threads, the pipelines are processed directly in the thread that queues the packets. */
+	void Start(int a_NumThreads);
+
+	/** Stops all the worker threads. Any pipelines still waiting are processed in the calling thread. */
+	void Stop(void);
+
+	/** Queues the pipeline to be processed by a worker thread, or processes it right away if there are no workers.
+	Called by cPacketPipeline when it gets new packets queued while not scheduled. */
+	void Schedule(cPacketPipeline & a_Pipeline);
+
+	/** Outputs the per-stage statistics collected since the start. */
+	void LogStats(cCommandOutputCallback & a_Output);
+
+protected:
+
+	class cWorkerThread :
+		public cIsThread
+	{
+		typedef cIsThread super;
+
+	public:
+		cWorkerThread(cPacketWorkers & a_Parent);
+
+		/** Signals the thread to terminate, without waiting for it. */
+		void SignalStop(void) { m_ShouldTerminate = true; }
+
+	protected:
+		cPacketWorkers & m_Parent;
+
+		// cIsThread overrides:
+		virtual void Execute(void) override;
+	} ;
+
+	typedef std::vector<cWorkerThread *> cWorkerThreads;
+	typedef std::list<cPacketPipeline *> cPacketPipelines;
+
+
+	/** Protects m_Threads and m_Ready against multithreaded access */
+	cCriticalSection m_CS;
+
+	/** The running worker threads */
+	cWorkerThreads m_Threads;
+
+	/** The pipelines that have items queued and are waiting for a worker */
+	cPacketPipelines m_Ready;
+
+	/** Set when a pipeline is added to m_Ready, or when the workers are to terminate */
+	cEvent m_evtWork;
+
+	/** Protects m_Stats against multithreaded access */
+	cCriticalSection m_CSStats;
+
+	/** The statistics collected since the start */
+	sStats m_Stats;
+
+
+	/** Returns the next pipeline waiting to be processed, or nullptr if there is none. */
+	cPacketPipeline * GetNextPipeline(void);
+
+	/** Processes one batch of the pipeline's queue, then reschedules it if it may have more items. */
+	void ProcessPipeline(cPacketPipeline & a_Pipeline);
+
+	/** Processes the pipeline's queue in the calling thread, until there's nothing left. */
+	void ProcessPipelineInline(cPacketPipeline & a_Pipeline);
+} ;
+
+
+
+
+
+class cPacketPipeline
+{
+public:
+
+	cPacketPipeline(cClientHandle & a_Client, cPacketWorkers & a_Workers);
+
+	/** Waits until all the queued items have been processed. */
+	~cPacketPipeline();
+
+	/** Queues a game-state packet (packet ID + payload) to be framed, compressed and encrypted. */
+	void QueuePacket(const AString & a_Packet);
+
+	/** Queues already framed data to be encrypted and sent. */
+	void QueueData(const char * a_Data, size_t a_Size);
+
+	/** Queues the start of encryption; all data queued afterwards is encrypted with the specified 16-byte key. */
+	void QueueStartEncryption(const Byte * a_Key);
+
+	/** Waits until everything queued so far has been handed over to the client handle. */
+	void Flush(void);
+
+protected:
+
+	friend class cPacketWorkers;
+
+	/** A single queued item; its data is stored in the data buffer of the batch the item is in */
+	struct sItem
+	{
+		enum eKind
+		{
+			ikPacket,           ///< A packet to be framed, compressed and encrypted
+			ikData,             ///< Framed data, to be encrypted only
+			ikStartEncryption,  ///< Start of the encryption, the data is the key
+		} m_Kind;
+
+		/** Offset of the item's data in the batch's data buffer */
+		size_t m_Start;
+
+		/** Size of the item's data */
+		size_t m_Size;
+
+		std::chrono::steady_clock::time_point m_QueuedAt;
+
+		sItem(eKind a_Kind, size_t a_Start, size_t a_Size) :
+			m_Kind(a_Kind),
+			m_Start(a_Start),
+			m_Size(a_Size),
+			m_QueuedAt(std::chrono::steady_clock::now())
+		{
+		}
+	};
+
+	typedef std::vector<sItem> sItems;
+
+	/** Items with all their data stored back to back in a single buffer.
+	Clearing keeps the memory of both, so the queue and the processed batch, swapped back and forth, get reused without allocating. */
+	struct sBatch
+	{
+		sItems  m_Items;
+		AString m_Data;
+
+		void Clear(void)
+		{
+			m_Items.clear();
+			m_Data.clear();
+		}
+	};
+
+
+	cClientHandle & m_Client;
+
+	cPacketWorkers & m_Workers;
+
+	/** Protects m_Queue and m_IsScheduled against multithreaded access.
+	A plain mutex, so that m_IdleCondVar can wait on it. */
+	std::mutex m_Mutex;
+
+	/** The items waiting to be processed */
+	sBatch m_Queue;
+
+	/** True while the pipeline is waiting in cPacketWorkers or being processed. */
+	bool m_IsScheduled;
+
+	/** Notified whenever the pipeline becomes idle (m_IsScheduled is reset); Flush() waits on it for any number of flushing threads. */
+	std::condition_variable m_IdleCondVar;
+
+	/** The items being processed; only accessed by the thread processing the pipeline, kept as a member to reuse its memory. */
+	sBatch m_Processing;
+
+	/** The framed data of the processed items, encrypted in place and sent in a single piece.
+	Only accessed by the thread processing the pipeline, kept as a member to reuse its memory. */
+	AString m_Outgoing;
+
+	/** Encrypts the outgoing data; only accessed by the thread processing the pipeline. */
+	cAesCfb128Encryptor m_Encryptor;
+
+	/** True if the data is to be encrypted; only accessed by the thread processing the pipeline. */
+	bool m_IsEncrypted;
+
+
+	/** Adds the item to the queue and schedules the pipeline, if needed. */
+	void Queue(sItem::eKind a_Kind, const char * a_Data, size_t a_Size);
+
+	/** Processes all the items currently in the queue, adding the stage times to a_Stats.
+	Returns true if the pipeline is to be processed again (more items may have been queued meanwhile),
+	false if the queue was empty and the pipeline is no longer scheduled. */
+	bool ProcessQueue(cPacketWorkers::sStats & a_Stats);
+
+	/** Encrypts m_Outgoing, if needed, sends it to the client handle and clears it. */
+	void SendOutgoing(cPacketWorkers::sStats & a_Stats);
+} ;
+
+
+
+
@@ -74,6 +74,7 @@ public:
 	virtual void SendEntityHeadLook             (const cEntity & a_Entity) = 0;
 	virtual void SendEntityLook                 (const cEntity & a_Entity) = 0;
 	virtual void SendEntityMetadata             (const cEntity & a_Entity) = 0;
+	virtual void SendEntityMetadataChanges      (const cEntity & a_Entity) = 0;  ///< Only the entries changed since the previous metadata broadcast; used only for broadcasts
 	virtual void SendEntityProperties           (const cEntity & a_Entity) = 0;
 	virtual void SendEntityRelMove              (const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ) = 0;
 	virtual void SendEntityRelMoveLook          (const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ) = 0;
@@ -113,6 +114,7 @@ public:
 	virtual void SendDisplayObjective           (const AString & a_Objective, cScoreboard::eDisplaySlot a_Display) = 0;
 	virtual void SendSoundEffect                (const AString & a_SoundName, double a_X, double a_Y, double a_Z, float a_Volume, float a_Pitch) = 0;
 	virtual void SendSoundParticleEffect        (int a_EffectID, int a_SrcX, int a_SrcY, int a_SrcZ, int a_Data) = 0;
+	virtual void SendSpawnEntities              (const cEntityList & a_Entities) = 0;  ///< Spawns all the entities, such as when the client starts watching a chunk
 	virtual void SendSpawnFallingBlock          (const cFallingBlock & a_FallingBlock) = 0;
 	virtual void SendSpawnMob                   (const cMonster & a_Mob) = 0;
 	virtual void SendSpawnObject                (const cEntity & a_Entity, char a_ObjectType, int a_ObjectData, Byte a_Yaw, Byte a_Pitch) = 0;
@@ -422,6 +422,16 @@ void cProtocol172::SendEntityMetadata(const cEntity & a_Entity)
 
 
 
+void cProtocol172::SendEntityMetadataChanges(const cEntity & a_Entity)
+{
+	// The 1.7 protocol doesn't track the changes, it always sends the full metadata:
+	SendEntityMetadata(a_Entity);
+}
+
+
+
+
+
 void cProtocol172::SendEntityProperties(const cEntity & a_Entity)
 {
 	ASSERT(m_State == 3);  // In game mode?
@@ -1112,6 +1122,20 @@ void cProtocol172::SendSoundParticleEffect(int a_EffectID, int a_SrcX, int a_Src
 
 
 
+void cProtocol172::SendSpawnEntities(const cEntityList & a_Entities)
+{
+	ASSERT(m_State == 3);  // In game mode?
+	
+	for (cEntityList::const_iterator itr = a_Entities.begin(), end = a_Entities.end(); itr != end; ++itr)
+	{
+		(*itr)->SpawnOn(*m_Client);
+	}
+}
+
+
+
+
+
 void cProtocol172::SendSpawnFallingBlock(const cFallingBlock & a_FallingBlock)
 {
 	ASSERT(m_State == 3);  // In game mode?
@@ -12,6 +12,7 @@ Implements the 1.8.x protocol classes:
 #include "json/json.h"
 #include "Protocol18x.h"
 #include "ChunkDataSerializer.h"
+#include "ProtocolRecognizer.h"
 #include "PolarSSL++/Sha1Checksum.h"
 
 #include "../ClientHandle.h"
@@ -76,7 +77,6 @@ Implements the 1.8.x protocol classes:
 
 
 const int MAX_ENC_LEN = 512;  // Maximum size of the encrypted message; should be 128, but who knows...
-const uLongf MAX_COMPRESSED_PACKET_LEN = 200 KiB;  // Maximum size of compressed packets.
 
 
 
@@ -100,7 +100,9 @@ cProtocol180::cProtocol180(cClientHandle * a_Client, const AString & a_ServerAdd
 	m_ReceivedData(32 KiB),
 	m_OutPacketBuffer(64 KiB),
 	m_OutPacketLenBuffer(20),  // 20 bytes is more than enough for one VarInt
+	m_OutMetadataBuffer(16 KiB),
 	m_IsEncrypted(false),
+	m_Pipeline(*a_Client, cRoot::Get()->GetServer()->GetPacketWorkers()),
 	m_LastSentDimension(dimNotSet)
 {
 	// Create the comm log file, if so requested:
@@ -308,6 +310,9 @@ void cProtocol180::SendDisconnect(const AString & a_Reason)
 			break;
 		}
 	}
+
+	// The client handle drops any data sent after the disconnect, make sure the packet gets there before that:
+	m_Pipeline.Flush();
 }
 
 
@@ -388,9 +393,40 @@ void cProtocol180::SendEntityMetadata(const cEntity & a_Entity)
 {
 	ASSERT(m_State == 3);  // In game mode?
 	
+	AString Metadata;
+	GetFullEntityMetadata(a_Entity, Metadata);
+
+	cPacketizer Pkt(*this, 0x1c);  // Entity Metadata packet
+	Pkt.WriteVarInt(a_Entity.GetUniqueID());
+	Pkt.WriteBuf(Metadata.data(), Metadata.size());
+	Pkt.WriteByte(0x7f);  // The termination byte
+}
+
+
+
+
+
+void cProtocol180::SendEntityMetadataChanges(const cEntity & a_Entity)
+{
+	ASSERT(m_State == 3);  // In game mode?
+	
+	// The first 1.8 client in the broadcast computes the changes, the rest reuse them:
+	AString Changes;
+	if (!a_Entity.GetMetadataBroadcastChanges(cProtocolRecognizer::PROTO_VERSION_1_8_0, Changes))
+	{
+		cEntity::cMetadataEntries Entries;
+		EncodeEntityMetadata(a_Entity, Entries);
+		a_Entity.SetMetadataBroadcast(cProtocolRecognizer::PROTO_VERSION_1_8_0, Entries, Changes);
+	}
+	if (Changes.empty())
+	{
+		// Nothing has changed since the last broadcast
+		return;
+	}
+
 	cPacketizer Pkt(*this, 0x1c);  // Entity Metadata packet
 	Pkt.WriteVarInt(a_Entity.GetUniqueID());
-	Pkt.WriteEntityMetadata(a_Entity);
+	Pkt.WriteBuf(Changes.data(), Changes.size());
 	Pkt.WriteByte(0x7f);  // The termination byte
 }
 
@@ -1144,6 +1180,26 @@ void cProtocol180::SendSoundParticleEffect(int a_EffectID, int a_SrcX, int a_Src
 
 
 
+void cProtocol180::SendSpawnEntities(const cEntityList & a_Entities)
+{
+	ASSERT(m_State == 3);  // In game mode?
+	
+	// Hold the packet CS for the whole batch, so that no other thread's packets get captured:
+	cCSLock Lock(m_CSPacket);
+	AString Batch;
+	m_SpawnPacketCapture.BuildBatch(a_Entities, cProtocolRecognizer::PROTO_VERSION_1_8_0, *m_Client, Batch);
+	
+	// Send the whole batch at once:
+	if (!Batch.empty())
+	{
+		SendData(Batch.data(), Batch.size());
+	}
+}
+
+
+
+
+
 void cProtocol180::SendSpawnFallingBlock(const cFallingBlock & a_FallingBlock)
 {
 	ASSERT(m_State == 3);  // In game mode?
@@ -1170,6 +1226,9 @@ void cProtocol180::SendSpawnMob(const cMonster & a_Mob)
 {
 	ASSERT(m_State == 3);  // In game mode?
 	
+	AString Metadata;
+	GetFullEntityMetadata(a_Mob, Metadata);
+
 	cPacketizer Pkt(*this, 0x0f);  // Spawn Mob packet
 	Pkt.WriteVarInt(a_Mob.GetUniqueID());
 	Pkt.WriteByte((Byte)a_Mob.GetMobType());
@@ -1182,7 +1241,7 @@ void cProtocol180::SendSpawnMob(const cMonster & a_Mob)
 	Pkt.WriteShort((short)(a_Mob.GetSpeedX() * 400));
 	Pkt.WriteShort((short)(a_Mob.GetSpeedY() * 400));
 	Pkt.WriteShort((short)(a_Mob.GetSpeedZ() * 400));
-	Pkt.WriteEntityMetadata(a_Mob);
+	Pkt.WriteBuf(Metadata.data(), Metadata.size());
 	Pkt.WriteByte(0x7f);  // Metadata terminator
 }
 
@@ -1515,46 +1574,6 @@ void cProtocol180::SendWindowProperty(const cWindow & a_Window, short a_Property
 
 
 
-bool cProtocol180::CompressPacket(const AString & a_Packet, AString & a_CompressedData)
-{
-	// Compress the data:
-	char CompressedData[MAX_COMPRESSED_PACKET_LEN];
-
-	uLongf CompressedSize = compressBound(a_Packet.size());
-	if (CompressedSize >= MAX_COMPRESSED_PACKET_LEN)
-	{
-		ASSERT(!"Too high packet size.");
-		return false;
-	}
-
-	int Status = compress2((Bytef*)CompressedData, &CompressedSize, (const Bytef*)a_Packet.data(), a_Packet.size(), Z_DEFAULT_COMPRESSION);
-	if (Status != Z_OK)
-	{
-		return false;
-	}
-
-	AString LengthData;
-	cByteBuffer Buffer(20);
-	Buffer.WriteVarInt((UInt32)a_Packet.size());
-	Buffer.ReadAll(LengthData);
-	Buffer.CommitRead();
-
-	Buffer.WriteVarInt(CompressedSize + LengthData.size());
-	Buffer.WriteVarInt(a_Packet.size());
-	Buffer.ReadAll(LengthData);
-	Buffer.CommitRead();
-
-	a_CompressedData.clear();
-	a_CompressedData.reserve(LengthData.size() + CompressedSize);
-	a_CompressedData.append(LengthData.data(), LengthData.size());
-	a_CompressedData.append(CompressedData, CompressedSize);
-	return true;
-}
-
-
-
-
-
 int cProtocol180::GetParticleID(const AString & a_ParticleName)
 {
 	static bool IsInitialized = false;
@@ -2602,22 +2621,57 @@ void cProtocol180::HandleVanillaPluginMessage(cByteBuffer & a_ByteBuffer, const
 
 void cProtocol180::SendData(const char * a_Data, size_t a_Size)
 {
-	if (m_IsEncrypted)
+	if (m_SpawnPacketCapture.CaptureData(a_Data, a_Size))
 	{
-		Byte Encrypted[8192];  // Larger buffer, we may be sending lots of data (chunks)
-		while (a_Size > 0)
-		{
-			size_t NumBytes = (a_Size > sizeof(Encrypted)) ? sizeof(Encrypted) : a_Size;
-			m_Encryptor.ProcessData(Encrypted, (Byte *)a_Data, NumBytes);
-			m_Client->SendData((const char *)Encrypted, NumBytes);
-			a_Size -= NumBytes;
-			a_Data += NumBytes;
-		}
+		// SendSpawnEntities() is building the spawn packets to be cached
+		return;
 	}
-	else
+
+	// The encryption is done by the network workers:
+	m_Pipeline.QueueData(a_Data, a_Size);
+}
+
+
+
+
+
+void cProtocol180::EncodeEntityMetadata(const cEntity & a_Entity, cEntity::cMetadataEntries & a_Entries)
+{
+	cPacketizer Enc(*this, a_Entries);
+	Enc.WriteEntityMetadata(a_Entity);
+}
+
+
+
+
+
+void cProtocol180::GetFullEntityMetadata(const cEntity & a_Entity, AString & a_Metadata)
+{
+	cEntity::cMetadataEntries Entries;
+	EncodeEntityMetadata(a_Entity, Entries);
+	for (cEntity::cMetadataEntries::const_iterator itr = Entries.begin(), end = Entries.end(); itr != end; ++itr)
 	{
-		m_Client->SendData(a_Data, a_Size);
+		a_Metadata.append(itr->second);
 	}
+
+	// If this client now has a different state than the last broadcast, the next broadcast needs to send everything:
+	a_Entity.MetadataSentFull(cProtocolRecognizer::PROTO_VERSION_1_8_0, Entries);
+}
+
+
+
+
+
+void cProtocol180::SendPacket(const AString & a_Packet)
+{
+	if (m_SpawnPacketCapture.CapturePacket(a_Packet))
+	{
+		// SendSpawnEntities() is building the spawn packets to be cached
+		return;
+	}
+
+	// The framing, compression and encryption is done by the network workers:
+	m_Pipeline.QueuePacket(a_Packet);
 }
 
 
@@ -2732,7 +2786,7 @@ void cProtocol180::ParseItemMetadata(cItem & a_Item, const AString & a_Metadata)
 
 void cProtocol180::StartEncryption(const Byte * a_Key)
 {
-	m_Encryptor.Init(a_Key, a_Key);
+	m_Pipeline.QueueStartEncryption(a_Key);  // All data queued from now on will be encrypted
 	m_Decryptor.Init(a_Key, a_Key);
 	m_IsEncrypted = true;
 	
@@ -2757,44 +2811,41 @@ void cProtocol180::StartEncryption(const Byte * a_Key)
 
 cProtocol180::cPacketizer::~cPacketizer()
 {
-	UInt32 PacketLen = (UInt32)m_Out.GetUsedSpace();
-	AString PacketData, CompressedPacket;
-	m_Out.ReadAll(PacketData);
-	m_Out.CommitRead();
-
-	if ((m_Protocol.m_State == 3) && (PacketLen >= 256))
+	if (m_MetadataEntries != nullptr)
 	{
-		if (!cProtocol180::CompressPacket(PacketData, CompressedPacket))
+		// Only encoding the metadata, split it into the entries:
+		AString Data;
+		m_Out.ReadAll(Data);
+		m_Out.CommitRead();
+		for (size_t i = 0; i < m_MetadataEntryStarts.size(); i++)
 		{
-			return;
+			size_t Start = m_MetadataEntryStarts[i];
+			size_t End = (i + 1 < m_MetadataEntryStarts.size()) ? m_MetadataEntryStarts[i + 1] : Data.size();
+			int Index = static_cast<Byte>(Data[Start]) & 0x1f;
+			(*m_MetadataEntries)[Index].assign(Data, Start, End - Start);
 		}
+		return;
 	}
-	else if (m_Protocol.m_State == 3)
-	{
-		m_Protocol.m_OutPacketLenBuffer.WriteVarInt(PacketLen + 1);
-		m_Protocol.m_OutPacketLenBuffer.WriteVarInt(0);
 
-		AString LengthData;
-		m_Protocol.m_OutPacketLenBuffer.ReadAll(LengthData);
-		m_Protocol.SendData(LengthData.data(), LengthData.size());
+	UInt32 PacketLen = (UInt32)m_Out.GetUsedSpace();
+	AString PacketData;
+	m_Out.ReadAll(PacketData);
+	m_Out.CommitRead();
+
+	if (m_Protocol.m_State == 3)
+	{
+		// The compression is enabled in the game state, leave the framing and compression to the network workers:
+		m_Protocol.SendPacket(PacketData);
 	}
 	else
 	{
 		m_Protocol.m_OutPacketLenBuffer.WriteVarInt(PacketLen);
 
-		AString LengthData;
-		m_Protocol.m_OutPacketLenBuffer.ReadAll(LengthData);
-		m_Protocol.SendData(LengthData.data(), LengthData.size());
-	}
-
-	if (CompressedPacket.empty())
-	{
+		AString Framed;
+		m_Protocol.m_OutPacketLenBuffer.ReadAll(Framed);
 		m_Protocol.m_OutPacketLenBuffer.CommitRead();
-		m_Protocol.SendData(PacketData.data(), PacketData.size());
-	}
-	else
-	{
-		m_Protocol.SendData(CompressedPacket.data(), CompressedPacket.size());
+		Framed.append(PacketData);
+		m_Protocol.SendData(Framed.data(), Framed.size());
 	}
 
 	// Log the comm into logfile:
@@ -2920,6 +2971,15 @@ void cProtocol180::cPacketizer::WriteItem(const cItem & a_Item)
 
 void cProtocol180::cPacketizer::WriteBlockEntity(const cBlockEntity & a_BlockEntity)
 {
+	// If the block entity hasn't changed since it was last sent, reuse its NBT:
+	AString CachedNBT;
+	if (a_BlockEntity.GetCachedNBT(cBlockEntity::nbtNetwork, CachedNBT))
+	{
+		WriteBuf(CachedNBT.data(), CachedNBT.size());
+		return;
+	}
+	int CacheGeneration = a_BlockEntity.GetNBTCacheGeneration();
+
 	cFastNBTWriter Writer;
 
 	switch (a_BlockEntity.GetBlockType())
@@ -3004,6 +3064,7 @@ void cProtocol180::cPacketizer::WriteBlockEntity(const cBlockEntity & a_BlockEnt
 
 	Writer.Finish();
 	WriteBuf(Writer.GetResult().data(), Writer.GetResult().size());
+	a_BlockEntity.SetCachedNBT(cBlockEntity::nbtNetwork, Writer.GetResult(), CacheGeneration);
 }
 
 
@@ -3029,6 +3090,19 @@ void cProtocol180::cPacketizer::WriteFPInt(double a_Value)
 
 
 
+void cProtocol180::cPacketizer::WriteMetadataHeader(Byte a_Header)
+{
+	if (m_MetadataEntries != nullptr)
+	{
+		m_MetadataEntryStarts.push_back(m_Out.GetUsedSpace());
+	}
+	m_Out.WriteByte(a_Header);
+}
+
+
+
+
+
 void cProtocol180::cPacketizer::WriteEntityMetadata(const cEntity & a_Entity)
 {
 	// Common metadata:
@@ -3053,7 +3127,7 @@ void cProtocol180::cPacketizer::WriteEntityMetadata(const cEntity & a_Entity)
 	{
 		Flags |= 0x20;
 	}
-	WriteByte(0);  // Byte(0) + index 0
+	WriteMetadataHeader(0);  // Byte(0) + index 0
 	WriteByte(Flags);
 	
 	switch (a_Entity.GetEntityType())
@@ -3061,13 +3135,13 @@ void cProtocol180::cPacketizer::WriteEntityMetadata(const cEntity & a_Entity)
 		case cEntity::etPlayer: break;  // TODO?
 		case cEntity::etPickup:
 		{
-			WriteByte((5 << 5) | 10);  // Slot(5) + index 10
+			WriteMetadataHeader((5 << 5) | 10);  // Slot(5) + index 10
 			WriteItem(((const cPickup &)a_Entity).GetItem());
 			break;
 		}
 		case cEntity::etMinecart:
 		{
-			WriteByte(0x51);
+			WriteMetadataHeader(0x51);
 
 			// The following expression makes Minecarts shake more with less health or higher damage taken
 			// It gets half the maximum health, and takes it away from the current health minus the half health:
@@ -3077,9 +3151,9 @@ void cProtocol180::cPacketizer::WriteEntityMetadata(const cEntity & a_Entity)
 			Health: 1 | 3 - (1 - 3) = 5
 			*/
 			WriteInt((((a_Entity.GetMaxHealth() / 2) - (a_Entity.GetHealth() - (a_Entity.GetMaxHealth() / 2))) * ((const cMinecart &)a_Entity).LastDamage()) * 4);
-			WriteByte(0x52);
+			WriteMetadataHeader(0x52);
 			WriteInt(1);  // Shaking direction, doesn't seem to affect anything
-			WriteByte(0x73);
+			WriteMetadataHeader(0x73);
 			WriteFloat((float)(((const cMinecart &)a_Entity).LastDamage() + 10));  // Damage taken / shake effect multiplyer
 			
 			if (((cMinecart &)a_Entity).GetPayload() == cMinecart::mpNone)
@@ -3088,19 +3162,19 @@ void cProtocol180::cPacketizer::WriteEntityMetadata(const cEntity & a_Entity)
 				const cItem & MinecartContent = RideableMinecart.GetContent();
 				if (!MinecartContent.IsEmpty())
 				{
-					WriteByte(0x54);
+					WriteMetadataHeader(0x54);
 					int Content = MinecartContent.m_ItemType;
 					Content |= MinecartContent.m_ItemDamage << 8;
 					WriteInt(Content);
-					WriteByte(0x55);
+					WriteMetadataHeader(0x55);
 					WriteInt(RideableMinecart.GetBlockHeight());
-					WriteByte(0x56);
+					WriteMetadataHeader(0x56);
 					WriteByte(1);
 				}
 			}
 			else if (((cMinecart &)a_Entity).GetPayload() == cMinecart::mpFurnace)
 			{
-				WriteByte(0x10);
+				WriteMetadataHeader(0x10);
 				WriteByte(((const cMinecartWithFurnace &)a_Entity).IsFueled() ? 1 : 0);
 			}
 			break;
@@ -3112,13 +3186,13 @@ void cProtocol180::cPacketizer::WriteEntityMetadata(const cEntity & a_Entity)
 			{
 				case cProjectileEntity::pkArrow:
 				{
-					WriteByte(0x10);
+					WriteMetadataHeader(0x10);
 					WriteByte(((const cArrowEntity &)a_Entity).IsCritical() ? 1 : 0);
 					break;
 				}
 				case cProjectileEntity::pkFirework:
 				{
-					WriteByte(0xA8);
+					WriteMetadataHeader(0xA8);
 					WriteItem(((const cFireworkEntity &)a_Entity).GetItem());
 					break;
 				}
@@ -3134,9 +3208,9 @@ void cProtocol180::cPacketizer::WriteEntityMetadata(const cEntity & a_Entity)
 		case cEntity::etItemFrame:
 		{
 			cItemFrame & Frame = (cItemFrame &)a_Entity;
-			WriteByte(0xA8);
+			WriteMetadataHeader(0xA8);
 			WriteItem(Frame.GetItem());
-			WriteByte(0x09);
+			WriteMetadataHeader(0x09);
 			WriteByte(Frame.GetItemRotation());
 			break;
 		}
@@ -3154,48 +3228,48 @@ void cProtocol180::cPacketizer::WriteMobMetadata(const cMonster & a_Mob)
 	{
 		case mtCreeper:
 		{
-			WriteByte(0x10);
+			WriteMetadataHeader(0x10);
 			WriteByte(((const cCreeper &)a_Mob).IsBlowing() ? 1 : -1);
-			WriteByte(0x11);
+			WriteMetadataHeader(0x11);
 			WriteByte(((const cCreeper &)a_Mob).IsCharged() ? 1 : 0);
 			break;
 		}
 		
 		case mtBat:
 		{
-			WriteByte(0x10);
+			WriteMetadataHeader(0x10);
 			WriteByte(((const cBat &)a_Mob).IsHanging() ? 1 : 0);
 			break;
 		}
 		
 		case mtPig:
 		{
-			WriteByte(0x10);
+			WriteMetadataHeader(0x10);
 			WriteByte(((const cPig &)a_Mob).IsSaddled() ? 1 : 0);
 			break;
 		}
 		
 		case mtVillager:
 		{
-			WriteByte(0x50);
+			WriteMetadataHeader(0x50);
 			WriteInt(((const cVillager &)a_Mob).GetVilType());
 			break;
 		}
 		
 		case mtZombie:
 		{
-			WriteByte(0x0c);
+			WriteMetadataHeader(0x0c);
 			WriteByte(((const cZombie &)a_Mob).IsBaby() ? 1 : 0);
-			WriteByte(0x0d);
+			WriteMetadataHeader(0x0d);
 			WriteByte(((const cZombie &)a_Mob).IsVillagerZombie() ? 1 : 0);
-			WriteByte(0x0e);
+			WriteMetadataHeader(0x0e);
 			WriteByte(((const cZombie &)a_Mob).IsConverting() ? 1 : 0);
 			break;
 		}
 		
 		case mtGhast:
 		{
-			WriteByte(0x10);
+			WriteMetadataHeader(0x10);
 			WriteByte(((const cGhast &)a_Mob).IsCharging());
 			break;
 		}
@@ -3216,21 +3290,21 @@ void cProtocol180::cPacketizer::WriteMobMetadata(const cMonster & a_Mob)
 			{
 				WolfStatus |= 0x4;
 			}
-			WriteByte(0x10);
+			WriteMetadataHeader(0x10);
 			WriteByte(WolfStatus);
 
-			WriteByte(0x72);
+			WriteMetadataHeader(0x72);
 			WriteFloat((float)(a_Mob.GetHealth()));
-			WriteByte(0x13);
+			WriteMetadataHeader(0x13);
 			WriteByte(Wolf.IsBegging() ? 1 : 0);
-			WriteByte(0x14);
+			WriteMetadataHeader(0x14);
 			WriteByte(Wolf.GetCollarColor());
 			break;
 		}
 		
 		case mtSheep:
 		{
-			WriteByte(0x10);
+			WriteMetadataHeader(0x10);
 			Byte SheepMetadata = 0;
 			SheepMetadata = ((const cSheep &)a_Mob).GetFurColor();
 			if (((const cSheep &)a_Mob).IsSheared())
@@ -3243,48 +3317,48 @@ void cProtocol180::cPacketizer::WriteMobMetadata(const cMonster & a_Mob)
 		
 		case mtEnderman:
 		{
-			WriteByte(0x30);
+			WriteMetadataHeader(0x30);
 			WriteShort((Byte)(((const cEnderman &)a_Mob).GetCarriedBlock()));
-			WriteByte(0x11);
+			WriteMetadataHeader(0x11);
 			WriteByte((Byte)(((const cEnderman &)a_Mob).GetCarriedMeta()));
-			WriteByte(0x12);
+			WriteMetadataHeader(0x12);
 			WriteByte(((const cEnderman &)a_Mob).IsScreaming() ? 1 : 0);
 			break;
 		}
 		
 		case mtSkeleton:
 		{
-			WriteByte(0x0d);
+			WriteMetadataHeader(0x0d);
 			WriteByte(((const cSkeleton &)a_Mob).IsWither() ? 1 : 0);
 			break;
 		}
 		
 		case mtWitch:
 		{
-			WriteByte(0x15);
+			WriteMetadataHeader(0x15);
 			WriteByte(((const cWitch &)a_Mob).IsAngry() ? 1 : 0);
 			break;
 		}
 
 		case mtWither:
 		{
-			WriteByte(0x54);  // Int at index 20
+			WriteMetadataHeader(0x54);  // Int at index 20
 			WriteInt(((const cWither &)a_Mob).GetWitherInvulnerableTicks());
-			WriteByte(0x66);  // Float at index 6
+			WriteMetadataHeader(0x66);  // Float at index 6
 			WriteFloat((float)(a_Mob.GetHealth()));
 			break;
 		}
 		
 		case mtSlime:
 		{
-			WriteByte(0x10);
+			WriteMetadataHeader(0x10);
 			WriteByte(((const cSlime &)a_Mob).GetSize());
 			break;
 		}
 		
 		case mtMagmaCube:
 		{
-			WriteByte(0x10);
+			WriteMetadataHeader(0x10);
 			WriteByte(((const cMagmaCube &)a_Mob).GetSize());
 			break;
 		}
@@ -3321,16 +3395,16 @@ void cProtocol180::cPacketizer::WriteMobMetadata(const cMonster & a_Mob)
 			{
 				Flags |= 0x80;
 			}
-			WriteByte(0x50);  // Int at index 16
+			WriteMetadataHeader(0x50);  // Int at index 16
 			WriteInt(Flags);
-			WriteByte(0x13);  // Byte at index 19
+			WriteMetadataHeader(0x13);  // Byte at index 19
 			WriteByte(Horse.GetHorseType());
-			WriteByte(0x54);  // Int at index 20
+			WriteMetadataHeader(0x54);  // Int at index 20
 			int Appearance = 0;
 			Appearance = Horse.GetHorseColor();
 			Appearance |= Horse.GetHorseStyle() << 8;
 			WriteInt(Appearance);
-			WriteByte(0x56);  // Int at index 22
+			WriteMetadataHeader(0x56);  // Int at index 22
 			WriteInt(Horse.GetHorseArmour());
 			break;
 		}
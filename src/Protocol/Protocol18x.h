@@ -16,6 +16,7 @@ Declares the 1.8.x protocol classes:
 
 #include "Protocol.h"
 #include "../ByteBuffer.h"
+#include "../Entities/Entity.h"
 
 #ifdef _MSC_VER
 	#pragma warning(push)
@@ -31,7 +32,8 @@ Declares the 1.8.x protocol classes:
 #endif
 
 #include "PolarSSL++/AesCfb128Decryptor.h"
-#include "PolarSSL++/AesCfb128Encryptor.h"
+#include "PacketWorkers.h"
+#include "SpawnPacketCapture.h"
 
 
 
@@ -77,6 +79,7 @@ public:
 	virtual void SendEntityHeadLook             (const cEntity & a_Entity) override;
 	virtual void SendEntityLook                 (const cEntity & a_Entity) override;
 	virtual void SendEntityMetadata             (const cEntity & a_Entity) override;
+	virtual void SendEntityMetadataChanges      (const cEntity & a_Entity) override;
 	virtual void SendEntityProperties           (const cEntity & a_Entity) override;
 	virtual void SendEntityRelMove              (const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ) override;
 	virtual void SendEntityRelMoveLook          (const cEntity & a_Entity, char a_RelX, char a_RelY, char a_RelZ) override;
@@ -116,6 +119,7 @@ public:
 	virtual void SendScoreUpdate                (const AString & a_Objective, const AString & a_Player, cObjective::Score a_Score, Byte a_Mode) override;
 	virtual void SendDisplayObjective           (const AString & a_Objective, cScoreboard::eDisplaySlot a_Display) override;
 	virtual void SendSoundParticleEffect        (int a_EffectID, int a_SrcX, int a_SrcY, int a_SrcZ, int a_Data) override;
+	virtual void SendSpawnEntities              (const cEntityList & a_Entities) override;
 	virtual void SendSpawnFallingBlock          (const cFallingBlock & a_FallingBlock) override;
 	virtual void SendSpawnMob                   (const cMonster & a_Mob) override;
 	virtual void SendSpawnObject                (const cEntity & a_Entity, char a_ObjectType, int a_ObjectData, Byte a_Yaw, Byte a_Pitch) override;
@@ -137,11 +141,6 @@ public:
 
 	virtual AString GetAuthServerID(void) override { return m_AuthServerID; }
 
-	/** Compress the packet. a_Packet must be without packet length.
-	a_Compressed will be set to the compressed packet includes packet length and data length.
-	If compression fails, the function returns false. */
-	static bool CompressPacket(const AString & a_Packet, AString & a_Compressed);
-
 	/** The 1.8 protocol use a particle id instead of a string. This function converts the name to the id. If the name is incorrect, it returns 0. */
 	static int GetParticleID(const AString & a_ParticleName);
 
@@ -157,10 +156,21 @@ protected:
 		cPacketizer(cProtocol180 & a_Protocol, UInt32 a_PacketType) :
 			m_Protocol(a_Protocol),
 			m_Out(a_Protocol.m_OutPacketBuffer),
-			m_Lock(a_Protocol.m_CSPacket)
+			m_Lock(a_Protocol.m_CSPacket),
+			m_MetadataEntries(nullptr)
 		{
 			m_Out.WriteVarInt(a_PacketType);
 		}
+
+		/** Creates a packetizer that doesn't send anything; the entity metadata written into it is split into a_MetadataEntries upon destruction. */
+		cPacketizer(cProtocol180 & a_Protocol, cEntity::cMetadataEntries & a_MetadataEntries) :
+			m_Protocol(a_Protocol),
+			m_Out(a_Protocol.m_OutMetadataBuffer),
+			m_Lock(a_Protocol.m_CSPacket),
+			m_MetadataEntries(&a_MetadataEntries)
+		{
+			ASSERT(m_Out.GetUsedSpace() == 0);
+		}
 		
 		~cPacketizer();
 
@@ -229,6 +239,7 @@ protected:
 		void WriteItem(const cItem & a_Item);
 		void WriteByteAngle(double a_Angle);  // Writes the specified angle using a single byte
 		void WriteFPInt(double a_Value);  // Writes the double value as a 27:5 fixed-point integer
+		void WriteMetadataHeader(Byte a_Header);  // Writes the type-and-index header of a metadata entry, starting a new entry
 		void WriteEntityMetadata(const cEntity & a_Entity);  // Writes the metadata for the specified entity, not including the terminating 0x7f
 		void WriteMobMetadata(const cMonster & a_Mob);  // Writes the mob-specific metadata for the specified mob
 		void WriteEntityProperties(const cEntity & a_Entity);  // Writes the entity properties for the specified entity, including the Count field
@@ -238,6 +249,12 @@ protected:
 		cProtocol180 & m_Protocol;
 		cByteBuffer & m_Out;
 		cCSLock m_Lock;
+
+		/** If not nullptr, the packetizer only encodes the entity metadata into these entries, instead of sending a packet */
+		cEntity::cMetadataEntries * m_MetadataEntries;
+
+		/** Positions in m_Out where the metadata entries start, recorded by WriteMetadataHeader() */
+		std::vector<size_t> m_MetadataEntryStarts;
 	} ;
 
 	AString m_ServerAddress;
@@ -258,10 +275,15 @@ protected:
 	/** Buffer for composing packet length (so that each cPacketizer instance doesn't allocate a new cPacketBuffer) */
 	cByteBuffer m_OutPacketLenBuffer;
 	
+	/** Buffer for encoding the entity metadata entries, through cPacketizer */
+	cByteBuffer m_OutMetadataBuffer;
+	
 	bool m_IsEncrypted;
 	
 	cAesCfb128Decryptor m_Decryptor;
-	cAesCfb128Encryptor m_Encryptor;
+
+	/** The queue of the outgoing data, framed, compressed and encrypted by the network workers. */
+	cPacketPipeline m_Pipeline;
 
 	/** The logfile where the comm is logged, when g_ShouldLogComm is true */
 	cFile m_CommLogFile;
@@ -270,6 +292,9 @@ protected:
 	Used to avoid Respawning into the same dimension, which confuses the client. */
 	eDimension m_LastSentDimension;
 	
+	/** Captures the packets sent while SendSpawnEntities() builds an entity's spawn packets. Protected by m_CSPacket. */
+	cSpawnPacketCapture m_SpawnPacketCapture;
+	
 	
 	/** Adds the received (unencrypted) data to m_ReceivedData, parses complete packets */
 	void AddReceivedData(const char * a_Data, size_t a_Size);
@@ -320,7 +345,18 @@ protected:
 	/** Sends the data to the client, encrypting them if needed. */
 	virtual void SendData(const char * a_Data, size_t a_Size) override;
 
+	/** Sends the game-state packet (packet ID + payload) to the client, framing and compressing it.
+	The framing, compression and encryption is done asynchronously by the network workers. */
+	void SendPacket(const AString & a_Packet);
+
 	void SendCompass(const cWorld & a_World);
+
+	/** Encodes the full metadata of the entity into separate entries, keyed by the metadata index. */
+	void EncodeEntityMetadata(const cEntity & a_Entity, cEntity::cMetadataEntries & a_Entries);
+
+	/** Encodes the full metadata of the entity for sending to this client only, not as a broadcast, into a_Metadata.
+	Doesn't include the terminating 0x7f. */
+	void GetFullEntityMetadata(const cEntity & a_Entity, AString & a_Metadata);
 	
 	/** Reads an item out of the received data, sets a_Item to the values read.
 	Returns false if not enough received data.
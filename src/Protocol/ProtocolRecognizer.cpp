@@ -270,6 +270,16 @@ void cProtocolRecognizer::SendEntityMetadata(const cEntity & a_Entity)
 
 
 
+void cProtocolRecognizer::SendEntityMetadataChanges(const cEntity & a_Entity)
+{
+	ASSERT(m_Protocol != nullptr);
+	m_Protocol->SendEntityMetadataChanges(a_Entity);
+}
+
+
+
+
+
 void cProtocolRecognizer::SendEntityProperties(const cEntity & a_Entity)
 {
 	ASSERT(m_Protocol != nullptr);
@@ -668,6 +678,16 @@ void cProtocolRecognizer::SendSoundParticleEffect(int a_EffectID, int a_SrcX, in
 
 
 
+void cProtocolRecognizer::SendSpawnEntities(const cEntityList & a_Entities)
+{
+	ASSERT(m_Protocol != nullptr);
+	m_Protocol->SendSpawnEntities(a_Entities);
+}
+
+
+
+
+
 void cProtocolRecognizer::SendSpawnFallingBlock(const cFallingBlock & a_FallingBlock)
 {
 	ASSERT(m_Protocol != nullptr);
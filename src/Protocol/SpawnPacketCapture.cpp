@@ -0,0 +1,51 @@
+
+// SpawnPacketCapture.cpp
+
+// Implements the cSpawnPacketCapture class that captures the spawn packets a protocol builds for an entity, so that they can be cached in the entity and shared by all the clients of that protocol version
+
+#include "Globals.h"
+#include "SpawnPacketCapture.h"
+#include "PacketFraming.h"
+
+
+
+
+
+cSpawnPacketCapture::cSpawnPacketCapture(void) :
+	m_Packets(nullptr)
+{
+}
+
+
+
+
+
+bool cSpawnPacketCapture::CaptureData(const char * a_Data, size_t a_Size)
+{
+	if (m_Packets == nullptr)
+	{
+		return false;
+	}
+	m_Packets->append(a_Data, a_Size);
+	return true;
+}
+
+
+
+
+
+bool cSpawnPacketCapture::CapturePacket(const AString & a_Packet)
+{
+	if (m_Packets == nullptr)
+	{
+		return false;
+	}
+
+	// The cached packets are sent as they are, so they need to be framed right away:
+	FrameCompressedPacket(a_Packet, *m_Packets);
+	return true;
+}
+
+
+
+
@@ -0,0 +1,59 @@
+
+// SpawnPacketCapture.h
+
+// Declares the cSpawnPacketCapture class that captures the spawn packets a protocol builds for an entity, so that they can be cached in the entity and shared by all the clients of that protocol version
+
+
+
+
+
+#pragma once
+
+
+
+
+
+class cSpawnPacketCapture
+{
+public:
+	cSpawnPacketCapture(void);
+
+	/** Appends the spawn packets of all the entities to a_Batch, framed for sending.
+	The packets that an entity has cached for the protocol version are reused. For the rest of the entities, SpawnOn(a_Client)
+	is called while capturing, so that the protocol's SendData() and SendPacket() store the packets instead of sending them;
+	the captured packets are then cached in the entity.
+	The caller must hold the protocol's packet CS for the whole batch, so that no other thread's packets get captured. */
+	template <class ENTITIES, class CLIENT>
+	void BuildBatch(const ENTITIES & a_Entities, int a_ProtocolVersion, CLIENT & a_Client, AString & a_Batch)
+	{
+		for (typename ENTITIES::const_iterator itr = a_Entities.begin(), end = a_Entities.end(); itr != end; ++itr)
+		{
+			// The framed (and compressed) packets don't depend on the client, only the encryption does, so they can be shared:
+			AString Packets;
+			if (!(*itr)->GetCachedSpawnPackets(a_ProtocolVersion, Packets))
+			{
+				m_Packets = &Packets;
+				(*itr)->SpawnOn(a_Client);
+				m_Packets = nullptr;
+				(*itr)->SetCachedSpawnPackets(a_ProtocolVersion, Packets);
+			}
+			a_Batch.append(Packets);
+		}
+	}
+
+	/** Called by the protocol's SendData() with data that is already framed.
+	Returns true if the data has been captured, false if not capturing and the data is to be sent. */
+	bool CaptureData(const char * a_Data, size_t a_Size);
+
+	/** Called by the protocol's SendPacket() with a packet without its length.
+	Returns true if the packet has been framed into the captured packets, false if not capturing and the packet is to be sent. */
+	bool CapturePacket(const AString & a_Packet);
+
+protected:
+	/** The packets of the entity whose spawn packets are being built by BuildBatch(), nullptr otherwise */
+	AString * m_Packets;
+} ;
+
+
+
+
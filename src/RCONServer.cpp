@@ -6,7 +6,6 @@
 #include "Globals.h"
 #include "IniFile.h"
 #include "RCONServer.h"
-#include "Server.h"
 #include "Root.h"
 #include "CommandOutput.h"
 
@@ -14,22 +13,12 @@
 
 
 
-// Disable MSVC warnings:
-#if defined(_MSC_VER)
-	#pragma warning(push)
-	#pragma warning(disable:4355)  // 'this' : used in base member initializer list
-#endif
-
-
-
-
-
 enum
 {
 	// Client -> Server:
 	RCON_PACKET_COMMAND = 2,
 	RCON_PACKET_LOGIN   = 3,
-	
+
 	// Server -> Client:
 	RCON_PACKET_RESPONSE = 2,
 } ;
@@ -45,27 +34,32 @@ class cRCONCommandOutput :
 	public cCommandOutputCallback
 {
 public:
-	cRCONCommandOutput(cRCONServer::cConnection & a_Connection, int a_RequestID) :
+	cRCONCommandOutput(SharedPtr<cRCONServer::cConnection> a_Connection, cRCONServer::cConnection::sResponse & a_Response) :
 		m_Connection(a_Connection),
-		m_RequestID(a_RequestID)
+		m_Response(a_Response)
 	{
 	}
-	
+
 	// cCommandOutputCallback overrides:
 	virtual void Out(const AString & a_Text) override
 	{
 		m_Buffer.append(a_Text);
 	}
-	
+
 	virtual void Finished(void) override
 	{
-		m_Connection.SendResponse(m_RequestID, RCON_PACKET_RESPONSE, (int)m_Buffer.size(), m_Buffer.c_str());
+		m_Connection->FinishResponse(m_Response, m_Buffer);
 		delete this;
 	}
-	
+
 protected:
-	cRCONServer::cConnection & m_Connection;
-	int m_RequestID;
+	/** The connection that has requested the command; kept alive until the command finishes, even if the client disconnects */
+	SharedPtr<cRCONServer::cConnection> m_Connection;
+
+	/** The connection's response slot for this command */
+	cRCONServer::cConnection::sResponse & m_Response;
+
+	/** The output collected so far */
 	AString m_Buffer;
 } ;
 
@@ -73,13 +67,49 @@ protected:
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+// cRCONListenCallbacks:
+
+class cRCONListenCallbacks :
+	public cNetwork::cListenCallbacks
+{
+public:
+	cRCONListenCallbacks(cRCONServer & a_RCONServer, UInt16 a_Port) :
+		m_RCONServer(a_RCONServer),
+		m_Port(a_Port)
+	{
+	}
+
+protected:
+	/** The RCON server instance that we're attached to. */
+	cRCONServer & m_RCONServer;
+
+	/** The port for which this instance is responsible. */
+	UInt16 m_Port;
+
+	// cNetwork::cListenCallbacks overrides:
+	virtual cTCPLink::cCallbacksPtr OnIncomingConnection(const AString & a_RemoteIPAddress, UInt16 a_RemotePort) override
+	{
+		LOG("RCON Client \"%s\" connected!", a_RemoteIPAddress.c_str());
+		return std::make_shared<cRCONServer::cConnection>(m_RCONServer, a_RemoteIPAddress);
+	}
+
+	virtual void OnAccepted(cTCPLink & a_Link) override {}
+
+	virtual void OnError(int a_ErrorCode, const AString & a_ErrorMsg) override
+	{
+		LOGWARNING("RCON server error on port %d: %d (%s)", m_Port, a_ErrorCode, a_ErrorMsg.c_str());
+	}
+};
+
+
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // cRCONServer:
 
-cRCONServer::cRCONServer(cServer & a_Server) :
-	m_Server(a_Server),
-	m_ListenThread4(*this, cSocket::IPv4, "RCON"),
-	m_ListenThread6(*this, cSocket::IPv6, "RCON")
+cRCONServer::cRCONServer(void)
 {
 }
 
@@ -89,8 +119,10 @@ cRCONServer::cRCONServer(cServer & a_Server) :
 
 cRCONServer::~cRCONServer()
 {
-	m_ListenThread4.Stop();
-	m_ListenThread6.Stop();
+	for (cServerHandlePtrs::iterator itr = m_ListenServers.begin(), end = m_ListenServers.end(); itr != end; ++itr)
+	{
+		(*itr)->Close();
+	}
 }
 
 
@@ -111,24 +143,12 @@ void cRCONServer::Initialize(cIniFile & a_IniFile)
 		LOGWARNING("RCON is requested, but the password is not set. RCON is now disabled.");
 		return;
 	}
-	
-	// Read and initialize both IPv4 and IPv6 ports for RCON
-	bool HasAnyPorts = false;
-	AString Ports4 = a_IniFile.GetValueSet("RCON", "PortsIPv4", "25575");
-	if (m_ListenThread4.Initialize(Ports4))
-	{
-		HasAnyPorts = true;
-		m_ListenThread4.Start();
-	}
-	AString Ports6 = a_IniFile.GetValueSet("RCON", "PortsIPv6", "25575");
-	if (m_ListenThread6.Initialize(Ports6))
-	{
-		HasAnyPorts = true;
-		m_ListenThread6.Start();
-	}
-	if (!HasAnyPorts)
+
+	// Read the ports; each port accepts both IPv4 and IPv6 connections, the old IPv4 setting is used as the default:
+	AString Ports = a_IniFile.GetValueSet("RCON", "Ports", a_IniFile.GetValue("RCON", "PortsIPv4", "25575"));
+	if (!Listen(Ports))
 	{
-		LOGWARNING("RCON is requested, but no ports are specified. Specify at least one port in PortsIPv4 or PortsIPv6. RCON is now disabled.");
+		LOGWARNING("RCON is requested, but no ports are specified. Specify at least one port in Ports. RCON is now disabled.");
 		return;
 	}
 }
@@ -137,17 +157,34 @@ void cRCONServer::Initialize(cIniFile & a_IniFile)
 
 
 
-void cRCONServer::OnConnectionAccepted(cSocket & a_Socket)
+bool cRCONServer::Listen(const AString & a_Ports)
 {
-	if (!a_Socket.IsValid())
+	AStringVector Ports = StringSplitAndTrim(a_Ports, ",");
+	for (AStringVector::const_iterator itr = Ports.begin(), end = Ports.end(); itr != end; ++itr)
 	{
-		return;
+		UInt16 Port;
+		if (!StringToInteger(*itr, Port))
+		{
+			LOGWARNING("Invalid RCON port \"%s\", ignoring.", itr->c_str());
+			continue;
+		}
+		cServerHandlePtr Handle = cNetwork::Listen(Port, std::make_shared<cRCONListenCallbacks>(*this, Port));
+		if (Handle->IsListening())
+		{
+			m_ListenServers.push_back(Handle);
+		}
 	}
+	return !m_ListenServers.empty();
+}
+
+
 
-	LOG("RCON Client \"%s\" connected!", a_Socket.GetIPString().c_str());
-	
-	// Create a new cConnection object, it will be deleted when the connection is closed
-	m_SocketThreads.AddClient(a_Socket, new cConnection(*this, a_Socket));
+
+
+void cRCONServer::ExecuteCommand(const AString & a_Command, cCommandOutputCallback & a_Output)
+{
+	// The command is executed in the root thread, so that the network thread isn't blocked by the command:
+	cRoot::Get()->QueueExecuteConsoleCommand(a_Command, a_Output);
 }
 
 
@@ -157,11 +194,10 @@ void cRCONServer::OnConnectionAccepted(cSocket & a_Socket)
 ////////////////////////////////////////////////////////////////////////////////
 // cRCONServer::cConnection:
 
-cRCONServer::cConnection::cConnection(cRCONServer & a_RCONServer, cSocket & a_Socket) :
-	m_IsAuthenticated(false),
+cRCONServer::cConnection::cConnection(cRCONServer & a_RCONServer, const AString & a_IPAddress) :
 	m_RCONServer(a_RCONServer),
-	m_Socket(a_Socket),
-	m_IPAddress(a_Socket.GetIPString())
+	m_IPAddress(a_IPAddress),
+	m_IsAuthenticated(false)
 {
 }
 
@@ -169,64 +205,79 @@ cRCONServer::cConnection::cConnection(cRCONServer & a_RCONServer, cSocket & a_So
 
 
 
-bool cRCONServer::cConnection::DataReceived(const char * a_Data, size_t a_Size)
+void cRCONServer::cConnection::OnLinkCreated(cTCPLinkPtr a_Link)
 {
+	cCSLock Lock(m_CS);
+	m_Link = a_Link;
+}
+
+
+
+
+
+void cRCONServer::cConnection::OnReceivedData(const char * a_Data, size_t a_Length)
+{
+	cCSLock Lock(m_CS);
+	if (m_Link == nullptr)
+	{
+		// The connection has been dropped, ignore any further data:
+		return;
+	}
+
 	// Append data to the buffer:
-	m_Buffer.append(a_Data, a_Size);
-	
-	// Process the packets in the buffer:
-	while (m_Buffer.size() >= 14)
+	m_Buffer.append(a_Data, a_Length);
+
+	// Process all the complete packets in the buffer, a client may send several requests at once:
+	size_t Start = 0;
+	while (m_Buffer.size() - Start >= 14)
 	{
-		int Length = IntFromBuffer(m_Buffer.data());
-		if (Length > 1500)
+		int Length = IntFromBuffer(m_Buffer.data() + Start);
+		if ((Length > 1500) || (Length < 10))
 		{
-			// Too long, drop the connection
+			// Too long or too short, drop the connection
 			LOGWARNING("Received an invalid RCON packet length (%d), dropping RCON connection to %s.",
 				Length, m_IPAddress.c_str()
 			);
-			m_RCONServer.m_SocketThreads.RemoveClient(this);
-			m_Socket.CloseSocket();
-			delete this;
-			return false;
+			DropConnection();
+			return;
 		}
-		if (Length > (int)(m_Buffer.size() + 4))
+		if (static_cast<size_t>(Length) + 4 > m_Buffer.size() - Start)
 		{
 			// Incomplete packet yet, wait for more data to come
-			return false;
+			break;
 		}
-		
-		int RequestID  = IntFromBuffer(m_Buffer.data() + 4);
-		int PacketType = IntFromBuffer(m_Buffer.data() + 8);
-		if (!ProcessPacket(RequestID, PacketType, Length - 10, m_Buffer.data() + 12))
+
+		int RequestID  = IntFromBuffer(m_Buffer.data() + Start + 4);
+		int PacketType = IntFromBuffer(m_Buffer.data() + Start + 8);
+		if (!ProcessPacket(RequestID, PacketType, Length - 10, m_Buffer.data() + Start + 12))
 		{
-			m_RCONServer.m_SocketThreads.RemoveClient(this);
-			m_Socket.CloseSocket();
-			delete this;
-			return false;
+			DropConnection();
+			return;
 		}
-		m_Buffer.erase(0, Length + 4);
-	}  // while (m_Buffer.size() >= 14)
-	return false;
+		Start += static_cast<size_t>(Length) + 4;
+	}  // while (m_Buffer has a packet header)
+	m_Buffer.erase(0, Start);
 }
 
 
 
 
 
-void cRCONServer::cConnection::GetOutgoingData(AString & a_Data)
+void cRCONServer::cConnection::OnRemoteClosed(void)
 {
-	a_Data.assign(m_Outgoing);
-	m_Outgoing.clear();
+	cCSLock Lock(m_CS);
+	m_Link.reset();
 }
 
 
 
 
 
-void cRCONServer::cConnection::SocketClosed(void)
+void cRCONServer::cConnection::OnError(int a_ErrorCode, const AString & a_ErrorMsg)
 {
-	m_RCONServer.m_SocketThreads.RemoveClient(this);
-	delete this;
+	LOGD("Error in RCON connection %s: %d (%s)", m_IPAddress.c_str(), a_ErrorCode, a_ErrorMsg.c_str());
+	cCSLock Lock(m_CS);
+	m_Link.reset();
 }
 
 
@@ -239,40 +290,46 @@ bool cRCONServer::cConnection::ProcessPacket(int a_RequestID, int a_PacketType,
 	{
 		case RCON_PACKET_LOGIN:
 		{
-			if (strncmp(a_Payload, m_RCONServer.m_Password.c_str(), a_PayloadLength) != 0)
+			if (AString(a_Payload, static_cast<size_t>(a_PayloadLength)) != m_RCONServer.m_Password)
 			{
-				LOGINFO("RCON: Invalid password from client %s, dropping connection.", m_IPAddress.c_str());
-				SendResponse(-1, RCON_PACKET_RESPONSE, 0, nullptr);
+				LOG("RCON: Invalid password from client %s, dropping connection.", m_IPAddress.c_str());
+				m_Responses.push_back(sResponse(-1));
+				m_Responses.back().m_IsFinished = true;
+				SendFinishedResponses();
 				return false;
 			}
 			m_IsAuthenticated = true;
-			
+
 			LOGD("RCON: Client at %s has successfully authenticated", m_IPAddress.c_str());
-			
-			// Send OK response:
-			SendResponse(a_RequestID, RCON_PACKET_RESPONSE, 0, nullptr);
+
+			// Send OK response, after the responses to any earlier requests:
+			m_Responses.push_back(sResponse(a_RequestID));
+			m_Responses.back().m_IsFinished = true;
+			SendFinishedResponses();
 			return true;
 		}
-		
+
 		case RCON_PACKET_COMMAND:
 		{
 			if (!m_IsAuthenticated)
 			{
-				char AuthNeeded[] = "You need to authenticate first!";
-				SendResponse(a_RequestID, RCON_PACKET_RESPONSE, sizeof(AuthNeeded), AuthNeeded);
+				m_Responses.push_back(sResponse(a_RequestID));
+				m_Responses.back().m_Payload.assign("You need to authenticate first!");
+				m_Responses.back().m_IsFinished = true;
+				SendFinishedResponses();
 				return false;
 			}
-			
-			AString cmd(a_Payload, a_PayloadLength);
+
+			AString cmd(a_Payload, static_cast<size_t>(a_PayloadLength));
 			LOGD("RCON command from %s: \"%s\"", m_IPAddress.c_str(), cmd.c_str());
-			cRoot::Get()->ExecuteConsoleCommand(cmd, *(new cRCONCommandOutput(*this, a_RequestID)));
-			
-			// Send an empty response:
-			SendResponse(a_RequestID, RCON_PACKET_RESPONSE, 0, nullptr);
+
+			// Reserve the response slot, the output is sent once the command finishes and all the earlier responses are sent:
+			m_Responses.push_back(sResponse(a_RequestID));
+			m_RCONServer.ExecuteCommand(cmd, *(new cRCONCommandOutput(shared_from_this(), m_Responses.back())));
 			return true;
 		}
 	}
-	
+
 	// Unknown packet type, drop the connection:
 	LOGWARNING("RCON: Client at %s has sent an unknown packet type %d, dropping connection.",
 		m_IPAddress.c_str(), a_PacketType
@@ -284,7 +341,32 @@ bool cRCONServer::cConnection::ProcessPacket(int a_RequestID, int a_PacketType,
 
 
 
-/// Reads 4 bytes from a_Buffer and returns the int they represent
+void cRCONServer::cConnection::FinishResponse(sResponse & a_Response, const AString & a_Payload)
+{
+	cCSLock Lock(m_CS);
+	a_Response.m_Payload = a_Payload;
+	a_Response.m_IsFinished = true;
+	SendFinishedResponses();
+}
+
+
+
+
+
+void cRCONServer::cConnection::SendFinishedResponses(void)
+{
+	while (!m_Responses.empty() && m_Responses.front().m_IsFinished)
+	{
+		const sResponse & Response = m_Responses.front();
+		SendResponse(Response.m_RequestID, RCON_PACKET_RESPONSE, static_cast<int>(Response.m_Payload.size()), Response.m_Payload.data());
+		m_Responses.pop_front();
+	}
+}
+
+
+
+
+
 int cRCONServer::cConnection::IntFromBuffer(const char * a_Buffer)
 {
 	return ((unsigned char)a_Buffer[3] << 24) | ((unsigned char)a_Buffer[2] << 16) | ((unsigned char)a_Buffer[1] << 8) | (unsigned char)a_Buffer[0];
@@ -294,7 +376,6 @@ int cRCONServer::cConnection::IntFromBuffer(const char * a_Buffer)
 
 
 
-/// Puts 4 bytes representing the int into the buffer
 void cRCONServer::cConnection::IntToBuffer(int a_Value, char * a_Buffer)
 {
 	a_Buffer[0] = a_Value & 0xff;
@@ -307,26 +388,46 @@ void cRCONServer::cConnection::IntToBuffer(int a_Value, char * a_Buffer)
 
 
 
-/// Sends a RCON packet back to the client
 void cRCONServer::cConnection::SendResponse(int a_RequestID, int a_PacketType, int a_PayloadLength, const char * a_Payload)
 {
 	ASSERT((a_PayloadLength == 0) || (a_Payload != nullptr));  // Either zero data to send, or a valid payload ptr
-	
+	if (m_Link == nullptr)
+	{
+		// The client has disconnected, there's nowhere to send the response:
+		return;
+	}
+
+	// Compose the whole packet, so that it is sent in one piece:
+	AString Packet;
+	Packet.reserve(static_cast<size_t>(a_PayloadLength) + 14);
 	char Buffer[4];
-	int Length = a_PayloadLength + 10;
-	IntToBuffer(Length, Buffer);
-	m_Outgoing.append(Buffer, 4);
+	IntToBuffer(a_PayloadLength + 10, Buffer);
+	Packet.append(Buffer, 4);
 	IntToBuffer(a_RequestID, Buffer);
-	m_Outgoing.append(Buffer, 4);
+	Packet.append(Buffer, 4);
 	IntToBuffer(a_PacketType, Buffer);
-	m_Outgoing.append(Buffer, 4);
+	Packet.append(Buffer, 4);
 	if (a_PayloadLength > 0)
 	{
-		m_Outgoing.append(a_Payload, a_PayloadLength);
+		Packet.append(a_Payload, static_cast<size_t>(a_PayloadLength));
+	}
+	Packet.push_back(0);
+	Packet.push_back(0);
+	m_Link->Send(Packet);
+}
+
+
+
+
+
+void cRCONServer::cConnection::DropConnection(void)
+{
+	if (m_Link != nullptr)
+	{
+		m_Link->Shutdown();
+		m_Link.reset();
 	}
-	m_Outgoing.push_back(0);
-	m_Outgoing.push_back(0);
-	m_RCONServer.m_SocketThreads.NotifyWrite(this);
+	m_Buffer.clear();
 }
 
 
@@ -9,100 +9,128 @@
 
 #pragma once
 
-#include "OSSupport/SocketThreads.h"
-#include "OSSupport/ListenThread.h"
+#include "OSSupport/Network.h"
+#include "OSSupport/CriticalSection.h"
 
 
 
 
 
 // fwd:
-class cServer;
 class cIniFile;
+class cCommandOutputCallback;
+class cRCONCommandOutput;
 
 
 
 
 
-class cRCONServer :
-	public cListenThread::cCallback
+class cRCONServer
 {
 public:
-	cRCONServer(cServer & a_Server);
+	cRCONServer(void);
 	virtual ~cRCONServer();
-	
+
+	/** Reads the RCON settings from the ini file and starts listening, if RCON is enabled. */
 	void Initialize(cIniFile & a_IniFile);
-	
+
 protected:
 	friend class cRCONCommandOutput;
-	
+	friend class cRCONListenCallbacks;
+
 	class cConnection :
-		public cSocketThreads::cCallback
+		public cTCPLink::cCallbacks,
+		public std::enable_shared_from_this<cConnection>
 	{
 	public:
-		cConnection(cRCONServer & a_RCONServer, cSocket & a_Socket);
-		
+		cConnection(cRCONServer & a_RCONServer, const AString & a_IPAddress);
+
 	protected:
 		friend class cRCONCommandOutput;
-	
-		/// Set to true if the client has successfully authenticated
-		bool m_IsAuthenticated;
-		
-		/// Buffer for the incoming data
-		AString m_Buffer;
-		
-		/// Buffer for the outgoing data
-		AString m_Outgoing;
-		
-		/// Server that owns this connection and processes requests
+
+		/** A response to a single request. The responses are kept in the order of the requests,
+		so that a client that sends several requests at once gets the responses in the same order,
+		even though the commands may finish in any order. */
+		struct sResponse
+		{
+			int m_RequestID;
+			AString m_Payload;
+			bool m_IsFinished;
+
+			sResponse(int a_RequestID) :
+				m_RequestID(a_RequestID),
+				m_IsFinished(false)
+			{
+			}
+		};
+		typedef std::list<sResponse> cResponses;
+
+		/** Server that owns this connection and processes requests */
 		cRCONServer & m_RCONServer;
-		
-		/// The socket belonging to the client
-		cSocket & m_Socket;
-		
-		/// Address of the client
+
+		/** Address of the client */
 		AString m_IPAddress;
-		
-
-		// cSocketThreads::cCallback overrides:
-		virtual bool DataReceived(const char * a_Data, size_t a_Size) override;
-		virtual void GetOutgoingData(AString & a_Data) override;
-		virtual void SocketClosed(void) override;
-		
-		/// Processes the given packet and sends the response; returns true if successful, false if the connection is to be dropped
+
+		/** Protects m_Link and m_Responses; the commands finish in a different thread than the one receiving the data */
+		cCriticalSection m_CS;
+
+		/** The link to the client; nullptr once the connection is closed or dropped */
+		cTCPLinkPtr m_Link;
+
+		/** Set to true if the client has successfully authenticated */
+		bool m_IsAuthenticated;
+
+		/** Buffer for the incoming data that doesn't form a complete packet yet */
+		AString m_Buffer;
+
+		/** Responses to the requests received so far that haven't been sent yet, in the order of the requests */
+		cResponses m_Responses;
+
+
+		// cTCPLink::cCallbacks overrides:
+		virtual void OnLinkCreated(cTCPLinkPtr a_Link) override;
+		virtual void OnReceivedData(const char * a_Data, size_t a_Length) override;
+		virtual void OnRemoteClosed(void) override;
+		virtual void OnError(int a_ErrorCode, const AString & a_ErrorMsg) override;
+
+		/** Processes the given packet and queues the response; returns true if successful, false if the connection is to be dropped.
+		Assumes m_CS is locked. */
 		bool ProcessPacket(int a_RequestID, int a_PacketType, int a_PayloadLength, const char * a_Payload);
-		
-		/// Reads 4 bytes from a_Buffer and returns the int they represent
-		int IntFromBuffer(const char * a_Buffer);
-		
-		/// Puts 4 bytes representing the int into the buffer
-		void IntToBuffer(int a_Value, char * a_Buffer);
-		
-		/// Sends a RCON packet back to the client
+
+		/** Stores the payload for the response and sends all the responses that are finished and not preceded by an unfinished one. */
+		void FinishResponse(sResponse & a_Response, const AString & a_Payload);
+
+		/** Sends all the finished responses at the front of m_Responses. Assumes m_CS is locked. */
+		void SendFinishedResponses(void);
+
+		/** Reads 4 bytes from a_Buffer and returns the int they represent */
+		static int IntFromBuffer(const char * a_Buffer);
+
+		/** Puts 4 bytes representing the int into the buffer */
+		static void IntToBuffer(int a_Value, char * a_Buffer);
+
+		/** Sends a RCON packet back to the client. Assumes m_CS is locked. */
 		void SendResponse(int a_RequestID, int a_PacketType, int a_PayloadLength, const char * a_Payload);
+
+		/** Shuts the link down and stops processing any further data from the client. Assumes m_CS is locked. */
+		void DropConnection(void);
 	} ;
-	
-	
-	/// The server object that will process the commands received
-	cServer & m_Server;
-	
-	/// The thread(s) that take care of all the traffic on the RCON ports
-	cSocketThreads m_SocketThreads;
-	
-	/// The thread for accepting IPv4 RCON connections
-	cListenThread  m_ListenThread4;
-	
-	/// The thread for accepting IPv6 RCON connections
-	cListenThread  m_ListenThread6;
-	
-	/// Password for authentication
+
+
+	/** The sockets accepting the RCON connections */
+	cServerHandlePtrs m_ListenServers;
+
+	/** Password for authentication */
 	AString m_Password;
 
 
-	// cListenThread::cCallback overrides:
-	virtual void OnConnectionAccepted(cSocket & a_Socket) override;
-} ;
+	/** Starts listening on the specified comma-separated ports. Returns true if listening on at least one of them. */
+	bool Listen(const AString & a_Ports);
 
+	/** Queues the command for execution; a_Output receives the output and its Finished() is called once the command is done,
+	possibly from a different thread. */
+	virtual void ExecuteCommand(const AString & a_Command, cCommandOutputCallback & a_Output);
+} ;
 
 
 
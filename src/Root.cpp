@@ -175,7 +175,11 @@ void cRoot::Start(void)
 		if (IniFile.GetValueSetB("DeadlockDetect", "Enabled", true))
 		{
 			LOGD("Starting deadlock detector...");
-			dd.Start(IniFile.GetValueSetI("DeadlockDetect", "IntervalSec", 20));
+			// IntervalSec is the kill threshold, kept under its old name; zero disables the killing:
+			dd.Start(
+				IniFile.GetValueSetI("DeadlockDetect", "WarningIntervalSec", 5),
+				IniFile.GetValueSetI("DeadlockDetect", "IntervalSec", 20)
+			);
 		}
 		
 		IniFile.WriteFile("settings.ini");
@@ -218,6 +222,7 @@ void cRoot::Start(void)
 
 		LOG("Shutting down server...");
 		m_Server->Shutdown();
+		FinishPendingCommands();
 		delete m_MojangAPI; m_MojangAPI = nullptr;
 
 		LOGD("Shutting down deadlock detector...");
@@ -445,6 +450,24 @@ void cRoot::TickCommands(void)
 
 
 
+void cRoot::FinishPendingCommands(void)
+{
+	cCommandQueue PendingCommands;
+	{
+		cCSLock Lock(m_CSPendingCommands);
+		std::swap(PendingCommands, m_PendingCommands);
+	}
+	for (cCommandQueue::iterator itr = PendingCommands.begin(), end = PendingCommands.end(); itr != end; ++itr)
+	{
+		itr->m_Output->Out(Printf("The server is shutting down, command \"%s\" was not executed.", itr->m_Command.c_str()));
+		itr->m_Output->Finished();
+	}
+}
+
+
+
+
+
 void cRoot::QueueExecuteConsoleCommand(const AString & a_Cmd, cCommandOutputCallback & a_Output)
 {
 	// Some commands are built-in:
@@ -483,11 +506,13 @@ void cRoot::ExecuteConsoleCommand(const AString & a_Cmd, cCommandOutputCallback
 	if (a_Cmd == "stop")
 	{
 		m_bStop = true;
+		a_Output.Finished();
 		return;
 	}
 	else if (a_Cmd == "restart")
 	{
 		m_bRestart = true;
+		a_Output.Finished();
 		return;
 	}
 
@@ -788,6 +813,8 @@ void cRoot::LogChunkStats(cCommandOutputCallback & a_Output)
 	int SumNumDirty = 0;
 	int SumNumInLighting = 0;
 	int SumNumInGenerator = 0;
+	int SumNumTicked = 0;
+	int SumNumVisibleOnly = 0;
 	int SumMem = 0;
 	for (WorldMap::iterator itr = m_WorldsByName.begin(), end = m_WorldsByName.end(); itr != end; ++itr)
 	{
@@ -798,10 +825,15 @@ void cRoot::LogChunkStats(cCommandOutputCallback & a_Output)
 		int NumValid = 0;
 		int NumDirty = 0;
 		int NumInLighting = 0;
+		int NumTicked = 0;
+		int NumVisibleOnly = 0;
 		World->GetChunkStats(NumValid, NumDirty, NumInLighting);
+		World->GetChunkTickStats(NumTicked, NumVisibleOnly);
 		a_Output.Out("World %s:", World->GetName().c_str());
 		a_Output.Out("  Num loaded chunks: %d", NumValid);
 		a_Output.Out("  Num dirty chunks: %d", NumDirty);
+		a_Output.Out("  Num chunks ticked: %d (simulation distance %d)", NumTicked, World->GetSimulationDistance());
+		a_Output.Out("  Num chunks visible but not ticked: %d", NumVisibleOnly);
 		a_Output.Out("  Num chunks in lighting queue: %d", NumInLighting);
 		a_Output.Out("  Num chunks in generator queue: %d", NumInGenerator);
 		a_Output.Out("  Num chunks in storage load queue: %d", NumInLoadQueue);
@@ -818,11 +850,15 @@ void cRoot::LogChunkStats(cCommandOutputCallback & a_Output)
 		SumNumDirty += NumDirty;
 		SumNumInLighting += NumInLighting;
 		SumNumInGenerator += NumInGenerator;
+		SumNumTicked += NumTicked;
+		SumNumVisibleOnly += NumVisibleOnly;
 		SumMem += Mem;
 	}
 	a_Output.Out("Totals:");
 	a_Output.Out("  Num loaded chunks: %d", SumNumValid);
 	a_Output.Out("  Num dirty chunks: %d", SumNumDirty);
+	a_Output.Out("  Num chunks ticked: %d", SumNumTicked);
+	a_Output.Out("  Num chunks visible but not ticked: %d", SumNumVisibleOnly);
 	a_Output.Out("  Num chunks in lighting queue: %d", SumNumInLighting);
 	a_Output.Out("  Num chunks in generator queue: %d", SumNumInGenerator);
 	a_Output.Out("  Memory used by chunks: %d KiB (%d MiB)", (SumMem + 1023) / 1024, (SumMem + 1024 * 1024 - 1) / (1024 * 1024));
@@ -217,6 +217,10 @@ private:
 	/// Does the actual work of executing a command
 	void DoExecuteConsoleCommand(const AString & a_Cmd);
 	
+	/** Finishes the outputs of the commands left in the queue once the tick thread has stopped, without executing the commands.
+	Their owners (RCON connections) wait for Finished() to be called. */
+	void FinishPendingCommands(void);
+	
 	static cRoot* s_Root;
 
 	static void InputThread(cRoot & a_Params);
@@ -79,8 +79,10 @@ cObjective::eType cObjective::StringToType(const AString & a_Name)
 
 
 
-cObjective::cObjective(const AString & a_Name, const AString & a_DisplayName, cObjective::eType a_Type, cWorld * a_World)
-	: m_DisplayName(a_DisplayName)
+cObjective::cObjective(const AString & a_Name, const AString & a_DisplayName, cObjective::eType a_Type, cWorld * a_World, cCriticalSection & a_CSDirtyScores)
+	: m_CSDirtyScores(a_CSDirtyScores)
+	, m_NumCoalescedUpdates(0)
+	, m_DisplayName(a_DisplayName)
 	, m_Name(a_Name)
 	, m_Type(a_Type)
 	, m_World(a_World)
@@ -95,7 +97,7 @@ void cObjective::Reset(void)
 {
 	for (cScoreMap::iterator it = m_Scores.begin(); it != m_Scores.end(); ++it)
 	{
-		m_World->BroadcastScoreUpdate(m_Name, it->first, 0, 1);
+		MarkDirty(it->first);
 	}
 
 	m_Scores.clear();
@@ -127,7 +129,7 @@ void cObjective::SetScore(const AString & a_Name, cObjective::Score a_Score)
 {
 	m_Scores[a_Name] = a_Score;
 
-	m_World->BroadcastScoreUpdate(m_Name, a_Name, a_Score, 0);
+	MarkDirty(a_Name);
 }
 
 
@@ -138,7 +140,7 @@ void cObjective::ResetScore(const AString & a_Name)
 {
 	m_Scores.erase(a_Name);
 
-	m_World->BroadcastScoreUpdate(m_Name, a_Name, 0, 1);
+	MarkDirty(a_Name);
 }
 
 
@@ -198,6 +200,49 @@ void cObjective::SendTo(cClientHandle & a_Client)
 
 
 
+void cObjective::TakeScoreUpdates(sScoreUpdates & a_Updates)
+{
+	for (cNameSet::const_iterator itr = m_DirtyScores.begin(), end = m_DirtyScores.end(); itr != end; ++itr)
+	{
+		sScoreUpdate Update;
+		Update.m_Objective = m_Name;
+		Update.m_Name = *itr;
+		cScoreMap::const_iterator Score = m_Scores.find(*itr);
+		if (Score == m_Scores.end())
+		{
+			// The score has been reset:
+			Update.m_Score = 0;
+			Update.m_Mode = 1;
+		}
+		else
+		{
+			Update.m_Score = Score->second;
+			Update.m_Mode = 0;
+		}
+		a_Updates.push_back(Update);
+	}
+	m_DirtyScores.clear();
+}
+
+
+
+
+
+void cObjective::MarkDirty(const AString & a_Name)
+{
+	// The scoreboard iterates the dirty scores while flushing, under this lock:
+	cCSLock Lock(m_CSDirtyScores);
+	if (!m_DirtyScores.insert(a_Name).second)
+	{
+		// An update for this score is already pending, it will carry the new value:
+		m_NumCoalescedUpdates += 1;
+	}
+}
+
+
+
+
+
 cTeam::cTeam(
 	const AString & a_Name, const AString & a_DisplayName,
 	const AString & a_Prefix, const AString & a_Suffix
@@ -288,7 +333,7 @@ cScoreboard::cScoreboard(cWorld * a_World) : m_World(a_World)
 
 cObjective* cScoreboard::RegisterObjective(const AString & a_Name, const AString & a_DisplayName, cObjective::eType a_Type)
 {
-	cObjective Objective(a_Name, a_DisplayName, a_Type, m_World);
+	cObjective Objective(a_Name, a_DisplayName, a_Type, m_World, m_CSObjectives);
 
 	std::pair<cObjectiveMap::iterator, bool> Status = m_Objectives.insert(cNamedObjective(a_Name, Objective));
 
@@ -460,6 +505,30 @@ void cScoreboard::SetDisplay(cObjective * a_Objective, eDisplaySlot a_Slot)
 
 
 
+void cScoreboard::FlushScoreUpdates(void)
+{
+	// Take the updates under the lock, but broadcast them only after releasing it, broadcasting locks the world's players.
+	// A plugin may set a score while enumerating the players, taking the locks in the opposite order:
+	cObjective::sScoreUpdates Updates;
+	{
+		cCSLock Lock(m_CSObjectives);
+		for (cObjectiveMap::iterator it = m_Objectives.begin(); it != m_Objectives.end(); ++it)
+		{
+			it->second.TakeScoreUpdates(Updates);
+		}
+	}
+
+	ASSERT(m_World != nullptr);
+	for (cObjective::sScoreUpdates::const_iterator itr = Updates.begin(), end = Updates.end(); itr != end; ++itr)
+	{
+		m_World->BroadcastScoreUpdate(itr->m_Objective, itr->m_Name, itr->m_Score, itr->m_Mode);
+	}
+}
+
+
+
+
+
 cObjective * cScoreboard::GetObjectiveIn(eDisplaySlot a_Slot)
 {
 	ASSERT(a_Slot < dsCount);
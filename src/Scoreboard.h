@@ -60,7 +60,8 @@ public:
 
 public:
 
-	cObjective(const AString & a_Name, const AString & a_DisplayName, eType a_Type, cWorld * a_World);
+	/** Creates a new objective. a_CSDirtyScores is the lock under which the scoreboard flushes the score updates, it guards the dirty scores. */
+	cObjective(const AString & a_Name, const AString & a_DisplayName, eType a_Type, cWorld * a_World, cCriticalSection & a_CSDirtyScores);
 
 	// tolua_begin
 
@@ -89,11 +90,30 @@ public:
 
 	void SetDisplayName(const AString & a_Name);
 
+	/** Returns the number of score updates that were not sent because a newer value of the same score
+	was sent instead, in the same tick */
+	size_t GetNumCoalescedUpdates(void) const { return m_NumCoalescedUpdates; }
+
 	// tolua_end
 
 	/** Send this objective to the specified client */
 	void SendTo(cClientHandle & a_Client);
 
+	/** A changed score, to be broadcast by the scoreboard */
+	struct sScoreUpdate
+	{
+		AString m_Objective;
+		AString m_Name;
+		Score m_Score;
+		Byte m_Mode;  ///< 0 = set the score, 1 = remove the score (it has been reset)
+	};
+
+	typedef std::vector<sScoreUpdate> sScoreUpdates;
+
+	/** Moves the final values of all the scores changed since the last call into a_Updates.
+	Called once per tick by the scoreboard, holding the lock given to the constructor; the scoreboard broadcasts the updates after releasing it. */
+	void TakeScoreUpdates(sScoreUpdates & a_Updates);
+
 	static const char * GetClassStatic(void)  // Needed for ManualBindings's ForEach templates
 	{
 		return "cObjective";
@@ -106,8 +126,19 @@ private:
 
 	typedef std::map<AString, Score> cScoreMap;
 
+	typedef std::set<AString> cNameSet;
+
 	cScoreMap m_Scores;
 
+	/** Names whose scores have changed since the last TakeScoreUpdates(). Protected by m_CSDirtyScores. */
+	cNameSet m_DirtyScores;
+
+	/** The scoreboard's objectives lock, held by the scoreboard while taking the updates; MarkDirty() takes it, too. */
+	cCriticalSection & m_CSDirtyScores;
+
+	/** Number of score changes that were merged into an already pending update */
+	size_t m_NumCoalescedUpdates;
+
 	AString m_DisplayName;
 	AString m_Name;
 
@@ -115,6 +146,9 @@ private:
 
 	cWorld * m_World;
 
+	/** Marks the score of the specified player as changed, to be broadcast after the next TakeScoreUpdates() */
+	void MarkDirty(const AString & a_Name);
+
 	friend class cScoreboardSerializer;
 
 
@@ -278,6 +312,10 @@ public:
 
 	void SetDisplay(cObjective * a_Objective, eDisplaySlot a_Slot);
 
+	/** Broadcasts the score changes made in all the objectives since the last flush.
+	Called by the world once per tick, so that each changed score is sent only once, with its final value. */
+	void FlushScoreUpdates(void);
+
 
 private:
 
@@ -107,7 +107,7 @@ cServer::cServer(void) :
 	m_ClientViewDistance(0),
 	m_bIsConnected(false),
 	m_bRestarting(false),
-	m_RCONServer(*this),
+	m_RCONServer(),
 	m_MaxPlayers(0),
 	m_bIsHardcore(false),
 	m_TickThread(*this),
@@ -279,6 +279,7 @@ bool cServer::InitServer(cIniFile & a_SettingsIni, bool a_ShouldAuth)
 	}
 	
 	m_NotifyWriteThread.Start(this);
+	m_PacketWorkers.Start(a_SettingsIni.GetValueSetI("Server", "NetworkWorkerThreads", 2));
 	
 	PrepareKeys();
 	
@@ -472,132 +473,223 @@ bool cServer::Command(cClientHandle & a_Client, AString & a_Cmd)
 
 void cServer::ExecuteConsoleCommand(const AString & a_Cmd, cCommandOutputCallback & a_Output)
 {
-	AStringVector split = StringSplit(a_Cmd, " ");
-	if (split.empty())
-	{
-		return;
-	}
+	ExecuteConsoleCommand(StringSplit(a_Cmd, " "), a_Output);
+}
+
+
+
 
+
+const cServer::sBuiltInCommand cServer::s_BuiltInCommands[] =
+{
 	// "stop" and "restart" are handled in cRoot::ExecuteConsoleCommand, our caller, due to its access to controlling variables
-	
 	// "help" and "reload" are to be handled by MCS, so that they work no matter what
-	if (split[0] == "help")
+	{"help",            &cServer::PrintHelp,                    "help",                      " - Shows the available commands"},
+	{"reload",          &cServer::ExecuteReloadCommand,         "reload",                    " - Reloads all plugins"},
+	{"reloadplugins",   &cServer::ExecuteReloadPluginsCommand,  nullptr,                     nullptr},
+	{"load",            &cServer::ExecuteLoadCommand,           "load <pluginname>",         " - Adds and enables the specified plugin"},
+	{"unload",          &cServer::ExecuteUnloadCommand,         "unload <pluginname>",       " - Disables the specified plugin"},
+	{"destroyentities", &cServer::ExecuteDestroyEntitiesCommand, "destroyentities",          " - Destroys all entities in all worlds"},
+
+	// There is currently no way a plugin can do these (and probably won't ever be):
+	{"chunkstats",      &cServer::ExecuteChunkStatsCommand,     "chunkstats",                " - Displays detailed chunk memory statistics"},
+	{"netstats",        &cServer::ExecuteNetStatsCommand,       "netstats",                  " - Displays the latency of the outgoing packet processing stages"},
+	{"lockstats",       &cServer::ExecuteLockStatsCommand,      "lockstats [on|off|reset]",  " - Turns the lock contention profiling on or off, zeroes it, or displays the gathered statistics"},
+	{"backup",          &cServer::ExecuteBackupCommand,         "backup <world> [<folder>]", " - Backs up the world's saved chunks into the folder without stopping the saving; without a folder, shows the backup progress"},
+	#if defined(_MSC_VER) && defined(_DEBUG) && defined(ENABLE_LEAK_FINDER)
+	{"dumpmem",         &cServer::ExecuteDumpMemCommand,        "dumpmem",                   " - Dumps all used memory blocks together with their callstacks into memdump.xml"},
+	{"killmem",         &cServer::ExecuteKillMemCommand,        nullptr,                     nullptr},
+	#endif
+};
+
+
+
+
+
+const cServer::sBuiltInCommand * cServer::FindBuiltInConsoleCommand(const AString & a_Name)
+{
+	for (size_t i = 0; i < ARRAYCOUNT(s_BuiltInCommands); i++)
 	{
-		PrintHelp(split, a_Output);
-		a_Output.Finished();
-		return;
+		if (a_Name == s_BuiltInCommands[i].m_Name)
+		{
+			return &s_BuiltInCommands[i];
+		}
 	}
-	else if (split[0] == "reload")
+	return nullptr;
+}
+
+
+
+
+
+bool cServer::IsBuiltInConsoleCommand(const AString & a_Command)
+{
+	return (FindBuiltInConsoleCommand(a_Command) != nullptr);
+}
+
+
+
+
+
+void cServer::ExecuteConsoleCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	if (a_Split.empty())
 	{
-		cPluginManager::Get()->ReloadPlugins();
 		a_Output.Finished();
 		return;
 	}
-	else if (split[0] == "reloadplugins")
+
+	const sBuiltInCommand * BuiltIn = FindBuiltInConsoleCommand(a_Split[0]);
+	if (BuiltIn != nullptr)
 	{
-		cPluginManager::Get()->ReloadPlugins();
-		a_Output.Out("Plugins reloaded");
-		a_Output.Finished();
-		return;
+		(this->*(BuiltIn->m_Handler))(a_Split, a_Output);
 	}
-	else if (split[0] == "load")
+	else if (!cPluginManager::Get()->ExecuteConsoleCommand(a_Split, a_Output))
 	{
-		if (split.size() > 1)
-		{
-			cPluginManager::PluginMap map = cPluginManager::Get()->GetAllPlugins();
+		a_Output.Out("Unknown command, type 'help' for all commands.");
+	}
+	a_Output.Finished();
+}
 
-			for (auto plugin_entry : map)
-			{
-				if (plugin_entry.first == split[1])
-				{
-					a_Output.Out("Error! Plugin is already loaded!");
-					a_Output.Finished();
-					return;
-				}
-			}
-			a_Output.Out(cPluginManager::Get()->LoadPlugin(split[1]) ? "Plugin loaded" : "Error occurred loading plugin");
-		}
-		else
-		{
-			a_Output.Out("Usage: load <pluginname>");
-		}
-		a_Output.Finished();
+
+
+
+
+void cServer::ExecuteReloadCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	UNUSED(a_Split);
+	UNUSED(a_Output);
+	cPluginManager::Get()->ReloadPlugins();
+}
+
+
+
+
+
+void cServer::ExecuteReloadPluginsCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	UNUSED(a_Split);
+	cPluginManager::Get()->ReloadPlugins();
+	a_Output.Out("Plugins reloaded");
+}
+
+
+
+
+
+void cServer::ExecuteLoadCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	if (a_Split.size() < 2)
+	{
+		a_Output.Out("Usage: load <pluginname>");
 		return;
 	}
-	else if (split[0] == "unload")
+
+	cPluginManager::PluginMap map = cPluginManager::Get()->GetAllPlugins();
+	for (auto plugin_entry : map)
 	{
-		if (split.size() > 1)
-		{
-			cPluginManager::Get()->RemovePlugin(cPluginManager::Get()->GetPlugin(split[1]));
-			a_Output.Out("Plugin unloaded");
-		}
-		else
+		if (plugin_entry.first == a_Split[1])
 		{
-			a_Output.Out("Usage: unload <pluginname>");
+			a_Output.Out("Error! Plugin is already loaded!");
+			return;
 		}
-		a_Output.Finished();
+	}
+	a_Output.Out(cPluginManager::Get()->LoadPlugin(a_Split[1]) ? "Plugin loaded" : "Error occurred loading plugin");
+}
+
+
+
+
+
+void cServer::ExecuteUnloadCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	if (a_Split.size() < 2)
+	{
+		a_Output.Out("Usage: unload <pluginname>");
 		return;
 	}
-	if (split[0] == "destroyentities")
+
+	cPluginManager::Get()->RemovePlugin(cPluginManager::Get()->GetPlugin(a_Split[1]));
+	a_Output.Out("Plugin unloaded");
+}
+
+
+
+
+
+void cServer::ExecuteDestroyEntitiesCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	UNUSED(a_Split);
+	class WorldCallback : public cWorldListCallback
 	{
-		class WorldCallback : public cWorldListCallback
+		virtual bool Item(cWorld * a_World) override
 		{
-			virtual bool Item(cWorld * a_World) override
+			class EntityCallback : public cEntityCallback
 			{
-				class EntityCallback : public cEntityCallback
+				virtual bool Item(cEntity * a_Entity) override
 				{
-					virtual bool Item(cEntity * a_Entity) override
+					if (!a_Entity->IsPlayer())
 					{
-						if (!a_Entity->IsPlayer())
-						{
-							a_Entity->Destroy();
-						}
-						return false;
+						a_Entity->Destroy();
 					}
-				} EC;
-				a_World->ForEachEntity(EC);
-				return false;
-			}
-		} WC;
-		cRoot::Get()->ForEachWorld(WC);
-		a_Output.Out("Destroyed all entities");
-		a_Output.Finished();
-		return;
-	}
-
-	// There is currently no way a plugin can do these (and probably won't ever be):
-	else if (split[0].compare("chunkstats") == 0)
-	{
-		cRoot::Get()->LogChunkStats(a_Output);
-		a_Output.Finished();
-		return;
-	}
-	#if defined(_MSC_VER) && defined(_DEBUG) && defined(ENABLE_LEAK_FINDER)
-	else if (split[0].compare("dumpmem") == 0)
-	{
-		LeakFinderXmlOutput Output("memdump.xml");
-		DumpUsedMemory(&Output);
-		return;
-	}
-	
-	else if (split[0].compare("killmem") == 0)
-	{
-		for (;;)
-		{
-			new char[100 * 1024 * 1024];  // Allocate and leak 100 MiB in a loop -> fill memory and kill MCS
+					return false;
+				}
+			} EC;
+			a_World->ForEachEntity(EC);
+			return false;
 		}
-	}
-	#endif
+	} WC;
+	cRoot::Get()->ForEachWorld(WC);
+	a_Output.Out("Destroyed all entities");
+}
+
+
+
+
+
+void cServer::ExecuteChunkStatsCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	UNUSED(a_Split);
+	cRoot::Get()->LogChunkStats(a_Output);
+}
+
+
 
-	else if (cPluginManager::Get()->ExecuteConsoleCommand(split, a_Output))
+
+
+void cServer::ExecuteNetStatsCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	UNUSED(a_Split);
+	m_PacketWorkers.LogStats(a_Output);
+}
+
+
+
+
+
+#if defined(_MSC_VER) && defined(_DEBUG) && defined(ENABLE_LEAK_FINDER)
+void cServer::ExecuteDumpMemCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	UNUSED(a_Split);
+	UNUSED(a_Output);
+	LeakFinderXmlOutput Output("memdump.xml");
+	DumpUsedMemory(&Output);
+}
+
+
+
+
+
+void cServer::ExecuteKillMemCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	UNUSED(a_Split);
+	UNUSED(a_Output);
+	for (;;)
 	{
-		a_Output.Finished();
-		return;
+		new char[100 * 1024 * 1024];  // Allocate and leak 100 MiB in a loop -> fill memory and kill MCS
 	}
-	
-	a_Output.Out("Unknown command, type 'help' for all commands.");
-	a_Output.Finished();
 }
+#endif
 
 
 
@@ -640,7 +732,85 @@ void cServer::PrintHelp(const AStringVector & a_Split, cCommandOutputCallback &
 		const AStringPair & cmd = *itr;
 		a_Output.Out(Printf("%-*s%s\n", static_cast<int>(Callback.m_MaxLen), cmd.first.c_str(), cmd.second.c_str()));
 	}  // for itr - Callback.m_Commands[]
-	a_Output.Finished();
+}
+
+
+
+
+
+void cServer::ExecuteBackupCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	if ((a_Split.size() < 2) || (a_Split.size() > 3))
+	{
+		a_Output.Out("Usage: backup <world> [<folder>]");
+		return;
+	}
+	cWorld * World = cRoot::Get()->GetWorld(a_Split[1]);
+	if (World == nullptr)
+	{
+		a_Output.Out("There's no world named \"%s\"", a_Split[1].c_str());
+		return;
+	}
+	if (a_Split.size() == 2)
+	{
+		a_Output.Out("%s", World->GetBackupStatus().c_str());
+		return;
+	}
+	if (!World->StartBackup(a_Split[2]))
+	{
+		a_Output.Out("Cannot start the backup of world \"%s\"", a_Split[1].c_str());
+		return;
+	}
+	a_Output.Out("Backup of world \"%s\" into \"%s\" started, use \"backup %s\" to see the progress",
+		a_Split[1].c_str(), a_Split[2].c_str(), a_Split[1].c_str()
+	);
+}
+
+
+
+
+
+void cServer::ExecuteLockStatsCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output)
+{
+	if (a_Split.size() > 2)
+	{
+		a_Output.Out("Usage: lockstats [on|off|reset]");
+		return;
+	}
+	if (a_Split.size() == 2)
+	{
+		if (NoCaseCompare(a_Split[1], "on") == 0)
+		{
+			cCriticalSection::SetProfilingEnabled(true);
+			a_Output.Out("Lock contention profiling is on");
+		}
+		else if (NoCaseCompare(a_Split[1], "off") == 0)
+		{
+			cCriticalSection::SetProfilingEnabled(false);
+			a_Output.Out("Lock contention profiling is off");
+		}
+		else if (NoCaseCompare(a_Split[1], "reset") == 0)
+		{
+			cCriticalSection::ResetLockStats();
+			a_Output.Out("Lock contention statistics have been reset");
+		}
+		else
+		{
+			a_Output.Out("Usage: lockstats [on|off|reset]");
+		}
+		return;
+	}
+
+	a_Output.Out("Lock contention profiling is %s", cCriticalSection::IsProfilingEnabled() ? "on" : "off");
+	a_Output.Out("%-32s %10s %10s %12s %12s %12s", "Lock", "Acquires", "Contended", "Wait [ms]", "MaxWait [ms]", "Hold [ms]");
+	cCriticalSection::sLockStatsVector Stats = cCriticalSection::GetLockStats();
+	for (cCriticalSection::sLockStatsVector::const_iterator itr = Stats.begin(), end = Stats.end(); itr != end; ++itr)
+	{
+		a_Output.Out("%-32s %10llu %10llu %12.3f %12.3f %12.3f",
+			itr->m_Name, itr->m_NumAcquires, itr->m_NumContended,
+			static_cast<double>(itr->m_WaitNSec) / 1e6, static_cast<double>(itr->m_MaxWaitNSec) / 1e6, static_cast<double>(itr->m_HoldNSec) / 1e6
+		);
+	}
 }
 
 
@@ -650,18 +820,15 @@ void cServer::PrintHelp(const AStringVector & a_Split, cCommandOutputCallback &
 void cServer::BindBuiltInConsoleCommands(void)
 {
 	cPluginManager * PlgMgr = cPluginManager::Get();
-	PlgMgr->BindConsoleCommand("help", nullptr, " - Shows the available commands");
-	PlgMgr->BindConsoleCommand("reload", nullptr, " - Reloads all plugins");
 	PlgMgr->BindConsoleCommand("restart", nullptr, " - Restarts the server cleanly");
 	PlgMgr->BindConsoleCommand("stop", nullptr, " - Stops the server cleanly");
-	PlgMgr->BindConsoleCommand("chunkstats", nullptr, " - Displays detailed chunk memory statistics");
-	PlgMgr->BindConsoleCommand("load <pluginname>", nullptr, " - Adds and enables the specified plugin");
-	PlgMgr->BindConsoleCommand("unload <pluginname>", nullptr, " - Disables the specified plugin");
-	PlgMgr->BindConsoleCommand("destroyentities", nullptr, " - Destroys all entities in all worlds");
-
-	#if defined(_MSC_VER) && defined(_DEBUG) && defined(ENABLE_LEAK_FINDER)
-	PlgMgr->BindConsoleCommand("dumpmem", nullptr, " - Dumps all used memory blocks together with their callstacks into memdump.xml");
-	#endif
+	for (size_t i = 0; i < ARRAYCOUNT(s_BuiltInCommands); i++)
+	{
+		if (s_BuiltInCommands[i].m_Usage != nullptr)
+		{
+			PlgMgr->BindConsoleCommand(s_BuiltInCommands[i].m_Usage, nullptr, s_BuiltInCommands[i].m_HelpString);
+		}
+	}
 }
 
 
@@ -13,6 +13,7 @@
 #include "OSSupport/ListenThread.h"
 
 #include "RCONServer.h"
+#include "Protocol/PacketWorkers.h"
 
 #ifdef _MSC_VER
 	#pragma warning(push)
@@ -86,11 +87,23 @@ public:  // tolua_export
 	
 	/** Executes the console command, sends output through the specified callback */
 	void ExecuteConsoleCommand(const AString & a_Cmd, cCommandOutputCallback & a_Output);
+
+	/** Executes the console command already split into words, sends output through the specified callback */
+	void ExecuteConsoleCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+	
+	/** Returns true if the command is one of the built-in commands, handled by the server itself in ExecuteConsoleCommand() before any plugin gets a chance to handle it */
+	static bool IsBuiltInConsoleCommand(const AString & a_Command);
 	
-	/** Lists all available console commands and their helpstrings */
+	/** Lists all available console commands and their helpstrings. The caller finishes the output. */
 	void PrintHelp(const AStringVector & a_Split, cCommandOutputCallback & a_Output);
 
-	/** Binds the built-in console commands with the plugin manager */
+	/** Handles the "backup" console command: starts an online backup of a world, or shows its progress */
+	void ExecuteBackupCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+
+	/** Handles the "lockstats" console command: turns the lock contention profiling on or off, resets it, or outputs the statistics */
+	void ExecuteLockStatsCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+
+	/** Binds the built-in console commands, with their help strings, with the plugin manager */
 	static void BindBuiltInConsoleCommands(void);
 	
 	void Shutdown(void);
@@ -143,11 +156,47 @@ public:  // tolua_export
 	Read from settings, admins should set this to true only when they chain to BungeeCord,
 	it makes the server vulnerable to identity theft through direct connections. */
 	bool ShouldAllowBungeeCord(void) const { return m_ShouldAllowBungeeCord; }
+
+	/** Returns the thread pool that compresses and encrypts the outgoing packets. */
+	cPacketWorkers & GetPacketWorkers(void) { return m_PacketWorkers; }
 	
 private:
 
 	friend class cRoot;  // so cRoot can create and destroy cServer
 	
+	/** Handler of a built-in console command; ExecuteConsoleCommand() finishes the output after calling it */
+	typedef void (cServer::*cBuiltInCommandHandler)(const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+	
+	/** A console command handled by the server itself */
+	struct sBuiltInCommand
+	{
+		const char * m_Name;
+		cBuiltInCommandHandler m_Handler;
+		
+		/** The command with its parameters and the help string, as listed by "help"; nullptr for the unlisted commands */
+		const char * m_Usage;
+		const char * m_HelpString;
+	} ;
+	
+	/** All the built-in console commands; the dispatch in ExecuteConsoleCommand(), IsBuiltInConsoleCommand() and the help all come from this single list */
+	static const sBuiltInCommand s_BuiltInCommands[];
+	
+	/** Returns the built-in console command of the specified name, or nullptr if there's none */
+	static const sBuiltInCommand * FindBuiltInConsoleCommand(const AString & a_Name);
+	
+	// The built-in console command handlers, besides the public ones above:
+	void ExecuteReloadCommand         (const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+	void ExecuteReloadPluginsCommand  (const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+	void ExecuteLoadCommand           (const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+	void ExecuteUnloadCommand         (const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+	void ExecuteDestroyEntitiesCommand(const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+	void ExecuteChunkStatsCommand     (const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+	void ExecuteNetStatsCommand       (const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+	#if defined(_MSC_VER) && defined(_DEBUG) && defined(ENABLE_LEAK_FINDER)
+	void ExecuteDumpMemCommand        (const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+	void ExecuteKillMemCommand        (const AStringVector & a_Split, cCommandOutputCallback & a_Output);
+	#endif
+	
 	/** When NotifyClientWrite() is called, it is queued for this thread to process (to avoid deadlocks between cSocketThreads, cClientHandle and cChunkMap) */
 	class cNotifyWriteThread :
 		public cIsThread
@@ -204,6 +253,9 @@ private:
 	int              m_PlayerCountDiff;    ///< Adjustment to m_PlayerCount to be applied in the Tick thread
 	
 	cSocketThreads m_SocketThreads;
+
+	/** The threads that compress and encrypt the outgoing packets; settable in Settings.ini */
+	cPacketWorkers m_PacketWorkers;
 	
 	int m_ClientViewDistance;  // The default view distance for clients; settable in Settings.ini
 
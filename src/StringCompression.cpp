@@ -5,176 +5,418 @@
 
 #include "Globals.h"
 #include "StringCompression.h"
+#include "OSSupport/CriticalSection.h"
 
 
 
 
 
-/// Compresses a_Data into a_Compressed; returns Z_XXX error constants same as zlib's compress2()
-int CompressString(const char * a_Data, size_t a_Length, AString & a_Compressed, int a_Factor)
+/** Parameters of the zlib streams used by the functions in this file: */
+static const int ZLIB_WINDOW_BITS = 15;  // zlib format, same as compress2() / uncompress()
+static const int GZIP_WINDOW_BITS = 31;  // gzip format
+static const int DEFAULT_MEM_LEVEL = 8;  // Same as compress2()
+
+
+
+
+
+/** A pool of initialized zlib streams.
+Initializing a deflate stream allocates about 256 KiB of state, which dominates the cost of compressing small data
+such as network packets. The streams are therefore kept after use and reset via deflateReset() / inflateReset()
+for the next user with the same parameters. Each thread has its own pool, see GetThreadZStreamPool(), so acquiring
+and releasing the streams needs no locking. */
+class cZStreamPool
 {
-	uLongf CompressedSize = compressBound((uLong)a_Length);
-	
-	// HACK: We're assuming that AString returns its internal buffer in its data() call and we're overwriting that buffer!
-	// It saves us one allocation and one memcpy of the entire compressed data
-	// It may not work on some STL implementations! (Confirmed working on MSVC 2008 & 2010)
-	a_Compressed.resize(CompressedSize);
-	int errorcode = compress2((Bytef*)a_Compressed.data(), &CompressedSize, (const Bytef *)a_Data, (uLong)a_Length, a_Factor);
-	if (errorcode != Z_OK)
+public:
+
+	/** Maximum number of idle streams kept in the pool; any more are destroyed on release.
+	A thread rarely uses more than a deflate and an inflate stream at once, in a format or two. */
+	static const size_t MAX_IDLE_STREAMS = 4;
+
+
+	~cZStreamPool()
 	{
-		return errorcode;
+		for (sStreams::iterator itr = m_Idle.begin(), end = m_Idle.end(); itr != end; ++itr)
+		{
+			End(*itr);
+		}
 	}
-	a_Compressed.resize(CompressedSize);
-	return Z_OK;
-}
 
 
+	/** Returns an initialized stream with the specified parameters, either from the pool or a new one.
+	For inflate streams, a_Level and a_MemLevel are ignored. Returns nullptr and sets a_Res on failure. */
+	z_stream * Acquire(bool a_IsDeflate, int a_Level, int a_WindowBits, int a_MemLevel, int & a_Res)
+	{
+		a_Res = Z_OK;
+		for (sStreams::iterator itr = m_Idle.begin(), end = m_Idle.end(); itr != end; ++itr)
+		{
+			if (
+				(itr->m_IsDeflate == a_IsDeflate) &&
+				(itr->m_WindowBits == a_WindowBits) &&
+				(!a_IsDeflate || ((itr->m_Level == a_Level) && (itr->m_MemLevel == a_MemLevel)))
+			)
+			{
+				z_stream * res = itr->m_Stream;
+				m_Idle.erase(itr);
+				return res;
+			}
+		}
 
+		// No suitable idle stream, create a new one:
+		z_stream * Stream = new z_stream;
+		memset(Stream, 0, sizeof(*Stream));
+		if (a_IsDeflate)
+		{
+			a_Res = deflateInit2(Stream, a_Level, Z_DEFLATED, a_WindowBits, a_MemLevel, Z_DEFAULT_STRATEGY);
+		}
+		else
+		{
+			a_Res = inflateInit2(Stream, a_WindowBits);
+		}
+		if (a_Res != Z_OK)
+		{
+			delete Stream;
+			return nullptr;
+		}
+		return Stream;
+	}
 
 
-/// Uncompresses a_Data into a_Decompressed; returns Z_XXX error constants same as zlib's uncompress()
-int UncompressString(const char * a_Data, size_t a_Length, AString & a_Uncompressed, size_t a_UncompressedSize)
-{
-	// HACK: We're assuming that AString returns its internal buffer in its data() call and we're overwriting that buffer!
-	// It saves us one allocation and one memcpy of the entire compressed data
-	// It may not work on some STL implementations! (Confirmed working on MSVC 2008 & 2010)
-	a_Uncompressed.resize(a_UncompressedSize);
-	uLongf UncompressedSize = (uLongf)a_UncompressedSize;  // On some architectures the uLongf is different in size to int, that may be the cause of the -5 error
-	int errorcode = uncompress((Bytef*)a_Uncompressed.data(), &UncompressedSize, (const Bytef*)a_Data, (uLong)a_Length);
-	if (errorcode != Z_OK)
+	/** Resets the stream and returns it into the pool, or destroys it if the pool is full or the reset fails. */
+	void Release(z_stream * a_Stream, bool a_IsDeflate, int a_Level, int a_WindowBits, int a_MemLevel)
 	{
-		return errorcode;
+		sStream Stream = { a_Stream, a_IsDeflate, a_Level, a_WindowBits, a_MemLevel };
+		int res = a_IsDeflate ? deflateReset(a_Stream) : inflateReset(a_Stream);
+		if ((res == Z_OK) && (m_Idle.size() < MAX_IDLE_STREAMS))
+		{
+			m_Idle.push_back(Stream);
+			return;
+		}
+		End(Stream);
 	}
-	a_Uncompressed.resize(UncompressedSize);
-	return Z_OK;
-}
 
+protected:
 
+	struct sStream
+	{
+		z_stream * m_Stream;
+		bool m_IsDeflate;
+		int m_Level;
+		int m_WindowBits;
+		int m_MemLevel;
+	};
 
+	typedef std::vector<sStream> sStreams;
 
 
-int CompressStringGZIP(const char * a_Data, size_t a_Length, AString & a_Compressed)
+	/** The streams that are ready to be used */
+	sStreams m_Idle;
+
+
+	/** Frees the stream's zlib state and the stream itself. */
+	static void End(const sStream & a_Stream)
+	{
+		if (a_Stream.m_IsDeflate)
+		{
+			deflateEnd(a_Stream.m_Stream);
+		}
+		else
+		{
+			inflateEnd(a_Stream.m_Stream);
+		}
+		delete a_Stream.m_Stream;
+	}
+};
+
+
+
+
+
+/** Owns the pools of all the threads, so that their streams are freed on exit.
+The thread-local storage can't run destructors, so a pool isn't freed when its thread ends; the server's threads
+run for its whole lifetime, so this holds at most MAX_IDLE_STREAMS idle streams per thread ever started. */
+class cZStreamPools
 {
-	// Compress a_Data into a_Compressed using GZIP; return Z_XXX error constants same as zlib's compress2()
+public:
+
+	~cZStreamPools()
+	{
+		for (std::vector<cZStreamPool *>::iterator itr = m_Pools.begin(), end = m_Pools.end(); itr != end; ++itr)
+		{
+			delete *itr;
+		}
+	}
 
-	a_Compressed.reserve(a_Length);
 
-	char Buffer[64 KiB];
-	z_stream strm;
-	memset(&strm, 0, sizeof(strm));
-	strm.next_in = (Bytef *)a_Data;
-	strm.avail_in = (uInt)a_Length;
-	strm.next_out = (Bytef *)Buffer;
-	strm.avail_out = sizeof(Buffer);
-	
-	int res = deflateInit2(&strm, 9, Z_DEFLATED, 31, 9, Z_DEFAULT_STRATEGY);
-	if (res != Z_OK)
+	/** Creates a new pool for the calling thread. */
+	cZStreamPool * CreatePool(void)
 	{
-		LOG("%s: compression initialization failed: %d (\"%s\").", __FUNCTION__, res, strm.msg);
+		cZStreamPool * res = new cZStreamPool;
+		cCSLock Lock(m_CS);
+		m_Pools.push_back(res);
 		return res;
 	}
-	
+
+protected:
+
+	/** Protects m_Pools against multithreaded access; only locked once per thread, when creating its pool. */
+	cCriticalSection m_CS;
+
+	/** All the pools created so far */
+	std::vector<cZStreamPool *> m_Pools;
+} g_ZStreamPools;
+
+/** The calling thread's pool, created on its first use by GetThreadZStreamPool().
+A plain pointer in the thread-local storage, the compilers we support don't all have the C++11 thread_local yet. */
+#ifdef _MSC_VER
+	static __declspec(thread) cZStreamPool * g_ThreadZStreamPool = nullptr;
+#else
+	static __thread cZStreamPool * g_ThreadZStreamPool = nullptr;
+#endif
+
+
+
+
+
+/** Returns the calling thread's stream pool. */
+static cZStreamPool & GetThreadZStreamPool(void)
+{
+	if (g_ThreadZStreamPool == nullptr)
+	{
+		g_ThreadZStreamPool = g_ZStreamPools.CreatePool();
+	}
+	return *g_ThreadZStreamPool;
+}
+
+
+
+
+
+/** Acquires a stream from the calling thread's pool for the duration of its scope. */
+class cPooledZStream
+{
+public:
+	cPooledZStream(bool a_IsDeflate, int a_Level, int a_WindowBits, int a_MemLevel) :
+		m_IsDeflate(a_IsDeflate),
+		m_Level(a_Level),
+		m_WindowBits(a_WindowBits),
+		m_MemLevel(a_MemLevel)
+	{
+		m_Stream = GetThreadZStreamPool().Acquire(a_IsDeflate, a_Level, a_WindowBits, a_MemLevel, m_InitResult);
+	}
+
+	~cPooledZStream()
+	{
+		if (m_Stream != nullptr)
+		{
+			GetThreadZStreamPool().Release(m_Stream, m_IsDeflate, m_Level, m_WindowBits, m_MemLevel);
+		}
+	}
+
+	/** Returns the stream, or nullptr if it couldn't be initialized. */
+	z_stream * Get(void) { return m_Stream; }
+
+	/** Returns the zlib result of the stream initialization. */
+	int GetInitResult(void) const { return m_InitResult; }
+
+protected:
+	z_stream * m_Stream;
+	bool m_IsDeflate;
+	int m_Level;
+	int m_WindowBits;
+	int m_MemLevel;
+	int m_InitResult;
+};
+
+
+
+
+
+/** Inflates a_Data using the specified stream and appends the result to a_Uncompressed.
+The output is written directly into a_Uncompressed, which is grown as needed.
+Returns Z_OK for success or Z_XXX error constants same as zlib. */
+static int InflateAppend(z_stream & a_Stream, const char * a_Data, size_t a_Length, AString & a_Uncompressed, const char * a_FnName)
+{
+	a_Stream.next_in = (Bytef *)a_Data;
+	a_Stream.avail_in = (uInt)a_Length;
+
+	size_t Written = a_Uncompressed.size();
 	for (;;)
 	{
-		res = deflate(&strm, Z_FINISH);
+		if (Written == a_Uncompressed.size())
+		{
+			// The output is full, grow it:
+			a_Uncompressed.resize(Written + std::max<size_t>(std::max(Written, a_Length), 16 KiB));
+		}
+		a_Stream.next_out = (Bytef *)&a_Uncompressed[Written];
+		a_Stream.avail_out = (uInt)(a_Uncompressed.size() - Written);
+
+		int res = inflate(&a_Stream, Z_NO_FLUSH);
+		Written = a_Uncompressed.size() - a_Stream.avail_out;
 		switch (res)
 		{
 			case Z_OK:
 			{
-				// Some data has been compressed. Consume the buffer and continue compressing
-				a_Compressed.append(Buffer, sizeof(Buffer) - strm.avail_out);
-				strm.next_out = (Bytef *)Buffer;
-				strm.avail_out = sizeof(Buffer);
-				if (strm.avail_in == 0)
+				if (a_Stream.avail_in == 0)
 				{
-					// All data has been compressed
-					deflateEnd(&strm);
+					// All data has been uncompressed
+					a_Uncompressed.resize(Written);
 					return Z_OK;
 				}
+				// Some data has been uncompressed, continue uncompressing
 				break;
 			}
-			
+
 			case Z_STREAM_END:
 			{
-				// Finished compressing. Consume the rest of the buffer and return
-				a_Compressed.append(Buffer, sizeof(Buffer) - strm.avail_out);
-				deflateEnd(&strm);
+				// Finished uncompressing
+				a_Uncompressed.resize(Written);
 				return Z_OK;
 			}
-			
+
 			default:
 			{
 				// An error has occurred, log it and return the error value
-				LOG("%s: compression failed: %d (\"%s\").", __FUNCTION__, res, strm.msg);
-				deflateEnd(&strm);
+				LOG("%s: uncompression failed: %d (\"%s\").", a_FnName, res, a_Stream.msg);
+				a_Uncompressed.resize(Written);
 				return res;
 			}
 		}  // switch (res)
-	}  // while (true)
+	}  // for (;;)
 }
 
 
 
 
 
-extern int UncompressStringGZIP(const char * a_Data, size_t a_Length, AString & a_Uncompressed)
+int CompressBuffer(const char * a_Data, size_t a_Length, char * a_Compressed, size_t & a_CompressedSize, int a_Factor)
 {
-	// Uncompresses a_Data into a_Uncompressed using GZIP; returns Z_OK for success or Z_XXX error constants same as zlib
+	cPooledZStream Stream(true, a_Factor, ZLIB_WINDOW_BITS, DEFAULT_MEM_LEVEL);
+	z_stream * strm = Stream.Get();
+	if (strm == nullptr)
+	{
+		return Stream.GetInitResult();
+	}
+
+	strm->next_in = (Bytef *)a_Data;
+	strm->avail_in = (uInt)a_Length;
+	strm->next_out = (Bytef *)a_Compressed;
+	strm->avail_out = (uInt)a_CompressedSize;
+	int res = deflate(strm, Z_FINISH);
+	if (res != Z_STREAM_END)
+	{
+		// Same as compress2(), report running out of the output space as Z_BUF_ERROR:
+		return (res == Z_OK) ? Z_BUF_ERROR : res;
+	}
+	a_CompressedSize = strm->total_out;
+	return Z_OK;
+}
+
+
 
-	a_Uncompressed.reserve(a_Length);
 
-	char Buffer[64 KiB];
-	z_stream strm;
-	memset(&strm, 0, sizeof(strm));
-	strm.next_in = (Bytef *)a_Data;
-	strm.avail_in = (uInt)a_Length;
-	strm.next_out = (Bytef *)Buffer;
-	strm.avail_out = sizeof(Buffer);
-	
-	int res = inflateInit2(&strm, 31);  // Force GZIP decoding
-	if (res != Z_OK)
+
+/// Compresses a_Data into a_Compressed; returns Z_XXX error constants same as zlib's compress2()
+int CompressString(const char * a_Data, size_t a_Length, AString & a_Compressed, int a_Factor)
+{
+	// Compress directly into a_Compressed, sized for the worst case:
+	size_t CompressedSize = compressBound((uLong)a_Length);
+	a_Compressed.resize(CompressedSize);
+	int errorcode = CompressBuffer(a_Data, a_Length, &a_Compressed[0], CompressedSize, a_Factor);
+	if (errorcode != Z_OK)
 	{
-		LOG("%s: uncompression initialization failed: %d (\"%s\").", __FUNCTION__, res, strm.msg);
-		return res;
+		return errorcode;
 	}
-	
-	for (;;)
+	a_Compressed.resize(CompressedSize);
+	return Z_OK;
+}
+
+
+
+
+
+/// Uncompresses a_Data into a_Decompressed; returns Z_XXX error constants same as zlib's uncompress()
+int UncompressString(const char * a_Data, size_t a_Length, AString & a_Uncompressed, size_t a_UncompressedSize)
+{
+	cPooledZStream Stream(false, 0, ZLIB_WINDOW_BITS, 0);
+	z_stream * strm = Stream.Get();
+	if (strm == nullptr)
 	{
-		res = inflate(&strm, Z_NO_FLUSH);
-		switch (res)
+		return Stream.GetInitResult();
+	}
+
+	// Uncompress directly into a_Uncompressed, sized to the expected size:
+	a_Uncompressed.resize(a_UncompressedSize);
+	strm->next_in = (Bytef *)a_Data;
+	strm->avail_in = (uInt)a_Length;
+	strm->next_out = (Bytef *)&a_Uncompressed[0];
+	strm->avail_out = (uInt)a_UncompressedSize;
+	int errorcode = inflate(strm, Z_FINISH);
+	if (errorcode != Z_STREAM_END)
+	{
+		// Same as uncompress(), report truncated input as Z_DATA_ERROR:
+		if ((errorcode == Z_NEED_DICT) || ((errorcode == Z_BUF_ERROR) && (strm->avail_out > 0)))
 		{
-			case Z_OK:
-			{
-				// Some data has been uncompressed. Consume the buffer and continue uncompressing
-				a_Uncompressed.append(Buffer, sizeof(Buffer) - strm.avail_out);
-				strm.next_out = (Bytef *)Buffer;
-				strm.avail_out = sizeof(Buffer);
-				if (strm.avail_in == 0)
-				{
-					// All data has been uncompressed
-					inflateEnd(&strm);
-					return Z_OK;
-				}
-				break;
-			}
-			
-			case Z_STREAM_END:
-			{
-				// Finished uncompressing. Consume the rest of the buffer and return
-				a_Uncompressed.append(Buffer, sizeof(Buffer) - strm.avail_out);
-				inflateEnd(&strm);
-				return Z_OK;
-			}
-			
-			default:
-			{
-				// An error has occurred, log it and return the error value
-				LOG("%s: uncompression failed: %d (\"%s\").", __FUNCTION__, res, strm.msg);
-				inflateEnd(&strm);
-				return res;
-			}
-		}  // switch (res)
-	}  // while (true)
+			return Z_DATA_ERROR;
+		}
+		return (errorcode == Z_OK) ? Z_BUF_ERROR : errorcode;
+	}
+	a_Uncompressed.resize(strm->total_out);
+	return Z_OK;
+}
+
+
+
+
+
+int CompressStringGZIP(const char * a_Data, size_t a_Length, AString & a_Compressed)
+{
+	// Compress a_Data into a_Compressed using GZIP; return Z_XXX error constants same as zlib's compress2()
+
+	cPooledZStream Stream(true, 9, GZIP_WINDOW_BITS, 9);
+	z_stream * strm = Stream.Get();
+	if (strm == nullptr)
+	{
+		LOG("%s: compression initialization failed: %d.", __FUNCTION__, Stream.GetInitResult());
+		return Stream.GetInitResult();
+	}
+
+	// Compress directly into a_Compressed, appending to its current contents, sized for the worst case:
+	size_t Start = a_Compressed.size();
+	a_Compressed.resize(Start + deflateBound(strm, (uLong)a_Length));
+	strm->next_in = (Bytef *)a_Data;
+	strm->avail_in = (uInt)a_Length;
+	strm->next_out = (Bytef *)&a_Compressed[Start];
+	strm->avail_out = (uInt)(a_Compressed.size() - Start);
+
+	int res = deflate(strm, Z_FINISH);
+	if (res != Z_STREAM_END)
+	{
+		// An error has occurred, log it and return the error value
+		LOG("%s: compression failed: %d (\"%s\").", __FUNCTION__, res, strm->msg);
+		a_Compressed.resize(Start);
+		return (res == Z_OK) ? Z_BUF_ERROR : res;
+	}
+	a_Compressed.resize(Start + strm->total_out);
+	return Z_OK;
+}
+
+
+
+
+
+extern int UncompressStringGZIP(const char * a_Data, size_t a_Length, AString & a_Uncompressed)
+{
+	// Uncompresses a_Data into a_Uncompressed using GZIP; returns Z_OK for success or Z_XXX error constants same as zlib
+
+	cPooledZStream Stream(false, 0, GZIP_WINDOW_BITS, 0);  // Force GZIP decoding
+	z_stream * strm = Stream.Get();
+	if (strm == nullptr)
+	{
+		LOG("%s: uncompression initialization failed: %d.", __FUNCTION__, Stream.GetInitResult());
+		return Stream.GetInitResult();
+	}
+	return InflateAppend(*strm, a_Data, a_Length, a_Uncompressed, __FUNCTION__);
 }
 
 
@@ -183,60 +425,111 @@ extern int UncompressStringGZIP(const char * a_Data, size_t a_Length, AString &
 
 extern int InflateString(const char * a_Data, size_t a_Length, AString & a_Uncompressed)
 {
-	a_Uncompressed.reserve(a_Length);
+	cPooledZStream Stream(false, 0, ZLIB_WINDOW_BITS, 0);
+	z_stream * strm = Stream.Get();
+	if (strm == nullptr)
+	{
+		LOG("%s: inflation initialization failed: %d.", __FUNCTION__, Stream.GetInitResult());
+		return Stream.GetInitResult();
+	}
+	return InflateAppend(*strm, a_Data, a_Length, a_Uncompressed, __FUNCTION__);
+}
+
+
 
-	char Buffer[64 KiB];
-	z_stream strm;
-	memset(&strm, 0, sizeof(strm));
-	strm.next_in = (Bytef *)a_Data;
-	strm.avail_in = (uInt)a_Length;
-	strm.next_out = (Bytef *)Buffer;
-	strm.avail_out = sizeof(Buffer);
-	
-	int res = inflateInit(&strm);  // Force GZIP decoding
-	if (res != Z_OK)
+
+
+////////////////////////////////////////////////////////////////////////////////
+// cZlibStreamCompressor:
+
+cZlibStreamCompressor::cZlibStreamCompressor(AString & a_Compressed, int a_Factor) :
+	m_Compressed(a_Compressed),
+	m_Factor(a_Factor)
+{
+	m_Stream = GetThreadZStreamPool().Acquire(true, a_Factor, ZLIB_WINDOW_BITS, DEFAULT_MEM_LEVEL, m_Result);
+}
+
+
+
+
+
+cZlibStreamCompressor::~cZlibStreamCompressor()
+{
+	if (m_Stream != nullptr)
 	{
-		LOG("%s: inflation initialization failed: %d (\"%s\").", __FUNCTION__, res, strm.msg);
-		return res;
+		GetThreadZStreamPool().Release(m_Stream, true, m_Factor, ZLIB_WINDOW_BITS, DEFAULT_MEM_LEVEL);
+	}
+}
+
+
+
+
+
+int cZlibStreamCompressor::Write(const char * a_Data, size_t a_Length)
+{
+	if (m_Result != Z_OK)
+	{
+		return m_Result;
+	}
+	m_Stream->next_in = (Bytef *)a_Data;
+	m_Stream->avail_in = (uInt)a_Length;
+	m_Result = Deflate(Z_NO_FLUSH);
+	return m_Result;
+}
+
+
+
+
+
+int cZlibStreamCompressor::Finish(void)
+{
+	if (m_Result != Z_OK)
+	{
+		return m_Result;
 	}
-	
+	m_Stream->next_in = nullptr;
+	m_Stream->avail_in = 0;
+	m_Result = Deflate(Z_FINISH);
+	return m_Result;
+}
+
+
+
+
+
+int cZlibStreamCompressor::Deflate(int a_Flush)
+{
+	size_t Written = m_Compressed.size();
 	for (;;)
 	{
-		res = inflate(&strm, Z_NO_FLUSH);
-		switch (res)
+		// Make room for the output; deflate buffers its input internally, so the output comes in pieces of similar size:
+		if (m_Compressed.size() - Written < 4 KiB)
 		{
-			case Z_OK:
-			{
-				// Some data has been uncompressed. Consume the buffer and continue uncompressing
-				a_Uncompressed.append(Buffer, sizeof(Buffer) - strm.avail_out);
-				strm.next_out = (Bytef *)Buffer;
-				strm.avail_out = sizeof(Buffer);
-				if (strm.avail_in == 0)
-				{
-					// All data has been uncompressed
-					inflateEnd(&strm);
-					return Z_OK;
-				}
-				break;
-			}
-			
-			case Z_STREAM_END:
-			{
-				// Finished uncompressing. Consume the rest of the buffer and return
-				a_Uncompressed.append(Buffer, sizeof(Buffer) - strm.avail_out);
-				inflateEnd(&strm);
-				return Z_OK;
-			}
-			
-			default:
-			{
-				// An error has occurred, log it and return the error value
-				LOG("%s: inflation failed: %d (\"%s\").", __FUNCTION__, res, strm.msg);
-				inflateEnd(&strm);
-				return res;
-			}
-		}  // switch (res)
-	}  // while (true)
+			m_Compressed.resize(Written + std::max<size_t>(m_Compressed.size() / 2, 16 KiB));
+		}
+		m_Stream->next_out = (Bytef *)&m_Compressed[Written];
+		m_Stream->avail_out = (uInt)(m_Compressed.size() - Written);
+
+		int res = deflate(m_Stream, a_Flush);
+		Written = m_Compressed.size() - m_Stream->avail_out;
+		if (res == Z_STREAM_END)
+		{
+			m_Compressed.resize(Written);
+			return Z_OK;
+		}
+		if ((res != Z_OK) && (res != Z_BUF_ERROR))
+		{
+			LOG("%s: compression failed: %d (\"%s\").", __FUNCTION__, res, m_Stream->msg);
+			m_Compressed.resize(Written);
+			return res;
+		}
+		if ((a_Flush == Z_NO_FLUSH) && (m_Stream->avail_in == 0) && (m_Stream->avail_out > 0))
+		{
+			// All the input has been consumed
+			m_Compressed.resize(Written);
+			return Z_OK;
+		}
+	}
 }
 
 
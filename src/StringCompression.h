@@ -3,12 +3,19 @@
 
 // Interfaces to the wrapping functions for compression and decompression using AString as their data
 
+#pragma once
+
 #include "zlib/zlib.h"  // Needed for the Z_XXX return values
 
 
 
 
 
+/** Compresses a_Data into the a_Compressed buffer using ZLIB, same as zlib's compress2(), but reusing a pooled zlib stream.
+On input, a_CompressedSize is the size of the buffer, on output it is the size of the compressed data.
+Returns Z_XXX error constants same as zlib's compress2() */
+extern int CompressBuffer(const char * a_Data, size_t a_Length, char * a_Compressed, size_t & a_CompressedSize, int a_Factor);
+
 /// Compresses a_Data into a_Compressed using ZLIB; returns Z_XXX error constants same as zlib's compress2()
 extern int CompressString(const char * a_Data, size_t a_Length, AString & a_Compressed, int a_Factor);
 
@@ -25,3 +32,39 @@ extern int UncompressStringGZIP(const char * a_Data, size_t a_Length, AString &
 extern int InflateString(const char * a_Data, size_t a_Length, AString & a_Uncompressed);
 
 
+
+
+
+/** Compresses data given in pieces using ZLIB, appending the compressed data to an AString as it is produced.
+Produces the same output as CompressString() would for all the pieces concatenated, without needing them in a single buffer. */
+class cZlibStreamCompressor
+{
+public:
+	/** Creates a compressor appending to a_Compressed, using the specified compression factor. */
+	cZlibStreamCompressor(AString & a_Compressed, int a_Factor);
+
+	~cZlibStreamCompressor();
+
+	/** Compresses the next piece of the data. Returns Z_OK for success or Z_XXX error constants same as zlib. */
+	int Write(const char * a_Data, size_t a_Length);
+
+	/** Finishes the compressed stream. Returns Z_OK for success or Z_XXX error constants same as zlib.
+	No more data may be written afterwards. */
+	int Finish(void);
+
+protected:
+	AString & m_Compressed;
+	int m_Factor;
+
+	/** The pooled zlib stream; nullptr if the initialization failed */
+	z_stream * m_Stream;
+
+	/** The first error encountered, reported by all the following calls; Z_OK if none */
+	int m_Result;
+
+	/** Runs deflate on the input already set in m_Stream, growing m_Compressed as needed, until the input is consumed
+	(or, for Z_FINISH, until the stream ends). */
+	int Deflate(int a_Flush);
+} ;
+
+
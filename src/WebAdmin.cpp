@@ -500,6 +500,22 @@ AString cWebAdmin::GetDefaultPage(void)
 		Content.append(PlayerAccum.m_Contents);
 	}
 	Content += "</ul><br>";
+
+	// Lock contention statistics, only while the profiling is on ("lockstats on" console command):
+	if (cCriticalSection::IsProfilingEnabled())
+	{
+		Content += "<h4>Lock contention:</h4>";
+		Content += "<table><tr><th>Lock</th><th>Acquires</th><th>Contended</th><th>Wait [ms]</th><th>Max wait [ms]</th><th>Hold [ms]</th></tr>";
+		cCriticalSection::sLockStatsVector Stats = cCriticalSection::GetLockStats();
+		for (cCriticalSection::sLockStatsVector::const_iterator itr = Stats.begin(), end = Stats.end(); itr != end; ++itr)
+		{
+			AppendPrintf(Content, "<tr><td>%s</td><td>%llu</td><td>%llu</td><td>%.3f</td><td>%.3f</td><td>%.3f</td></tr>",
+				itr->m_Name, itr->m_NumAcquires, itr->m_NumContended,
+				static_cast<double>(itr->m_WaitNSec) / 1e6, static_cast<double>(itr->m_MaxWaitNSec) / 1e6, static_cast<double>(itr->m_HoldNSec) / 1e6
+			);
+		}
+		Content += "</table><br>";
+	}
 	return Content;
 }
 
@@ -313,9 +313,12 @@ cWorld::cWorld(const AString & a_WorldName, eDimension a_Dimension, const AStrin
 	m_IsSaplingBonemealable(true),
 	m_IsSugarcaneBonemealable(false),
 	m_bCommandBlocksEnabled(true),
+	m_MaxCommandBlocksPerTick(100),
+	m_NumDeferredCommandBlocks(0),
 	m_bUseChatPrefixes(false),
 	m_TNTShrapnelLevel(slNone),
 	m_MaxViewDistance(12),
+	m_SimulationDistance(cClientHandle::MAX_VIEW_DISTANCE),
 	m_Scoreboard(this),
 	m_MapManager(this),
 	m_GeneratorCallbacks(*this),
@@ -323,6 +326,9 @@ cWorld::cWorld(const AString & a_WorldName, eDimension a_Dimension, const AStrin
 {
 	LOGD("cWorld::cWorld(\"%s\")", a_WorldName.c_str());
 
+	m_CSClients.SetName("cWorld::m_CSClients");
+	m_CSPlayers.SetName("cWorld::m_CSPlayers");
+
 	cFile::CreateFolder(FILE_IO_PREFIX + m_WorldName);
 
 	// Load the scoreboard
@@ -555,6 +561,7 @@ void cWorld::Start(void)
 	m_BroadcastAchievementMessages = IniFile.GetValueSetB("Broadcasting", "BroadcastAchievementMessages", true);
 
 	SetMaxViewDistance(IniFile.GetValueSetI("SpawnPosition", "MaxViewDistance", 12));
+	SetSimulationDistance(IniFile.GetValueSetI("SpawnPosition", "SimulationDistance", cClientHandle::MAX_VIEW_DISTANCE));
 
 	// Try to find the "SpawnPosition" key and coord values in the world configuration, set the flag if found
 	int KeyNum = IniFile.FindKey("SpawnPosition");
@@ -595,6 +602,7 @@ void cWorld::Start(void)
 	m_ShouldLavaSpawnFire         = IniFile.GetValueSetB("Physics",       "ShouldLavaSpawnFire",         true);
 	int TNTShrapnelLevel          = IniFile.GetValueSetI("Physics",       "TNTShrapnelLevel",            (int)slAll);
 	m_bCommandBlocksEnabled       = IniFile.GetValueSetB("Mechanics",     "CommandBlocksEnabled",        false);
+	m_MaxCommandBlocksPerTick     = IniFile.GetValueSetI("Mechanics",     "MaxCommandBlocksPerTick",     100);
 	m_bEnabledPVP                 = IniFile.GetValueSetB("Mechanics",     "PVPEnabled",                  true);
 	m_bUseChatPrefixes            = IniFile.GetValueSetB("Mechanics",     "UseChatPrefixes",             true);
 	m_VillagersShouldHarvestCrops = IniFile.GetValueSetB("Monsters",      "VillagersShouldHarvestCrops", true);
@@ -907,8 +915,10 @@ void cWorld::Tick(std::chrono::milliseconds a_Dt, std::chrono::milliseconds a_La
 
 	// Add players waiting in the queue to be added:
 	AddQueuedPlayers();
+	CollectTickPlayers();
 
 	m_ChunkMap->Tick(a_Dt);
+	TickQueuedCommandBlocks();
 
 	TickClients(static_cast<float>(a_Dt.count()));
 	TickQueuedBlocks();
@@ -921,6 +931,9 @@ void cWorld::Tick(std::chrono::milliseconds a_Dt, std::chrono::milliseconds a_La
 
 	m_ChunkMap->FastSetQueuedBlocks();
 
+	// Send the scores changed during this tick, each one only once:
+	m_Scoreboard.FlushScoreUpdates();
+
 	if (m_WorldAge - m_LastSave > std::chrono::minutes(5))  // Save each 5 minutes
 	{
 		SaveAllChunks();
@@ -1720,6 +1733,15 @@ EMCSBiome cWorld::GetBiomeAt (int a_BlockX, int a_BlockZ)
 
 
 
+int cWorld::GetHeightAt(int a_BlockX, int a_BlockZ)
+{
+	return m_ChunkMap->GetHeightAt(a_BlockX, a_BlockZ);
+}
+
+
+
+
+
 bool cWorld::SetBiomeAt(int a_BlockX, int a_BlockZ, EMCSBiome a_Biome)
 {
 	return m_ChunkMap->SetBiomeAt(a_BlockX, a_BlockZ, a_Biome);
@@ -2553,7 +2575,13 @@ void cWorld::ChunkLighted(
 	const cChunkDef::BlockNibbles & a_SkyLight
 )
 {
-	m_ChunkMap->ChunkLighted(a_ChunkX, a_ChunkZ, a_BlockLight, a_SkyLight);
+	UInt16 ChangedSections = m_ChunkMap->ChunkLighted(a_ChunkX, a_ChunkZ, a_BlockLight, a_SkyLight);
+
+	// Clients that have already received the chunk don't get the new light otherwise, resend only the changed sections to them:
+	if ((ChangedSections != 0) && m_ChunkMap->HasChunkAnyClients(a_ChunkX, a_ChunkZ))
+	{
+		m_ChunkSender.QueueSendChunkSections(a_ChunkX, a_ChunkZ, ChangedSections);
+	}
 }
 
 
@@ -2659,6 +2687,14 @@ void cWorld::RemovePlayer(cPlayer * a_Player, bool a_RemoveFromChunk)
 		cCSLock Lock(m_CSPlayers);
 		LOGD("Removing player %s from world \"%s\"", a_Player->GetName().c_str(), m_WorldName.c_str());
 		m_Players.remove(a_Player);
+		for (sTickPlayers::iterator itr = m_TickPlayers.begin(), end = m_TickPlayers.end(); itr != end; ++itr)
+		{
+			if (itr->m_Player == a_Player)
+			{
+				m_TickPlayers.erase(itr);
+				break;
+			}
+		}
 	}
 	
 	// Remove the player's client from the list of clients to be ticked:
@@ -2801,6 +2837,30 @@ cPlayer * cWorld::FindClosestPlayer(const Vector3d & a_Pos, float a_SightLimit,
 
 
 
+bool cWorld::ForEachTargetablePlayerInRange(const Vector3d & a_Position, double a_Range, cPlayerListCallback & a_Callback)
+{
+	ASSERT(m_TickThread.IsCurrentThread());
+
+	double RangeSq = a_Range * a_Range;
+	cCSLock Lock(m_CSPlayers);
+	for (sTickPlayers::const_iterator itr = m_TickPlayers.begin(), end = m_TickPlayers.end(); itr != end; ++itr)
+	{
+		if (itr->m_IsGameModeCreative || ((itr->m_Position - a_Position).SqrLength() > RangeSq))
+		{
+			continue;
+		}
+		if (a_Callback.Item(itr->m_Player))
+		{
+			return false;
+		}
+	}  // for itr - m_TickPlayers[]
+	return true;
+}
+
+
+
+
+
 void cWorld::SendPlayerList(cPlayer * a_DestPlayer)
 {
 	// Sends the playerlist to a_DestPlayer
@@ -2993,6 +3053,63 @@ bool cWorld::SetCommandBlockCommand(int a_BlockX, int a_BlockY, int a_BlockZ, co
 
 
 
+void cWorld::QueueCommandBlockExecution(int a_BlockX, int a_BlockY, int a_BlockZ)
+{
+	cCSLock Lock(m_CSCommandBlockQueue);
+	m_CommandBlockQueue.push_back(Vector3i(a_BlockX, a_BlockY, a_BlockZ));
+}
+
+
+
+
+
+void cWorld::TickQueuedCommandBlocks(void)
+{
+	// Take the oldest command blocks that fit into this tick's budget, the rest stays queued before any later activations:
+	std::vector<Vector3i> CommandBlocks;
+	{
+		cCSLock Lock(m_CSCommandBlockQueue);
+		size_t NumToExecute = m_CommandBlockQueue.size();
+		if ((m_MaxCommandBlocksPerTick > 0) && (NumToExecute > static_cast<size_t>(m_MaxCommandBlocksPerTick)))
+		{
+			NumToExecute = static_cast<size_t>(m_MaxCommandBlocksPerTick);
+			m_NumDeferredCommandBlocks += m_CommandBlockQueue.size() - NumToExecute;
+		}
+		CommandBlocks.assign(m_CommandBlockQueue.begin(), m_CommandBlockQueue.begin() + static_cast<std::deque<Vector3i>::difference_type>(NumToExecute));
+		m_CommandBlockQueue.erase(m_CommandBlockQueue.begin(), m_CommandBlockQueue.begin() + static_cast<std::deque<Vector3i>::difference_type>(NumToExecute));
+	}
+
+	class cExecuteCommandBlock :
+		public cCommandBlockCallback
+	{
+	public:
+		bool m_HasExecuted;
+
+		virtual bool Item(cCommandBlockEntity * a_CommandBlock) override
+		{
+			m_HasExecuted = a_CommandBlock->ExecuteQueued();
+			return false;
+		}
+	} ExecuteCommandBlock;
+	for (const auto & Pos : CommandBlocks)
+	{
+		// The command block may have been destroyed or unloaded since its activation, then there's nothing to execute:
+		ExecuteCommandBlock.m_HasExecuted = false;
+		DoWithCommandBlockAt(Pos.x, Pos.y, Pos.z, ExecuteCommandBlock);
+		if (ExecuteCommandBlock.m_HasExecuted)
+		{
+			// The command block's last output and result have changed, save them with the chunk:
+			int ChunkX, ChunkZ;
+			cChunkDef::BlockToChunk(Pos.x, Pos.z, ChunkX, ChunkZ);
+			m_ChunkMap->MarkChunkDirty(ChunkX, ChunkZ);
+		}
+	}
+}
+
+
+
+
+
 bool cWorld::IsTrapdoorOpen(int a_BlockX, int a_BlockY, int a_BlockZ)
 {
 	BLOCKTYPE Block;
@@ -3199,6 +3316,15 @@ void cWorld::GetChunkStats(int & a_NumValid, int & a_NumDirty, int & a_NumInLigh
 
 
 
+void cWorld::GetChunkTickStats(int & a_NumTicked, int & a_NumVisibleOnly)
+{
+	m_ChunkMap->GetChunkTickStats(a_NumTicked, a_NumVisibleOnly);
+}
+
+
+
+
+
 void cWorld::TickQueuedBlocks(void)
 {
 	if (m_BlockTickQueue.empty())
@@ -3550,6 +3676,27 @@ void cWorld::AddQueuedPlayers(void)
 
 
 
+void cWorld::CollectTickPlayers(void)
+{
+	ASSERT(m_TickThread.IsCurrentThread());
+
+	cCSLock Lock(m_CSPlayers);
+	m_TickPlayers.clear();
+	m_TickPlayers.reserve(m_Players.size());
+	for (cPlayerList::const_iterator itr = m_Players.begin(), end = m_Players.end(); itr != end; ++itr)
+	{
+		sTickPlayer Player;
+		Player.m_Player = *itr;
+		Player.m_Position = (*itr)->GetPosition();
+		Player.m_IsGameModeCreative = (*itr)->IsGameModeCreative();
+		m_TickPlayers.push_back(Player);
+	}  // for itr - m_Players[]
+}
+
+
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // cWorld::cTaskSaveAllChunks:
 
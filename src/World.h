@@ -323,6 +323,12 @@ public:
 	// TODO: This interface is dangerous - rewrite to DoWithClosestPlayer(pos, sight, action)
 	cPlayer * FindClosestPlayer(const Vector3d & a_Pos, float a_SightLimit, bool a_CheckLineOfSight = true);
 	
+	/** Calls the callback for each player that is not in creative gamemode and was within a_Range of a_Position at the start of this tick.
+	Walks the players collected once per tick, so that the mobs looking for a target needn't walk the entire player list each.
+	Returns true if all players processed, false if the callback aborted by returning true.
+	Assumes it is called from the Tick thread. */
+	bool ForEachTargetablePlayerInRange(const Vector3d & a_Position, double a_Range, cPlayerListCallback & a_Callback);
+	
 	/** Finds the player over his uuid and calls the callback */
 	bool DoWithPlayerByUUID(const AString & a_PlayerUUID, cPlayerListCallback & a_Callback);  // >> EXPORTED IN MANUALBINDINGS <<
 
@@ -389,6 +395,11 @@ public:
 	/** Sets the command block command. Returns true if command changed. */
 	bool SetCommandBlockCommand(int a_BlockX, int a_BlockY, int a_BlockZ, const AString & a_Command);  // tolua_export
 
+	/** Queues the command block at the specified coords for execution, called when the command block is activated.
+	The queue is processed in the order of activation, at most m_MaxCommandBlocksPerTick command blocks in each tick;
+	the rest stay at the front of the queue for the next tick, so that every activated command block gets its turn. */
+	void QueueCommandBlockExecution(int a_BlockX, int a_BlockY, int a_BlockZ);
+
 	/** Is the trapdoor open? Returns false if there is no trapdoor at the specified coords. */
 	bool IsTrapdoorOpen(int a_BlockX, int a_BlockY, int a_BlockZ);                                      // tolua_export
 
@@ -626,6 +637,11 @@ public:
 	/** Returns the biome at the specified coords. Reads the biome from the chunk, if loaded, otherwise uses the world generator to provide the biome value */
 	EMCSBiome GetBiomeAt(int a_BlockX, int a_BlockZ);
 	
+	/** Returns the world height at the specified coords. Reads the height from the chunk, if loaded, otherwise uses the world generator
+	to provide the terrain height, without generating the whole chunk; that height doesn't include the finishers (trees, structures)
+	nor the plugins' changes. Doesn't load the chunk and doesn't wait for it. */
+	int GetHeightAt(int a_BlockX, int a_BlockZ);
+	
 	/** Sets the biome at the specified coords. Returns true if successful, false if not (chunk not loaded).
 	Doesn't resend the chunk to clients, use ForceSendChunkTo() for that. */
 	bool SetBiomeAt(int a_BlockX, int a_BlockZ, EMCSBiome a_Biome);
@@ -654,6 +670,13 @@ public:
 	bool AreCommandBlocksEnabled(void) const { return m_bCommandBlocksEnabled; }
 	void SetCommandBlocksEnabled(bool a_Flag) { m_bCommandBlocksEnabled = a_Flag; }
 
+	/** Returns the max number of command blocks executed in a single tick, the rest is deferred to the next ticks. 0 means unlimited. */
+	int GetMaxCommandBlocksPerTick(void) const { return m_MaxCommandBlocksPerTick; }
+	void SetMaxCommandBlocksPerTick(int a_MaxCommandBlocksPerTick) { m_MaxCommandBlocksPerTick = a_MaxCommandBlocksPerTick; }
+
+	/** Returns the number of times a command block execution has been deferred to the next tick because of the per-tick limit. */
+	size_t GetNumDeferredCommandBlocks(void) const { return m_NumDeferredCommandBlocks; }
+
 	eShrapnelLevel GetTNTShrapnelLevel(void) const { return m_TNTShrapnelLevel; }
 	void SetTNTShrapnelLevel(eShrapnelLevel a_Flag) { m_TNTShrapnelLevel = a_Flag; }
 
@@ -663,6 +686,18 @@ public:
 		m_MaxViewDistance = Clamp(a_MaxViewDistance, cClientHandle::MIN_VIEW_DISTANCE, cClientHandle::MAX_VIEW_DISTANCE);
 	}
 
+	/** Returns the distance (in chunks) from players within which the chunks are ticked.
+	Chunks further away, but still within the players' view distance, are sent to the clients but not ticked.
+	Configured by the [SpawnPosition].SimulationDistance value in world.ini, defaults to the maximum view distance. */
+	int GetSimulationDistance(void) const { return m_SimulationDistance; }
+
+	/** Sets the distance (in chunks) from players within which the chunks are ticked, clamped to the valid view distance range.
+	Takes effect on the next tick; doesn't change world.ini. Exported to Lua, see APIDesc.lua. */
+	void SetSimulationDistance(int a_SimulationDistance)
+	{
+		m_SimulationDistance = Clamp(a_SimulationDistance, cClientHandle::MIN_VIEW_DISTANCE, cClientHandle::MAX_VIEW_DISTANCE);
+	}
+
 	bool ShouldUseChatPrefixes(void) const { return m_bUseChatPrefixes; }
 	void SetShouldUseChatPrefixes(bool a_Flag) { m_bUseChatPrefixes = a_Flag; }
 
@@ -700,12 +735,24 @@ public:
 	/** Returns the number of chunks loaded and dirty, and in the lighting queue */
 	void GetChunkStats(int & a_NumValid, int & a_NumDirty, int & a_NumInLightingQueue);
 
+	/** Returns the number of chunks ticked in the last tick, and the number of chunks that were skipped
+	despite having clients, because they were outside the simulation distance. */
+	void GetChunkTickStats(int & a_NumTicked, int & a_NumVisibleOnly);
+
 	// Various queues length queries (cannot be const, they lock their CS):
 	inline int GetGeneratorQueueLength     (void) { return m_Generator.GetQueueLength();   }    // tolua_export
 	inline size_t GetLightingQueueLength   (void) { return m_Lighting.GetQueueLength();    }    // tolua_export
 	inline size_t GetStorageLoadQueueLength(void) { return m_Storage.GetLoadQueueLength(); }    // tolua_export
 	inline size_t GetStorageSaveQueueLength(void) { return m_Storage.GetSaveQueueLength(); }    // tolua_export
 
+	/** Starts an online backup of the saved chunks into the specified folder, the chunks keep being saved meanwhile.
+	Only the chunks already saved are included, use QueueSaveAllChunks() beforehand to include the recent changes.
+	Returns false if the backup cannot be started (another one is still running, or the storage doesn't support it). */
+	bool StartBackup(const AString & a_DestFolder) { return m_Storage.StartBackup(a_DestFolder); }  // tolua_export
+
+	/** Returns the progress and the throughput of the running or the last finished backup. */
+	AString GetBackupStatus(void) { return m_Storage.GetBackupStatus(); }  // tolua_export
+
 	cLightingThread & GetLightingThread(void) { return m_Lighting; }
 
 	void InitializeSpawn(void);
@@ -939,9 +986,22 @@ private:
 	std::unique_ptr<cFireSimulator>      m_FireSimulator;
 	cRedstoneSimulator * m_RedstoneSimulator;
 	
+	/** A player's state as collected at the start of the tick, for the mobs looking for a target. */
+	struct sTickPlayer
+	{
+		cPlayer * m_Player;
+		Vector3d m_Position;
+		bool m_IsGameModeCreative;
+	};
+	typedef std::vector<sTickPlayer> sTickPlayers;
+
 	cCriticalSection m_CSPlayers;
 	cPlayerList      m_Players;
 
+	/** The players in m_Players, as they were at the start of the current tick. Protected by m_CSPlayers.
+	A player is removed from here as soon as it is removed from the world, so the pointers are valid while m_CSPlayers is held. */
+	sTickPlayers m_TickPlayers;
+
 	cWorldStorage     m_Storage;
 	
 	unsigned int m_MaxPlayers;
@@ -970,6 +1030,12 @@ private:
 
 	/** Whether command blocks are enabled or not */
 	bool m_bCommandBlocksEnabled;
+
+	/** The max number of command blocks executed in a single tick; 0 = unlimited */
+	int m_MaxCommandBlocksPerTick;
+
+	/** Number of command block executions deferred to the next tick because of m_MaxCommandBlocksPerTick */
+	size_t m_NumDeferredCommandBlocks;
 	
 	/** Whether prefixes such as [INFO] are prepended to SendMessageXXX() / BroadcastChatXXX() functions */
 	bool m_bUseChatPrefixes;
@@ -982,6 +1048,9 @@ private:
 	/** The maximum view distance that a player can have in this world. */
 	int m_MaxViewDistance;
 
+	/** The distance from players within which the chunks are ticked. */
+	int m_SimulationDistance;
+
 	/** Name of the nether world */
 	AString m_NetherWorldName;
 
@@ -1039,6 +1108,12 @@ private:
 	/** List of players that are scheduled for adding, waiting for the Tick thread to add them. */
 	cPlayerList m_PlayersToAdd;
 	
+	/** Guards m_CommandBlockQueue */
+	cCriticalSection m_CSCommandBlockQueue;
+
+	/** Coords of the activated command blocks waiting for their execution, in the order of activation. Protected by m_CSCommandBlockQueue */
+	std::deque<Vector3i> m_CommandBlockQueue;
+	
 	/** CS protecting m_SetChunkDataQueue. */
 	cCriticalSection m_CSSetChunkDataQueue;
 	
@@ -1059,6 +1134,9 @@ private:
 	
 	/** Executes all tasks queued onto the tick thread */
 	void TickQueuedTasks(void);
+
+	/** Executes the queued command blocks, up to m_MaxCommandBlocksPerTick of them */
+	void TickQueuedCommandBlocks(void);
 	
 	/** Executes all tasks queued onto the tick thread */
 	void TickScheduledTasks(void);
@@ -1087,6 +1165,10 @@ private:
 	Assumes it is called from the Tick thread. */
 	void AddQueuedPlayers(void);
 
+	/** Fills m_TickPlayers with the current state of the players in m_Players.
+	Assumes it is called from the Tick thread. */
+	void CollectTickPlayers(void);
+
 	/** Sets generator values to dimension specific defaults, if those values do not exist */
 	void InitialiseGeneratorDefaults(cIniFile & a_IniFile);
 
@@ -341,7 +341,10 @@ int cParsedNBT::FindTagByPath(int a_Tag, const AString & a_Path) const
 // cFastNBTWriter:
 
 cFastNBTWriter::cFastNBTWriter(const AString & a_RootTagName) :
-	m_CurrentStack(0)
+	m_CurrentStack(0),
+	m_Sink(nullptr),
+	m_FlushThreshold(0),
+	m_FlushedSize(0)
 {
 	m_Stack[0].m_Type = TAG_Compound;
 	m_Result.reserve(100 * 1024);
@@ -353,6 +356,22 @@ cFastNBTWriter::cFastNBTWriter(const AString & a_RootTagName) :
 
 
 
+cFastNBTWriter::cFastNBTWriter(cSink & a_Sink, size_t a_FlushThreshold, const AString & a_RootTagName) :
+	m_CurrentStack(0),
+	m_Sink(&a_Sink),
+	m_FlushThreshold(a_FlushThreshold),
+	m_FlushedSize(0)
+{
+	m_Stack[0].m_Type = TAG_Compound;
+	m_Result.reserve(a_FlushThreshold + 16 * 1024);  // A bit of headroom, flushing happens only after adding whole tags
+	m_Result.push_back(TAG_Compound);
+	WriteString(a_RootTagName.data(), (UInt16)a_RootTagName.size());
+}
+
+
+
+
+
 void cFastNBTWriter::BeginCompound(const AString & a_Name)
 {
 	if (m_CurrentStack >= MAX_STACK - 1)
@@ -378,6 +397,20 @@ void cFastNBTWriter::EndCompound(void)
 	
 	m_Result.push_back(TAG_End);
 	--m_CurrentStack;
+	MaybeFlush();
+}
+
+
+
+
+
+void cFastNBTWriter::AddRawCompound(const AString & a_Name, const AString & a_Contents)
+{
+	ASSERT(!a_Contents.empty() && (a_Contents.back() == TAG_End));
+	
+	TagCommon(a_Name, TAG_Compound);
+	m_Result.append(a_Contents);
+	MaybeFlush();
 }
 
 
@@ -408,15 +441,51 @@ void cFastNBTWriter::BeginList(const AString & a_Name, eTagType a_ChildrenType)
 
 
 
+void cFastNBTWriter::BeginList(const AString & a_Name, eTagType a_ChildrenType, int a_Count)
+{
+	if (m_CurrentStack >= MAX_STACK - 1)
+	{
+		ASSERT(!"Stack overflow");
+		return;
+	}
+	
+	TagCommon(a_Name, TAG_List);
+	
+	// Write the count right away, there will be nothing to update later:
+	m_Result.push_back((char)a_ChildrenType);
+	char Count[4];
+	SetBEInt(Count, a_Count);
+	m_Result.append(Count, 4);
+	
+	++m_CurrentStack;
+	m_Stack[m_CurrentStack].m_Type     = TAG_List;
+	m_Stack[m_CurrentStack].m_Pos      = -1;
+	m_Stack[m_CurrentStack].m_Count    = -a_Count;  // Counts up to zero, checked in EndList()
+	m_Stack[m_CurrentStack].m_ItemType = a_ChildrenType;
+}
+
+
+
+
+
 void cFastNBTWriter::EndList(void)
 {
 	ASSERT(m_CurrentStack > 0);
 	ASSERT(m_Stack[m_CurrentStack].m_Type == TAG_List);
 	
-	// Update the list count:
-	SetBEInt(const_cast<char *>(m_Result.c_str() + m_Stack[m_CurrentStack].m_Pos), m_Stack[m_CurrentStack].m_Count);
+	if (m_Stack[m_CurrentStack].m_Pos < 0)
+	{
+		// The count was known beforehand, check that it was right:
+		ASSERT(m_Stack[m_CurrentStack].m_Count == 0);
+	}
+	else
+	{
+		// Update the list count:
+		SetBEInt(const_cast<char *>(m_Result.c_str() + m_Stack[m_CurrentStack].m_Pos), m_Stack[m_CurrentStack].m_Count);
+	}
 
 	--m_CurrentStack;
+	MaybeFlush();
 }
 
 
@@ -506,6 +575,7 @@ void cFastNBTWriter::AddByteArray(const AString & a_Name, const char * a_Value,
 	u_long len = htonl(static_cast<u_long>(a_NumElements));
 	m_Result.append(reinterpret_cast<const char *>(&len), 4);
 	m_Result.append(a_Value, a_NumElements);
+	MaybeFlush();
 }
 
 
@@ -528,6 +598,7 @@ void cFastNBTWriter::AddIntArray(const AString & a_Name, const int * a_Value, si
 		UInt32 Element = htonl(a_Value[i]);
 		m_Result.append(reinterpret_cast<const char *>(&Element), 4);
 	}
+	MaybeFlush();
 }
 
 
@@ -538,6 +609,10 @@ void cFastNBTWriter::Finish(void)
 {
 	ASSERT(m_CurrentStack == 0);
 	m_Result.push_back(TAG_End);
+	if (m_Sink != nullptr)
+	{
+		Flush();
+	}
 }
 
 
@@ -554,3 +629,40 @@ void cFastNBTWriter::WriteString(const char * a_Data, UInt16 a_Length)
 
 
 
+
+void cFastNBTWriter::Flush(void)
+{
+	ASSERT(m_Sink != nullptr);
+
+	// Everything up to the count of the outermost list with an unknown count can no longer change:
+	size_t FlushSize = m_Result.size();
+	for (int i = 1; i <= m_CurrentStack; i++)
+	{
+		if ((m_Stack[i].m_Type == TAG_List) && (m_Stack[i].m_Pos >= 0))
+		{
+			FlushSize = static_cast<size_t>(m_Stack[i].m_Pos);
+			break;
+		}
+	}
+	if (FlushSize == 0)
+	{
+		return;
+	}
+
+	m_Sink->Write(m_Result.data(), FlushSize);
+	m_Result.erase(0, FlushSize);
+	m_FlushedSize += FlushSize;
+
+	// Rebase the positions of the list counts still to be updated:
+	for (int i = 1; i <= m_CurrentStack; i++)
+	{
+		if ((m_Stack[i].m_Type == TAG_List) && (m_Stack[i].m_Pos >= 0))
+		{
+			m_Stack[i].m_Pos -= static_cast<int>(FlushSize);
+		}
+	}
+}
+
+
+
+
@@ -276,12 +276,33 @@ protected:
 class cFastNBTWriter
 {
 public:
+	/** Interface for receiving the serialized NBT data in pieces, as it is written. */
+	class cSink
+	{
+	public:
+		virtual ~cSink() {}
+
+		/** Called with each piece of the serialized data, in order. */
+		virtual void Write(const char * a_Data, size_t a_Size) = 0;
+	} ;
+
+
 	cFastNBTWriter(const AString & a_RootTagName = "");
+
+	/** Creates a writer that passes the serialized data to a_Sink whenever more than a_FlushThreshold bytes are buffered.
+	Only the data that can no longer change is passed on; lists with an unknown count stay buffered until they are ended.
+	GetResult() then returns only the data not yet passed on; Finish() passes on everything. */
+	cFastNBTWriter(cSink & a_Sink, size_t a_FlushThreshold, const AString & a_RootTagName = "");
 	
 	void BeginCompound(const AString & a_Name);
 	void EndCompound(void);
 	
 	void BeginList(const AString & a_Name, eTagType a_ChildrenType);
+
+	/** Begins a list whose item count is known beforehand. Unlike lists with an unknown count,
+	the items of such a list can be passed to the sink before the list is ended. */
+	void BeginList(const AString & a_Name, eTagType a_ChildrenType, int a_Count);
+
 	void EndList(void);
 	
 	void AddByte     (const AString & a_Name, unsigned char a_Value);
@@ -299,7 +320,22 @@ public:
 		AddByteArray(a_Name, a_Value.data(), a_Value.size());
 	}
 	
+	/** Adds a compound whose contents (the child tags, including the terminating TAG_End) have already been serialized.
+	Used for re-inserting cached NBT without re-encoding it. */
+	void AddRawCompound(const AString & a_Name, const AString & a_Contents);
+	
 	const AString & GetResult(void) const {return m_Result; }
+
+	/** Returns the total number of bytes written so far, including those already passed to the sink. */
+	size_t GetPos(void) const { return m_FlushedSize + m_Result.size(); }
+
+	/** Returns the data written since the specified position (obtained by GetPos()).
+	The data must not have been passed to the sink yet, which is guaranteed inside a list with an unknown count. */
+	AString GetDataSince(size_t a_Pos) const
+	{
+		ASSERT(a_Pos >= m_FlushedSize);
+		return m_Result.substr(a_Pos - m_FlushedSize);
+	}
 	
 	void Finish(void);
 	
@@ -308,7 +344,7 @@ protected:
 	struct sParent
 	{
 		int m_Type;   // TAG_Compound or TAG_List
-		int m_Pos;    // for TAG_List, the position of the list count
+		int m_Pos;    // for TAG_List, the position of the list count in m_Result; -1 if the count was known beforehand
 		int m_Count;  // for TAG_List, the element count
 		eTagType m_ItemType;  // for TAG_List, the element type
 	} ;
@@ -320,10 +356,31 @@ protected:
 	int     m_CurrentStack;
 	
 	AString m_Result;
+
+	/** The sink receiving the data; nullptr if all the data is kept in m_Result */
+	cSink * m_Sink;
+
+	/** The size of m_Result above which the data is passed to m_Sink */
+	size_t m_FlushThreshold;
+
+	/** The number of bytes already passed to m_Sink */
+	size_t m_FlushedSize;
 	
 	bool IsStackTopCompound(void) const { return (m_Stack[m_CurrentStack].m_Type == TAG_Compound); }
 	
 	void WriteString(const char * a_Data, UInt16 a_Length);
+
+	/** If there's a sink and m_Result is over the threshold, passes the data that can no longer change to the sink. */
+	void MaybeFlush(void)
+	{
+		if ((m_Sink != nullptr) && (m_Result.size() > m_FlushThreshold))
+		{
+			Flush();
+		}
+	}
+
+	/** Passes the data that can no longer change to the sink. */
+	void Flush(void);
 	
 	inline void TagCommon(const AString & a_Name, eTagType a_Type)
 	{
@@ -918,6 +918,17 @@ void cNBTChunkSerializer::BlockEntity(cBlockEntity * a_Entity)
 	}
 	m_IsTagOpen = true;
 
+	// If the block entity hasn't changed since it was last saved, reuse its NBT:
+	AString CachedNBT;
+	if (a_Entity->GetCachedNBT(cBlockEntity::nbtSave, CachedNBT))
+	{
+		m_Writer.AddRawCompound("", CachedNBT);
+		m_HasHadBlockEntity = true;
+		return;
+	}
+	int CacheGeneration = a_Entity->GetNBTCacheGeneration();
+	size_t StartPos = m_Writer.GetPos();
+
 	// Add tile-entity into NBT:
 	switch (a_Entity->GetBlockType())
 	{
@@ -944,6 +955,12 @@ void cNBTChunkSerializer::BlockEntity(cBlockEntity * a_Entity)
 			ASSERT(!"Unhandled block entity saved into Anvil");
 		}
 	}
+
+	// Cache the newly written NBT. Inside the TileEntities list, the compound has no tag header, only its contents:
+	if (m_Writer.GetPos() > StartPos)
+	{
+		a_Entity->SetCachedNBT(cBlockEntity::nbtSave, m_Writer.GetDataSince(StartPos), CacheGeneration);
+	}
 	m_HasHadBlockEntity = true;
 }
 
@@ -0,0 +1,194 @@
+
+// StorageBackup.cpp
+
+// Implements the cStorageBackup class representing a thread that copies a snapshot of the world storage files into a backup folder
+
+#include "Globals.h"
+#include "StorageBackup.h"
+
+
+
+
+
+/** Number of bytes read from the snapshot at once.
+The schema may be locked for each read, so this shouldn't be too large. */
+static const int BACKUP_BLOCK_SIZE = 64 * 1024;
+
+
+
+
+
+cStorageBackup::cStorageBackup(cWSSchema & a_Schema, const AString & a_DestFolder) :
+	super("cStorageBackup"),
+	m_Schema(a_Schema),
+	m_DestFolder(a_DestFolder),
+	m_IsRunning(true),
+	m_HasFailed(false),
+	m_NumFiles(0),
+	m_NumFilesDone(0),
+	m_NumBytes(0),
+	m_NumBytesDone(0),
+	m_StartTime(std::chrono::steady_clock::now()),
+	m_EndTime(m_StartTime)
+{
+}
+
+
+
+
+
+cStorageBackup::~cStorageBackup()
+{
+	// Stop the thread here, while the descendant's members still exist:
+	Stop();
+}
+
+
+
+
+
+bool cStorageBackup::IsRunning(void)
+{
+	cCSLock Lock(m_CS);
+	return m_IsRunning;
+}
+
+
+
+
+
+AString cStorageBackup::GetStatus(void)
+{
+	cCSLock Lock(m_CS);
+	double Elapsed = GetElapsedSeconds();
+	double MiBDone = static_cast<double>(m_NumBytesDone) / (1024 * 1024);
+	const char * State = m_IsRunning ? "running" : (m_HasFailed ? "failed" : "finished");
+	return Printf("Backup into \"%s\" %s: " SIZE_T_FMT " / " SIZE_T_FMT " files, %.1f / %.1f MiB in %.1f sec (%.1f MiB/s)",
+		m_DestFolder.c_str(), State,
+		m_NumFilesDone, m_NumFiles,
+		MiBDone, static_cast<double>(m_NumBytes) / (1024 * 1024),
+		Elapsed, (Elapsed > 0) ? MiBDone / Elapsed : 0.0
+	);
+}
+
+
+
+
+
+void cStorageBackup::Execute(void)
+{
+	cWSSchema::sSnapshotFiles Files;
+	bool IsSuccess = false;
+	if (m_Schema.BeginSnapshot(Files))
+	{
+		{
+			cCSLock Lock(m_CS);
+			m_NumFiles = Files.size();
+			for (cWSSchema::sSnapshotFiles::const_iterator itr = Files.begin(), end = Files.end(); itr != end; ++itr)
+			{
+				m_NumBytes += itr->m_Size;
+			}
+			m_StartTime = std::chrono::steady_clock::now();
+		}
+		IsSuccess = CopyFiles(Files);
+		m_Schema.EndSnapshot();
+	}
+	else
+	{
+		LOGWARNING("Cannot back up into \"%s\": the storage schema \"%s\" cannot take a snapshot now.", m_DestFolder.c_str(), m_Schema.GetName().c_str());
+	}
+
+	{
+		cCSLock Lock(m_CS);
+		m_IsRunning = false;
+		m_HasFailed = !IsSuccess;
+		m_EndTime = std::chrono::steady_clock::now();
+	}
+	LOG("%s", GetStatus().c_str());
+}
+
+
+
+
+
+bool cStorageBackup::CopyFiles(const cWSSchema::sSnapshotFiles & a_Files)
+{
+	for (cWSSchema::sSnapshotFiles::const_iterator itr = a_Files.begin(), end = a_Files.end(); itr != end; ++itr)
+	{
+		if (!CopySnapshotFile(*itr))
+		{
+			return false;
+		}
+		cCSLock Lock(m_CS);
+		m_NumFilesDone += 1;
+	}
+	return true;
+}
+
+
+
+
+
+bool cStorageBackup::CopySnapshotFile(const cWSSchema::sSnapshotFile & a_File)
+{
+	AString DestFileName = m_DestFolder + cFile::PathSeparator + a_File.m_FileName;
+	CreateFolders(DestFileName);
+	cFile Dest;
+	if (!Dest.Open(DestFileName, cFile::fmWrite))
+	{
+		LOGWARNING("Cannot back up file \"%s\", opening \"%s\" for writing failed", a_File.m_FileName.c_str(), DestFileName.c_str());
+		return false;
+	}
+
+	AString Buffer;
+	Buffer.resize(BACKUP_BLOCK_SIZE);
+	for (int Offset = 0; Offset < a_File.m_Size; Offset += BACKUP_BLOCK_SIZE)
+	{
+		if (m_ShouldTerminate)
+		{
+			LOGWARNING("Backup into \"%s\" aborted", m_DestFolder.c_str());
+			return false;
+		}
+		int Size = std::min(BACKUP_BLOCK_SIZE, a_File.m_Size - Offset);
+		if (!m_Schema.ReadSnapshot(a_File.m_FileName, Offset, &Buffer[0], Size))
+		{
+			LOGWARNING("Cannot back up file \"%s\", reading at offset %d failed", a_File.m_FileName.c_str(), Offset);
+			return false;
+		}
+		if (Dest.Write(Buffer.data(), static_cast<size_t>(Size)) != Size)
+		{
+			LOGWARNING("Cannot back up file \"%s\", writing into \"%s\" failed", a_File.m_FileName.c_str(), DestFileName.c_str());
+			return false;
+		}
+		cCSLock Lock(m_CS);
+		m_NumBytesDone += Size;
+	}
+	return true;
+}
+
+
+
+
+
+void cStorageBackup::CreateFolders(const AString & a_FileName)
+{
+	for (size_t Pos = a_FileName.find_first_of("/\\", 1); Pos != AString::npos; Pos = a_FileName.find_first_of("/\\", Pos + 1))
+	{
+		cFile::CreateFolder(a_FileName.substr(0, Pos));
+	}
+}
+
+
+
+
+
+double cStorageBackup::GetElapsedSeconds(void) const
+{
+	// ASSUME m_CS is locked
+	std::chrono::steady_clock::time_point End = m_IsRunning ? std::chrono::steady_clock::now() : m_EndTime;
+	return std::chrono::duration_cast<std::chrono::duration<double>>(End - m_StartTime).count();
+}
+
+
+
+
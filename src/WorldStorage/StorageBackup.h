@@ -0,0 +1,104 @@
+
+// StorageBackup.h
+
+// Declares the cStorageBackup class representing a thread that copies a snapshot of the world storage files into a backup folder
+
+/*
+The backup doesn't need the world saving to be turned off. When started, it asks the save schema for a snapshot
+(cWSSchema::BeginSnapshot()); the schema briefly locks out the saving, records the files' current state and
+from then on saves the chunks only into space that the snapshot doesn't use. The backup thread then reads the
+snapshotted data through the schema (cWSSchema::ReadSnapshot()) at its own pace and writes it into the backup
+folder. When all the files are copied (or the backup is aborted), the snapshot is ended and the schema may
+reuse the space again.
+
+The resulting files are regular storage files, restoring the backup means copying them back while the server is stopped.
+*/
+
+
+
+
+
+#pragma once
+
+#include "WorldStorage.h"
+#include <chrono>
+
+
+
+
+
+class cStorageBackup :
+	public cIsThread
+{
+	typedef cIsThread super;
+
+public:
+
+	/** Creates a backup that copies the snapshot of a_Schema's files into a_DestFolder.
+	The backup doesn't start until Start() is called. */
+	cStorageBackup(cWSSchema & a_Schema, const AString & a_DestFolder);
+
+	/** Aborts the backup, if still running, and waits for the thread to finish. */
+	virtual ~cStorageBackup();
+
+	/** Returns true while the backup thread is copying the files. */
+	bool IsRunning(void);
+
+	/** Returns a human-readable status of the backup, including the throughput. */
+	AString GetStatus(void);
+
+protected:
+
+	/** The schema whose files are being backed up */
+	cWSSchema & m_Schema;
+
+	/** The folder into which the files are copied */
+	AString m_DestFolder;
+
+	/** Protects the progress members below against multithreaded access */
+	cCriticalSection m_CS;
+
+	/** True until the thread finishes copying (or gives up) */
+	bool m_IsRunning;
+
+	/** True if the backup has failed or has been aborted */
+	bool m_HasFailed;
+
+	/** Number of files in the snapshot */
+	size_t m_NumFiles;
+
+	/** Number of files already copied */
+	size_t m_NumFilesDone;
+
+	/** Total number of bytes in the snapshot */
+	Int64 m_NumBytes;
+
+	/** Number of bytes already copied */
+	Int64 m_NumBytesDone;
+
+	/** When the copying started */
+	std::chrono::steady_clock::time_point m_StartTime;
+
+	/** When the copying finished; only valid once m_IsRunning is false */
+	std::chrono::steady_clock::time_point m_EndTime;
+
+
+	// cIsThread overrides:
+	virtual void Execute(void) override;
+
+	/** Copies all the snapshotted files. Returns false on failure or when aborted. */
+	bool CopyFiles(const cWSSchema::sSnapshotFiles & a_Files);
+
+	/** Copies a single snapshotted file into the backup folder. Returns false on failure or when aborted. */
+	bool CopySnapshotFile(const cWSSchema::sSnapshotFile & a_File);
+
+	/** Creates all the folders on the path to the specified file. */
+	static void CreateFolders(const AString & a_FileName);
+
+	/** Returns the number of seconds the copying has taken so far; assumes m_CS is locked. */
+	double GetElapsedSeconds(void) const;
+} ;
+
+
+
+
@@ -68,6 +68,9 @@ Since only the header is actually in the memory, this number can be high, but st
 */
 #define MAX_MCA_FILES 32
 
+/** Amount of the uncompressed NBT data buffered while saving a chunk, before it is passed on to the compressor. */
+#define NBT_FLUSH_THRESHOLD (64 KiB)
+
 #define LOAD_FAILED(CHX, CHZ) \
 	{ \
 		const int RegionX = FAST_FLOOR_DIV(CHX, 32); \
@@ -90,6 +93,7 @@ Since only the header is actually in the memory, this number can be high, but st
 
 cWSSAnvil::cWSSAnvil(cWorld * a_World, int a_CompressionFactor) :
 	super(a_World),
+	m_IsSnapshotActive(false),
 	m_CompressionFactor(a_CompressionFactor)
 {
 	// Create a level.dat file for mapping tools, if it doesn't already exist:
@@ -152,6 +156,132 @@ cWSSAnvil::~cWSSAnvil()
 
 
 
+bool cWSSAnvil::BeginSnapshot(sSnapshotFiles & a_Files)
+{
+	{
+		cCSLock Lock(m_CS);
+		if (m_IsSnapshotActive)
+		{
+			return false;
+		}
+		// Mark the snapshot active right away, so that LoadMCAFile() protects each region as soon as it is added below:
+		m_IsSnapshotActive = true;
+	}
+
+	// List the folder without holding the CS, the storage thread may keep saving meanwhile:
+	AString RegionFolder;
+	Printf(RegionFolder, "%s/region", m_World->GetName().c_str());
+	AStringVector Contents = cFile::GetFolderContents(RegionFolder);
+	for (AStringVector::const_iterator itr = Contents.begin(), end = Contents.end(); itr != end; ++itr)
+	{
+		sSnapshotRegion Region;
+		if ((sscanf(itr->c_str(), "r.%d.%d.mca", &Region.m_RegionX, &Region.m_RegionZ) != 2) || (*itr != Printf("r.%d.%d.mca", Region.m_RegionX, Region.m_RegionZ)))
+		{
+			// Not a region file
+			continue;
+		}
+		AString FileName = RegionFolder + "/" + *itr;
+
+		// Each file is snapshotted under the CS separately, so that its header and size match and no save interleaves:
+		cCSLock Lock(m_CS);
+		int FileSize = 0;
+		bool IsSnapshotValid;
+		cMCAFile * File = FindCachedMCAFile(Region.m_RegionX, Region.m_RegionZ);
+		if (File != nullptr)
+		{
+			IsSnapshotValid = File->GetSnapshot(Region.m_Header, FileSize);
+		}
+		else
+		{
+			// Not cached, read the header without putting the file into the cache, it would evict the files being used by the saving:
+			cMCAFile Uncached(FileName, Region.m_RegionX, Region.m_RegionZ);
+			IsSnapshotValid = Uncached.GetSnapshot(Region.m_Header, FileSize);
+		}
+		if (!IsSnapshotValid)
+		{
+			LOGWARNING("Cannot include region file \"%s\" in the backup, it cannot be opened", FileName.c_str());
+			continue;
+		}
+		Region.m_ProtectedSectors = static_cast<unsigned>((FileSize + 4095) / 4096);
+		if (File != nullptr)
+		{
+			File->SetProtectedSectors(Region.m_ProtectedSectors);
+		}
+
+		sSnapshotFile SnapshotFile;
+		SnapshotFile.m_FileName = FileName;
+		SnapshotFile.m_Size = FileSize;
+		a_Files.push_back(SnapshotFile);
+		m_SnapshotRegions[FileName] = Region;
+	}
+
+	return true;
+}
+
+
+
+
+
+bool cWSSAnvil::ReadSnapshot(const AString & a_FileName, int a_Offset, char * a_Buffer, int a_Size)
+{
+	if ((a_Offset < 0) || (a_Size < 0))
+	{
+		return false;
+	}
+
+	// The header is being rewritten with each saved chunk, use the copy taken with the snapshot:
+	{
+		cCSLock Lock(m_CS);
+		ASSERT(m_IsSnapshotActive);
+		sSnapshotRegions::const_iterator itr = m_SnapshotRegions.find(a_FileName);
+		if (itr == m_SnapshotRegions.end())
+		{
+			return false;
+		}
+		const AString & Header = itr->second.m_Header;
+		int HeaderSize = static_cast<int>(Header.size());
+		if (a_Offset < HeaderSize)
+		{
+			int Size = std::min(a_Size, HeaderSize - a_Offset);
+			memcpy(a_Buffer, Header.data() + a_Offset, static_cast<size_t>(Size));
+			a_Offset += Size;
+			a_Buffer += Size;
+			a_Size -= Size;
+			if (a_Size == 0)
+			{
+				return true;
+			}
+		}
+	}
+
+	// The rest of the snapshot is protected from overwriting, read it through a separate handle, without the CS and the MCA file cache:
+	cFile File;
+	if (!File.Open(a_FileName, cFile::fmRead) || (File.Seek(a_Offset) < 0))
+	{
+		return false;
+	}
+	return (File.Read(a_Buffer, static_cast<size_t>(a_Size)) == a_Size);
+}
+
+
+
+
+
+void cWSSAnvil::EndSnapshot(void)
+{
+	cCSLock Lock(m_CS);
+	for (cMCAFiles::iterator itr = m_Files.begin(); itr != m_Files.end(); ++itr)
+	{
+		(*itr)->SetProtectedSectors(0);
+	}
+	m_SnapshotRegions.clear();
+	m_IsSnapshotActive = false;
+}
+
+
+
+
+
 bool cWSSAnvil::LoadChunk(const cChunkCoords & a_Chunk)
 {
 	AString ChunkData;
@@ -220,6 +350,25 @@ bool cWSSAnvil::SetChunkData(const cChunkCoords & a_Chunk, const AString & a_Dat
 
 
 
+cWSSAnvil::cMCAFile * cWSSAnvil::FindCachedMCAFile(int a_RegionX, int a_RegionZ)
+{
+	// ASSUME m_CS is locked
+	ASSERT(m_CS.IsLocked());
+
+	for (cMCAFiles::const_iterator itr = m_Files.begin(), end = m_Files.end(); itr != end; ++itr)
+	{
+		if (((*itr) != nullptr) && ((*itr)->GetRegionX() == a_RegionX) && ((*itr)->GetRegionZ() == a_RegionZ))
+		{
+			return *itr;
+		}
+	}
+	return nullptr;
+}
+
+
+
+
+
 cWSSAnvil::cMCAFile * cWSSAnvil::LoadMCAFile(const cChunkCoords & a_Chunk)
 {
 	// ASSUME m_CS is locked
@@ -260,6 +409,16 @@ cWSSAnvil::cMCAFile * cWSSAnvil::LoadMCAFile(const cChunkCoords & a_Chunk)
 	}
 	m_Files.push_front(f);
 	
+	// If the file is in the snapshot being backed up, protect the snapshotted data:
+	if (m_IsSnapshotActive)
+	{
+		sSnapshotRegions::const_iterator itrSnapshot = m_SnapshotRegions.find(FileName);
+		if (itrSnapshot != m_SnapshotRegions.end())
+		{
+			f->SetProtectedSectors(itrSnapshot->second.m_ProtectedSectors);
+		}
+	}
+	
 	// If there are too many MCA files cached, delete the last one used:
 	if (m_Files.size() > MAX_MCA_FILES)
 	{
@@ -304,7 +463,26 @@ bool cWSSAnvil::LoadChunkFromData(const cChunkCoords & a_Chunk, const AString &
 
 bool cWSSAnvil::SaveChunkToData(const cChunkCoords & a_Chunk, AString & a_Data)
 {
-	cFastNBTWriter Writer;
+	/** Passes the NBT data to the compressor as it is being written, so that the whole uncompressed NBT never needs to be in memory. */
+	class cCompressingSink :
+		public cFastNBTWriter::cSink
+	{
+	public:
+		cZlibStreamCompressor m_Compressor;
+
+		cCompressingSink(AString & a_Compressed, int a_Factor) :
+			m_Compressor(a_Compressed, a_Factor)
+		{
+		}
+
+		virtual void Write(const char * a_Data, size_t a_Size) override
+		{
+			m_Compressor.Write(a_Data, a_Size);
+		}
+	} Sink(a_Data, m_CompressionFactor);
+
+	a_Data.clear();
+	cFastNBTWriter Writer(Sink, NBT_FLUSH_THRESHOLD);
 	if (!SaveChunkToNBT(a_Chunk, Writer))
 	{
 		LOGWARNING("Cannot save chunk [%d, %d] to NBT", a_Chunk.m_ChunkX, a_Chunk.m_ChunkZ);
@@ -312,7 +490,12 @@ bool cWSSAnvil::SaveChunkToData(const cChunkCoords & a_Chunk, AString & a_Data)
 	}
 	Writer.Finish();
 	
-	CompressString(Writer.GetResult().data(), Writer.GetResult().size(), a_Data, m_CompressionFactor);
+	int res = Sink.m_Compressor.Finish();
+	if (res != Z_OK)
+	{
+		LOGWARNING("Cannot compress chunk [%d, %d] data: %d", a_Chunk.m_ChunkX, a_Chunk.m_ChunkZ, res);
+		return false;
+	}
 	return true;
 }
 
@@ -477,8 +660,8 @@ bool cWSSAnvil::SaveChunkToNBT(const cChunkCoords & a_Chunk, cFastNBTWriter & a_
 	// Save heightmap (Vanilla require this):
 	a_Writer.AddIntArray("HeightMap", (const int *)Serializer.m_VanillaHeightMap, ARRAYCOUNT(Serializer.m_VanillaHeightMap));
 
-	// Save blockdata:
-	a_Writer.BeginList("Sections", TAG_Compound);
+	// Save blockdata; the count is known, so that the sections can be passed to the writer's sink one by one:
+	a_Writer.BeginList("Sections", TAG_Compound, 16);
 	size_t SliceSizeBlock  = cChunkDef::Width * cChunkDef::Width * 16;
 	size_t SliceSizeNibble = SliceSizeBlock / 2;
 	const char * BlockTypes    = (const char *)(Serializer.m_BlockTypes);
@@ -2961,7 +3144,8 @@ bool cWSSAnvil::GetBlockEntityNBTPos(const cParsedNBT & a_NBT, int a_TagIdx, int
 cWSSAnvil::cMCAFile::cMCAFile(const AString & a_FileName, int a_RegionX, int a_RegionZ) :
 	m_RegionX(a_RegionX),
 	m_RegionZ(a_RegionZ),
-	m_FileName(a_FileName)
+	m_FileName(a_FileName),
+	m_ProtectedSectors(0)
 {
 }
 
@@ -3178,12 +3362,28 @@ bool cWSSAnvil::cMCAFile::SetChunkData(const cChunkCoords & a_Chunk, const AStri
 
 
 
+bool cWSSAnvil::cMCAFile::GetSnapshot(AString & a_Header, int & a_FileSize)
+{
+	if (!OpenFile(true))
+	{
+		return false;
+	}
+	a_Header.assign(reinterpret_cast<const char *>(m_Header), sizeof(m_Header));
+	a_Header.append(reinterpret_cast<const char *>(m_TimeStamps), sizeof(m_TimeStamps));
+	a_FileSize = m_File.GetSize();
+	return (a_FileSize >= 0);
+}
+
+
+
+
+
 unsigned cWSSAnvil::cMCAFile::FindFreeLocation(int a_LocalX, int a_LocalZ, const AString & a_Data)
 {
-	// See if it fits the current location:
+	// See if it fits the current location (unless a snapshot still needs the data there):
 	unsigned ChunkLocation = ntohl(m_Header[a_LocalX + 32 * a_LocalZ]);
 	unsigned ChunkLen = ChunkLocation & 0xff;
-	if (a_Data.size() + MCA_CHUNK_HEADER_LENGTH <= (ChunkLen * 4096))
+	if ((a_Data.size() + MCA_CHUNK_HEADER_LENGTH <= (ChunkLen * 4096)) && ((ChunkLocation >> 8) >= m_ProtectedSectors))
 	{
 		return ChunkLocation >> 8;
 	}
@@ -3199,7 +3399,9 @@ unsigned cWSSAnvil::cMCAFile::FindFreeLocation(int a_LocalX, int a_LocalZ, const
 			MaxLocation = ChunkLocation;
 		}
 	}  // for i - m_Header[]
-	return MaxLocation >> 8;
+	
+	// Never append into the protected sectors, even if the chunks that used them have been moved since:
+	return std::max(MaxLocation >> 8, m_ProtectedSectors);
 }
 
 
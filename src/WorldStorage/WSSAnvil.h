@@ -53,6 +53,11 @@ public:
 	cWSSAnvil(cWorld * a_World, int a_CompressionFactor);
 	virtual ~cWSSAnvil();
 	
+	// cWSSchema overrides for the online backups:
+	virtual bool BeginSnapshot(sSnapshotFiles & a_Files) override;
+	virtual bool ReadSnapshot(const AString & a_FileName, int a_Offset, char * a_Buffer, int a_Size) override;
+	virtual void EndSnapshot(void) override;
+	
 protected:
 
 	class cMCAFile
@@ -65,6 +70,13 @@ protected:
 		bool SetChunkData  (const cChunkCoords & a_Chunk, const AString & a_Data);
 		bool EraseChunkData(const cChunkCoords & a_Chunk);
 		
+		/** Fills a_Header with the current file header (both the chunk locations and the timestamps)
+		and returns the current file size. Returns false if the file cannot be opened. */
+		bool GetSnapshot(AString & a_Header, int & a_FileSize);
+		
+		/** Sets the number of sectors at the start of the file that mustn't be overwritten (because a snapshot refers to them). */
+		void SetProtectedSectors(unsigned a_NumSectors) { m_ProtectedSectors = a_NumSectors; }
+		
 		int             GetRegionX (void) const {return m_RegionX; }
 		int             GetRegionZ (void) const {return m_RegionZ; }
 		const AString & GetFileName(void) const {return m_FileName; }
@@ -83,6 +95,10 @@ protected:
 		// Chunk timestamps, following the chunk headers
 		unsigned m_TimeStamps[MCA_MAX_CHUNKS];
 		
+		/** Number of sectors at the start of the file that mustn't be overwritten; all the new chunk data is placed after them.
+		Non-zero only while a snapshot of the file is being backed up. */
+		unsigned m_ProtectedSectors;
+		
 		/// Finds a free location large enough to hold a_Data. Gets a hint of the chunk coords, places the data there if it fits. Returns the sector number.
 		unsigned FindFreeLocation(int a_LocalX, int a_LocalZ, const AString & a_Data);
 		
@@ -91,9 +107,25 @@ protected:
 	} ;
 	typedef std::list<cMCAFile *> cMCAFiles;
 	
+	/** The state of a single MCA file at the time the snapshot was taken */
+	struct sSnapshotRegion
+	{
+		int      m_RegionX;
+		int      m_RegionZ;
+		AString  m_Header;            ///< Both the chunk locations and the timestamps, as they were in the file
+		unsigned m_ProtectedSectors;  ///< Number of sectors in the file, the snapshot may refer to any of them
+	} ;
+	typedef std::map<AString, sSnapshotRegion> sSnapshotRegions;
+	
 	cCriticalSection m_CS;
 	cMCAFiles        m_Files;  // a MRU cache of MCA files
 	
+	/** True while a snapshot is in progress; protected by m_CS */
+	bool m_IsSnapshotActive;
+	
+	/** The files in the snapshot in progress, mapped by their filename; protected by m_CS */
+	sSnapshotRegions m_SnapshotRegions;
+	
 	int m_CompressionFactor;
 
 	/// Gets chunk data from the correct file; locks file CS as needed
@@ -236,6 +268,9 @@ protected:
 	
 	/// Gets the correct MCA file either from cache or from disk, manages the m_MCAFiles cache; assumes m_CS is locked
 	cMCAFile * LoadMCAFile(const cChunkCoords & a_Chunk);
+
+	/// Returns the MCA file for the specified region if it is in the cache, nullptr if not. Doesn't change the cache; assumes m_CS is locked
+	cMCAFile * FindCachedMCAFile(int a_RegionX, int a_RegionZ);
 	
 	/// Copies a_Length bytes of data from the specified NBT Tag's Child into the a_Destination buffer
 	void CopyNBTData(const cParsedNBT & a_NBT, int a_Tag, const AString & a_ChildName, char * a_Destination, size_t a_Length);
@@ -8,6 +8,7 @@
 #include "Globals.h"
 #include "WorldStorage.h"
 #include "WSSAnvil.h"
+#include "StorageBackup.h"
 #include "../World.h"
 #include "../Generating/ChunkGenerator.h"
 #include "../Entities/Entity.h"
@@ -40,7 +41,8 @@ protected:
 cWorldStorage::cWorldStorage(void) :
 	super("cWorldStorage"),
 	m_World(nullptr),
-	m_SaveSchema(nullptr)
+	m_SaveSchema(nullptr),
+	m_Backup(nullptr)
 {
 }
 
@@ -50,6 +52,7 @@ cWorldStorage::cWorldStorage(void) :
 
 cWorldStorage::~cWorldStorage()
 {
+	delete m_Backup;
 	for (cWSSchemaList::iterator itr = m_Schemas.begin(); itr != m_Schemas.end(); ++itr)
 	{
 		delete *itr;
@@ -75,6 +78,14 @@ bool cWorldStorage::Start(cWorld * a_World, const AString & a_StorageSchemaName,
 
 void cWorldStorage::Stop(void)
 {
+	// Abort the backup, if running, so that it doesn't outlive the schemas:
+	{
+		cCSLock Lock(m_CSBackup);
+		if (m_Backup != nullptr)
+		{
+			m_Backup->Stop();
+		}
+	}
 	WaitForFinish();
 }
 
@@ -140,6 +151,41 @@ size_t cWorldStorage::GetSaveQueueLength(void)
 
 
 
+bool cWorldStorage::StartBackup(const AString & a_DestFolder)
+{
+	cCSLock Lock(m_CSBackup);
+	if ((m_Backup != nullptr) && m_Backup->IsRunning())
+	{
+		LOGWARNING("Cannot start a backup of world \"%s\", another one is still running", m_World->GetName().c_str());
+		return false;
+	}
+	if (m_SaveSchema == nullptr)
+	{
+		return false;
+	}
+	delete m_Backup;
+	m_Backup = new cStorageBackup(*m_SaveSchema, a_DestFolder);
+	return m_Backup->Start();
+}
+
+
+
+
+
+AString cWorldStorage::GetBackupStatus(void)
+{
+	cCSLock Lock(m_CSBackup);
+	if (m_Backup == nullptr)
+	{
+		return "No backup has been made yet";
+	}
+	return m_Backup->GetStatus();
+}
+
+
+
+
+
 void cWorldStorage::QueueLoadChunk(int a_ChunkX, int a_ChunkZ, cChunkCoordCallback * a_Callback)
 {
 	ASSERT(m_World->IsChunkQueued(a_ChunkX, a_ChunkZ));
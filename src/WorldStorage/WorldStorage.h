@@ -24,6 +24,7 @@
 
 // fwd:
 class cWorld;
+class cStorageBackup;
 
 typedef cQueue<cChunkCoordsWithCallback> cChunkCoordsQueue;
 
@@ -42,6 +43,26 @@ public:
 	virtual bool SaveChunk(const cChunkCoords & a_Chunk) = 0;
 	virtual const AString GetName(void) const = 0;
 	
+	/** A single file to be copied by an online backup */
+	struct sSnapshotFile
+	{
+		AString m_FileName;  ///< Name of the file, relative to the server folder
+		int     m_Size;      ///< Number of bytes to copy
+	} ;
+	typedef std::vector<sSnapshotFile> sSnapshotFiles;
+	
+	/** Takes a consistent snapshot of the schema's files for an online backup and fills a_Files with the files to copy.
+	Until EndSnapshot() is called, chunks keep being saved, but no data that the snapshot refers to is overwritten.
+	Returns false if the schema doesn't support snapshots, or if a snapshot is already in progress. */
+	virtual bool BeginSnapshot(sSnapshotFiles & a_Files) { return false; }
+	
+	/** Reads a_Size bytes of the file, as it was when the snapshot was taken, starting at a_Offset.
+	May be called from any thread while the snapshot is in progress. Returns true on success. */
+	virtual bool ReadSnapshot(const AString & a_FileName, int a_Offset, char * a_Buffer, int a_Size) { return false; }
+	
+	/** Ends the snapshot started by BeginSnapshot(), the space it held may be reused for saving again. */
+	virtual void EndSnapshot(void) {}
+	
 protected:
 
 	cWorld * m_World;
@@ -79,6 +100,14 @@ public:
 	size_t GetLoadQueueLength(void);
 	size_t GetSaveQueueLength(void);
 	
+	/** Starts an online backup of the world's storage files into a_DestFolder.
+	The files are copied in a separate thread while the chunks keep being saved.
+	Returns false if a backup is already running or the save schema doesn't support online backups. */
+	bool StartBackup(const AString & a_DestFolder);
+	
+	/** Returns a human-readable status of the running or the last finished backup. */
+	AString GetBackupStatus(void);
+	
 protected:
 
 	cWorld * m_World;
@@ -92,6 +121,12 @@ protected:
 	
 	/// The one storage schema used for saving
 	cWSSchema *   m_SaveSchema;
+	
+	/** Protects m_Backup against multithreaded access */
+	cCriticalSection m_CSBackup;
+	
+	/** The running or the last finished online backup, nullptr if there was none yet */
+	cStorageBackup * m_Backup;
 
 	
 	/// Loads the chunk specified; returns true on success, false on failure
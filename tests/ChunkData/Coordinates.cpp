@@ -132,6 +132,33 @@ int main(int argc, char** argv)
 		testassert(buffer.GetMeta(0, 16, 1) == 0xc);
 	}
 	
+	{
+		cChunkData buffer(Pool);
+		
+		// Single-block light, notloaded segments
+		testassert(!buffer.SetBlockLight(0, 32, 0, 0x0));
+		testassert(!buffer.SetSkyLight(0, 32, 0, 0xf));
+		testassert(buffer.GetBlockLight(0, 32, 0) == 0x0);
+		testassert(buffer.GetSkyLight(0, 32, 0) == 0xf);
+		
+		// Single-block light, neighbor nibbles stay untouched
+		testassert(buffer.SetBlockLight(0, 48, 0, 0xe));
+		testassert(buffer.SetSkyLight(0, 48, 0, 0x3));
+		testassert(!buffer.SetBlockLight(0, 48, 0, 0xe));
+		testassert(buffer.GetBlockLight(0, 48, 0) == 0xe);
+		testassert(buffer.GetSkyLight(0, 48, 0) == 0x3);
+		testassert(buffer.GetBlockLight(1, 48, 0) == 0x0);
+		testassert(buffer.GetSkyLight(1, 48, 0) == 0xf);
+		
+		// Out of Range
+		CheckAsserts(
+			buffer.SetBlockLight(-1, 0, 0, 0);
+		);
+		CheckAsserts(
+			buffer.SetSkyLight(0, 256, 0, 0);
+		);
+	}
+	
 	
 	{
 		// Operator =
@@ -141,7 +141,31 @@ int main(int argc, char** argv)
 		buffer.CopySkyLight(DstNibbleBuffer);
 		testassert(memcmp(SrcNibbleBuffer, DstNibbleBuffer, (16 * 16 * 256 / 2) - 1) == 0);
 	}
-	
+
+	{
+		cChunkData buffer(Pool);
+		cChunkData copy(Pool);
+
+		// Copy into an empty object:
+		buffer.SetBlock(3, 1, 4, 0xDE);
+		buffer.SetMeta(3, 1, 4, 0xA);
+		copy.CopyFrom(buffer);
+		testassert(copy.GetBlock(3, 1, 4) == 0xDE);
+		testassert(copy.GetMeta(3, 1, 4) == 0xA);
+		testassert(copy.GetSection(0) != nullptr);
+		testassert(copy.GetSection(1) == nullptr);
+
+		// Copy again, reusing the allocated section and releasing the one that is now empty in the source:
+		cChunkData buffer2(Pool);
+		buffer2.SetBlock(5, 20, 6, 0xAD);
+		copy.CopyFrom(buffer2);
+		testassert(copy.GetBlock(3, 1, 4) == 0x00);
+		testassert(copy.GetMeta(3, 1, 4) == 0x0);
+		testassert(copy.GetBlock(5, 20, 6) == 0xAD);
+		testassert(copy.GetSection(0) == nullptr);
+		testassert(copy.GetSection(1) != nullptr);
+	}
+
 	// All tests successful:
 	return 0;
 }
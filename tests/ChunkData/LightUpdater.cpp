@@ -0,0 +1,439 @@
+
+// LightUpdater.cpp
+
+// Tests that the incremental light updates done by cLightUpdater produce the same light as relighting the chunks fully
+
+#include "Globals.h"
+#include "ChunkData.h"
+#include "LightUpdater.h"
+#include "Blocks/BlockHandler.h"
+
+
+
+
+
+/** The light updates only need cBlockInfo's light values, not the block handlers */
+cBlockHandler * cBlockHandler::CreateBlockHandler(BLOCKTYPE a_BlockType)
+{
+	UNUSED(a_BlockType);
+	return nullptr;
+}
+
+
+
+
+
+/** The Y coord of the topmost block of the fixture's ground */
+static const int GROUND_Y = 60;
+
+
+
+
+
+class cFixtureAllocationPool :
+	public cAllocationPool<cChunkData::sChunkSection>
+{
+public:
+	virtual cChunkData::sChunkSection * Allocate() override
+	{
+		return new cChunkData::sChunkSection();
+	}
+
+	virtual void Free(cChunkData::sChunkSection * a_Ptr) override
+	{
+		delete a_Ptr;
+	}
+} ;
+
+
+
+
+
+/** The 3x3 chunk neighborhood that cLightUpdater works on, with the block coords relative to the middle chunk.
+Keeps the heightmap up to date the same way cChunk does. */
+class cFixture
+{
+public:
+	/** Size of the whole fixture along X and Z, in blocks */
+	static const int SIZE = 3 * cChunkDef::Width;
+
+	/** Number of blocks in the whole fixture */
+	static const int NUM_BLOCKS = SIZE * SIZE * cChunkDef::Height;
+
+	typedef std::vector<NIBBLETYPE> cLight;
+
+
+	cFixture(void)
+	{
+		for (size_t i = 0; i < ARRAYCOUNT(m_Data); i++)
+		{
+			m_Data[i].reset(new cChunkData(m_Pool));
+			memset(m_HeightMaps[i], 0, sizeof(m_HeightMaps[i]));
+		}
+	}
+
+	/** Sets the block at the specified coords, relative to the middle chunk, and updates the heightmap */
+	void SetBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockType)
+	{
+		int Idx = GetChunkIdx(a_RelX, a_RelZ);
+		m_Data[Idx]->SetBlock(a_RelX, a_RelY, a_RelZ, a_BlockType);
+		cChunkDef::HeightMap & HeightMap = m_HeightMaps[Idx];
+		if (a_RelY < cChunkDef::GetHeight(HeightMap, a_RelX, a_RelZ))
+		{
+			return;
+		}
+		if (a_BlockType != E_BLOCK_AIR)
+		{
+			cChunkDef::SetHeight(HeightMap, a_RelX, a_RelZ, static_cast<unsigned char>(a_RelY));
+			return;
+		}
+		for (int y = a_RelY - 1; y > 0; --y)
+		{
+			if (m_Data[Idx]->GetBlock(a_RelX, y, a_RelZ) != E_BLOCK_AIR)
+			{
+				cChunkDef::SetHeight(HeightMap, a_RelX, a_RelZ, static_cast<unsigned char>(y));
+				break;
+			}
+		}
+	}
+
+	/** Changes the block in the middle chunk and updates the light using cLightUpdater, the same way cChunk does.
+	Returns the cLightUpdater's result. */
+	bool ChangeBlock(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockType)
+	{
+		int OldHeight = cChunkDef::GetHeight(m_HeightMaps[4], a_RelX, a_RelZ);
+		SetBlock(a_RelX, a_RelY, a_RelZ, a_BlockType);
+
+		cChunkData * Data[9];
+		const cChunkDef::HeightMap * HeightMaps[9];
+		for (size_t i = 0; i < ARRAYCOUNT(m_Data); i++)
+		{
+			Data[i] = m_Data[i].get();
+			HeightMaps[i] = &m_HeightMaps[i];
+		}
+		cLightUpdater Updater(Data, HeightMaps);
+		return Updater.BlockChanged(a_RelX, a_RelY, a_RelZ, OldHeight);
+	}
+
+	/** Calculates the light of the whole fixture from scratch, the same way cLightingThread does:
+	seeds the full skylight above the heightmap and the light-emitting blocks, then floods the light into the neighbors. */
+	void FullRelight(cLight & a_BlockLight, cLight & a_SkyLight) const
+	{
+		a_BlockLight.assign(NUM_BLOCKS, 0);
+		a_SkyLight.assign(NUM_BLOCKS, 0);
+		std::vector<int> BlockSeeds, SkySeeds;
+		for (int z = 0; z < SIZE; z++)
+		{
+			for (int x = 0; x < SIZE; x++)
+			{
+				int RelX = x - cChunkDef::Width;
+				int RelZ = z - cChunkDef::Width;
+				int Idx = GetChunkIdx(RelX, RelZ);
+				int Height = cChunkDef::GetHeight(m_HeightMaps[Idx], RelX, RelZ);
+				for (int y = 0; y < cChunkDef::Height; y++)
+				{
+					int LightIdx = MakeIndex(x, y, z);
+					if (y > Height)
+					{
+						a_SkyLight[LightIdx] = 15;
+						SkySeeds.push_back(LightIdx);
+					}
+					NIBBLETYPE Source = cBlockInfo::GetLightValue(m_Data[Idx]->GetBlock(RelX, y, RelZ));
+					if (Source > 0)
+					{
+						a_BlockLight[LightIdx] = Source;
+						BlockSeeds.push_back(LightIdx);
+					}
+				}
+			}
+		}
+		Flood(a_BlockLight, BlockSeeds);
+		Flood(a_SkyLight, SkySeeds);
+	}
+
+	/** Stores the light into the chunks, as if lit by cLightingThread */
+	void SetLight(const cLight & a_BlockLight, const cLight & a_SkyLight)
+	{
+		ForEachBlock([&](int a_Idx, cChunkData & a_Data, int a_RelX, int a_RelY, int a_RelZ, int a_LightIdx)
+			{
+				a_Data.SetBlockLight(a_RelX, a_RelY, a_RelZ, a_BlockLight[static_cast<size_t>(a_LightIdx)]);
+				a_Data.SetSkyLight  (a_RelX, a_RelY, a_RelZ, a_SkyLight[static_cast<size_t>(a_LightIdx)]);
+			}
+		);
+	}
+
+	/** Returns the number of blocks whose light in the chunks differs from the expected, logs the first one */
+	int CountDifferences(const cLight & a_BlockLight, const cLight & a_SkyLight)
+	{
+		int NumDifferences = 0;
+		ForEachBlock([&](int a_Idx, cChunkData & a_Data, int a_RelX, int a_RelY, int a_RelZ, int a_LightIdx)
+			{
+				NIBBLETYPE BlockLight = a_Data.GetBlockLight(a_RelX, a_RelY, a_RelZ);
+				NIBBLETYPE SkyLight = a_Data.GetSkyLight(a_RelX, a_RelY, a_RelZ);
+				if ((BlockLight == a_BlockLight[static_cast<size_t>(a_LightIdx)]) && (SkyLight == a_SkyLight[static_cast<size_t>(a_LightIdx)]))
+				{
+					return;
+				}
+				if (NumDifferences == 0)
+				{
+					LOG("  First difference in chunk %d at {%d, %d, %d}: blocklight %d (expected %d), skylight %d (expected %d)",
+						a_Idx, a_RelX, a_RelY, a_RelZ,
+						BlockLight, a_BlockLight[static_cast<size_t>(a_LightIdx)],
+						SkyLight, a_SkyLight[static_cast<size_t>(a_LightIdx)]
+					);
+				}
+				NumDifferences += 1;
+			}
+		);
+		return NumDifferences;
+	}
+
+protected:
+	cFixtureAllocationPool m_Pool;
+	std::unique_ptr<cChunkData> m_Data[9];
+	cChunkDef::HeightMap m_HeightMaps[9];
+
+
+	/** Returns the index of the chunk containing the specified block, adjusts the coords to be relative to that chunk */
+	static int GetChunkIdx(int & a_RelX, int & a_RelZ)
+	{
+		ASSERT((a_RelX >= -cChunkDef::Width) && (a_RelX < 2 * cChunkDef::Width));
+		ASSERT((a_RelZ >= -cChunkDef::Width) && (a_RelZ < 2 * cChunkDef::Width));
+		int ChunkX = (a_RelX + cChunkDef::Width) / cChunkDef::Width;
+		int ChunkZ = (a_RelZ + cChunkDef::Width) / cChunkDef::Width;
+		a_RelX -= (ChunkX - 1) * cChunkDef::Width;
+		a_RelZ -= (ChunkZ - 1) * cChunkDef::Width;
+		return ChunkX + 3 * ChunkZ;
+	}
+
+	/** Returns the index into the whole-fixture light arrays, the coords are relative to the fixture's corner */
+	static int MakeIndex(int a_X, int a_Y, int a_Z)
+	{
+		return a_X + SIZE * (a_Z + SIZE * a_Y);
+	}
+
+	/** Returns the block type at the specified whole-fixture light array index */
+	BLOCKTYPE GetBlockAt(int a_LightIdx) const
+	{
+		int RelX = (a_LightIdx % SIZE) - cChunkDef::Width;
+		int RelZ = ((a_LightIdx / SIZE) % SIZE) - cChunkDef::Width;
+		int y = a_LightIdx / (SIZE * SIZE);
+		int Idx = GetChunkIdx(RelX, RelZ);
+		return m_Data[Idx]->GetBlock(RelX, y, RelZ);
+	}
+
+	/** Spreads the light from the seeds until it cannot spread any further, same as cLightingThread::PropagateLight() */
+	void Flood(cLight & a_Light, std::vector<int> & a_Seeds) const
+	{
+		for (size_t i = 0; i < a_Seeds.size(); i++)
+		{
+			int Idx = a_Seeds[i];
+			int x = Idx % SIZE;
+			int z = (Idx / SIZE) % SIZE;
+			int y = Idx / (SIZE * SIZE);
+			NIBBLETYPE Light = a_Light[static_cast<size_t>(Idx)];
+			int Neighbors[6];
+			int NumNeighbors = 0;
+			if (x > 0)                      { Neighbors[NumNeighbors++] = Idx - 1; }
+			if (x < SIZE - 1)               { Neighbors[NumNeighbors++] = Idx + 1; }
+			if (z > 0)                      { Neighbors[NumNeighbors++] = Idx - SIZE; }
+			if (z < SIZE - 1)               { Neighbors[NumNeighbors++] = Idx + SIZE; }
+			if (y > 0)                      { Neighbors[NumNeighbors++] = Idx - SIZE * SIZE; }
+			if (y < cChunkDef::Height - 1)  { Neighbors[NumNeighbors++] = Idx + SIZE * SIZE; }
+			for (int n = 0; n < NumNeighbors; n++)
+			{
+				size_t Dst = static_cast<size_t>(Neighbors[n]);
+				NIBBLETYPE Falloff = cBlockInfo::GetSpreadLightFalloff(GetBlockAt(Neighbors[n]));
+				if (Light <= a_Light[Dst] + Falloff)
+				{
+					// We're not offering more light than the dest block already has
+					continue;
+				}
+				a_Light[Dst] = Light - Falloff;
+				a_Seeds.push_back(Neighbors[n]);
+			}
+		}
+	}
+
+	/** Calls the callback for each block in the fixture, with the chunk index, its data, the coords relative to that chunk,
+	and the index into the whole-fixture light arrays */
+	template <class CALLBACK>
+	void ForEachBlock(CALLBACK a_Callback)
+	{
+		for (int Idx = 0; Idx < 9; Idx++)
+		{
+			int BaseX = (Idx % 3) * cChunkDef::Width;
+			int BaseZ = (Idx / 3) * cChunkDef::Width;
+			for (int y = 0; y < cChunkDef::Height; y++)
+			{
+				for (int z = 0; z < cChunkDef::Width; z++)
+				{
+					for (int x = 0; x < cChunkDef::Width; x++)
+					{
+						a_Callback(Idx, *m_Data[Idx], x, y, z, MakeIndex(BaseX + x, y, BaseZ + z));
+					}
+				}
+			}
+		}
+	}
+} ;
+
+
+
+
+
+/** Builds the fixture terrain: flat ground with a closed cave under it, a room with a roof and an opening,
+and a pond; then lights it fully. */
+static void BuildTerrain(cFixture & a_Fixture)
+{
+	for (int z = -cChunkDef::Width; z < 2 * cChunkDef::Width; z++)
+	{
+		for (int x = -cChunkDef::Width; x < 2 * cChunkDef::Width; x++)
+		{
+			for (int y = 0; y <= GROUND_Y; y++)
+			{
+				a_Fixture.SetBlock(x, y, z, E_BLOCK_STONE);
+			}
+		}
+	}
+
+	// A closed cave, from the middle chunk into its +X neighbor:
+	for (int z = 4; z < 10; z++)
+	{
+		for (int x = 6; x < 24; x++)
+		{
+			for (int y = 40; y < 44; y++)
+			{
+				a_Fixture.SetBlock(x, y, z, E_BLOCK_AIR);
+			}
+		}
+	}
+
+	// A room on the ground, walls and a roof, with a door-sized opening on the -Z side:
+	for (int z = 2; z <= 12; z++)
+	{
+		for (int x = 2; x <= 12; x++)
+		{
+			bool IsWall = ((x == 2) || (x == 12) || (z == 2) || (z == 12));
+			for (int y = GROUND_Y + 1; y <= GROUND_Y + 5; y++)
+			{
+				a_Fixture.SetBlock(x, y, z, IsWall ? E_BLOCK_STONE : E_BLOCK_AIR);
+			}
+			a_Fixture.SetBlock(x, GROUND_Y + 6, z, E_BLOCK_STONE);
+		}
+	}
+	a_Fixture.SetBlock(7, GROUND_Y + 1, 2, E_BLOCK_AIR);
+	a_Fixture.SetBlock(7, GROUND_Y + 2, 2, E_BLOCK_AIR);
+
+	// A pond on the -X side of the middle chunk, extending into the neighbor:
+	for (int z = 3; z < 8; z++)
+	{
+		for (int x = -3; x < 2; x++)
+		{
+			a_Fixture.SetBlock(x, GROUND_Y, z, E_BLOCK_WATER);
+			a_Fixture.SetBlock(x, GROUND_Y - 1, z, E_BLOCK_WATER);
+		}
+	}
+
+	cFixture::cLight BlockLight, SkyLight;
+	a_Fixture.FullRelight(BlockLight, SkyLight);
+	a_Fixture.SetLight(BlockLight, SkyLight);
+}
+
+
+
+
+
+/** Changes the block, updates the light incrementally and checks it against the full relight */
+static void TestChange(cFixture & a_Fixture, int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE a_BlockType, const char * a_Description)
+{
+	testassert(a_Fixture.ChangeBlock(a_RelX, a_RelY, a_RelZ, a_BlockType));
+	cFixture::cLight BlockLight, SkyLight;
+	a_Fixture.FullRelight(BlockLight, SkyLight);
+	int NumDifferences = a_Fixture.CountDifferences(BlockLight, SkyLight);
+	if (NumDifferences != 0)
+	{
+		LOG("%s: %d blocks differ from the full relight", a_Description, NumDifferences);
+	}
+	testassert(NumDifferences == 0);
+}
+
+
+
+
+
+/** Places and removes the light sources and the blocks that shade the skylight */
+static void TestBasicChanges(void)
+{
+	cFixture Fixture;
+	BuildTerrain(Fixture);
+
+	// Light sources in the closed cave, one spreading into the neighbor chunk:
+	TestChange(Fixture, 8,  40, 6, E_BLOCK_TORCH,     "Torch placed in a cave");
+	TestChange(Fixture, 15, 41, 7, E_BLOCK_GLOWSTONE, "Glowstone placed at the chunk border");
+	TestChange(Fixture, 8,  40, 6, E_BLOCK_AIR,       "Torch removed from a cave");
+	TestChange(Fixture, 15, 41, 7, E_BLOCK_AIR,       "Glowstone removed");
+
+	// A torch in the room, then opening and closing the roof above it:
+	TestChange(Fixture, 5, GROUND_Y + 1, 5, E_BLOCK_TORCH, "Torch placed in the room");
+	TestChange(Fixture, 5, GROUND_Y + 6, 5, E_BLOCK_AIR,   "Roof block removed");
+	TestChange(Fixture, 5, GROUND_Y + 6, 5, E_BLOCK_STONE, "Roof block placed back");
+	TestChange(Fixture, 5, GROUND_Y + 1, 5, E_BLOCK_AIR,   "Torch removed from the room");
+
+	// Shading the open ground, and the water's higher falloff:
+	TestChange(Fixture, 14, GROUND_Y + 3, 14, E_BLOCK_STONE, "Block placed in the air");
+	TestChange(Fixture, 14, GROUND_Y + 3, 14, E_BLOCK_AIR,   "Block removed from the air");
+	TestChange(Fixture, 1, GROUND_Y + 1, 4, E_BLOCK_GLOWSTONE, "Glowstone placed by the pond");
+	TestChange(Fixture, 1, GROUND_Y, 5, E_BLOCK_STONE,       "Pond partly filled");
+
+	// Opening the closed cave to the room above:
+	TestChange(Fixture, 7, GROUND_Y, 7, E_BLOCK_AIR, "Room floor removed");
+	for (int y = GROUND_Y - 1; y >= 44; y--)
+	{
+		TestChange(Fixture, 7, y, 7, E_BLOCK_AIR, "Shaft dug into the cave");
+	}
+	TestChange(Fixture, 7, GROUND_Y + 6, 7, E_BLOCK_AIR, "Roof above the shaft removed");
+}
+
+
+
+
+
+/** A deterministic sequence of random changes around the room and on the surface */
+static void TestRandomChanges(void)
+{
+	cFixture Fixture;
+	BuildTerrain(Fixture);
+
+	static const BLOCKTYPE BlockTypes[] =
+	{
+		E_BLOCK_AIR, E_BLOCK_AIR, E_BLOCK_STONE, E_BLOCK_TORCH, E_BLOCK_GLOWSTONE, E_BLOCK_WATER, E_BLOCK_GLASS, E_BLOCK_LEAVES,
+	};
+	UInt32 Seed = 12345;
+	for (int i = 0; i < 60; i++)
+	{
+		// A simple LCG, so that the sequence is the same on all platforms:
+		Seed = Seed * 1103515245 + 12345;
+		int x = static_cast<int>((Seed >> 8) % 16);
+		int y = GROUND_Y - 3 + static_cast<int>((Seed >> 12) % 12);
+		int z = static_cast<int>((Seed >> 16) % 16);
+		BLOCKTYPE BlockType = BlockTypes[(Seed >> 20) % ARRAYCOUNT(BlockTypes)];
+		TestChange(Fixture, x, y, z, BlockType, Printf("Random change #%d", i).c_str());
+	}
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	TestBasicChanges();
+	TestRandomChanges();
+	LOG("LightUpdater test finished");
+	return 0;
+}
+
+
+
+
@@ -0,0 +1,132 @@
+
+// SectionSerialization.cpp
+
+// Tests that the chunk data serializer decides between the full chunk and the section-only update explicitly, not by the section mask
+
+#include "Globals.h"
+#include "ChunkData.h"
+#include "ByteBuffer.h"
+#include "StringCompression.h"
+#include "Protocol/ChunkDataSerializer.h"
+
+
+
+
+
+/** Size of a single section's data in the 1.8 chunk packet: block types with metas, block light and skylight */
+static const UInt32 SECTION_SIZE_1_8 = 4096 * 2 + 2048 + 2048;
+
+/** Size of the biome data in the full chunk packet */
+static const UInt32 BIOMES_SIZE = cChunkDef::Width * cChunkDef::Width;
+
+
+
+
+
+/** Checks the 1.8 chunk packet header produced by the serializer. */
+static void CheckPacket18(cChunkDataSerializer & a_Serializer, bool a_ShouldBeGroundUp, UInt16 a_ExpectedMask, int a_NumSections)
+{
+	// The packet is framed for the compressed game state, unframe it first:
+	const AString & Framed = a_Serializer.Serialize(cChunkDataSerializer::RELEASE_1_8_0, 3, -5);
+	cByteBuffer Frame(Framed.size() + 1);
+	testassert(Frame.Write(Framed.data(), Framed.size()));
+	UInt32 FrameSize, UncompressedSize;
+	testassert(Frame.ReadVarInt(FrameSize));
+	testassert(FrameSize == Frame.GetReadableSpace());
+	testassert(Frame.ReadVarInt(UncompressedSize));
+	AString Compressed, Packet;
+	testassert(Frame.ReadString(Compressed, Frame.GetReadableSpace()));
+	testassert(UncompressString(Compressed.data(), Compressed.size(), Packet, UncompressedSize) == Z_OK);
+
+	cByteBuffer Buffer(Packet.size() + 1);
+	testassert(Buffer.Write(Packet.data(), Packet.size()));
+	UInt32 PacketID, ChunkSize;
+	int ChunkX, ChunkZ;
+	bool IsGroundUp;
+	UInt16 Mask;
+	testassert(Buffer.ReadVarInt(PacketID));
+	testassert(Buffer.ReadBEInt(ChunkX));
+	testassert(Buffer.ReadBEInt(ChunkZ));
+	testassert(Buffer.ReadBool(IsGroundUp));
+	testassert(Buffer.ReadBEUInt16(Mask));
+	testassert(Buffer.ReadVarInt(ChunkSize));
+	testassert(PacketID == 0x21);
+	testassert((ChunkX == 3) && (ChunkZ == -5));
+	testassert(IsGroundUp == a_ShouldBeGroundUp);
+	testassert(Mask == a_ExpectedMask);
+	UInt32 ExpectedSize = static_cast<UInt32>(a_NumSections) * SECTION_SIZE_1_8 + (a_ShouldBeGroundUp ? BIOMES_SIZE : 0);
+	testassert(ChunkSize == ExpectedSize);
+	testassert(Buffer.GetReadableSpace() == ChunkSize);
+}
+
+
+
+
+
+/** Checks the 1.7 chunk data header produced by the serializer. */
+static void CheckData17(cChunkDataSerializer & a_Serializer, bool a_ShouldBeGroundUp, UInt16 a_ExpectedMask)
+{
+	const AString & Data = a_Serializer.Serialize(cChunkDataSerializer::RELEASE_1_3_2, 3, -5);
+	testassert(Data.size() > 5);
+	testassert(Data[0] == (a_ShouldBeGroundUp ? 1 : 0));
+	UInt16 Mask = static_cast<UInt16>((static_cast<Byte>(Data[1]) << 8) | static_cast<Byte>(Data[2]));
+	testassert(Mask == a_ExpectedMask);
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	class cMockAllocationPool
+		: public cAllocationPool<cChunkData::sChunkSection>
+	{
+		virtual cChunkData::sChunkSection * Allocate()
+		{
+			return new cChunkData::sChunkSection();
+		}
+
+		virtual void Free(cChunkData::sChunkSection * a_Ptr)
+		{
+			delete a_Ptr;
+		}
+	} Pool;
+
+	// A chunk with only the bottom section allocated:
+	cChunkData Data(Pool);
+	Data.SetBlock(1, 2, 3, 1);
+	unsigned char Biomes[cChunkDef::Width * cChunkDef::Width];
+	memset(Biomes, 0, sizeof(Biomes));
+
+	// The full chunk leaves out the unallocated sections and sends the biomes:
+	{
+		cChunkDataSerializer Full(Data, Biomes);
+		testassert(Full.IsFullChunk());
+		CheckPacket18(Full, true, 0x0001, 1);
+		CheckData17(Full, true, 0x0001);
+	}
+
+	// A relight resend that has accumulated all the sections is still a partial update, sending all the sections without biomes:
+	{
+		cChunkDataSerializer AllSections(Data, Biomes, 0xffff);
+		testassert(!AllSections.IsFullChunk());
+		CheckPacket18(AllSections, false, 0xffff, 16);
+		CheckData17(AllSections, false, 0xffff);
+	}
+
+	// A partial update of some sections:
+	{
+		cChunkDataSerializer SomeSections(Data, Biomes, 0x0006);
+		testassert(!SomeSections.IsFullChunk());
+		CheckPacket18(SomeSections, false, 0x0006, 2);
+		CheckData17(SomeSections, false, 0x0006);
+	}
+
+	LOG("Section serialization test finished.");
+	return 0;
+}
+
+
+
+
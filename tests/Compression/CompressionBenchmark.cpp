@@ -0,0 +1,68 @@
+
+// CompressionBenchmark.cpp
+
+// Measures the per-packet overhead of compressing the data using a fresh zlib stream (compress2()) vs the pooled streams (CompressBuffer())
+
+#include "Globals.h"
+#include "StringCompression.h"
+#include "TestData.h"
+#include <chrono>
+
+
+
+
+
+/** Number of packets compressed for each measurement */
+static const int NUM_PACKETS = 5000;
+
+
+
+
+
+/** Compresses a_Packet NUM_PACKETS times and returns the average time per packet, in microseconds. */
+template <typename Func>
+static double MeasurePerPacket(const AString & a_Packet, Func a_Compress)
+{
+	AString Buffer;
+	Buffer.resize(compressBound(static_cast<uLong>(a_Packet.size())));
+	auto Start = std::chrono::steady_clock::now();
+	for (int i = 0; i < NUM_PACKETS; i++)
+	{
+		a_Compress(a_Packet, Buffer);
+	}
+	auto Duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Start);
+	return static_cast<double>(Duration.count()) / NUM_PACKETS;
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	const size_t PacketSizes[] = { 256, 1 KiB, 4 KiB, 32 KiB };
+	LOG("Compressing %d packets of each size:", NUM_PACKETS);
+	for (size_t i = 0; i < ARRAYCOUNT(PacketSizes); i++)
+	{
+		AString Packet = MakeTestData(PacketSizes[i], 1);
+
+		double FreshStream = MeasurePerPacket(Packet, [](const AString & a_Data, AString & a_Out)
+			{
+				uLongf CompressedSize = static_cast<uLongf>(a_Out.size());
+				compress2(reinterpret_cast<Bytef *>(&a_Out[0]), &CompressedSize, reinterpret_cast<const Bytef *>(a_Data.data()), static_cast<uLong>(a_Data.size()), Z_DEFAULT_COMPRESSION);
+			}
+		);
+		double PooledStream = MeasurePerPacket(Packet, [](const AString & a_Data, AString & a_Out)
+			{
+				size_t CompressedSize = a_Out.size();
+				CompressBuffer(a_Data.data(), a_Data.size(), &a_Out[0], CompressedSize, Z_DEFAULT_COMPRESSION);
+			}
+		);
+		LOG("  " SIZE_T_FMT_PRECISION(6) " bytes: fresh stream %8.2f us, pooled stream %8.2f us per packet", PacketSizes[i], FreshStream, PooledStream);
+	}
+	return 0;
+}
+
+
+
+
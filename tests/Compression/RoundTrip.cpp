@@ -0,0 +1,166 @@
+
+// RoundTrip.cpp
+
+// Tests that the compression wrappers produce data that decompresses back to the original, even when their zlib streams are reused
+
+#include "Globals.h"
+#include "StringCompression.h"
+#include "TestData.h"
+#include <thread>
+
+
+
+
+
+static void TestZlib(const AString & a_Data, int a_Factor)
+{
+	// Compress using the AString interface:
+	AString Compressed;
+	testassert(CompressString(a_Data.data(), a_Data.size(), Compressed, a_Factor) == Z_OK);
+
+	// Decompress using both the known-size and the streaming interface:
+	AString Uncompressed;
+	testassert(UncompressString(Compressed.data(), Compressed.size(), Uncompressed, a_Data.size()) == Z_OK);
+	testassert(Uncompressed == a_Data);
+	AString Inflated;
+	testassert(InflateString(Compressed.data(), Compressed.size(), Inflated) == Z_OK);
+	testassert(Inflated == a_Data);
+
+	// Decompressing into a too small buffer must fail:
+	if (!a_Data.empty())
+	{
+		testassert(UncompressString(Compressed.data(), Compressed.size(), Uncompressed, a_Data.size() - 1) == Z_BUF_ERROR);
+	}
+
+	// The raw buffer interface must produce the same data as the AString one, and report too small output buffers:
+	AString Buffer;
+	Buffer.resize(compressBound(static_cast<uLong>(a_Data.size())));
+	size_t CompressedSize = Buffer.size();
+	testassert(CompressBuffer(a_Data.data(), a_Data.size(), &Buffer[0], CompressedSize, a_Factor) == Z_OK);
+	testassert(Buffer.substr(0, CompressedSize) == Compressed);
+	CompressedSize = 4;
+	testassert(CompressBuffer(a_Data.data(), a_Data.size(), &Buffer[0], CompressedSize, a_Factor) == Z_BUF_ERROR);
+}
+
+
+
+
+
+static void TestGZip(const AString & a_Data)
+{
+	// The GZIP functions append to the output:
+	AString Compressed("prefix");
+	testassert(CompressStringGZIP(a_Data.data(), a_Data.size(), Compressed) == Z_OK);
+	testassert(Compressed.substr(0, 6) == "prefix");
+
+	AString Uncompressed("prefix");
+	testassert(UncompressStringGZIP(Compressed.data() + 6, Compressed.size() - 6, Uncompressed) == Z_OK);
+	testassert(Uncompressed == "prefix" + a_Data);
+}
+
+
+
+
+
+static void TestStream(const AString & a_Data)
+{
+	// Compress in pieces of various sizes, the result must uncompress to the original:
+	const size_t PieceSizes[] = { 1, 1000, 70000 };
+	for (size_t i = 0; i < ARRAYCOUNT(PieceSizes); i++)
+	{
+		AString Compressed;
+		{
+			cZlibStreamCompressor Compressor(Compressed, Z_DEFAULT_COMPRESSION);
+			for (size_t Pos = 0; Pos < a_Data.size(); Pos += PieceSizes[i])
+			{
+				testassert(Compressor.Write(a_Data.data() + Pos, std::min(PieceSizes[i], a_Data.size() - Pos)) == Z_OK);
+			}
+			testassert(Compressor.Finish() == Z_OK);
+		}
+		AString Uncompressed;
+		testassert(UncompressString(Compressed.data(), Compressed.size(), Uncompressed, a_Data.size()) == Z_OK);
+		testassert(Uncompressed == a_Data);
+	}
+}
+
+
+
+
+
+/** Runs the round trips from several threads at once, each thread uses its own pooled streams. */
+static void TestThreads(void)
+{
+	std::vector<std::thread> Threads;
+	for (int i = 0; i < 4; i++)
+	{
+		Threads.push_back(std::thread([i]()
+			{
+				for (int Repeat = 0; Repeat < 20; Repeat++)
+				{
+					AString Data = MakeTestData(static_cast<size_t>(256 + 1000 * i), Repeat);
+					TestZlib(Data, Z_DEFAULT_COMPRESSION);
+					TestGZip(Data);
+				}
+			}
+		));
+	}
+
+	// A stream compressor created in one thread may be finished and destroyed in another:
+	AString Data = MakeTestData(4000, 7);
+	AString Compressed;
+	cZlibStreamCompressor * Compressor = new cZlibStreamCompressor(Compressed, Z_DEFAULT_COMPRESSION);
+	testassert(Compressor->Write(Data.data(), Data.size()) == Z_OK);
+	Threads.push_back(std::thread([Compressor]()
+		{
+			testassert(Compressor->Finish() == Z_OK);
+			delete Compressor;
+		}
+	));
+
+	for (std::vector<std::thread>::iterator itr = Threads.begin(), end = Threads.end(); itr != end; ++itr)
+	{
+		itr->join();
+	}
+	AString Uncompressed;
+	testassert(UncompressString(Compressed.data(), Compressed.size(), Uncompressed, Data.size()) == Z_OK);
+	testassert(Uncompressed == Data);
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	// Run each size multiple times, so that the pooled streams get reused, including after a failure:
+	const size_t Sizes[] = { 0, 1, 255, 256, 4000, 100000, 1000000 };
+	for (int Repeat = 0; Repeat < 3; Repeat++)
+	{
+		for (size_t i = 0; i < ARRAYCOUNT(Sizes); i++)
+		{
+			AString Data = MakeTestData(Sizes[i], Repeat);
+			TestZlib(Data, Z_DEFAULT_COMPRESSION);
+			TestZlib(Data, 1);
+			TestGZip(Data);
+			if (Sizes[i] <= 100000)
+			{
+				TestStream(Data);
+			}
+		}
+	}
+
+	TestThreads();
+
+	// Garbage must not decompress:
+	AString Garbage = MakeTestData(1000, 42);
+	AString Out;
+	testassert(InflateString(Garbage.data(), Garbage.size(), Out) != Z_OK);
+	testassert(UncompressStringGZIP(Garbage.data(), Garbage.size(), Out) != Z_OK);
+
+	LOG("RoundTrip test finished");
+	return 0;
+}
+
+
+
+
@@ -0,0 +1,28 @@
+
+// TestData.cpp
+
+// Implements the generator of the data compressed by the Compression tests and benchmarks
+
+#include "Globals.h"
+#include "TestData.h"
+
+
+
+
+
+AString MakeTestData(size_t a_Size, int a_Seed)
+{
+	AString res;
+	res.reserve(a_Size);
+	unsigned Value = static_cast<unsigned>(a_Seed);
+	for (size_t i = 0; i < a_Size; i++)
+	{
+		Value = Value * 1103515245 + 12345;
+		res.push_back(static_cast<char>(((Value >> 16) % 4 == 0) ? (Value >> 8) : (i % 16)));
+	}
+	return res;
+}
+
+
+
+
@@ -0,0 +1,22 @@
+
+// TestData.h
+
+// Declares the generator of the data compressed by the Compression tests and benchmarks
+
+
+
+
+
+#pragma once
+
+
+
+
+
+/** Returns a_Size bytes of data that is somewhat compressible, similar to packet data.
+The same a_Seed always produces the same data. */
+extern AString MakeTestData(size_t a_Size, int a_Seed);
+
+
+
+
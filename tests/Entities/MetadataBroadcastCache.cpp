@@ -0,0 +1,195 @@
+
+// MetadataBroadcastCache.cpp
+
+// Tests that the metadata broadcasts send only the changed entries, and all of them whenever a client may have missed a change
+
+#include "Globals.h"
+#include "Entities/MetadataBroadcastCache.h"
+
+
+
+
+
+static const int PROTOCOL_A = 47;
+static const int PROTOCOL_B = 5;
+
+
+
+
+
+/** Encodes the entries the way the protocols do: each entry starts with its index, followed by the value */
+static cMetadataBroadcastCache::cEntries MakeEntries(const AString & a_Flags, const AString & a_Name, const AString & a_Health)
+{
+	cMetadataBroadcastCache::cEntries Entries;
+	Entries[0] = AString("\x00", 1) + a_Flags;
+	Entries[2] = "\x02" + a_Name;
+	Entries[6] = "\x06" + a_Health;
+	return Entries;
+}
+
+
+
+
+
+static AString Concat(const cMetadataBroadcastCache::cEntries & a_Entries)
+{
+	AString res;
+	for (cMetadataBroadcastCache::cEntries::const_iterator itr = a_Entries.begin(), end = a_Entries.end(); itr != end; ++itr)
+	{
+		res.append(itr->second);
+	}
+	return res;
+}
+
+
+
+
+
+/** Runs one broadcast the way cChunkMap and the protocols do: each client first asks for the computed changes,
+the first one of each protocol version computes them from the full entries. Returns the changes sent to the clients. */
+static AString Broadcast(cMetadataBroadcastCache & a_Cache, int a_ProtocolVersion, const cMetadataBroadcastCache::cEntries & a_Entries, int a_NumClients, bool a_HasExcludedClient)
+{
+	a_Cache.StartBroadcast();
+	AString FirstChanges;
+	for (int i = 0; i < a_NumClients; i++)
+	{
+		AString Changes;
+		if (!a_Cache.GetBroadcastChanges(a_ProtocolVersion, Changes))
+		{
+			testassert(i == 0);  // Only the first client computes the changes
+			a_Cache.SetBroadcastEntries(a_ProtocolVersion, a_Entries, Changes);
+		}
+		if (i == 0)
+		{
+			FirstChanges = Changes;
+		}
+		testassert(Changes == FirstChanges);  // All the clients get the same changes
+	}
+	if (a_HasExcludedClient)
+	{
+		a_Cache.Invalidate();
+	}
+	return FirstChanges;
+}
+
+
+
+
+
+/** The first broadcast sends everything, the next ones only the changed entries, in index order */
+static void TestChangedEntries(void)
+{
+	cMetadataBroadcastCache Cache;
+	cMetadataBroadcastCache::cEntries Entries = MakeEntries("f", "Name", "20");
+	testassert(Broadcast(Cache, PROTOCOL_A, Entries, 3, false) == Concat(Entries));
+
+	// Nothing changed:
+	testassert(Broadcast(Cache, PROTOCOL_A, Entries, 3, false).empty());
+
+	// A single entry changed:
+	cMetadataBroadcastCache::cEntries Hurt = MakeEntries("f", "Name", "15");
+	testassert(Broadcast(Cache, PROTOCOL_A, Hurt, 3, false) == "\x06" "15");
+
+	// Two entries changed, sent in index order:
+	cMetadataBroadcastCache::cEntries Renamed = MakeEntries("g", "Other", "15");
+	testassert(Broadcast(Cache, PROTOCOL_A, Renamed, 3, false) == AString("\x00" "g", 2) + "\x02" "Other");
+
+	// An entry that appears is sent, too:
+	cMetadataBroadcastCache::cEntries Added = Renamed;
+	Added[10] = "\x0a" "new";
+	testassert(Broadcast(Cache, PROTOCOL_A, Added, 3, false) == "\x0a" "new");
+}
+
+
+
+
+
+/** Each protocol version has its own baseline */
+static void TestProtocolVersions(void)
+{
+	cMetadataBroadcastCache Cache;
+	cMetadataBroadcastCache::cEntries Entries = MakeEntries("f", "Name", "20");
+	testassert(Broadcast(Cache, PROTOCOL_A, Entries, 1, false) == Concat(Entries));
+	testassert(Broadcast(Cache, PROTOCOL_B, Entries, 1, false) == Concat(Entries));
+
+	cMetadataBroadcastCache::cEntries Hurt = MakeEntries("f", "Name", "15");
+	testassert(Broadcast(Cache, PROTOCOL_A, Hurt, 1, false) == "\x06" "15");
+	testassert(Broadcast(Cache, PROTOCOL_B, Hurt, 1, false) == "\x06" "15");
+
+	// Computing the changes again in the same broadcast returns the same changes, the baseline is already updated:
+	cMetadataBroadcastCache::cEntries Healed = MakeEntries("f", "Name", "20");
+	Cache.StartBroadcast();
+	AString Changes1, Changes2;
+	Cache.SetBroadcastEntries(PROTOCOL_A, Healed, Changes1);
+	Cache.SetBroadcastEntries(PROTOCOL_A, Healed, Changes2);
+	testassert(Changes1 == "\x06" "20");
+	testassert(Changes2 == Changes1);
+}
+
+
+
+
+
+/** A broadcast that excludes a client makes the next broadcast send everything, so the excluded client catches up */
+static void TestExcludedClient(void)
+{
+	cMetadataBroadcastCache Cache;
+	cMetadataBroadcastCache::cEntries Entries = MakeEntries("f", "Name", "20");
+	Broadcast(Cache, PROTOCOL_A, Entries, 2, false);
+
+	// The crouching flag is broadcast to everyone but the player's own client:
+	cMetadataBroadcastCache::cEntries Crouched = MakeEntries("c", "Name", "20");
+	testassert(Broadcast(Cache, PROTOCOL_A, Crouched, 2, true) == AString("\x00" "c", 2));
+
+	// The next broadcast sends all the entries, including the flags the excluded client has missed:
+	cMetadataBroadcastCache::cEntries Hurt = MakeEntries("c", "Name", "15");
+	testassert(Broadcast(Cache, PROTOCOL_A, Hurt, 2, false) == Concat(Hurt));
+
+	// And the one after that only the changes again:
+	cMetadataBroadcastCache::cEntries Healed = MakeEntries("c", "Name", "20");
+	testassert(Broadcast(Cache, PROTOCOL_A, Healed, 2, false) == "\x06" "20");
+}
+
+
+
+
+
+/** The full metadata sent to a single client invalidates the baseline only if it differs from the last broadcast */
+static void TestSentFull(void)
+{
+	cMetadataBroadcastCache Cache;
+	cMetadataBroadcastCache::cEntries Entries = MakeEntries("f", "Name", "20");
+	Broadcast(Cache, PROTOCOL_A, Entries, 2, false);
+
+	// Spawning the entity for a new client with the broadcast state keeps the baseline:
+	Cache.SentFull(PROTOCOL_A, Entries);
+	cMetadataBroadcastCache::cEntries Hurt = MakeEntries("f", "Name", "15");
+	testassert(Broadcast(Cache, PROTOCOL_A, Hurt, 3, false) == "\x06" "15");
+
+	// Spawning it with a state that hasn't been broadcast makes the next broadcast send everything:
+	cMetadataBroadcastCache::cEntries Renamed = MakeEntries("f", "Other", "15");
+	Cache.SentFull(PROTOCOL_A, Renamed);
+	testassert(Broadcast(Cache, PROTOCOL_A, Renamed, 3, false) == Concat(Renamed));
+
+	// The other protocol versions are unaffected:
+	Cache.SentFull(PROTOCOL_B, Renamed);
+	Broadcast(Cache, PROTOCOL_B, Renamed, 1, false);
+	testassert(Broadcast(Cache, PROTOCOL_B, Renamed, 1, false).empty());
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	TestChangedEntries();
+	TestProtocolVersions();
+	TestExcludedClient();
+	TestSentFull();
+	return 0;
+}
+
+
+
+
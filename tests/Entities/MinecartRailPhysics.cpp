@@ -0,0 +1,482 @@
+
+// MinecartRailPhysics.cpp
+
+// Tests the minecart rail physics over fixture chunks: the rail and collision blocks are read through the cart's chunk
+// and its neighbors, and the cart moves the same way on each run
+
+#include "Globals.h"
+#include "ChunkData.h"
+#include "Entities/MinecartRailPhysics.h"
+#include "Blocks/BlockHandler.h"
+
+
+
+
+
+/** The rail physics only needs cBlockInfo's solidity flags, not the block handlers */
+cBlockHandler * cBlockHandler::CreateBlockHandler(BLOCKTYPE a_BlockType)
+{
+	UNUSED(a_BlockType);
+	return nullptr;
+}
+
+
+
+
+
+/** Length of a tick, as used by cWorld */
+static const std::chrono::milliseconds TICK_LENGTH(50);
+
+/** The Y coord of the rails in the fixtures */
+static const int RAIL_Y = 64;
+
+
+
+
+
+class cFixtureAllocationPool :
+	public cAllocationPool<cChunkData::sChunkSection>
+{
+public:
+	virtual cChunkData::sChunkSection * Allocate() override
+	{
+		return new cChunkData::sChunkSection();
+	}
+
+	virtual void Free(cChunkData::sChunkSection * a_Ptr) override
+	{
+		delete a_Ptr;
+	}
+} ;
+
+
+
+
+
+class cFixtureWorld;
+
+
+
+
+
+/** A chunk of the fixture world, providing the cChunk accessors used by the rail physics over a cChunkData.
+Counts the blocks read, so that the tests can check that the reads go through the chunks. */
+class cFixtureChunk
+{
+public:
+	cFixtureChunk(cFixtureWorld & a_World, int a_ChunkX, int a_ChunkZ, cAllocationPool<cChunkData::sChunkSection> & a_Pool) :
+		m_World(a_World),
+		m_ChunkX(a_ChunkX),
+		m_ChunkZ(a_ChunkZ),
+		m_Data(a_Pool),
+		m_NumReads(0)
+	{
+	}
+
+	int GetPosX(void) const { return m_ChunkX; }
+	int GetPosZ(void) const { return m_ChunkZ; }
+
+	void GetBlockTypeMeta(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE & a_BlockType, NIBBLETYPE & a_BlockMeta)
+	{
+		m_NumReads += 1;
+		a_BlockType = m_Data.GetBlock(a_RelX, a_RelY, a_RelZ);
+		a_BlockMeta = m_Data.GetMeta(a_RelX, a_RelY, a_RelZ);
+	}
+
+	/** Same as cChunk::UnboundedRelGetBlockType(), reads the block from a neighbor chunk if the coords are outside this one */
+	bool UnboundedRelGetBlockType(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE & a_BlockType);
+
+	cChunkData & GetData(void) { return m_Data; }
+	int GetNumReads(void) const { return m_NumReads; }
+
+protected:
+	cFixtureWorld & m_World;
+	int m_ChunkX, m_ChunkZ;
+	cChunkData m_Data;
+	int m_NumReads;
+} ;
+
+
+
+
+
+/** A fixed square of fixture chunks, with the chunk coords from 0 to NUM_CHUNKS - 1 */
+class cFixtureWorld
+{
+public:
+	static const int NUM_CHUNKS = 3;
+
+	cFixtureWorld(void)
+	{
+		for (int z = 0; z < NUM_CHUNKS; z++)
+		{
+			for (int x = 0; x < NUM_CHUNKS; x++)
+			{
+				m_Chunks.push_back(std::make_shared<cFixtureChunk>(*this, x, z, m_Pool));
+			}
+		}
+	}
+
+	/** Returns the chunk with the specified chunk coords, or nullptr if outside the fixture */
+	cFixtureChunk * GetChunk(int a_ChunkX, int a_ChunkZ)
+	{
+		if ((a_ChunkX < 0) || (a_ChunkX >= NUM_CHUNKS) || (a_ChunkZ < 0) || (a_ChunkZ >= NUM_CHUNKS))
+		{
+			return nullptr;
+		}
+		return m_Chunks[static_cast<size_t>(a_ChunkX + a_ChunkZ * NUM_CHUNKS)].get();
+	}
+
+	/** Returns the chunk containing the specified block */
+	cFixtureChunk & GetChunkAt(int a_BlockX, int a_BlockZ)
+	{
+		cFixtureChunk * Chunk = GetChunk(a_BlockX / cChunkDef::Width, a_BlockZ / cChunkDef::Width);
+		testassert(Chunk != nullptr);
+		return *Chunk;
+	}
+
+	void SetBlock(int a_BlockX, int a_BlockY, int a_BlockZ, BLOCKTYPE a_BlockType, NIBBLETYPE a_BlockMeta)
+	{
+		cChunkData & Data = GetChunkAt(a_BlockX, a_BlockZ).GetData();
+		Data.SetBlock(a_BlockX % cChunkDef::Width, a_BlockY, a_BlockZ % cChunkDef::Width, a_BlockType);
+		Data.SetMeta(a_BlockX % cChunkDef::Width, a_BlockY, a_BlockZ % cChunkDef::Width, a_BlockMeta);
+	}
+
+	NIBBLETYPE GetBlockMeta(int a_BlockX, int a_BlockY, int a_BlockZ)
+	{
+		return GetChunkAt(a_BlockX, a_BlockZ).GetData().GetMeta(a_BlockX % cChunkDef::Width, a_BlockY, a_BlockZ % cChunkDef::Width);
+	}
+
+	/** Returns the total number of blocks read through the chunks */
+	int GetNumReads(void) const
+	{
+		int res = 0;
+		for (const auto & Chunk: m_Chunks)
+		{
+			res += Chunk->GetNumReads();
+		}
+		return res;
+	}
+
+protected:
+	cFixtureAllocationPool m_Pool;
+	std::vector<std::shared_ptr<cFixtureChunk>> m_Chunks;
+} ;
+
+
+
+
+
+bool cFixtureChunk::UnboundedRelGetBlockType(int a_RelX, int a_RelY, int a_RelZ, BLOCKTYPE & a_BlockType)
+{
+	if ((a_RelY < 0) || (a_RelY >= cChunkDef::Height))
+	{
+		return false;
+	}
+	int ChunkX = m_ChunkX, ChunkZ = m_ChunkZ;
+	while (a_RelX < 0)
+	{
+		a_RelX += cChunkDef::Width;
+		ChunkX -= 1;
+	}
+	while (a_RelX >= cChunkDef::Width)
+	{
+		a_RelX -= cChunkDef::Width;
+		ChunkX += 1;
+	}
+	while (a_RelZ < 0)
+	{
+		a_RelZ += cChunkDef::Width;
+		ChunkZ -= 1;
+	}
+	while (a_RelZ >= cChunkDef::Width)
+	{
+		a_RelZ -= cChunkDef::Width;
+		ChunkZ += 1;
+	}
+	cFixtureChunk * Chunk = m_World.GetChunk(ChunkX, ChunkZ);
+	if (Chunk == nullptr)
+	{
+		return false;
+	}
+	Chunk->m_NumReads += 1;
+	a_BlockType = Chunk->m_Data.GetBlock(a_RelX, a_RelY, a_RelZ);
+	return true;
+}
+
+
+
+
+
+/** A minecart providing the cEntity accessors used by the rail physics, with no entities around to collide with */
+class cFixtureCart
+{
+public:
+	typedef cMinecartRailPhysics<cFixtureCart, cFixtureChunk> cRailPhysics;
+
+	cFixtureCart(cFixtureWorld & a_World, double a_PosX, double a_PosY, double a_PosZ) :
+		m_World(a_World),
+		m_Pos(a_PosX, a_PosY, a_PosZ),
+		m_Yaw(0),
+		m_NumDetectorRailsPowered(0)
+	{
+	}
+
+	/** Moves the cart for one tick, the way cMinecart::HandlePhysics() does while the cart is on a rail.
+	Returns the type of the rail the cart was moved along, E_BLOCK_AIR if it is not on a rail. */
+	BLOCKTYPE Tick(void)
+	{
+		return cRailPhysics::MoveAlongRail(*this, TICK_LENGTH, m_World.GetChunkAt(FloorC(m_Pos.x), FloorC(m_Pos.z)));
+	}
+
+	double GetPosX(void) const { return m_Pos.x; }
+	double GetPosY(void) const { return m_Pos.y; }
+	double GetPosZ(void) const { return m_Pos.z; }
+	void SetPosX(double a_PosX) { m_Pos.x = a_PosX; }
+	void SetPosY(double a_PosY) { m_Pos.y = a_PosY; }
+	void SetPosZ(double a_PosZ) { m_Pos.z = a_PosZ; }
+	void SetPosition(double a_PosX, double a_PosY, double a_PosZ) { m_Pos.Set(a_PosX, a_PosY, a_PosZ); }
+	void AddPosition(const Vector3d & a_AddPos) { m_Pos += a_AddPos; }
+	void AddPosY(double a_AddPosY) { m_Pos.y += a_AddPosY; }
+
+	const Vector3d & GetSpeed(void) const { return m_Speed; }
+	double GetSpeedX(void) const { return m_Speed.x; }
+	double GetSpeedY(void) const { return m_Speed.y; }
+	double GetSpeedZ(void) const { return m_Speed.z; }
+	void SetSpeed(double a_SpeedX, double a_SpeedY, double a_SpeedZ) { m_Speed.Set(a_SpeedX, a_SpeedY, a_SpeedZ); }
+	void SetSpeedX(double a_SpeedX) { m_Speed.x = a_SpeedX; }
+	void SetSpeedY(double a_SpeedY) { m_Speed.y = a_SpeedY; }
+	void SetSpeedZ(double a_SpeedZ) { m_Speed.z = a_SpeedZ; }
+	void AddSpeedX(double a_AddSpeedX) { m_Speed.x += a_AddSpeedX; }
+	void AddSpeedZ(double a_AddSpeedZ) { m_Speed.z += a_AddSpeedZ; }
+
+	void SetYaw(double a_Yaw) { m_Yaw = a_Yaw; }
+	double GetYaw(void) const { return m_Yaw; }
+
+	// Same size as cMinecart:
+	double GetWidth(void) const { return 1; }
+	double GetHeight(void) const { return 0.9; }
+
+	bool TestEntityCollision(NIBBLETYPE a_RailMeta, cFixtureChunk & a_Chunk)
+	{
+		UNUSED(a_RailMeta);
+		UNUSED(a_Chunk);
+		return false;
+	}
+
+	void PowerDetectorRail(NIBBLETYPE a_RailMeta, cFixtureChunk & a_Chunk)
+	{
+		// The rail must be in the chunk the cart was handed:
+		int RelX = FloorC(m_Pos.x) - a_Chunk.GetPosX() * cChunkDef::Width;
+		int RelZ = FloorC(m_Pos.z) - a_Chunk.GetPosZ() * cChunkDef::Width;
+		testassert((RelX >= 0) && (RelX < cChunkDef::Width) && (RelZ >= 0) && (RelZ < cChunkDef::Width));
+		a_Chunk.GetData().SetMeta(RelX, FloorC(m_Pos.y), RelZ, a_RailMeta | 0x08);
+		m_NumDetectorRailsPowered += 1;
+	}
+
+	int GetNumDetectorRailsPowered(void) const { return m_NumDetectorRailsPowered; }
+
+protected:
+	cFixtureWorld & m_World;
+	Vector3d m_Pos;
+	Vector3d m_Speed;
+	double m_Yaw;
+	int m_NumDetectorRailsPowered;
+} ;
+
+
+
+
+
+/** Lays a straight east-west rail from a_FromX to a_ToX (inclusive) at the specified Z, on top of a stone floor */
+static void LayRailX(cFixtureWorld & a_World, int a_FromX, int a_ToX, int a_Z)
+{
+	for (int x = a_FromX; x <= a_ToX; x++)
+	{
+		a_World.SetBlock(x, RAIL_Y - 1, a_Z, E_BLOCK_STONE, 0);
+		a_World.SetBlock(x, RAIL_Y, a_Z, E_BLOCK_RAIL, E_META_RAIL_XM_XP);
+	}
+}
+
+
+
+
+
+/** A cart pushed along a straight rail slows down by the same amount each tick, and travels the same distance on each run */
+static void TestStraightRail(void)
+{
+	double FinalPosX[2];
+	for (int run = 0; run < 2; run++)
+	{
+		cFixtureWorld World;
+		LayRailX(World, 0, 47, 8);
+		cFixtureCart Cart(World, 1.5, RAIL_Y, 8.2);
+		Cart.SetSpeed(8, 0, 0);
+
+		for (int i = 0; i < 20; i++)
+		{
+			double SpeedBefore = Cart.GetSpeedX();
+			testassert(Cart.Tick() == E_BLOCK_RAIL);
+			testassert(std::abs(Cart.GetSpeedX() - (SpeedBefore - 0.1)) < 1e-9);
+			testassert(Cart.GetPosZ() == 8.5);  // Snapped to the rail's axis
+			testassert(Cart.GetPosY() == RAIL_Y + 0.55);
+			testassert(Cart.GetYaw() == 180);
+		}
+		FinalPosX[run] = Cart.GetPosX();
+	}
+
+	// 20 ticks, the speed goes from 7.9 down to 6.0 blocks per second:
+	double ExpectedDistance = (7.9 + 6.0) / 2 * 20 * 0.05;
+	testassert(std::abs(FinalPosX[0] - (1.5 + ExpectedDistance)) < 1e-6);
+	testassert(FinalPosX[0] == FinalPosX[1]);
+}
+
+
+
+
+
+/** A cart running against a solid block stops in front of it, even if the block is in the neighboring chunk */
+static void TestBlockCollisionAcrossChunks(void)
+{
+	cFixtureWorld World;
+	LayRailX(World, 0, 15, 8);
+	World.SetBlock(16, RAIL_Y, 8, E_BLOCK_STONE, 0);  // First block of chunk [1, 0]
+	cFixtureCart Cart(World, 5.5, RAIL_Y, 8.5);
+	Cart.SetSpeed(8, 0, 0);
+
+	for (int i = 0; i < 100; i++)
+	{
+		// The cart never leaves chunk [0, 0], the stone is only ever read through its neighbor:
+		testassert(Cart.GetPosX() < cChunkDef::Width);
+		Cart.Tick();
+	}
+	testassert(Cart.GetSpeedX() == 0);
+	testassert(std::abs(Cart.GetPosX() - 15.4) < 1e-9);
+	testassert(World.GetChunk(1, 0)->GetNumReads() > 0);
+}
+
+
+
+
+
+/** A cart going east into a curve that ends pointing south turns south on the curve's axis */
+static void TestCurve(void)
+{
+	cFixtureWorld World;
+	LayRailX(World, 0, 19, 14);
+	World.SetBlock(20, RAIL_Y - 1, 14, E_BLOCK_STONE, 0);
+	World.SetBlock(20, RAIL_Y, 14, E_BLOCK_RAIL, E_META_RAIL_CURVED_ZP_XM);
+	for (int z = 15; z < 40; z++)
+	{
+		World.SetBlock(20, RAIL_Y - 1, z, E_BLOCK_STONE, 0);
+		World.SetBlock(20, RAIL_Y, z, E_BLOCK_RAIL, E_META_RAIL_ZM_ZP);
+	}
+	cFixtureCart Cart(World, 14.5, RAIL_Y, 14.5);
+	Cart.SetSpeed(8, 0, 0);
+
+	bool HasTurned = false;
+	for (int i = 0; i < 60; i++)
+	{
+		Cart.Tick();
+		if (Cart.GetSpeedZ() > 0)
+		{
+			HasTurned = true;
+		}
+	}
+	testassert(HasTurned);
+	testassert(Cart.GetPosX() == 20.5);
+	testassert(Cart.GetSpeedX() == 0);
+	testassert(Cart.GetPosZ() > cChunkDef::Width);  // Has gone on into chunk [1, 1]
+	testassert(Cart.GetYaw() == 270);
+}
+
+
+
+
+
+/** Unpowered powered rails brake the cart, powered ones speed it up */
+static void TestPoweredRail(void)
+{
+	cFixtureWorld World;
+	LayRailX(World, 0, 47, 8);
+	World.SetBlock(10, RAIL_Y, 8, E_BLOCK_POWERED_RAIL, E_META_RAIL_XM_XP);
+	World.SetBlock(20, RAIL_Y, 8, E_BLOCK_POWERED_RAIL, E_META_RAIL_XM_XP | 0x08);
+
+	cFixtureCart Cart(World, 10.5, RAIL_Y, 8.5);
+	Cart.SetSpeed(5, 0, 0);
+	testassert(Cart.Tick() == E_BLOCK_POWERED_RAIL);
+	testassert(Cart.GetSpeedX() == 3);
+
+	cFixtureCart Cart2(World, 20.5, RAIL_Y, 8.5);
+	Cart2.SetSpeed(5, 0, 0);
+	testassert(Cart2.Tick() == E_BLOCK_POWERED_RAIL);
+	testassert(Cart2.GetSpeedX() == 6);
+}
+
+
+
+
+
+/** A cart passing a detector rail powers it once, in the chunk containing it */
+static void TestDetectorRail(void)
+{
+	cFixtureWorld World;
+	LayRailX(World, 0, 47, 8);
+	World.SetBlock(17, RAIL_Y, 8, E_BLOCK_DETECTOR_RAIL, E_META_RAIL_XM_XP);
+	cFixtureCart Cart(World, 12.5, RAIL_Y, 8.5);
+	Cart.SetSpeed(8, 0, 0);
+
+	int NumTicksOnDetector = 0;
+	for (int i = 0; i < 40; i++)
+	{
+		if (Cart.Tick() == E_BLOCK_DETECTOR_RAIL)
+		{
+			NumTicksOnDetector += 1;
+		}
+	}
+	testassert(NumTicksOnDetector > 1);
+	testassert(Cart.GetNumDetectorRailsPowered() == 1);
+	testassert(World.GetBlockMeta(17, RAIL_Y, 8) == (E_META_RAIL_XM_XP | 0x08));
+	testassert(Cart.GetPosX() > 18);
+}
+
+
+
+
+
+/** A cart that has sunk below a flat rail is pushed back up onto it */
+static void TestPushUpOntoRail(void)
+{
+	cFixtureWorld World;
+	LayRailX(World, 0, 47, 8);
+	cFixtureCart Cart(World, 5.5, RAIL_Y - 1 + 0.8, 8.5);
+	Cart.SetSpeed(2, 0, 0);
+	testassert(Cart.Tick() == E_BLOCK_RAIL);
+	testassert(Cart.GetPosY() == RAIL_Y + 0.55);
+
+	// Off the rails, the cart is left to the generic entity physics:
+	cFixtureCart OffRail(World, 5.5, RAIL_Y + 3, 8.5);
+	OffRail.SetSpeed(2, 0, 0);
+	testassert(OffRail.Tick() == E_BLOCK_AIR);
+	testassert(OffRail.GetPosX() == 5.5);
+	testassert(World.GetNumReads() > 0);
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	TestStraightRail();
+	TestBlockCollisionAcrossChunks();
+	TestCurve();
+	TestPoweredRail();
+	TestDetectorRail();
+	TestPushUpOntoRail();
+	return 0;
+}
+
+
+
+
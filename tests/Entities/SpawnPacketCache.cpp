@@ -0,0 +1,316 @@
+
+// SpawnPacketCache.cpp
+
+// Tests that the cached spawn packets are rebuilt after every change of the entity state that they encode,
+// and that the spawn packets captured from the protocol are framed the same way as the sent ones
+
+#include "Globals.h"
+#include "Entities/SpawnPacketCache.h"
+#include "Protocol/PacketFraming.h"
+#include "Protocol/SpawnPacketCapture.h"
+#include "StringCompression.h"
+
+
+
+
+
+static const int PROTOCOL_A = 47;
+static const int PROTOCOL_B = 5;
+
+class cTestProtocol;
+
+
+
+
+
+/** A minimal entity that uses the cache the same way cEntity does:
+the spawn packets encode the entity's state, the metadata setters invalidate the cache. */
+class cTestEntity
+{
+public:
+	cTestEntity(void) :
+		m_Pos(1, 2, 3),
+		m_HeadYaw(0),
+		m_Health(20),
+		m_IsSheared(false),
+		m_NumSpawned(0)
+	{
+	}
+
+	/** The metadata setter, invalidates the cached packets the same way the entities' setters do */
+	void SetSheared(bool a_IsSheared)
+	{
+		m_IsSheared = a_IsSheared;
+		m_Cache.Invalidate();
+	}
+
+	bool GetCachedSpawnPackets(int a_ProtocolVersion, AString & a_Packets) const
+	{
+		return m_Cache.Get(a_ProtocolVersion, cSpawnPacketCache::sState(m_Pos, m_Rot, m_Speed, m_HeadYaw, m_Health), a_Packets);
+	}
+
+	void SetCachedSpawnPackets(int a_ProtocolVersion, const AString & a_Packets)
+	{
+		m_Cache.Set(a_ProtocolVersion, cSpawnPacketCache::sState(m_Pos, m_Rot, m_Speed, m_HeadYaw, m_Health), a_Packets);
+	}
+
+	/** Sends the spawn packets through the protocol, same as the entities do through their client handle */
+	void SpawnOn(cTestProtocol & a_Protocol);
+
+	Vector3d m_Pos, m_Rot, m_Speed;
+	double m_HeadYaw;
+	int m_Health;
+	bool m_IsSheared;
+
+	/** Number of times the spawn packets were built instead of taken from the cache */
+	int m_NumSpawned;
+
+protected:
+	cSpawnPacketCache m_Cache;
+} ;
+
+typedef std::vector<cTestEntity *> cTestEntities;
+
+
+
+
+
+/** A protocol that routes its output through cSpawnPacketCapture the same way cProtocol180 does.
+Whatever isn't captured is "sent" by framing it into m_Sent. */
+class cTestProtocol
+{
+public:
+	cTestProtocol(int a_ProtocolVersion) :
+		m_ProtocolVersion(a_ProtocolVersion)
+	{
+	}
+
+	void SendSpawnEntities(const cTestEntities & a_Entities)
+	{
+		AString Batch;
+		m_SpawnPacketCapture.BuildBatch(a_Entities, m_ProtocolVersion, *this, Batch);
+		if (!Batch.empty())
+		{
+			SendData(Batch.data(), Batch.size());
+		}
+	}
+
+	void SendData(const char * a_Data, size_t a_Size)
+	{
+		if (m_SpawnPacketCapture.CaptureData(a_Data, a_Size))
+		{
+			return;
+		}
+		m_Sent.append(a_Data, a_Size);
+	}
+
+	void SendPacket(const AString & a_Packet)
+	{
+		if (m_SpawnPacketCapture.CapturePacket(a_Packet))
+		{
+			return;
+		}
+		m_Sent.append(Frame(a_Packet));
+	}
+
+	/** Frames the packet the way the packet workers do, the captured packets must use the same framing */
+	static AString Frame(const AString & a_Packet)
+	{
+		AString res;
+		testassert(FrameCompressedPacket(a_Packet, res));
+		return res;
+	}
+
+	int m_ProtocolVersion;
+
+	/** All the framed data sent to the client */
+	AString m_Sent;
+
+protected:
+	cSpawnPacketCapture m_SpawnPacketCapture;
+} ;
+
+
+
+
+
+void cTestEntity::SpawnOn(cTestProtocol & a_Protocol)
+{
+	m_NumSpawned += 1;
+	a_Protocol.SendPacket(Printf("proto %d: pos {%.1f, %.1f, %.1f}, health %d, sheared %d",
+		a_Protocol.m_ProtocolVersion, m_Pos.x, m_Pos.y, m_Pos.z, m_Health, m_IsSheared ? 1 : 0
+	));
+
+	// A packet over the compression threshold, such as the one with the metadata of a named mob:
+	a_Protocol.SendPacket(AString(300, m_IsSheared ? 's' : 'w'));
+}
+
+
+
+
+
+/** Reads a VarInt from a_Data at a_Pos, advances a_Pos past it */
+static UInt32 ReadVarInt(const AString & a_Data, size_t & a_Pos)
+{
+	UInt32 res = 0;
+	int Shift = 0;
+	Byte b;
+	do
+	{
+		testassert(a_Pos < a_Data.size());
+		b = static_cast<Byte>(a_Data[a_Pos++]);
+		res |= static_cast<UInt32>(b & 0x7f) << Shift;
+		Shift += 7;
+	} while ((b & 0x80) != 0);
+	return res;
+}
+
+
+
+
+
+/** Parses the framed data back into the packets, decompressing the compressed ones */
+static AStringVector Unframe(const AString & a_Framed)
+{
+	AStringVector res;
+	size_t Pos = 0;
+	while (Pos < a_Framed.size())
+	{
+		size_t PacketLen = ReadVarInt(a_Framed, Pos);
+		size_t End = Pos + PacketLen;
+		testassert(End <= a_Framed.size());
+		size_t DataLen = ReadVarInt(a_Framed, Pos);
+		if (DataLen == 0)
+		{
+			res.push_back(a_Framed.substr(Pos, End - Pos));
+		}
+		else
+		{
+			AString Uncompressed;
+			testassert(UncompressString(a_Framed.data() + Pos, End - Pos, Uncompressed, DataLen) == Z_OK);
+			testassert(Uncompressed.size() == DataLen);
+			res.push_back(Uncompressed);
+		}
+		Pos = End;
+	}
+	return res;
+}
+
+
+
+
+
+/** Returns the spawn packets of the entity, as sent by a new client of the protocol version */
+static AStringVector SpawnForNewClient(cTestEntity & a_Entity, int a_ProtocolVersion)
+{
+	cTestProtocol Protocol(a_ProtocolVersion);
+	cTestEntities Entities;
+	Entities.push_back(&a_Entity);
+	Protocol.SendSpawnEntities(Entities);
+	return Unframe(Protocol.m_Sent);
+}
+
+
+
+
+
+/** The cache is reused by the clients of the same protocol version, until the entity changes */
+static void TestCacheReuse(void)
+{
+	cTestEntity Entity;
+
+	// The second client reuses the packets built for the first one:
+	AStringVector First = SpawnForNewClient(Entity, PROTOCOL_A);
+	testassert(First.size() == 2);
+	testassert(First[0].find("sheared 0") != AString::npos);
+	testassert(First[1] == AString(300, 'w'));
+	testassert(SpawnForNewClient(Entity, PROTOCOL_A) == First);
+	testassert(Entity.m_NumSpawned == 1);
+
+	// Changing a metadata flag makes the next spawn packet carry the new flag:
+	Entity.SetSheared(true);
+	AStringVector Sheared = SpawnForNewClient(Entity, PROTOCOL_A);
+	testassert(Entity.m_NumSpawned == 2);
+	testassert(Sheared[0].find("sheared 1") != AString::npos);
+	testassert(Sheared[1] == AString(300, 's'));
+	testassert(SpawnForNewClient(Entity, PROTOCOL_A) == Sheared);
+	testassert(Entity.m_NumSpawned == 2);
+
+	// Moving or losing health is detected without any invalidation:
+	Entity.m_Pos.x += 1;
+	testassert(SpawnForNewClient(Entity, PROTOCOL_A)[0].find("pos {2.0, 2.0, 3.0}") != AString::npos);
+	testassert(Entity.m_NumSpawned == 3);
+	Entity.m_Health -= 1;
+	testassert(SpawnForNewClient(Entity, PROTOCOL_A)[0].find("health 19") != AString::npos);
+	testassert(Entity.m_NumSpawned == 4);
+
+	// A client of a different protocol version doesn't get the other version's packets:
+	testassert(SpawnForNewClient(Entity, PROTOCOL_B)[0].find("proto 5:") == 0);
+	testassert(Entity.m_NumSpawned == 5);
+	testassert(SpawnForNewClient(Entity, PROTOCOL_A)[0].find("proto 47:") == 0);
+	testassert(Entity.m_NumSpawned == 6);
+}
+
+
+
+
+
+/** The batch sent from the capture and the cache is byte-for-byte the same as the packets sent one by one,
+and the protocol sends normally again once the batch is built */
+static void TestCapturedFraming(void)
+{
+	cTestEntity Entity1, Entity2;
+	Entity2.m_Pos.y = 64;
+	Entity2.SetSheared(true);
+	cTestEntities Entities;
+	Entities.push_back(&Entity1);
+	Entities.push_back(&Entity2);
+
+	// The packets as they would be sent without any capturing:
+	cTestProtocol Direct(PROTOCOL_A);
+	Entity1.SpawnOn(Direct);
+	Entity2.SpawnOn(Direct);
+
+	// Built by capturing, then from the cache:
+	cTestProtocol Captured(PROTOCOL_A);
+	Captured.SendSpawnEntities(Entities);
+	testassert(Captured.m_Sent == Direct.m_Sent);
+	cTestProtocol Cached(PROTOCOL_A);
+	Cached.SendSpawnEntities(Entities);
+	testassert(Cached.m_Sent == Direct.m_Sent);
+	testassert(Entity1.m_NumSpawned == 2);
+	testassert(Entity2.m_NumSpawned == 2);
+
+	// Only one entity changed, the other one still comes from the cache:
+	Entity1.SetSheared(true);
+	cTestProtocol Partial(PROTOCOL_A);
+	Partial.SendSpawnEntities(Entities);
+	testassert(Entity1.m_NumSpawned == 3);
+	testassert(Entity2.m_NumSpawned == 2);
+	AStringVector Packets = Unframe(Partial.m_Sent);
+	testassert(Packets.size() == 4);
+	testassert(Packets[1] == AString(300, 's'));
+	testassert(Packets[2].find("pos {1.0, 64.0, 3.0}") != AString::npos);
+
+	// Once the batch is done, the packets are sent again instead of captured:
+	Partial.SendPacket("after");
+	Packets = Unframe(Partial.m_Sent);
+	testassert(Packets.size() == 5);
+	testassert(Packets[4] == "after");
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	TestCacheReuse();
+	TestCapturedFraming();
+	LOG("SpawnPacketCache test finished.");
+	return 0;
+}
+
+
+
+
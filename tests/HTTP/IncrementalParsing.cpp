@@ -0,0 +1,351 @@
+
+// IncrementalParsing.cpp
+
+// Implements a test of the HTTP request, multipart and name-value parsers, feeding them the data split at every possible position, and of the form parser
+
+#include "Globals.h"
+#include "HTTPServer/HTTPMessage.h"
+#include "HTTPServer/MultipartParser.h"
+#include "HTTPServer/NameValueParser.h"
+#include "HTTPServer/HTTPFormParser.h"
+
+
+
+
+
+static const char TEST_REQUEST[] =
+	"\r\n"
+	"POST /webadmin/files?a=b HTTP/1.1\r\n"
+	"Host: localhost\r\n"
+	"Authorization: Basic dXNlcjpwYXNz\r\n"
+	"Connection: keep-alive\r\n"
+	"Content-Type:\tmultipart/form-data; boundary=XyZ\r\n"
+	"Content-Length: 123\r\n"
+	"\r\n"
+	"BodyData";
+
+/** Number of bytes of TEST_REQUEST that belong to the request header, the rest is the body */
+static const size_t TEST_REQUEST_HEADER_SIZE = sizeof(TEST_REQUEST) - 1 - 8;
+
+static const char TEST_MULTIPART[] =
+	"preamble\r\n"
+	"--XyZ\r\n"
+	"Content-Disposition: form-data; name=\"first\"\r\n"
+	"\r\n"
+	"value1\r\n"
+	"--XyZ\r\n"
+	"Content-Disposition: form-data; name=\"second\"\r\n"
+	"Content-Type: text/plain\r\n"
+	"\r\n"
+	"line1\r\n"
+	"--XyZnot a boundary\r\n"
+	"line3\r\n"
+	"--XyZ--\r\n";
+
+static const char TEST_NAME_VALUE[] = "   Name1=Value1;Name2 = Value 2; Name3 =\"Value 3\"; Name4 =\'Value 4\'; Name5=\"Confusing; isn\'t it?\"; Name6";
+
+
+
+
+
+/** Feeds the request data to the parser in chunks whose boundaries are given in a_Splits.
+Returns the total number of bytes consumed, or AString::npos on error. */
+static size_t ParseRequest(cHTTPRequest & a_Request, const AString & a_Data, const std::vector<size_t> & a_Splits)
+{
+	size_t Start = 0;
+	size_t Consumed = 0;
+	for (size_t i = 0; i <= a_Splits.size(); i++)
+	{
+		size_t End = (i < a_Splits.size()) ? a_Splits[i] : a_Data.size();
+		size_t res = a_Request.ParseHeaders(a_Data.data() + Start, End - Start);
+		if (res == AString::npos)
+		{
+			return AString::npos;
+		}
+		Consumed += res;
+		if (!a_Request.IsInHeaders())
+		{
+			return Consumed;
+		}
+		testassert(res == End - Start);  // While in headers, all the data must be consumed
+		Start = End;
+	}
+	return Consumed;
+}
+
+
+
+
+
+static void CheckRequest(const std::vector<size_t> & a_Splits)
+{
+	cHTTPRequest Request;
+	size_t Consumed = ParseRequest(Request, TEST_REQUEST, a_Splits);
+	testassert(Consumed == TEST_REQUEST_HEADER_SIZE);
+	testassert(!Request.IsInHeaders());
+	testassert(Request.GetMethod() == "POST");
+	testassert(Request.GetURL() == "/webadmin/files?a=b");
+	testassert(Request.GetBareURL() == "/webadmin/files");
+	testassert(Request.HasAuth());
+	testassert(Request.GetAuthUsername() == "user");
+	testassert(Request.GetAuthPassword() == "pass");
+	testassert(Request.DoesAllowKeepAlive());
+	testassert(Request.GetContentType() == "multipart/form-data; boundary=XyZ");
+	testassert(Request.GetContentLength() == 123);
+}
+
+
+
+
+
+/** Parses the request whole, split at every single position and byte by byte, the results must be the same. */
+static void TestRequestSplits(void)
+{
+	LOG("Testing the request parsing...");
+	AString Data(TEST_REQUEST);
+	std::vector<size_t> Splits;
+	CheckRequest(Splits);
+	for (size_t i = 1; i < Data.size(); i++)
+	{
+		Splits.assign(1, i);
+		CheckRequest(Splits);
+	}
+	Splits.clear();
+	for (size_t i = 1; i < Data.size(); i++)
+	{
+		Splits.push_back(i);
+	}
+	CheckRequest(Splits);
+}
+
+
+
+
+
+/** Malformed and oversized requests must be reported as errors, no matter how they are split. */
+static void TestRequestErrors(void)
+{
+	LOG("Testing the request errors...");
+	const char * Invalid[] =
+	{
+		"GET /\r\n\r\n",
+		"GET / HTTP/2.0\r\n\r\n",
+		"GET  / HTTP/1.1\r\n\r\n",
+		"GET / HTTP/1.1\n\r\n",
+		"GET / HTTP/1.1\r\n: value\r\n\r\n",
+		"GET / HTTP/1.1\r\nKey: value\n\r\n",
+	};
+	for (size_t i = 0; i < ARRAYCOUNT(Invalid); i++)
+	{
+		cHTTPRequest Whole;
+		testassert(ParseRequest(Whole, Invalid[i], std::vector<size_t>()) == AString::npos);
+		std::vector<size_t> Splits;
+		for (size_t j = 1; j < strlen(Invalid[i]); j++)
+		{
+			Splits.push_back(j);
+		}
+		cHTTPRequest ByteByByte;
+		testassert(ParseRequest(ByteByByte, Invalid[i], Splits) == AString::npos);
+	}
+
+	// Request line too long, even if it never ends:
+	AString LongLine("GET /");
+	LongLine.append(cHTTPRequest::MAX_REQUEST_LINE_LENGTH, 'a');
+	cHTTPRequest LongRequest;
+	std::vector<size_t> Splits;
+	for (size_t i = 1024; i < LongLine.size(); i += 1024)
+	{
+		Splits.push_back(i);
+	}
+	testassert(ParseRequest(LongRequest, LongLine, Splits) == AString::npos);
+
+	// Headers too long, even if they never end:
+	AString LongHeaders("GET / HTTP/1.1\r\n");
+	while (LongHeaders.size() <= cEnvelopeParser::MAX_ENVELOPE_SIZE + 100)
+	{
+		LongHeaders.append("X-Padding: 0123456789012345678901234567890123456789\r\n");
+	}
+	cHTTPRequest LongHeadersRequest;
+	testassert(ParseRequest(LongHeadersRequest, LongHeaders, std::vector<size_t>()) == AString::npos);
+}
+
+
+
+
+
+/** Collects all the parts reported by the multipart parser into a single string, so that they can be compared. */
+class cPartCollector :
+	public cMultipartParser::cCallbacks
+{
+public:
+	AString m_Result;
+
+	virtual void OnPartStart(void) override
+	{
+		m_Result.append("<start>");
+	}
+
+	virtual void OnPartHeader(const AString & a_Key, const AString & a_Value) override
+	{
+		m_Result.append(Printf("<header %s=%s>", a_Key.c_str(), a_Value.c_str()));
+	}
+
+	virtual void OnPartData(const char * a_Data, size_t a_Size) override
+	{
+		m_Result.append(a_Data, a_Size);
+	}
+
+	virtual void OnPartEnd(void) override
+	{
+		m_Result.append("<end>");
+	}
+};
+
+
+
+
+
+/** Parses the multipart body whole and split into chunks of every size, the reported parts must be the same. */
+static void TestMultipart(void)
+{
+	LOG("Testing the multipart parsing...");
+	AString Data(TEST_MULTIPART);
+	const char ContentType[] = "multipart/form-data; boundary=XyZ";
+	cPartCollector Whole;
+	{
+		cMultipartParser Parser(ContentType, Whole);
+		Parser.Parse(Data.data(), Data.size());
+	}
+	testassert(Whole.m_Result ==
+		"\r\npreamble<end><start>"
+		"<header Content-Disposition=form-data; name=\"first\">"
+		"value1<end><start>"
+		"<header Content-Disposition=form-data; name=\"second\">"
+		"<header Content-Type=text/plain>"
+		"line1\r\n--XyZnot a boundary\r\nline3<end>"
+	);
+
+	for (size_t ChunkSize = 1; ChunkSize < Data.size(); ChunkSize++)
+	{
+		cPartCollector Split;
+		{
+			cMultipartParser Parser(ContentType, Split);
+			for (size_t i = 0; i < Data.size(); i += ChunkSize)
+			{
+				Parser.Parse(Data.data() + i, std::min(ChunkSize, Data.size() - i));
+			}
+		}
+		testassert(Split.m_Result == Whole.m_Result);
+	}
+}
+
+
+
+
+
+/** Parses the name-value pairs whole and byte by byte, the resulting maps must be the same. */
+static void TestNameValue(void)
+{
+	LOG("Testing the name-value parsing...");
+	AString Data(TEST_NAME_VALUE);
+	cNameValueParser Whole(Data.data(), Data.size());
+	testassert(Whole.Finish());
+	testassert(Whole.size() == 6);
+	testassert(Whole["Name1"] == "Value1");
+	testassert(Whole["Name2"] == " Value 2");  // Raw values keep the leading space
+	testassert(Whole["Name3"] == "Value 3");
+	testassert(Whole["Name4"] == "Value 4");
+	testassert(Whole["Name5"] == "Confusing; isn't it?");
+	testassert(Whole["Name6"] == "");
+
+	cNameValueParser ByteByByte;
+	for (size_t i = 0; i < Data.size(); i++)
+	{
+		ByteByByte.Parse(Data.data() + i, 1);
+	}
+	testassert(ByteByByte.Finish());
+	testassert(ByteByByte == Whole);
+
+	// Unterminated quotes are invalid:
+	cNameValueParser Unterminated("Name=\"Value", 11);
+	testassert(!Unterminated.Finish());
+}
+
+
+
+
+
+/** Ignores the files in the form data, the tested forms have none. */
+class cNoFiles :
+	public cHTTPFormParser::cCallbacks
+{
+public:
+	virtual void OnFileStart(cHTTPFormParser & a_Parser, const AString & a_FileName) override
+	{
+		testassert(!"Unexpected file in the form");
+	}
+
+	virtual void OnFileData(cHTTPFormParser & a_Parser, const char * a_Data, size_t a_Size) override
+	{
+		testassert(!"Unexpected file in the form");
+	}
+
+	virtual void OnFileEnd(cHTTPFormParser & a_Parser) override
+	{
+		testassert(!"Unexpected file in the form");
+	}
+};
+
+
+
+
+
+/** Parses the urlencoded forms, received in two pieces; checks the decoding and the rejection of malformed variables. */
+static void TestFormUrlEncoded(void)
+{
+	LOG("Testing the urlencoded form parsing...");
+	cNoFiles Callbacks;
+	AString Data("a=1&b=x+y%20z%2B&c&d=&e=f=&=g&");
+	cHTTPFormParser Form(cHTTPFormParser::fpkFormUrlEncoded, Data.data(), 10, Callbacks);
+	Form.Parse(Data.data() + 10, Data.size() - 10);
+	testassert(Form.Finish());
+	testassert(Form.size() == 6);
+	testassert(Form["a"] == "1");
+	testassert(Form["b"] == "x y z+");
+	testassert(Form["c"] == "");
+	testassert(Form["d"] == "");
+	testassert(Form["e"] == "f");
+	testassert(Form[""] == "g");
+
+	const char * Invalid[] =
+	{
+		"&",
+		"a=1&&b=2",
+		"a==b",
+		"a=b==",
+	};
+	for (size_t i = 0; i < ARRAYCOUNT(Invalid); i++)
+	{
+		cHTTPFormParser InvalidForm(cHTTPFormParser::fpkFormUrlEncoded, Invalid[i], strlen(Invalid[i]), Callbacks);
+		testassert(!InvalidForm.Finish());
+	}
+}
+
+
+
+
+
+int main()
+{
+	TestRequestSplits();
+	TestRequestErrors();
+	TestMultipart();
+	TestNameValue();
+	TestFormUrlEncoded();
+	LOG("HTTP parsing test finished.");
+	return 0;
+}
+
+
+
+
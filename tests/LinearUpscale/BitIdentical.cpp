@@ -0,0 +1,243 @@
+
+// BitIdentical.cpp
+
+// Tests that the row-wise upscalers in LinearUpscale.h produce exactly the same values as the original
+// cell-by-cell implementation, for the array shapes and upscale factors used by the generators
+
+#include "Globals.h"
+#include "LinearUpscale.h"
+
+
+
+
+
+/** The original implementation of LinearUpscale2DArray(), processing the array cell by cell. */
+template <typename TYPE> void ReferenceUpscale2DArray(
+	TYPE * a_Src,                    ///< Source array of size a_SrcSizeX x a_SrcSizeY
+	int a_SrcSizeX, int a_SrcSizeY,  ///< Dimensions of the src array
+	TYPE * a_Dst,                    ///< Dest array, of size (a_SrcSizeX * a_UpscaleX + 1) x (a_SrcSizeY * a_UpscaleY + 1)
+	int a_UpscaleX, int a_UpscaleY   ///< Upscale factor for each direction
+)
+{
+	// For optimization reasons, we're storing the upscaling ratios in a fixed-size arrays of these sizes
+	// Feel free to enlarge them if needed, but keep in mind that they're on the stack
+	const int MAX_UPSCALE_X = 128;
+	const int MAX_UPSCALE_Y = 128;
+
+	ASSERT(a_Src != nullptr);
+	ASSERT(a_Dst != nullptr);
+	ASSERT(a_SrcSizeX > 0);
+	ASSERT(a_SrcSizeY > 0);
+	ASSERT(a_UpscaleX > 0);
+	ASSERT(a_UpscaleY > 0);
+	ASSERT(a_UpscaleX <= MAX_UPSCALE_X);
+	ASSERT(a_UpscaleY <= MAX_UPSCALE_Y);
+
+	// Pre-calculate the upscaling ratios:
+	TYPE RatioX[MAX_UPSCALE_X + 1];
+	TYPE RatioY[MAX_UPSCALE_Y + 1];
+	for (int x = 0; x <= a_UpscaleX; x++)
+	{
+		RatioX[x] = (TYPE)x / a_UpscaleX;
+	}
+	for (int y = 0; y <= a_UpscaleY; y++)
+	{
+		RatioY[y] = (TYPE)y / a_UpscaleY;
+	}
+
+	// Interpolate each XY cell:
+	int DstSizeX = (a_SrcSizeX - 1) * a_UpscaleX + 1;
+	int DstSizeY = (a_SrcSizeY - 1) * a_UpscaleY + 1;
+	for (int y = 0; y < (a_SrcSizeY - 1); y++)
+	{
+		int DstY = y * a_UpscaleY;
+		int idx = y * a_SrcSizeX;
+		for (int x = 0; x < (a_SrcSizeX - 1); x++, idx++)
+		{
+			int DstX = x * a_UpscaleX;
+			TYPE LoXLoY = a_Src[idx];
+			TYPE LoXHiY = a_Src[idx + a_SrcSizeX];
+			TYPE HiXLoY = a_Src[idx + 1];
+			TYPE HiXHiY = a_Src[idx + 1 + a_SrcSizeX];
+			for (int CellY = 0; CellY <= a_UpscaleY; CellY++)
+			{
+				int DestIdx = (DstY + CellY) * DstSizeX + DstX;
+				ASSERT(DestIdx + a_UpscaleX < DstSizeX * DstSizeY);
+				TYPE LoXInY = LoXLoY + (LoXHiY - LoXLoY) * RatioY[CellY];
+				TYPE HiXInY = HiXLoY + (HiXHiY - HiXLoY) * RatioY[CellY];
+				for (int CellX = 0; CellX <= a_UpscaleX; CellX++, DestIdx++)
+				{
+					a_Dst[DestIdx] = LoXInY + (HiXInY - LoXInY) * RatioX[CellX];
+				}
+			}  // for CellY
+		}  // for x
+	}  // for y
+}
+
+
+
+
+
+template <typename TYPE> void ReferenceUpscale3DArray(
+	TYPE * a_Src,                                    ///< Source array of size a_SrcSizeX x a_SrcSizeY x a_SrcSizeZ
+	int a_SrcSizeX, int a_SrcSizeY, int a_SrcSizeZ,  ///< Dimensions of the src array
+	TYPE * a_Dst,                                    ///< Dest array, of size (a_SrcSizeX * a_UpscaleX + 1) x (a_SrcSizeY * a_UpscaleY + 1) x (a_SrcSizeZ * a_UpscaleZ + 1)
+	int a_UpscaleX, int a_UpscaleY, int a_UpscaleZ   ///< Upscale factor for each direction
+)
+{
+	// For optimization reasons, we're storing the upscaling ratios in a fixed-size arrays of these sizes
+	// Feel free to enlarge them if needed, but keep in mind that they're on the stack
+	const int MAX_UPSCALE_X = 128;
+	const int MAX_UPSCALE_Y = 128;
+	const int MAX_UPSCALE_Z = 128;
+
+	ASSERT(a_Src != nullptr);
+	ASSERT(a_Dst != nullptr);
+	ASSERT(a_SrcSizeX > 0);
+	ASSERT(a_SrcSizeY > 0);
+	ASSERT(a_SrcSizeZ > 0);
+	ASSERT(a_UpscaleX > 0);
+	ASSERT(a_UpscaleY > 0);
+	ASSERT(a_UpscaleZ > 0);
+	ASSERT(a_UpscaleX <= MAX_UPSCALE_X);
+	ASSERT(a_UpscaleY <= MAX_UPSCALE_Y);
+	ASSERT(a_UpscaleZ <= MAX_UPSCALE_Z);
+
+	// Pre-calculate the upscaling ratios:
+	TYPE RatioX[MAX_UPSCALE_X + 1];
+	TYPE RatioY[MAX_UPSCALE_Y + 1];
+	TYPE RatioZ[MAX_UPSCALE_Z + 1];
+	for (int x = 0; x <= a_UpscaleX; x++)
+	{
+		RatioX[x] = (TYPE)x / a_UpscaleX;
+	}
+	for (int y = 0; y <= a_UpscaleY; y++)
+	{
+		RatioY[y] = (TYPE)y / a_UpscaleY;
+	}
+	for (int z = 0; z <= a_UpscaleZ; z++)
+	{
+		RatioZ[z] = (TYPE)z / a_UpscaleZ;
+	}
+
+	// Interpolate each XYZ cell:
+	int DstSizeX = (a_SrcSizeX - 1) * a_UpscaleX + 1;
+	int DstSizeY = (a_SrcSizeY - 1) * a_UpscaleY + 1;
+	int DstSizeZ = (a_SrcSizeZ - 1) * a_UpscaleZ + 1;
+	for (int z = 0; z < (a_SrcSizeZ - 1); z++)
+	{
+		int DstZ = z * a_UpscaleZ;
+		for (int y = 0; y < (a_SrcSizeY - 1); y++)
+		{
+			int DstY = y * a_UpscaleY;
+			int idx = y * a_SrcSizeX + z * a_SrcSizeX * a_SrcSizeY;
+			for (int x = 0; x < (a_SrcSizeX - 1); x++, idx++)
+			{
+				int DstX = x * a_UpscaleX;
+				TYPE LoXLoYLoZ = a_Src[idx];
+				TYPE LoXLoYHiZ = a_Src[idx + a_SrcSizeX * a_SrcSizeY];
+				TYPE LoXHiYLoZ = a_Src[idx + a_SrcSizeX];
+				TYPE LoXHiYHiZ = a_Src[idx + a_SrcSizeX + a_SrcSizeX * a_SrcSizeY];
+				TYPE HiXLoYLoZ = a_Src[idx + 1];
+				TYPE HiXLoYHiZ = a_Src[idx + 1 + a_SrcSizeX * a_SrcSizeY];
+				TYPE HiXHiYLoZ = a_Src[idx + 1 + a_SrcSizeX];
+				TYPE HiXHiYHiZ = a_Src[idx + 1 + a_SrcSizeX + a_SrcSizeX * a_SrcSizeY];
+				for (int CellZ = 0; CellZ <= a_UpscaleZ; CellZ++)
+				{
+					TYPE LoXLoYInZ = LoXLoYLoZ + (LoXLoYHiZ - LoXLoYLoZ) * RatioZ[CellZ];
+					TYPE LoXHiYInZ = LoXHiYLoZ + (LoXHiYHiZ - LoXHiYLoZ) * RatioZ[CellZ];
+					TYPE HiXLoYInZ = HiXLoYLoZ + (HiXLoYHiZ - HiXLoYLoZ) * RatioZ[CellZ];
+					TYPE HiXHiYInZ = HiXHiYLoZ + (HiXHiYHiZ - HiXHiYLoZ) * RatioZ[CellZ];
+					for (int CellY = 0; CellY <= a_UpscaleY; CellY++)
+					{
+						int DestIdx = (DstZ + CellZ) * DstSizeX * DstSizeY + (DstY + CellY) * DstSizeX + DstX;
+						ASSERT(DestIdx + a_UpscaleX < DstSizeX * DstSizeY * DstSizeZ);
+						TYPE LoXInY = LoXLoYInZ + (LoXHiYInZ - LoXLoYInZ) * RatioY[CellY];
+						TYPE HiXInY = HiXLoYInZ + (HiXHiYInZ - HiXLoYInZ) * RatioY[CellY];
+						for (int CellX = 0; CellX <= a_UpscaleX; CellX++, DestIdx++)
+						{
+							a_Dst[DestIdx] = LoXInY + (HiXInY - LoXInY) * RatioX[CellX];
+						}
+					}  // for CellY
+				}  // for CellZ
+			}  // for x
+		}  // for y
+	}  // for z
+}
+
+
+
+
+
+/** Fills the array with pseudo-random values, including negative ones and values with many significant bits. */
+static void FillRandom(std::vector<float> & a_Array, unsigned a_Seed)
+{
+	unsigned Val = a_Seed;
+	for (auto & v: a_Array)
+	{
+		Val = Val * 1103515245 + 12345;
+		v = static_cast<float>(static_cast<int>(Val >> 8) % 20000 - 10000) / 77.7f;
+	}
+}
+
+
+
+
+
+static void Test2D(int a_SrcSizeX, int a_SrcSizeY, int a_UpscaleX, int a_UpscaleY)
+{
+	std::vector<float> Src(static_cast<size_t>(a_SrcSizeX * a_SrcSizeY));
+	FillRandom(Src, static_cast<unsigned>(a_SrcSizeX * 31 + a_UpscaleX));
+	size_t DstSize = static_cast<size_t>(((a_SrcSizeX - 1) * a_UpscaleX + 1) * ((a_SrcSizeY - 1) * a_UpscaleY + 1));
+	std::vector<float> Expected(DstSize), Actual(DstSize);
+	ReferenceUpscale2DArray(Src.data(), a_SrcSizeX, a_SrcSizeY, Expected.data(), a_UpscaleX, a_UpscaleY);
+	LinearUpscale2DArray(Src.data(), a_SrcSizeX, a_SrcSizeY, Actual.data(), a_UpscaleX, a_UpscaleY);
+	testassert(memcmp(Expected.data(), Actual.data(), DstSize * sizeof(float)) == 0);
+}
+
+
+
+
+
+static void Test3D(int a_SrcSizeX, int a_SrcSizeY, int a_SrcSizeZ, int a_UpscaleX, int a_UpscaleY, int a_UpscaleZ)
+{
+	std::vector<float> Src(static_cast<size_t>(a_SrcSizeX * a_SrcSizeY * a_SrcSizeZ));
+	FillRandom(Src, static_cast<unsigned>(a_SrcSizeX * 31 + a_SrcSizeZ * 7 + a_UpscaleX));
+	size_t DstSize = static_cast<size_t>(
+		((a_SrcSizeX - 1) * a_UpscaleX + 1) * ((a_SrcSizeY - 1) * a_UpscaleY + 1) * ((a_SrcSizeZ - 1) * a_UpscaleZ + 1)
+	);
+	std::vector<float> Expected(DstSize), Actual(DstSize);
+	ReferenceUpscale3DArray(Src.data(), a_SrcSizeX, a_SrcSizeY, a_SrcSizeZ, Expected.data(), a_UpscaleX, a_UpscaleY, a_UpscaleZ);
+	LinearUpscale3DArray(Src.data(), a_SrcSizeX, a_SrcSizeY, a_SrcSizeZ, Actual.data(), a_UpscaleX, a_UpscaleY, a_UpscaleZ);
+	testassert(memcmp(Expected.data(), Actual.data(), DstSize * sizeof(float)) == 0);
+}
+
+
+
+
+
+int main(int argc, char ** argv)
+{
+	// The shapes used by the generators:
+	Test3D(33, 5, 5, 8, 4, 4);    // cNoise3DGenerator, cBiomalNoise3DComposable, cTwoHeights
+	Test3D(5, 33, 5, 4, 8, 4);    // cNoise3DComposable
+	Test3D(3, 65, 3, 8, 4, 8);    // cDistortedHeightmap
+	Test3D(5, 5, 65, 4, 4, 4);    // cEndGen
+	Test3D(3, 3, 3, 8, 16, 17);   // Noise3DGenerator's upscale test
+	Test2D(3, 3, 8, 16);
+	Test2D(5, 5, 4, 4);
+	Test2D(2, 2, 16, 16);
+
+	// The fallback for other upscale factors:
+	Test3D(4, 3, 5, 5, 3, 7);
+	Test3D(2, 2, 2, 1, 1, 1);
+	Test2D(7, 4, 3, 5);
+	Test2D(3, 3, 128, 2);
+
+	LOG("LinearUpscale test finished");
+	return 0;
+}
+
+
+
+
@@ -0,0 +1,362 @@
+
+// RCONLoopback.cpp
+
+// Implements a test of the RCON server, talking to it over a loopback connection using the cNetwork API
+
+#include "Globals.h"
+#include <thread>
+#include "OSSupport/Event.h"
+#include "OSSupport/Network.h"
+#include "RCONServer.h"
+#include "CommandOutput.h"
+#include "Root.h"
+
+
+
+
+
+/** The port on which the test RCON server listens. */
+static const UInt16 TEST_PORT = 9877;
+
+/** The password for the test RCON server. */
+static const char TEST_PASSWORD[] = "TestPassword";
+
+/** How long to wait for the responses before failing the test, in milliseconds. */
+static const unsigned TEST_TIMEOUT = 10000;
+
+
+
+
+
+// The RCON server queues its commands through cRoot, stub it out; the test server below doesn't use it:
+cRoot * cRoot::s_Root = nullptr;
+
+void cRoot::QueueExecuteConsoleCommand(const AString & a_Cmd, cCommandOutputCallback & a_Output)
+{
+	a_Output.Finished();
+}
+
+
+
+
+
+/** RCON server that executes the commands on separate threads.
+Each command is "<delay in msec> <text>"; the output, the text, is produced after the delay,
+so the commands sent together finish in a different order than they were sent. */
+class cTestRCONServer :
+	public cRCONServer
+{
+public:
+	~cTestRCONServer()
+	{
+		for (std::vector<std::thread>::iterator itr = m_Threads.begin(), end = m_Threads.end(); itr != end; ++itr)
+		{
+			itr->join();
+		}
+	}
+
+	bool Start(void)
+	{
+		m_Password = TEST_PASSWORD;
+		return Listen(Printf("%d", TEST_PORT));
+	}
+
+protected:
+	std::vector<std::thread> m_Threads;
+
+	virtual void ExecuteCommand(const AString & a_Command, cCommandOutputCallback & a_Output) override
+	{
+		m_Threads.push_back(std::thread([a_Command, &a_Output]()
+			{
+				size_t Space = a_Command.find(' ');
+				int Delay = 0;
+				StringToInteger(a_Command.substr(0, Space), Delay);
+				std::this_thread::sleep_for(std::chrono::milliseconds(Delay));
+				a_Output.Out((Space == AString::npos) ? AString() : a_Command.substr(Space + 1));
+				a_Output.Finished();
+			}
+		));
+	}
+};
+
+
+
+
+
+/** Returns the RCON packet with the specified contents, as sent over the wire. */
+static AString MakePacket(int a_RequestID, int a_PacketType, const AString & a_Payload)
+{
+	AString res;
+	int Ints[] = {static_cast<int>(a_Payload.size()) + 10, a_RequestID, a_PacketType};
+	for (size_t i = 0; i < ARRAYCOUNT(Ints); i++)
+	{
+		for (int b = 0; b < 32; b += 8)
+		{
+			res.push_back(static_cast<char>((Ints[i] >> b) & 0xff));
+		}
+	}
+	res.append(a_Payload);
+	res.append(2, '\0');
+	return res;
+}
+
+
+
+
+
+/** The RCON client side of the test: parses the incoming responses and signals when the expected number of them has arrived. */
+class cRCONClientCallbacks :
+	public cTCPLink::cCallbacks
+{
+public:
+	/** A single response received from the server */
+	struct sResponse
+	{
+		int m_RequestID;
+		AString m_Payload;
+	};
+	typedef std::vector<sResponse> sResponses;
+
+
+	cRCONClientCallbacks(size_t a_NumExpected) :
+		m_NumExpected(a_NumExpected),
+		m_IsClosed(false)
+	{
+	}
+
+	/** Waits until the expected number of responses arrives; returns false on timeout. */
+	bool WaitForResponses(void)
+	{
+		return m_EvtDone.Wait(TEST_TIMEOUT);
+	}
+
+	/** Waits until the server closes the connection; returns false on timeout. */
+	bool WaitForClose(void)
+	{
+		return m_EvtClosed.Wait(TEST_TIMEOUT);
+	}
+
+	sResponses GetResponses(void)
+	{
+		cCSLock Lock(m_CS);
+		return m_Responses;
+	}
+
+	void Send(const AString & a_Data)
+	{
+		cCSLock Lock(m_CS);
+		testassert(m_Link != nullptr);
+		m_Link->Send(a_Data);
+	}
+
+	void Close(void)
+	{
+		cCSLock Lock(m_CS);
+		if (m_Link != nullptr)
+		{
+			m_Link->Close();
+			m_Link.reset();
+		}
+	}
+
+protected:
+	cCriticalSection m_CS;
+	cTCPLinkPtr m_Link;
+	AString m_Buffer;
+	sResponses m_Responses;
+	size_t m_NumExpected;
+	bool m_IsClosed;
+	cEvent m_EvtDone;
+	cEvent m_EvtClosed;
+
+
+	// cTCPLink::cCallbacks overrides:
+	virtual void OnLinkCreated(cTCPLinkPtr a_Link) override
+	{
+		cCSLock Lock(m_CS);
+		m_Link = a_Link;
+	}
+
+	virtual void OnReceivedData(const char * a_Data, size_t a_Length) override
+	{
+		cCSLock Lock(m_CS);
+		m_Buffer.append(a_Data, a_Length);
+		while (m_Buffer.size() >= 4)
+		{
+			int Length = static_cast<int>(
+				static_cast<Byte>(m_Buffer[0]) | (static_cast<Byte>(m_Buffer[1]) << 8) |
+				(static_cast<Byte>(m_Buffer[2]) << 16) | (static_cast<Byte>(m_Buffer[3]) << 24)
+			);
+			testassert(Length >= 10);
+			if (m_Buffer.size() < static_cast<size_t>(Length) + 4)
+			{
+				break;
+			}
+			sResponse Response;
+			Response.m_RequestID = static_cast<int>(
+				static_cast<Byte>(m_Buffer[4]) | (static_cast<Byte>(m_Buffer[5]) << 8) |
+				(static_cast<Byte>(m_Buffer[6]) << 16) | (static_cast<Byte>(m_Buffer[7]) << 24)
+			);
+			Response.m_Payload.assign(m_Buffer, 12, static_cast<size_t>(Length) - 10);
+			m_Responses.push_back(Response);
+			m_Buffer.erase(0, static_cast<size_t>(Length) + 4);
+			if (m_Responses.size() == m_NumExpected)
+			{
+				m_EvtDone.Set();
+			}
+		}
+	}
+
+	virtual void OnRemoteClosed(void) override
+	{
+		cCSLock Lock(m_CS);
+		m_Link.reset();
+		m_EvtClosed.Set();
+	}
+
+	virtual void OnError(int a_ErrorCode, const AString & a_ErrorMsg) override
+	{
+		LOGD("Client link error %d (%s)", a_ErrorCode, a_ErrorMsg.c_str());
+		cCSLock Lock(m_CS);
+		m_Link.reset();
+		m_EvtClosed.Set();
+	}
+};
+
+typedef SharedPtr<cRCONClientCallbacks> cRCONClientCallbacksPtr;
+
+
+
+
+
+/** Connect callbacks that only report failure. */
+class cConnectCallbacks :
+	public cNetwork::cConnectCallbacks
+{
+public:
+	cConnectCallbacks(cEvent & a_Event) :
+		m_Event(a_Event)
+	{
+	}
+
+protected:
+	cEvent & m_Event;
+
+	virtual void OnConnected(cTCPLink & a_Link) override
+	{
+		m_Event.Set();
+	}
+
+	virtual void OnError(int a_ErrorCode, const AString & a_ErrorMsg) override
+	{
+		LOGWARNING("Cannot connect to the RCON server: %d (%s)", a_ErrorCode, a_ErrorMsg.c_str());
+		abort();
+	}
+};
+
+
+
+
+
+/** Connects a new client to the test server, expecting the specified number of responses. */
+static cRCONClientCallbacksPtr Connect(size_t a_NumExpected)
+{
+	cEvent EvtConnected;
+	cRCONClientCallbacksPtr Client = std::make_shared<cRCONClientCallbacks>(a_NumExpected);
+	testassert(cNetwork::Connect("127.0.0.1", TEST_PORT, std::make_shared<cConnectCallbacks>(EvtConnected), Client));
+	testassert(EvtConnected.Wait(TEST_TIMEOUT));
+	return Client;
+}
+
+
+
+
+
+/** Sends the login and several commands at once; the responses must come in the order of the requests,
+even though the commands finish in a different order. The last packet arrives byte by byte. */
+static void TestPipelined(void)
+{
+	LOG("Testing pipelined requests...");
+	cRCONClientCallbacksPtr Client = Connect(5);
+	AString Requests;
+	Requests.append(MakePacket(1, 3, TEST_PASSWORD));
+	Requests.append(MakePacket(2, 2, "300 first"));
+	Requests.append(MakePacket(3, 2, "0 second"));
+	Requests.append(MakePacket(4, 2, "100 third"));
+	Client->Send(Requests);
+	AString Last = MakePacket(5, 2, "0 fourth");
+	for (size_t i = 0; i < Last.size(); i++)
+	{
+		Client->Send(Last.substr(i, 1));
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	testassert(Client->WaitForResponses());
+
+	cRCONClientCallbacks::sResponses Responses = Client->GetResponses();
+	testassert(Responses.size() == 5);
+	const char * Payloads[] = {"", "first", "second", "third", "fourth"};
+	for (size_t i = 0; i < Responses.size(); i++)
+	{
+		testassert(Responses[i].m_RequestID == static_cast<int>(i) + 1);
+		testassert(Responses[i].m_Payload == Payloads[i]);
+	}
+	Client->Close();
+}
+
+
+
+
+
+/** A bad password gets the -1 response and the connection is dropped. */
+static void TestBadPassword(void)
+{
+	LOG("Testing a bad password...");
+	cRCONClientCallbacksPtr Client = Connect(1);
+	Client->Send(MakePacket(1, 3, "WrongPassword"));
+	testassert(Client->WaitForResponses());
+	cRCONClientCallbacks::sResponses Responses = Client->GetResponses();
+	testassert(Responses[0].m_RequestID == -1);
+	testassert(Client->WaitForClose());
+}
+
+
+
+
+
+/** A command without logging in first is refused and the connection is dropped. */
+static void TestUnauthenticated(void)
+{
+	LOG("Testing an unauthenticated command...");
+	cRCONClientCallbacksPtr Client = Connect(1);
+	Client->Send(MakePacket(7, 2, "0 text"));
+	testassert(Client->WaitForResponses());
+	cRCONClientCallbacks::sResponses Responses = Client->GetResponses();
+	testassert(Responses[0].m_RequestID == 7);
+	testassert(Responses[0].m_Payload == "You need to authenticate first!");
+	testassert(Client->WaitForClose());
+}
+
+
+
+
+
+int main()
+{
+	cTestRCONServer Server;
+	if (!Server.Start())
+	{
+		LOGWARNING("Cannot listen on port %d", TEST_PORT);
+		abort();
+	}
+
+	TestPipelined();
+	TestBadPassword();
+	TestUnauthenticated();
+
+	LOG("RCON test finished.");
+	return 0;
+}
+
+
+
+